@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/aggregate.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace aggregate
+{
+using flat_group_tags =
+    benchmark_schema::schema::messages::msg1::flat_group;
+
+constexpr sbepp::endian byte_order =
+    sbepp::schema_traits<benchmark_schema::schema>::byte_order();
+
+// message with `flat_group` of `entry_count` entries and empty rest groups
+class group_message
+{
+public:
+    explicit group_message(const std::size_t entry_count)
+        : buffer(0x100 + entry_count * 20)
+    {
+        auto m = sbepp::make_view<benchmark_schema::messages::msg1>(
+            buffer.data(), buffer.size());
+        sbepp::fill_message_header(m);
+        auto g = m.flat_group();
+        sbepp::fill_group_header(g, entry_count);
+        std::uint32_t i{};
+        for(auto e : g)
+        {
+            e.field1(1000 + (i * 7) % 13);
+            e.field2(1 + i % 100);
+            e.field3(i);
+            e.field4(i);
+            e.field5(i);
+            i++;
+        }
+        sbepp::fill_group_header(m.nested_group(), 0);
+        sbepp::fill_group_header(m.nested_group2(), 0);
+        m.data().resize(0);
+    }
+
+    benchmark_schema::messages::msg1<const std::uint8_t> view() const
+    {
+        return sbepp::make_const_view<benchmark_schema::messages::msg1>(
+            buffer.data(), buffer.size());
+    }
+
+private:
+    std::vector<std::uint8_t> buffer;
+};
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of entries
+    b->Arg(16);
+    b->Arg(256);
+    b->Arg(1000);
+}
+
+void set_processed(::benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void accessor_sum(::benchmark::State& state)
+{
+    const group_message msg{static_cast<std::size_t>(state.range(0))};
+    const auto m = msg.view();
+
+    for(auto _ : state)
+    {
+        std::uint64_t sum{};
+        for(const auto e : m.flat_group())
+        {
+            sum += *e.field1();
+        }
+        ::benchmark::DoNotOptimize(sum);
+    }
+
+    set_processed(state);
+}
+
+BENCHMARK(aggregate::accessor_sum)->Apply(aggregate::configure_benchmark);
+
+void kernel_sum(::benchmark::State& state)
+{
+    const group_message msg{static_cast<std::size_t>(state.range(0))};
+    const auto m = msg.view();
+
+    for(auto _ : state)
+    {
+        ::benchmark::DoNotOptimize(sbepp::column_sum(
+            sbepp::make_group_column<flat_group_tags::field1, byte_order>(
+                m.flat_group())));
+    }
+
+    set_processed(state);
+}
+
+BENCHMARK(aggregate::kernel_sum)->Apply(aggregate::configure_benchmark);
+
+void accessor_min_max(::benchmark::State& state)
+{
+    const group_message msg{static_cast<std::size_t>(state.range(0))};
+    const auto m = msg.view();
+
+    for(auto _ : state)
+    {
+        auto min = (std::numeric_limits<std::uint32_t>::max)();
+        std::uint32_t max{};
+        for(const auto e : m.flat_group())
+        {
+            const auto v = *e.field1();
+            min = (std::min)(min, v);
+            max = (std::max)(max, v);
+        }
+        ::benchmark::DoNotOptimize(min);
+        ::benchmark::DoNotOptimize(max);
+    }
+
+    set_processed(state);
+}
+
+BENCHMARK(aggregate::accessor_min_max)->Apply(aggregate::configure_benchmark);
+
+void kernel_min_max(::benchmark::State& state)
+{
+    const group_message msg{static_cast<std::size_t>(state.range(0))};
+    const auto m = msg.view();
+
+    for(auto _ : state)
+    {
+        ::benchmark::DoNotOptimize(sbepp::column_min_max(
+            sbepp::make_group_column<flat_group_tags::field1, byte_order>(
+                m.flat_group())));
+    }
+
+    set_processed(state);
+}
+
+BENCHMARK(aggregate::kernel_min_max)->Apply(aggregate::configure_benchmark);
+
+// VWAP-like `field1 * field2` weighted sum
+void accessor_weighted_sum(::benchmark::State& state)
+{
+    const group_message msg{static_cast<std::size_t>(state.range(0))};
+    const auto m = msg.view();
+
+    for(auto _ : state)
+    {
+        double sum{};
+        double weight{};
+        for(const auto e : m.flat_group())
+        {
+            const double w = *e.field2();
+            sum += *e.field1() * w;
+            weight += w;
+        }
+        ::benchmark::DoNotOptimize(sum);
+        ::benchmark::DoNotOptimize(weight);
+    }
+
+    set_processed(state);
+}
+
+BENCHMARK(aggregate::accessor_weighted_sum)
+    ->Apply(aggregate::configure_benchmark);
+
+void kernel_weighted_sum(::benchmark::State& state)
+{
+    const group_message msg{static_cast<std::size_t>(state.range(0))};
+    const auto m = msg.view();
+
+    for(auto _ : state)
+    {
+        const auto g = m.flat_group();
+        ::benchmark::DoNotOptimize(sbepp::column_weighted_sum(
+            sbepp::make_group_column<flat_group_tags::field1, byte_order>(g),
+            sbepp::make_group_column<flat_group_tags::field2, byte_order>(g)));
+    }
+
+    set_processed(state);
+}
+
+BENCHMARK(aggregate::kernel_weighted_sum)
+    ->Apply(aggregate::configure_benchmark);
+} // namespace aggregate
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/batch_encoder.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace batch_encoder
+{
+using trade_tag = benchmark_schema::schema::messages::trade;
+using encoder_type =
+    sbepp::batch_encoder<benchmark_schema::schema, trade_tag>;
+
+constexpr std::uint32_t security_id = 123;
+constexpr char symbol[] = "SBEPP";
+
+template<typename Array>
+void set_symbol(Array a)
+{
+    std::copy(std::begin(symbol), std::end(symbol) - 1, a.begin());
+}
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of messages per batch
+    b->Arg(16);
+    b->Arg(128);
+    b->Arg(1024);
+}
+
+struct row
+{
+    std::uint64_t timestamp;
+    std::int64_t price;
+    std::uint32_t quantity;
+};
+
+std::vector<row> generate_rows(const std::size_t n)
+{
+    std::mt19937 mt;
+    std::uniform_int_distribution<std::uint32_t> dist;
+    std::vector<row> rows(n);
+    for(auto& r : rows)
+    {
+        r.timestamp = dist(mt);
+        r.price = dist(mt);
+        r.quantity = dist(mt);
+    }
+
+    return rows;
+}
+
+void one_at_a_time_benchmark(::benchmark::State& state)
+{
+    const auto rows =
+        generate_rows(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint8_t> buf(rows.size() * encoder_type::message_size());
+
+    for(auto _ : state)
+    {
+        auto ptr = buf.data();
+        for(const auto& r : rows)
+        {
+            auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+                ptr, encoder_type::message_size());
+            sbepp::fill_message_header(m);
+            m.securityId(security_id);
+            set_symbol(m.symbol());
+            m.timestamp(r.timestamp);
+            m.price(r.price);
+            m.quantity(r.quantity);
+            ptr += sbepp::size_bytes(m);
+        }
+        ::benchmark::DoNotOptimize(buf.data());
+        ::benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * rows.size()));
+}
+
+void batch_benchmark(::benchmark::State& state)
+{
+    const auto rows =
+        generate_rows(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint8_t> buf(rows.size() * encoder_type::message_size());
+    encoder_type encoder;
+    encoder.prototype().securityId(security_id);
+    set_symbol(encoder.prototype().symbol());
+
+    for(auto _ : state)
+    {
+        const auto n = encoder.encode(
+            buf.data(),
+            buf.size(),
+            rows.begin(),
+            rows.end(),
+            [](encoder_type::message_type m, const row& r)
+            {
+                m.timestamp(r.timestamp);
+                m.price(r.price);
+                m.quantity(r.quantity);
+            });
+        ::benchmark::DoNotOptimize(n);
+        ::benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * rows.size()));
+}
+
+// order entry messages where most fields come from session and instrument
+// configuration, unlike constants above, they are known only at run time
+using new_order_tag = benchmark_schema::schema::messages::new_order;
+using order_encoder_type =
+    sbepp::batch_encoder<benchmark_schema::schema, new_order_tag>;
+
+struct order_config
+{
+    std::uint8_t ord_type;
+    std::uint8_t time_in_force;
+    std::uint8_t exec_inst;
+    std::uint32_t security_id;
+    std::array<char, 8> symbol;
+    std::uint32_t account;
+    std::uint32_t trader_id;
+    std::uint32_t min_qty;
+    std::uint16_t session_id;
+    std::uint16_t firm_id;
+};
+
+order_config load_order_config()
+{
+    order_config res{2, 0, 1, security_id, {}, 1001, 42, 1, 7, 3};
+    std::copy(std::begin(symbol), std::end(symbol) - 1, res.symbol.begin());
+    ::benchmark::DoNotOptimize(res);
+    return res;
+}
+
+template<typename Message>
+void set_shared_order_fields(Message m, const order_config& config)
+{
+    m.ordType(config.ord_type);
+    m.timeInForce(config.time_in_force);
+    m.execInst(config.exec_inst);
+    m.securityId(config.security_id);
+    std::copy(config.symbol.begin(), config.symbol.end(), m.symbol().begin());
+    m.account(config.account);
+    m.traderId(config.trader_id);
+    m.minQty(config.min_qty);
+    m.sessionId(config.session_id);
+    m.firmId(config.firm_id);
+}
+
+template<typename Message>
+void set_order_row_fields(Message m, const row& r)
+{
+    m.clOrdId(r.timestamp);
+    m.price(r.price);
+    m.quantity(r.quantity);
+    m.side(static_cast<std::uint8_t>(r.quantity & 1));
+}
+
+void one_at_a_time_order_benchmark(::benchmark::State& state)
+{
+    const auto rows =
+        generate_rows(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint8_t> buf(
+        rows.size() * order_encoder_type::message_size());
+    const auto config = load_order_config();
+
+    for(auto _ : state)
+    {
+        auto ptr = buf.data();
+        for(const auto& r : rows)
+        {
+            auto m = sbepp::make_view<benchmark_schema::messages::new_order>(
+                ptr, order_encoder_type::message_size());
+            sbepp::fill_message_header(m);
+            set_shared_order_fields(m, config);
+            set_order_row_fields(m, r);
+            ptr += sbepp::size_bytes(m);
+        }
+        ::benchmark::DoNotOptimize(buf.data());
+        ::benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * rows.size()));
+}
+
+void batch_order_benchmark(::benchmark::State& state)
+{
+    const auto rows =
+        generate_rows(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint8_t> buf(
+        rows.size() * order_encoder_type::message_size());
+    order_encoder_type encoder;
+    set_shared_order_fields(encoder.prototype(), load_order_config());
+    // long-lived encoder, its image is not known to the compiler at the
+    // point of `encode()`
+    ::benchmark::DoNotOptimize(encoder);
+
+    for(auto _ : state)
+    {
+        const auto n = encoder.encode(
+            buf.data(),
+            buf.size(),
+            rows.begin(),
+            rows.end(),
+            [](order_encoder_type::message_type m, const row& r)
+            {
+                set_order_row_fields(m, r);
+            });
+        ::benchmark::DoNotOptimize(n);
+        ::benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * rows.size()));
+}
+
+BENCHMARK(batch_encoder::one_at_a_time_benchmark)
+    ->Apply(configure_benchmark);
+BENCHMARK(batch_encoder::batch_benchmark)->Apply(configure_benchmark);
+BENCHMARK(batch_encoder::one_at_a_time_order_benchmark)
+    ->Apply(configure_benchmark);
+BENCHMARK(batch_encoder::batch_order_benchmark)->Apply(configure_benchmark);
+} // namespace batch_encoder
+} // namespace benchmark
+} // namespace sbepp
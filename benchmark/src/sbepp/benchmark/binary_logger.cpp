@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/binary_logger.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace logger
+{
+using message_tag = benchmark_schema::schema::messages::msg1;
+
+constexpr std::size_t number_of_messages = 1000;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // group size, controls message size
+    b->Arg(0);
+    b->Arg(2);
+    b->Arg(5);
+    b->Arg(10);
+}
+
+std::vector<benchmark_schema::messages::msg1<const byte_type>>
+    make_messages(
+        const std::vector<test_data>& test_data, ::benchmark::State& state)
+{
+    std::vector<benchmark_schema::messages::msg1<const byte_type>> messages;
+    std::size_t total_size{};
+    for(const auto& test : test_data)
+    {
+        messages.push_back(
+            sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                test.buffer.data(), test.buffer.size()));
+        total_size += sbepp::size_bytes(messages.back());
+    }
+    state.counters["message_bytes"] =
+        static_cast<double>(total_size) / messages.size();
+    return messages;
+}
+
+// hot path cost of `binary_logger::log()`, formatting is done by the
+// background thread. Ring is drained between iterations so the cost of
+// dropped messages doesn't affect results
+void binary_log_benchmark(::benchmark::State& state)
+{
+    const auto group_size = static_cast<std::size_t>(state.range(0));
+    message_generator msg_generator{group_size, group_size, 32, 32};
+    const auto test_data = msg_generator.generate(number_of_messages);
+    const auto messages = make_messages(test_data, state);
+    std::size_t output_size{};
+    sbepp::binary_logger_options options;
+    options.capacity = 64 * 1024 * 1024;
+    sbepp::binary_logger logger{
+        [&output_size](const char*, const std::size_t size)
+        {
+            output_size += size;
+        },
+        options};
+
+    for(auto _ : state)
+    {
+        for(const auto& m : messages)
+        {
+            ::benchmark::DoNotOptimize(logger.log<message_tag>(m));
+        }
+        state.PauseTiming();
+        logger.flush();
+        state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * messages.size());
+    state.counters["dropped"] = static_cast<double>(logger.dropped());
+    ::benchmark::DoNotOptimize(output_size);
+}
+
+// cost of formatting text on the hot path, what binary logging avoids
+void text_log_benchmark(::benchmark::State& state)
+{
+    const auto group_size = static_cast<std::size_t>(state.range(0));
+    message_generator msg_generator{group_size, group_size, 32, 32};
+    const auto test_data = msg_generator.generate(number_of_messages);
+    const auto messages = make_messages(test_data, state);
+    std::string buffer;
+
+    for(auto _ : state)
+    {
+        for(const auto& m : messages)
+        {
+            buffer.clear();
+            detail::format_log_record(
+                buffer,
+                sbepp::binary_log_format::text,
+                0,
+                sbepp::make_any_message<message_tag>(
+                    sbepp::addressof(m), sbepp::size_bytes(m)));
+            ::benchmark::DoNotOptimize(buffer.data());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * messages.size());
+}
+
+BENCHMARK(logger::binary_log_benchmark)
+    ->Apply(logger::configure_benchmark)
+    ->UseRealTime();
+BENCHMARK(logger::text_log_benchmark)->Apply(logger::configure_benchmark);
+} // namespace logger
+} // namespace benchmark
+} // namespace sbepp
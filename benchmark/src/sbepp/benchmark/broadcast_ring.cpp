@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/broadcast_ring.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace broadcast
+{
+constexpr std::size_t number_of_messages = 1000;
+constexpr std::size_t ring_capacity = 0x40000;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of consumers
+    b->Arg(1);
+    b->Arg(2);
+    b->Arg(4);
+    b->Arg(8);
+    b->Arg(16);
+    b->UseRealTime();
+}
+
+struct messages
+{
+    std::vector<test_data> data;
+    std::vector<std::size_t> sizes;
+    std::uint64_t total_size{};
+};
+
+messages make_messages()
+{
+    message_generator msg_generator{0, 5, 0, 32};
+    messages res;
+    res.data = msg_generator.generate(number_of_messages);
+    for(const auto& test : res.data)
+    {
+        res.sizes.push_back(sbepp::size_bytes(
+            sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                test.buffer.data(), test.buffer.size())));
+        res.total_size += res.sizes.back();
+    }
+    return res;
+}
+
+// each thread polls its consumer until stopped
+class consumers
+{
+public:
+    explicit consumers(std::vector<sbepp::broadcast_ring::consumer> handles)
+        : handles{std::move(handles)}, sums(this->handles.size())
+    {
+        for(std::size_t i = 0; i != this->handles.size(); i++)
+        {
+            threads.emplace_back(&consumers::run, this, i);
+        }
+    }
+
+    ~consumers()
+    {
+        stopped.store(true, std::memory_order_release);
+        for(auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+private:
+    std::vector<sbepp::broadcast_ring::consumer> handles;
+    std::vector<std::uint64_t> sums;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopped{};
+
+    void run(const std::size_t index)
+    {
+        auto& sum = sums[index];
+        while(!stopped.load(std::memory_order_acquire))
+        {
+            const auto n = handles[index].poll(
+                [&sum](const std::uint8_t* data, const std::size_t size)
+                {
+                    const auto m = sbepp::make_const_view<
+                        benchmark_schema::messages::msg1>(data, size);
+                    sum += *m.field1() + *m.field5();
+                });
+            if(!n)
+            {
+                std::this_thread::yield();
+            }
+        }
+        ::benchmark::DoNotOptimize(sum);
+    }
+};
+
+void publish(
+    sbepp::broadcast_ring& ring, const byte_type* data, const std::size_t size)
+{
+    while(!ring.try_publish(data, size))
+    {
+        std::this_thread::yield();
+    }
+}
+
+// waits until all consumers read all messages
+void wait(const sbepp::broadcast_ring& ring)
+{
+    while(ring.slowest_consumer().lag)
+    {
+        std::this_thread::yield();
+    }
+}
+
+// single ring, every message is written once and read by all consumers
+void broadcast_benchmark(::benchmark::State& state)
+{
+    const auto number_of_consumers = static_cast<std::size_t>(state.range(0));
+    const auto messages = make_messages();
+    sbepp::broadcast_ring ring{ring_capacity, number_of_consumers};
+    std::vector<sbepp::broadcast_ring::consumer> handles;
+    for(std::size_t i = 0; i != number_of_consumers; i++)
+    {
+        handles.push_back(ring.add_consumer());
+    }
+    consumers c{std::move(handles)};
+
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i != messages.data.size(); i++)
+        {
+            publish(ring, messages.data[i].buffer.data(), messages.sizes[i]);
+        }
+        wait(ring);
+    }
+
+    state.SetBytesProcessed(state.iterations() * messages.total_size);
+    state.SetItemsProcessed(state.iterations() * messages.data.size());
+    state.counters["stalls"] = static_cast<double>(ring.stalls());
+}
+
+// ring per consumer, every message is copied into each of them
+void per_consumer_ring_benchmark(::benchmark::State& state)
+{
+    const auto number_of_consumers = static_cast<std::size_t>(state.range(0));
+    const auto messages = make_messages();
+    std::vector<std::unique_ptr<sbepp::broadcast_ring>> rings;
+    std::vector<sbepp::broadcast_ring::consumer> handles;
+    for(std::size_t i = 0; i != number_of_consumers; i++)
+    {
+        rings.emplace_back(new sbepp::broadcast_ring{ring_capacity, 1});
+        handles.push_back(rings.back()->add_consumer());
+    }
+    consumers c{std::move(handles)};
+
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i != messages.data.size(); i++)
+        {
+            for(auto& ring : rings)
+            {
+                publish(
+                    *ring, messages.data[i].buffer.data(), messages.sizes[i]);
+            }
+        }
+        for(const auto& ring : rings)
+        {
+            wait(*ring);
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * messages.total_size);
+    state.SetItemsProcessed(state.iterations() * messages.data.size());
+}
+
+BENCHMARK(broadcast::broadcast_benchmark)
+    ->Apply(broadcast::configure_benchmark);
+BENCHMARK(broadcast::per_consumer_ring_benchmark)
+    ->Apply(broadcast::configure_benchmark);
+} // namespace broadcast
+} // namespace benchmark
+} // namespace sbepp
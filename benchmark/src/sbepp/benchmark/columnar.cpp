@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/benchmark/config.hpp>
+#include <sbepp/columnar.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace columnar
+{
+// copies generated messages back-to-back as they would be stored in a
+// journal
+std::vector<std::uint8_t> make_journal(const std::vector<test_data>& messages)
+{
+    std::vector<std::uint8_t> journal;
+    for(const auto& test : messages)
+    {
+        const auto size = sbepp::size_bytes(
+            sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                test.buffer.data(), test.buffer.size()));
+        journal.insert(
+            journal.end(), test.buffer.data(), test.buffer.data() + size);
+    }
+    return journal;
+}
+
+void convert_benchmark(::benchmark::State& state)
+{
+    message_generator msg_generator{
+        config::get_min_group_size(state),
+        config::get_max_group_size(state),
+        config::get_min_data_size(state),
+        config::get_max_data_size(state)};
+    const auto journal = make_journal(
+        msg_generator.generate(config::get_number_of_messages(state)));
+    sbepp::columnar_converter<benchmark_schema::messages::msg1> converter;
+
+    for(auto _ : state)
+    {
+        std::size_t offset{};
+        while(offset != journal.size())
+        {
+            const auto m =
+                sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                    journal.data() + offset, journal.size() - offset);
+            offset += sbepp::size_bytes(m);
+            if(converter.append(m))
+            {
+                ::benchmark::DoNotOptimize(converter.tables().data());
+                converter.clear();
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * journal.size());
+    state.SetItemsProcessed(
+        state.iterations() * config::get_number_of_messages(state));
+}
+
+BENCHMARK(columnar::convert_benchmark)->Apply(config::configure_benchmark);
+
+// `msg2` has only a flat group whose entries are copied in bulk
+std::vector<std::uint8_t> make_flat_journal(
+    const std::size_t message_count, const std::size_t entry_count)
+{
+    std::vector<std::uint8_t> journal;
+    std::vector<std::uint8_t> buf(64 * 1024);
+    for(std::size_t i = 0; i != message_count; i++)
+    {
+        auto m = sbepp::make_view<benchmark_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        const auto value = static_cast<std::uint32_t>(i);
+        m.field1(value);
+        m.field2(value + 1);
+        m.field3(value + 2);
+        m.field4(value + 3);
+        auto g = m.group();
+        sbepp::fill_group_header(g, entry_count);
+        for(auto e : g)
+        {
+            e.field1(value);
+            e.field2(value + 1);
+        }
+        journal.insert(
+            journal.end(), buf.data(), buf.data() + sbepp::size_bytes(m));
+    }
+    return journal;
+}
+
+void convert_flat_group_benchmark(::benchmark::State& state)
+{
+    const auto message_count = static_cast<std::size_t>(state.range(0));
+    const auto journal = make_flat_journal(
+        message_count, static_cast<std::size_t>(state.range(1)));
+    sbepp::columnar_converter<benchmark_schema::messages::msg2> converter;
+
+    for(auto _ : state)
+    {
+        std::size_t offset{};
+        while(offset != journal.size())
+        {
+            const auto m =
+                sbepp::make_const_view<benchmark_schema::messages::msg2>(
+                    journal.data() + offset, journal.size() - offset);
+            offset += sbepp::size_bytes(m);
+            if(converter.append(m))
+            {
+                ::benchmark::DoNotOptimize(converter.tables().data());
+                converter.clear();
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * journal.size());
+    state.SetItemsProcessed(state.iterations() * message_count);
+}
+
+// number of messages, group size
+BENCHMARK(columnar::convert_flat_group_benchmark)
+    ->Args({1000, 10})
+    ->Args({1000, 100});
+} // namespace columnar
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/benchmark/config.hpp>
+#include <sbepp/csv.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace csv
+{
+std::vector<std::uint8_t> make_journal(const std::vector<test_data>& messages)
+{
+    std::vector<std::uint8_t> journal;
+    for(const auto& test : messages)
+    {
+        const auto size = sbepp::size_bytes(
+            sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                test.buffer.data(), test.buffer.size()));
+        journal.insert(
+            journal.end(), test.buffer.data(), test.buffer.data() + size);
+    }
+    return journal;
+}
+
+void format_benchmark(::benchmark::State& state)
+{
+    message_generator msg_generator{
+        config::get_min_group_size(state),
+        config::get_max_group_size(state),
+        config::get_min_data_size(state),
+        config::get_max_data_size(state)};
+    const auto journal = make_journal(
+        msg_generator.generate(config::get_number_of_messages(state)));
+    sbepp::csv_formatter<benchmark_schema::messages::msg1> formatter;
+    std::size_t output_size{};
+
+    for(auto _ : state)
+    {
+        std::size_t offset{};
+        while(offset != journal.size())
+        {
+            const auto m =
+                sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                    journal.data() + offset, journal.size() - offset);
+            formatter.format(m);
+            offset += sbepp::size_bytes(m);
+        }
+        output_size = formatter.size();
+        ::benchmark::DoNotOptimize(formatter.data());
+        formatter.clear();
+    }
+
+    state.SetBytesProcessed(state.iterations() * journal.size());
+    state.SetItemsProcessed(
+        state.iterations() * config::get_number_of_messages(state));
+    state.counters["csv_bytes"] = static_cast<double>(output_size);
+}
+
+BENCHMARK(csv::format_benchmark)->Apply(config::configure_benchmark);
+
+#if defined(__linux__)
+void configure_export_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of threads
+    b->Arg(1);
+    b->Arg(2);
+    b->Arg(4);
+    b->Arg(8);
+    b->UseRealTime();
+}
+
+// exports large journal to `/dev/null` using different number of threads
+void export_benchmark(::benchmark::State& state)
+{
+    message_generator msg_generator{0, 20, 0, 32};
+    const auto test_data = msg_generator.generate(1000);
+    std::vector<std::uint8_t> journal;
+    for(std::size_t i = 0; i != 4; i++)
+    {
+        const auto chunk = make_journal(test_data);
+        journal.insert(journal.end(), chunk.begin(), chunk.end());
+    }
+    const auto fd = ::open("/dev/null", O_WRONLY);
+    sbepp::csv_export_options options;
+    options.threads = static_cast<std::size_t>(state.range(0));
+
+    for(auto _ : state)
+    {
+        ::benchmark::DoNotOptimize(
+            sbepp::export_csv<benchmark_schema::messages::msg1>(
+                fd, journal.data(), journal.size(), options));
+    }
+
+    ::close(fd);
+    state.SetBytesProcessed(state.iterations() * journal.size());
+}
+
+BENCHMARK(csv::export_benchmark)->Apply(csv::configure_export_benchmark);
+#endif
+} // namespace csv
+} // namespace benchmark
+} // namespace sbepp
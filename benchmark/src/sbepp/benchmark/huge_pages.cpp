@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/memory.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace huge_pages
+{
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // working set size in MiB
+    b->Arg(64);
+    b->Arg(256);
+}
+
+// fills working set with copies of generated messages and decodes them in
+// random order so nearly each access touches a different page
+void decode_benchmark(::benchmark::State& state, const sbepp::huge_pages pages)
+{
+    const auto working_set_size =
+        static_cast<std::size_t>(state.range(0)) * 1024 * 1024;
+    sbepp::memory_options options;
+    options.pages = pages;
+    options.prefault = true;
+    sbepp::buffer_memory memory{working_set_size, options};
+
+    message_generator msg_generator{0, 4, 0, 16};
+    const auto test_data = msg_generator.generate(100);
+    std::vector<std::size_t> offsets;
+    std::size_t offset{};
+    for(std::size_t i = 0;; i++)
+    {
+        const auto& test = test_data[i % test_data.size()];
+        const auto size = sbepp::size_bytes(
+            sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                test.buffer.data(), test.buffer.size()));
+        if((offset + size) > memory.size())
+        {
+            break;
+        }
+        std::memcpy(memory.data() + offset, test.buffer.data(), size);
+        offsets.push_back(offset);
+        offset += size;
+    }
+    std::shuffle(offsets.begin(), offsets.end(), std::mt19937{});
+    constexpr std::size_t messages_per_iteration = 10000;
+
+    std::size_t next{};
+    for(auto _ : state)
+    {
+        std::uint64_t sum{};
+        for(std::size_t i = 0; i != messages_per_iteration; i++)
+        {
+            auto msg = sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                memory.data() + offsets[next], memory.size() - offsets[next]);
+            sum += *msg.field1() + *msg.field5() + sbepp::size_bytes(msg);
+            next = (next + 1 == offsets.size()) ? 0 : next + 1;
+        }
+        ::benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * messages_per_iteration);
+    state.counters["hugetlb"] = memory.uses_huge_pages();
+}
+
+void regular_pages_benchmark(::benchmark::State& state)
+{
+    decode_benchmark(state, sbepp::huge_pages::disabled);
+}
+
+void transparent_huge_pages_benchmark(::benchmark::State& state)
+{
+    decode_benchmark(state, sbepp::huge_pages::transparent);
+}
+
+void huge_pages_benchmark(::benchmark::State& state)
+{
+    decode_benchmark(state, sbepp::huge_pages::preferred);
+}
+
+BENCHMARK(huge_pages::regular_pages_benchmark)
+    ->Apply(huge_pages::configure_benchmark);
+BENCHMARK(huge_pages::transparent_huge_pages_benchmark)
+    ->Apply(huge_pages::configure_benchmark);
+BENCHMARK(huge_pages::huge_pages_benchmark)
+    ->Apply(huge_pages::configure_benchmark);
+} // namespace huge_pages
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/journal_index.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace journal_index
+{
+#if defined(__linux__)
+using trade = benchmark_schema::messages::trade<const std::uint8_t>;
+using symbol_type = std::array<char, 8>;
+
+constexpr std::uint32_t number_of_securities = 1000000;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // journal size in MiB
+    b->Arg(256);
+    b->Arg(2048);
+    b->Unit(::benchmark::kMillisecond);
+}
+
+// temporary file mapped into memory
+class mapped_file
+{
+public:
+    explicit mapped_file(const std::size_t size)
+        : file{std::tmpfile()}, file_size{size}
+    {
+        if(!file || ::ftruncate(::fileno(file), static_cast<off_t>(size)))
+        {
+            throw std::runtime_error{"can't create temporary file"};
+        }
+        addr = ::mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            ::fileno(file),
+            0);
+        if(addr == MAP_FAILED)
+        {
+            std::fclose(file);
+            throw std::runtime_error{"can't map temporary file"};
+        }
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file()
+    {
+        ::munmap(addr, file_size);
+        std::fclose(file);
+    }
+
+    std::uint8_t* data() const noexcept
+    {
+        return static_cast<std::uint8_t*>(addr);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return file_size;
+    }
+
+private:
+    std::FILE* file;
+    std::size_t file_size;
+    void* addr;
+};
+
+symbol_type make_symbol(const std::uint32_t security_id)
+{
+    char str[16];
+    std::snprintf(str, sizeof(str), "S%07u", security_id);
+    symbol_type res;
+    std::memcpy(res.data(), str, res.size());
+    return res;
+}
+
+// journal of trades of random securities with growing timestamps, index
+// sidecar is stored in a separate file
+struct journal
+{
+    std::unique_ptr<mapped_file> messages;
+    std::unique_ptr<mapped_file> index_file;
+    sbepp::journal_index_view index;
+    std::size_t number_of_messages{};
+    symbol_type queried_symbol;
+    std::uint64_t max_timestamp{};
+};
+
+std::vector<std::uint8_t> build_index(const journal& j)
+{
+    return sbepp::build_journal_index<benchmark_schema::messages::trade>(
+        j.messages->data(),
+        j.messages->size(),
+        [](const trade m)
+        {
+            return m.symbol();
+        },
+        [](const trade m)
+        {
+            return *m.timestamp();
+        });
+}
+
+// generating multi-GB journal is slow so journals are reused
+const journal& get_journal(const std::size_t size_mib)
+{
+    static std::map<std::size_t, std::unique_ptr<journal>> cache;
+    auto& cached = cache[size_mib];
+    if(cached)
+    {
+        return *cached;
+    }
+
+    std::vector<symbol_type> symbols;
+    for(std::uint32_t i = 0; i != number_of_securities; i++)
+    {
+        symbols.push_back(make_symbol(i));
+    }
+
+    std::unique_ptr<journal> j{new journal};
+    const auto message_size =
+        sbepp::message_traits<
+            benchmark_schema::schema::messages::trade>::block_length()
+        + sbepp::composite_traits<
+            benchmark_schema::schema::types::messageHeader>::size_bytes();
+    j->number_of_messages = size_mib * 1024 * 1024 / message_size;
+    j->messages.reset(new mapped_file{j->number_of_messages * message_size});
+    std::mt19937_64 mt{42};
+    std::uint64_t timestamp{};
+    for(std::size_t i = 0; i != j->number_of_messages; i++)
+    {
+        const auto security_id =
+            static_cast<std::uint32_t>(mt() % number_of_securities);
+        auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+            j->messages->data() + i * message_size, message_size);
+        sbepp::fill_message_header(m);
+        timestamp += 1 + mt() % 100;
+        m.timestamp(timestamp);
+        m.securityId(security_id);
+        const auto& symbol = symbols[security_id];
+        std::memcpy(m.symbol().data(), symbol.data(), symbol.size());
+        m.price(static_cast<std::int64_t>(mt() % 100000));
+        m.quantity(static_cast<std::uint32_t>(mt() % 1000));
+        if(i == j->number_of_messages / 2)
+        {
+            j->queried_symbol = symbols[security_id];
+        }
+    }
+    j->max_timestamp = timestamp;
+
+    const auto index = build_index(*j);
+    j->index_file.reset(new mapped_file{index.size()});
+    std::memcpy(j->index_file->data(), index.data(), index.size());
+    j->index = sbepp::journal_index_view{
+        j->index_file->data(), j->index_file->size()};
+
+    cached = std::move(j);
+    return *cached;
+}
+
+struct query
+{
+    symbol_type symbol;
+    std::uint64_t min_timestamp;
+    std::uint64_t max_timestamp;
+};
+
+// a symbol which exists in the journal, either over the whole journal or
+// within the middle 10% of its time range
+query make_query(const journal& j, const bool time_range)
+{
+    if(!time_range)
+    {
+        return {j.queried_symbol, 0, j.max_timestamp};
+    }
+    return {
+        j.queried_symbol,
+        j.max_timestamp / 20 * 9,
+        j.max_timestamp / 20 * 11};
+}
+
+bool matches(const trade m, const query& q) noexcept
+{
+    const auto timestamp = *m.timestamp();
+    return (timestamp >= q.min_timestamp) && (timestamp <= q.max_timestamp)
+           && !std::memcmp(
+               m.symbol().data(), q.symbol.data(), sizeof(symbol_type));
+}
+
+// checks every message of the journal
+void full_scan(::benchmark::State& state, const bool time_range)
+{
+    const auto& j = get_journal(static_cast<std::size_t>(state.range(0)));
+    const auto q = make_query(j, time_range);
+    const auto data = j.messages->data();
+    const auto size = j.messages->size();
+    std::size_t found{};
+
+    for(auto _ : state)
+    {
+        found = 0;
+        std::size_t offset{};
+        while(offset != size)
+        {
+            const auto m =
+                sbepp::make_const_view<benchmark_schema::messages::trade>(
+                    data + offset, size - offset);
+            found += matches(m, q);
+            offset += sbepp::size_bytes(m);
+        }
+        ::benchmark::DoNotOptimize(found);
+    }
+
+    state.SetBytesProcessed(state.iterations() * size);
+    state.counters["found"] = static_cast<double>(found);
+}
+
+// checks only messages of chunks selected by the index
+void indexed_scan(::benchmark::State& state, const bool time_range)
+{
+    const auto& j = get_journal(static_cast<std::size_t>(state.range(0)));
+    const auto q = make_query(j, time_range);
+    std::size_t found{};
+    std::size_t chunks{};
+
+    for(auto _ : state)
+    {
+        found = 0;
+        chunks = sbepp::scan_journal<benchmark_schema::messages::trade>(
+            j.messages->data(),
+            j.messages->size(),
+            j.index,
+            q.symbol,
+            q.min_timestamp,
+            q.max_timestamp,
+            [&found, &q](const trade m)
+            {
+                found += matches(m, q);
+            });
+        ::benchmark::DoNotOptimize(found);
+    }
+
+    state.SetBytesProcessed(state.iterations() * j.messages->size());
+    state.counters["found"] = static_cast<double>(found);
+    state.counters["scanned_chunks"] = static_cast<double>(chunks);
+    state.counters["total_chunks"] =
+        static_cast<double>(j.index.chunk_count());
+}
+
+void full_scan_benchmark(::benchmark::State& state)
+{
+    full_scan(state, false);
+}
+
+void full_scan_time_range_benchmark(::benchmark::State& state)
+{
+    full_scan(state, true);
+}
+
+void indexed_scan_benchmark(::benchmark::State& state)
+{
+    indexed_scan(state, false);
+}
+
+void indexed_scan_time_range_benchmark(::benchmark::State& state)
+{
+    indexed_scan(state, true);
+}
+
+void build_index_benchmark(::benchmark::State& state)
+{
+    const auto& j = get_journal(static_cast<std::size_t>(state.range(0)));
+    std::size_t index_size{};
+
+    for(auto _ : state)
+    {
+        index_size = build_index(j).size();
+    }
+
+    state.SetBytesProcessed(state.iterations() * j.messages->size());
+    state.counters["index_bytes"] = static_cast<double>(index_size);
+}
+
+BENCHMARK(journal_index::build_index_benchmark)
+    ->Apply(journal_index::configure_benchmark);
+BENCHMARK(journal_index::full_scan_benchmark)
+    ->Apply(journal_index::configure_benchmark);
+BENCHMARK(journal_index::indexed_scan_benchmark)
+    ->Apply(journal_index::configure_benchmark);
+BENCHMARK(journal_index::full_scan_time_range_benchmark)
+    ->Apply(journal_index::configure_benchmark);
+BENCHMARK(journal_index::indexed_scan_time_range_benchmark)
+    ->Apply(journal_index::configure_benchmark);
+#endif
+} // namespace journal_index
+} // namespace benchmark
+} // namespace sbepp
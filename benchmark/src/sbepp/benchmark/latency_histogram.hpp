@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sbepp
+{
+namespace benchmark
+{
+// log-linear histogram of nanosecond latencies: values below 64 are stored
+// exactly, larger ones in 32 sub-buckets per power of two (~3% error)
+class latency_histogram
+{
+public:
+    void record(const std::uint64_t ns) noexcept
+    {
+        buckets[bucket_of(ns)]++;
+        total++;
+        if(ns > max_value)
+        {
+            max_value = ns;
+        }
+    }
+
+    std::uint64_t count() const noexcept
+    {
+        return total;
+    }
+
+    std::uint64_t max() const noexcept
+    {
+        return max_value;
+    }
+
+    // returns lower bound of the bucket which contains `p` quantile
+    std::uint64_t percentile(const double p) const noexcept
+    {
+        const auto rank = static_cast<std::uint64_t>(p * total);
+        std::uint64_t seen{};
+        for(std::size_t i = 0; i != buckets.size(); i++)
+        {
+            seen += buckets[i];
+            if(seen > rank)
+            {
+                return lower_bound_of(i);
+            }
+        }
+        return max_value;
+    }
+
+    void report(::benchmark::State& state) const
+    {
+        state.counters["p50_ns"] = static_cast<double>(percentile(0.5));
+        state.counters["p99_ns"] = static_cast<double>(percentile(0.99));
+        state.counters["p999_ns"] = static_cast<double>(percentile(0.999));
+        state.counters["max_ns"] = static_cast<double>(max());
+    }
+
+private:
+    static constexpr std::size_t linear_size = 64;
+    static constexpr std::size_t sub_bucket_bits = 5;
+    static constexpr std::size_t max_exponent = 48;
+
+    std::array<
+        std::uint64_t,
+        linear_size + (max_exponent - 6) * (1u << sub_bucket_bits)>
+        buckets{};
+    std::uint64_t total{};
+    std::uint64_t max_value{};
+
+    static std::size_t bucket_of(std::uint64_t ns) noexcept
+    {
+        if(ns < linear_size)
+        {
+            return static_cast<std::size_t>(ns);
+        }
+        std::size_t exponent = 6;
+        while(((ns >> exponent) > 1) && (exponent != max_exponent - 1))
+        {
+            exponent++;
+        }
+        if(ns >> (exponent + 1))
+        {
+            ns = (std::uint64_t{1} << (exponent + 1)) - 1;
+        }
+        const auto sub = static_cast<std::size_t>(
+            (ns >> (exponent - sub_bucket_bits))
+            & ((1u << sub_bucket_bits) - 1));
+        return linear_size + (exponent - 6) * (1u << sub_bucket_bits) + sub;
+    }
+
+    static std::uint64_t lower_bound_of(const std::size_t bucket) noexcept
+    {
+        if(bucket < linear_size)
+        {
+            return bucket;
+        }
+        const auto exponent =
+            (bucket - linear_size) / (1u << sub_bucket_bits) + 6;
+        const auto sub = (bucket - linear_size) % (1u << sub_bucket_bits);
+        return (std::uint64_t{1} << exponent)
+               + (std::uint64_t{sub} << (exponent - sub_bucket_bits));
+    }
+};
+} // namespace benchmark
+} // namespace sbepp
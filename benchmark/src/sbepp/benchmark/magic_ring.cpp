@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/benchmark/config.hpp>
+#include <sbepp/magic_ring.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace ring
+{
+// both rings store messages prefixed with 4-byte length
+constexpr std::size_t prefix_size = 4;
+constexpr std::size_t ring_capacity = 0x10000;
+
+// classic ring which inserts padding when message doesn't fit before the end
+class padded_ring
+{
+public:
+    explicit padded_ring(const std::size_t capacity) : buffer(capacity)
+    {
+    }
+
+    bool push(const byte_type* data, const std::size_t size)
+    {
+        const auto frame_size = prefix_size + size;
+        auto padding = buffer.size() - write_offset;
+        if(padding >= frame_size)
+        {
+            padding = 0;
+        }
+        if((used + padding + frame_size) > buffer.size())
+        {
+            return false;
+        }
+
+        if(padding)
+        {
+            if(padding >= prefix_size)
+            {
+                // zero length marks padding
+                std::memset(buffer.data() + write_offset, 0, prefix_size);
+            }
+            used += padding;
+            write_offset = 0;
+        }
+
+        const auto frame_length = static_cast<std::uint32_t>(size);
+        std::memcpy(buffer.data() + write_offset, &frame_length, prefix_size);
+        std::memcpy(buffer.data() + write_offset + prefix_size, data, size);
+        used += frame_size;
+        write_offset += frame_size;
+        if(write_offset == buffer.size())
+        {
+            write_offset = 0;
+        }
+
+        return true;
+    }
+
+    template<typename F>
+    void drain(F&& f)
+    {
+        while(used)
+        {
+            const auto tail_size = buffer.size() - read_offset;
+            std::uint32_t size{};
+            if(tail_size >= prefix_size)
+            {
+                std::memcpy(&size, buffer.data() + read_offset, prefix_size);
+            }
+            if(!size)
+            {
+                used -= tail_size;
+                read_offset = 0;
+                continue;
+            }
+
+            f(buffer.data() + read_offset + prefix_size, size);
+            used -= prefix_size + size;
+            read_offset += prefix_size + size;
+            if(read_offset == buffer.size())
+            {
+                read_offset = 0;
+            }
+        }
+    }
+
+private:
+    std::vector<byte_type> buffer;
+    std::size_t read_offset{};
+    std::size_t write_offset{};
+    std::size_t used{};
+};
+
+class mirrored_ring
+{
+public:
+    explicit mirrored_ring(const std::size_t capacity) : ring{capacity}
+    {
+    }
+
+    bool push(const byte_type* data, const std::size_t size)
+    {
+        const auto frame_size = prefix_size + size;
+        if(ring.free_space() < frame_size)
+        {
+            return false;
+        }
+
+        const auto frame_length = static_cast<std::uint32_t>(size);
+        std::memcpy(ring.write_data(), &frame_length, prefix_size);
+        std::memcpy(ring.write_data() + prefix_size, data, size);
+        ring.commit(frame_size);
+
+        return true;
+    }
+
+    template<typename F>
+    void drain(F&& f)
+    {
+        while(!ring.empty())
+        {
+            std::uint32_t size{};
+            std::memcpy(&size, ring.read_data(), prefix_size);
+            f(ring.read_data() + prefix_size, size);
+            ring.consume(prefix_size + size);
+        }
+    }
+
+private:
+    sbepp::magic_ring ring;
+};
+
+template<typename Ring>
+void ring_benchmark(::benchmark::State& state)
+{
+    message_generator msg_generator{
+        config::get_min_group_size(state),
+        config::get_max_group_size(state),
+        config::get_min_data_size(state),
+        config::get_max_data_size(state)};
+    const auto test_data =
+        msg_generator.generate(config::get_number_of_messages(state));
+    std::vector<std::size_t> sizes;
+    std::uint64_t total_size{};
+    for(const auto& test : test_data)
+    {
+        sizes.push_back(
+            sbepp::size_bytes(sbepp::make_const_view<
+                              benchmark_schema::messages::msg1>(
+                test.buffer.data(), test.buffer.size())));
+        total_size += sizes.back();
+    }
+    Ring ring{ring_capacity};
+    std::uint64_t sum{};
+    auto reader = [&sum](const byte_type* ptr, const std::size_t size)
+    {
+        auto msg = sbepp::make_const_view<benchmark_schema::messages::msg1>(
+            ptr, size);
+        sum += *msg.field1() + *msg.field5() + sbepp::size_bytes(msg);
+    };
+
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i != test_data.size(); i++)
+        {
+            if(!ring.push(test_data[i].buffer.data(), sizes[i]))
+            {
+                ring.drain(reader);
+                ring.push(test_data[i].buffer.data(), sizes[i]);
+            }
+        }
+        ring.drain(reader);
+        ::benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(state.iterations() * total_size);
+}
+
+void padded_ring_benchmark(::benchmark::State& state)
+{
+    ring_benchmark<padded_ring>(state);
+}
+
+void magic_ring_benchmark(::benchmark::State& state)
+{
+    ring_benchmark<mirrored_ring>(state);
+}
+
+BENCHMARK(ring::padded_ring_benchmark)->Apply(config::configure_benchmark);
+BENCHMARK(ring::magic_ring_benchmark)->Apply(config::configure_benchmark);
+} // namespace ring
+} // namespace benchmark
+} // namespace sbepp
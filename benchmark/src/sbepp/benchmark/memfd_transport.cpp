@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <sbepp/memfd_transport.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__)
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace memfd_transport
+{
+#if defined(__linux__)
+constexpr std::size_t chunk_size = 0x10000;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // payload size in KiB
+    b->Arg(256);
+    b->Arg(4 * 1024);
+    b->Arg(32 * 1024);
+}
+
+std::vector<std::uint8_t> make_payload(const ::benchmark::State& state)
+{
+    std::vector<std::uint8_t> res(
+        static_cast<std::size_t>(state.range(0)) * 1024);
+    for(std::size_t i = 0; i != res.size(); i++)
+    {
+        res[i] = static_cast<std::uint8_t>(i);
+    }
+    return res;
+}
+
+// payload is copied through a stream socket into receiver's buffer, sender
+// and receiver alternate in the same thread
+void socket_copy_benchmark(::benchmark::State& state)
+{
+    const auto payload = make_payload(state);
+    std::vector<std::uint8_t> received(payload.size());
+    int fds[2];
+    if(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1)
+    {
+        state.SkipWithError("socketpair() failed");
+        return;
+    }
+
+    for(auto _ : state)
+    {
+        std::size_t offset{};
+        while(offset != payload.size())
+        {
+            const auto n = (std::min)(chunk_size, payload.size() - offset);
+            const auto written = ::write(fds[0], payload.data() + offset, n);
+            if(written <= 0)
+            {
+                state.SkipWithError("write() failed");
+                break;
+            }
+            auto left = static_cast<std::size_t>(written);
+            while(left)
+            {
+                const auto res = ::read(
+                    fds[1], received.data() + offset, left);
+                if(res <= 0)
+                {
+                    state.SkipWithError("read() failed");
+                    break;
+                }
+                offset += static_cast<std::size_t>(res);
+                left -= static_cast<std::size_t>(res);
+            }
+        }
+        ::benchmark::DoNotOptimize(received.back());
+    }
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * payload.size()));
+}
+
+// payload is copied once into a memfd which is passed to the receiver
+void memfd_benchmark(::benchmark::State& state)
+{
+    const auto payload = make_payload(state);
+    auto transports = sbepp::memfd_transport::make_pair();
+    sbepp::received_message msg;
+
+    for(auto _ : state)
+    {
+        transports.first.send(payload.data(), payload.size());
+        transports.second.receive(msg);
+        ::benchmark::DoNotOptimize(msg.data()[msg.size() - 1]);
+    }
+
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * payload.size()));
+}
+
+BENCHMARK(memfd_transport::socket_copy_benchmark)
+    ->Apply(memfd_transport::configure_benchmark);
+BENCHMARK(memfd_transport::memfd_benchmark)
+    ->Apply(memfd_transport::configure_benchmark);
+#endif
+} // namespace memfd_transport
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/benchmark/config.hpp>
+#include <sbepp/memoized_view.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <cassert>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace memoized_view
+{
+// all readers access the same members of `msg1`: trailing `data` first,
+// then all the groups from the last one, then `data` again
+using msg1_tag = benchmark_schema::schema::messages::msg1;
+using message_type = benchmark_schema::messages::msg1<const std::uint8_t>;
+
+template<typename Data>
+std::uint64_t get_data_checksum(Data d)
+{
+    return std::accumulate(std::begin(d), std::end(d), std::uint64_t{});
+}
+
+std::uint64_t get_view_checksum(message_type m)
+{
+    auto res = get_data_checksum(m.data());
+    res += m.nested_group2().size();
+    res += m.nested_group().size();
+    res += m.flat_group().size();
+    res += m.data().size();
+
+    return res;
+}
+
+std::uint64_t get_memoized_view_checksum(message_type msg)
+{
+    auto m = sbepp::make_memoized_view(msg);
+    auto res = get_data_checksum(m.data<msg1_tag::data>());
+    res += m.group<msg1_tag::nested_group2>().size();
+    res += m.group<msg1_tag::nested_group>().size();
+    res += m.group<msg1_tag::flat_group>().size();
+    res += m.data<msg1_tag::data>().size();
+
+    return res;
+}
+
+// cursor requires schema order so results are kept in local variables
+std::uint64_t get_cursor_checksum(message_type m)
+{
+    auto c = sbepp::init_cursor(m);
+    const auto flat_group_size =
+        m.flat_group(sbepp::cursor_ops::dont_move(c)).size();
+    m.flat_group(sbepp::cursor_ops::skip(c));
+    const auto nested_group_size =
+        m.nested_group(sbepp::cursor_ops::dont_move(c)).size();
+    m.nested_group(sbepp::cursor_ops::skip(c));
+    const auto nested_group2_size =
+        m.nested_group2(sbepp::cursor_ops::dont_move(c)).size();
+    m.nested_group2(sbepp::cursor_ops::skip(c));
+    const auto data = m.data(c);
+
+    auto res = get_data_checksum(data);
+    res += nested_group2_size;
+    res += nested_group_size;
+    res += flat_group_size;
+    res += data.size();
+
+    return res;
+}
+
+template<typename ChecksumFn>
+void run_benchmark(::benchmark::State& state, ChecksumFn get_checksum)
+{
+    message_generator msg_generator{
+        config::get_min_group_size(state),
+        config::get_max_group_size(state),
+        config::get_min_data_size(state),
+        config::get_max_data_size(state)};
+    const auto test_data =
+        msg_generator.generate(config::get_number_of_messages(state));
+
+    for(auto _ : state)
+    {
+        std::uint64_t sum{};
+        for(const auto& test : test_data)
+        {
+            const auto msg =
+                sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                    test.buffer.data(), test.buffer.size());
+            const auto checksum = get_checksum(msg);
+            assert(checksum == get_view_checksum(msg));
+            sum += checksum;
+        }
+        ::benchmark::DoNotOptimize(sum);
+    }
+}
+
+void view_benchmark(::benchmark::State& state)
+{
+    run_benchmark(state, &get_view_checksum);
+}
+
+void memoized_view_benchmark(::benchmark::State& state)
+{
+    run_benchmark(state, &get_memoized_view_checksum);
+}
+
+void cursor_benchmark(::benchmark::State& state)
+{
+    run_benchmark(state, &get_cursor_checksum);
+}
+
+BENCHMARK(memoized_view::view_benchmark)->Apply(config::configure_benchmark);
+BENCHMARK(memoized_view::memoized_view_benchmark)
+    ->Apply(config::configure_benchmark);
+BENCHMARK(memoized_view::cursor_benchmark)
+    ->Apply(config::configure_benchmark);
+} // namespace memoized_view
+} // namespace benchmark
+} // namespace sbepp
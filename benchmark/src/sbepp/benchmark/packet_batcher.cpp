@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/packet_batcher.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace batching
+{
+// small messages is the case where batching matters the most
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of messages, max data size
+    b->Args({1000, 0});
+    b->Args({1000, 32});
+}
+
+// connected non-blocking UDP sockets over loopback. Receiver is never read,
+// its buffer overflows quickly and further datagrams are dropped by kernel
+// but syscall cost is still paid in full.
+class udp_loopback
+{
+public:
+    udp_loopback()
+    {
+        receiver = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        sender = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if((receiver == -1) || (sender == -1))
+        {
+            return;
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        if((::bind(receiver, reinterpret_cast<sockaddr*>(&addr), addr_len)
+            == -1)
+           || (::getsockname(
+                   receiver, reinterpret_cast<sockaddr*>(&addr), &addr_len)
+               == -1)
+           || (::connect(sender, reinterpret_cast<sockaddr*>(&addr), addr_len)
+               == -1))
+        {
+            close();
+        }
+    }
+
+    udp_loopback(const udp_loopback&) = delete;
+    udp_loopback& operator=(const udp_loopback&) = delete;
+
+    ~udp_loopback()
+    {
+        close();
+    }
+
+    bool is_valid() const noexcept
+    {
+        return (sender != -1) && (receiver != -1);
+    }
+
+    int get_sender() const noexcept
+    {
+        return sender;
+    }
+
+private:
+    int sender{-1};
+    int receiver{-1};
+
+    void close() noexcept
+    {
+        if(sender != -1)
+        {
+            ::close(sender);
+            sender = -1;
+        }
+        if(receiver != -1)
+        {
+            ::close(receiver);
+            receiver = -1;
+        }
+    }
+};
+
+std::vector<test_data> generate_messages(const ::benchmark::State& state)
+{
+    message_generator generator{0, 0, 0, std::size_t(state.range(1))};
+    return generator.generate(state.range(0));
+}
+
+std::size_t get_message_size(const test_data& data)
+{
+    return sbepp::size_bytes(
+        benchmark_schema::messages::msg1<const byte_type>{
+            data.buffer.data(), data.buffer.size()});
+}
+
+void send_per_message(::benchmark::State& state)
+{
+    udp_loopback sockets;
+    if(!sockets.is_valid())
+    {
+        state.SkipWithError("cannot create UDP sockets");
+        return;
+    }
+    const auto messages = generate_messages(state);
+    std::size_t syscalls{};
+
+    for(auto _ : state)
+    {
+        for(const auto& m : messages)
+        {
+            auto res = ::send(
+                sockets.get_sender(),
+                m.buffer.data(),
+                get_message_size(m),
+                0);
+            ::benchmark::DoNotOptimize(res);
+            syscalls++;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * messages.size());
+    state.counters["syscalls/msg"] = ::benchmark::Counter(
+        static_cast<double>(syscalls)
+        / (state.iterations() * messages.size()));
+}
+
+void send_batched(::benchmark::State& state)
+{
+    udp_loopback sockets;
+    if(!sockets.is_valid())
+    {
+        state.SkipWithError("cannot create UDP sockets");
+        return;
+    }
+    const auto messages = generate_messages(state);
+    sbepp::packet_batcher_options options;
+    options.max_packets = 64;
+    options.use_packet_header = true;
+    sbepp::packet_batcher batcher{options};
+    std::array<mmsghdr, 64> msgs{};
+    std::array<iovec, 64> iovs{};
+    std::size_t syscalls{};
+
+    auto send_packets = [&]()
+    {
+        const auto n = sbepp::make_mmsghdrs(
+            batcher, msgs.data(), iovs.data(), msgs.size());
+        auto res = ::sendmmsg(sockets.get_sender(), msgs.data(), n, 0);
+        ::benchmark::DoNotOptimize(res);
+        syscalls++;
+        // drop packets even if they weren't sent, like the per-message
+        // version does
+        batcher.release();
+    };
+
+    for(auto _ : state)
+    {
+        for(const auto& m : messages)
+        {
+            if(!batcher.push(m.buffer.data(), get_message_size(m)))
+            {
+                send_packets();
+                batcher.push(m.buffer.data(), get_message_size(m));
+            }
+        }
+        batcher.flush();
+        send_packets();
+    }
+
+    state.SetItemsProcessed(state.iterations() * messages.size());
+    state.counters["syscalls/msg"] = ::benchmark::Counter(
+        static_cast<double>(syscalls)
+        / (state.iterations() * messages.size()));
+}
+
+BENCHMARK(batching::send_per_message)->Apply(batching::configure_benchmark);
+BENCHMARK(batching::send_batched)->Apply(batching::configure_benchmark);
+} // namespace batching
+} // namespace benchmark
+} // namespace sbepp
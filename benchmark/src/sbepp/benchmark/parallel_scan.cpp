@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/test_data.hpp>
+#include <sbepp/benchmark/message_generator.hpp>
+#include <sbepp/parallel_scan.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace parallel_scan
+{
+using message_type = benchmark_schema::messages::msg1<const std::uint8_t>;
+
+constexpr std::size_t chunk_size = 0x10000;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of workers
+    const auto max_threads = static_cast<int>(
+        (std::max)(std::thread::hardware_concurrency(), 1u));
+    for(int n = 1; n < max_threads; n *= 2)
+    {
+        b->Arg(n);
+    }
+    b->Arg(max_threads);
+    b->UseRealTime();
+}
+
+// generates in batches since each `test_data` has a large fixed-size buffer
+void append_messages(
+    std::vector<std::uint8_t>& journal,
+    message_generator& generator,
+    std::size_t n)
+{
+    while(n)
+    {
+        const auto batch_size = (std::min)(n, std::size_t{1000});
+        for(const auto& test : generator.generate(batch_size))
+        {
+            const auto size = sbepp::size_bytes(
+                sbepp::make_const_view<benchmark_schema::messages::msg1>(
+                    test.buffer.data(), test.buffer.size()));
+            journal.insert(
+                journal.end(),
+                test.buffer.begin(),
+                test.buffer.begin() + size);
+        }
+        n -= batch_size;
+    }
+}
+
+// the first messages have large groups to emulate snapshot-heavy region
+// which makes its chunks much more expensive
+std::vector<std::uint8_t> make_journal()
+{
+    std::vector<std::uint8_t> res;
+    message_generator heavy{10, 12, 0, 16};
+    append_messages(res, heavy, 1000);
+    message_generator light{0, 5, 0, 16};
+    append_messages(res, light, 20000);
+    return res;
+}
+
+std::uint64_t get_checksum(message_type m)
+{
+    std::uint64_t res = *m.field1() + *m.field5();
+    for(const auto e : m.flat_group())
+    {
+        res += *e.field1() + *e.field5();
+    }
+    for(const auto e : m.nested_group())
+    {
+        res += *e.field1() + e.data().size();
+    }
+    for(const auto e : m.nested_group2())
+    {
+        for(const auto e2 : e.nested_group())
+        {
+            res += *e2.field1() + e2.data().size();
+        }
+    }
+    return res + m.data().size();
+}
+
+void parallel_scan_benchmark(::benchmark::State& state)
+{
+    const auto journal = make_journal();
+    const auto ranges = sbepp::split_journal<benchmark_schema::messages::msg1>(
+        journal.data(), journal.size(), chunk_size);
+    sbepp::work_stealing_pool pool{static_cast<std::size_t>(state.range(0))};
+
+    for(auto _ : state)
+    {
+        const auto sum =
+            sbepp::parallel_scan_journal<benchmark_schema::messages::msg1>(
+                pool,
+                journal.data(),
+                ranges,
+                std::uint64_t{},
+                [](std::uint64_t& res, message_type m)
+                {
+                    res += get_checksum(m);
+                },
+                [](std::uint64_t& res, const std::uint64_t& worker_res)
+                {
+                    res += worker_res;
+                });
+        ::benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetBytesProcessed(
+        static_cast<std::int64_t>(state.iterations() * journal.size()));
+    state.counters["chunks"] = static_cast<double>(ranges.size());
+    state.counters["steals"] = static_cast<double>(pool.steals());
+}
+
+BENCHMARK(parallel_scan::parallel_scan_benchmark)
+    ->Apply(parallel_scan::configure_benchmark);
+} // namespace parallel_scan
+} // namespace benchmark
+} // namespace sbepp
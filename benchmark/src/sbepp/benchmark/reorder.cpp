@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/reorder.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace reorder
+{
+using messages = benchmark_schema::schema::messages;
+
+constexpr std::size_t batch_size = 1024;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of message types in a batch
+    b->Arg(1);
+    b->Arg(2);
+    b->Arg(4);
+    b->Arg(8);
+}
+
+struct batch
+{
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::size_t> offsets;
+};
+
+template<template<typename> class Message>
+void append_message(batch& b, std::mt19937& mt)
+{
+    std::uniform_int_distribution<std::uint32_t> dist;
+    const auto group_size = dist(mt) % 5;
+    const auto offset = b.buffer.size();
+    b.buffer.resize(offset + 256);
+    auto m = sbepp::make_view<Message>(b.buffer.data() + offset, 256);
+    sbepp::fill_message_header(m);
+    m.field1(dist(mt));
+    m.field2(dist(mt));
+    m.field3(dist(mt));
+    m.field4(dist(mt));
+    auto g = m.group();
+    sbepp::fill_group_header(g, group_size);
+    for(auto e : g)
+    {
+        e.field1(dist(mt));
+        e.field2(dist(mt));
+    }
+    b.buffer.resize(offset + sbepp::size_bytes(m));
+    b.offsets.push_back(offset);
+}
+
+// messages of the first `types` types in random order
+batch make_batch(const std::size_t types, const bool grouped)
+{
+    std::mt19937 mt{42};
+    std::vector<std::size_t> kinds;
+    for(std::size_t i = 0; i != batch_size; i++)
+    {
+        kinds.push_back(mt() % types);
+    }
+    if(grouped)
+    {
+        std::stable_sort(kinds.begin(), kinds.end());
+    }
+
+    batch b;
+    for(const auto kind : kinds)
+    {
+        switch(kind)
+        {
+        case 0:
+            append_message<benchmark_schema::messages::msg2>(b, mt);
+            break;
+        case 1:
+            append_message<benchmark_schema::messages::msg3>(b, mt);
+            break;
+        case 2:
+            append_message<benchmark_schema::messages::msg4>(b, mt);
+            break;
+        case 3:
+            append_message<benchmark_schema::messages::msg5>(b, mt);
+            break;
+        case 4:
+            append_message<benchmark_schema::messages::msg6>(b, mt);
+            break;
+        case 5:
+            append_message<benchmark_schema::messages::msg7>(b, mt);
+            break;
+        case 6:
+            append_message<benchmark_schema::messages::msg8>(b, mt);
+            break;
+        default:
+            append_message<benchmark_schema::messages::msg9>(b, mt);
+            break;
+        }
+    }
+    return b;
+}
+
+// each message type has its own handler code, constants make instantiations
+// different
+template<typename MessageTag>
+struct small_handler
+{
+    std::uint64_t& state;
+
+    template<typename Message>
+    void operator()(const Message m) const noexcept
+    {
+        constexpr std::uint64_t id = sbepp::message_traits<MessageTag>::id();
+        constexpr std::uint64_t k1 = 0x9E3779B97F4A7C15ull * id;
+        constexpr std::uint64_t k2 = 0xC2B2AE3D27D4EB4Full ^ (id << 17);
+        auto s = state;
+        s = (s ^ *m.field1()) * k1;
+        s = (s + *m.field2()) ^ (s >> (id + 7));
+        s = (s ^ *m.field3()) * k2;
+        s = (s + *m.field4()) ^ (s >> (id + 13));
+        for(const auto e : m.group())
+        {
+            s = (s ^ (*e.field1() + id)) * k1;
+            s ^= (s >> (29 - id)) + *e.field2() * k2;
+        }
+        state = s;
+    }
+};
+
+// unrolled mixing rounds on 4 independent lanes, emulates heavy per-type
+// logic. Code of 8 such handlers doesn't fit into L1 instruction cache
+template<std::uint64_t Id, std::size_t Round>
+struct mix_rounds
+{
+    static void apply(std::uint64_t (&lanes)[4], const std::uint64_t v) noexcept
+    {
+        mix_rounds<Id, Round - 1>::apply(lanes, v);
+        constexpr std::uint64_t k =
+            (0x9E3779B97F4A7C15ull ^ (Id << 32)) * (2 * Round + 1);
+        auto& lane = lanes[Round % 4];
+        lane = ((lane ^ (v + Round)) * k) ^ (lane >> (Round % 29 + 1));
+    }
+};
+
+template<std::uint64_t Id>
+struct mix_rounds<Id, 0>
+{
+    static void apply(std::uint64_t (&)[4], std::uint64_t) noexcept
+    {
+    }
+};
+
+template<typename MessageTag>
+struct large_handler
+{
+    std::uint64_t& state;
+
+    template<typename Message>
+    void operator()(const Message m) const noexcept
+    {
+        constexpr std::uint64_t id = sbepp::message_traits<MessageTag>::id();
+        std::uint64_t lanes[4] = {
+            state ^ *m.field1(), *m.field2(), *m.field3(), *m.field4()};
+        for(const auto e : m.group())
+        {
+            lanes[0] += *e.field1();
+            lanes[1] += *e.field2();
+        }
+        mix_rounds<id, 256>::apply(lanes, id);
+        state = lanes[0] ^ lanes[1] ^ lanes[2] ^ lanes[3];
+    }
+};
+
+template<template<typename> class Handler, typename MessageTag>
+void handle(
+    const std::uint8_t* ptr, const std::size_t size, std::uint64_t& state)
+{
+    Handler<MessageTag>{state}(
+        typename sbepp::message_traits<
+            MessageTag>::template value_type<const std::uint8_t>{ptr, size});
+}
+
+// dispatches each message in arrival order
+template<template<typename> class Handler>
+std::uint64_t dispatch_in_order(const batch& b)
+{
+    std::uint64_t state{};
+    for(const auto offset : b.offsets)
+    {
+        const auto ptr = b.buffer.data() + offset;
+        const auto size = b.buffer.size() - offset;
+        const auto header =
+            sbepp::make_const_view<benchmark_schema::types::messageHeader>(
+                ptr, size);
+        switch(*header.templateId())
+        {
+        case 2:
+            handle<Handler, messages::msg2>(ptr, size, state);
+            break;
+        case 3:
+            handle<Handler, messages::msg3>(ptr, size, state);
+            break;
+        case 4:
+            handle<Handler, messages::msg4>(ptr, size, state);
+            break;
+        case 5:
+            handle<Handler, messages::msg5>(ptr, size, state);
+            break;
+        case 6:
+            handle<Handler, messages::msg6>(ptr, size, state);
+            break;
+        case 7:
+            handle<Handler, messages::msg7>(ptr, size, state);
+            break;
+        case 8:
+            handle<Handler, messages::msg8>(ptr, size, state);
+            break;
+        case 9:
+            handle<Handler, messages::msg9>(ptr, size, state);
+            break;
+        }
+    }
+    return state;
+}
+
+template<template<typename> class Handler>
+void in_order_benchmark(::benchmark::State& state, const bool grouped)
+{
+    const auto b =
+        make_batch(static_cast<std::size_t>(state.range(0)), grouped);
+
+    for(auto _ : state)
+    {
+        ::benchmark::DoNotOptimize(dispatch_in_order<Handler>(b));
+    }
+
+    state.SetItemsProcessed(state.iterations() * b.offsets.size());
+}
+
+// messages of different types are interleaved
+template<template<typename> class Handler>
+void arrival_order_benchmark(::benchmark::State& state)
+{
+    in_order_benchmark<Handler>(state, false);
+}
+
+// the same messages already grouped by type, best case for in-order dispatch
+template<template<typename> class Handler>
+void grouped_arrival_order_benchmark(::benchmark::State& state)
+{
+    in_order_benchmark<Handler>(state, true);
+}
+
+// buckets interleaved messages by `templateId` then handles each bucket
+template<template<typename> class Handler>
+void reordered_benchmark(::benchmark::State& state)
+{
+    const auto b = make_batch(static_cast<std::size_t>(state.range(0)), false);
+    sbepp::template_id_reorderer<benchmark_schema::schema> reorderer{9};
+
+    for(auto _ : state)
+    {
+        for(const auto offset : b.offsets)
+        {
+            reorderer.push(
+                b.buffer.data() + offset, b.buffer.size() - offset);
+        }
+        std::uint64_t s{};
+        reorderer.for_each<messages::msg2>(Handler<messages::msg2>{s});
+        reorderer.for_each<messages::msg3>(Handler<messages::msg3>{s});
+        reorderer.for_each<messages::msg4>(Handler<messages::msg4>{s});
+        reorderer.for_each<messages::msg5>(Handler<messages::msg5>{s});
+        reorderer.for_each<messages::msg6>(Handler<messages::msg6>{s});
+        reorderer.for_each<messages::msg7>(Handler<messages::msg7>{s});
+        reorderer.for_each<messages::msg8>(Handler<messages::msg8>{s});
+        reorderer.for_each<messages::msg9>(Handler<messages::msg9>{s});
+        reorderer.clear();
+        ::benchmark::DoNotOptimize(s);
+    }
+
+    state.SetItemsProcessed(state.iterations() * b.offsets.size());
+}
+
+// `BENCHMARK_TEMPLATE` requires unqualified names
+BENCHMARK_TEMPLATE(arrival_order_benchmark, small_handler)
+    ->Apply(configure_benchmark);
+BENCHMARK_TEMPLATE(grouped_arrival_order_benchmark, small_handler)
+    ->Apply(configure_benchmark);
+BENCHMARK_TEMPLATE(reordered_benchmark, small_handler)
+    ->Apply(configure_benchmark);
+BENCHMARK_TEMPLATE(arrival_order_benchmark, large_handler)
+    ->Apply(configure_benchmark);
+BENCHMARK_TEMPLATE(grouped_arrival_order_benchmark, large_handler)
+    ->Apply(configure_benchmark);
+BENCHMARK_TEMPLATE(reordered_benchmark, large_handler)
+    ->Apply(configure_benchmark);
+} // namespace reorder
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/latency_histogram.hpp>
+#include <sbepp/segmented_journal.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace segmented_journal
+{
+#if defined(__linux__)
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t segment_size = 4 * 1024 * 1024;
+// plain file is truncated after this size to keep disk usage bounded
+constexpr std::size_t max_file_size = 4 * segment_size;
+constexpr std::size_t message_size =
+    8 + sbepp::message_traits<benchmark_schema::schema::messages::trade>::
+            block_length();
+
+class temp_directory
+{
+public:
+    temp_directory()
+    {
+        char tmpl[] = "/tmp/sbepp_bench_journal_XXXXXX";
+        if(::mkdtemp(tmpl))
+        {
+            path = tmpl;
+        }
+    }
+
+    temp_directory(const temp_directory&) = delete;
+    temp_directory& operator=(const temp_directory&) = delete;
+
+    ~temp_directory()
+    {
+        for(const auto& p : sbepp::list_journal_segments(path))
+        {
+            ::unlink(p.c_str());
+        }
+        ::unlink(file_path().c_str());
+        ::rmdir(path.c_str());
+    }
+
+    std::string file_path() const
+    {
+        return path + "/journal.bin";
+    }
+
+    std::string path;
+};
+
+void encode_trade(std::uint8_t* ptr, const std::uint64_t timestamp)
+{
+    auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+        ptr, message_size);
+    sbepp::fill_message_header(m);
+    m.securityId(123);
+    m.timestamp(timestamp);
+    m.price(static_cast<std::int64_t>(timestamp % 1000));
+    m.quantity(static_cast<std::uint32_t>(timestamp % 100));
+}
+
+std::uint64_t get_ns(const clock_type::duration d)
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+// message is encoded directly into preallocated mapped segment, the argument
+// is `prepare_in_background` option
+void segmented_journal_benchmark(::benchmark::State& state)
+{
+    const temp_directory dir;
+    sbepp::segmented_journal_options options;
+    options.segment_size = segment_size;
+    options.max_segments = 4;
+    options.prepare_in_background = (state.range(0) != 0);
+    sbepp::segmented_journal_writer writer{dir.path, options};
+    latency_histogram histogram;
+    std::uint64_t timestamp{};
+
+    for(auto _ : state)
+    {
+        const auto start = clock_type::now();
+        encode_trade(writer.claim(message_size), timestamp++);
+        writer.commit(message_size);
+        histogram.record(get_ns(clock_type::now() - start));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["segments"] = static_cast<double>(writer.segment_count());
+    histogram.report(state);
+}
+
+// message is encoded into a buffer and `write()` to a growing file
+void growing_file_benchmark(::benchmark::State& state)
+{
+    const temp_directory dir;
+    const auto fd = ::open(
+        dir.file_path().c_str(),
+        O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC,
+        0644);
+    if(fd == -1)
+    {
+        state.SkipWithError("open() failed");
+        return;
+    }
+    std::array<std::uint8_t, 4 + message_size> buf{};
+    sbepp::detail::set_primitive<sbepp::endian::little>(
+        buf.data(), static_cast<std::uint32_t>(message_size));
+    latency_histogram histogram;
+    std::uint64_t timestamp{};
+    std::size_t file_size{};
+
+    for(auto _ : state)
+    {
+        const auto start = clock_type::now();
+        encode_trade(buf.data() + 4, timestamp++);
+        const auto res = ::write(fd, buf.data(), buf.size());
+        histogram.record(get_ns(clock_type::now() - start));
+        ::benchmark::DoNotOptimize(res);
+
+        file_size += buf.size();
+        if(file_size > max_file_size)
+        {
+            state.PauseTiming();
+            if(::ftruncate(fd, 0) == 0)
+            {
+                file_size = 0;
+            }
+            state.ResumeTiming();
+        }
+    }
+
+    ::close(fd);
+    state.SetItemsProcessed(state.iterations());
+    histogram.report(state);
+}
+
+BENCHMARK(segmented_journal::segmented_journal_benchmark)->Arg(0)->Arg(1);
+BENCHMARK(segmented_journal::growing_file_benchmark);
+#endif
+} // namespace segmented_journal
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/sharding_router.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace sharding
+{
+using trade_type = benchmark_schema::messages::trade<const std::uint8_t>;
+
+// message header + block
+constexpr std::size_t message_size =
+    8
+    + sbepp::message_traits<
+        benchmark_schema::schema::messages::trade>::block_length();
+constexpr std::size_t number_of_messages = 10000;
+constexpr std::uint32_t number_of_instruments = 1000;
+constexpr std::size_t queue_capacity = 4096;
+// emulates strategy's per-message work
+constexpr std::size_t work_iterations = 200;
+
+void configure_benchmark(::benchmark::internal::Benchmark* b)
+{
+    // number of consumer threads
+    const auto max_threads = static_cast<int>(
+        (std::max)(std::thread::hardware_concurrency(), 1u));
+    for(int n = 1; n < max_threads; n *= 2)
+    {
+        b->Arg(n);
+    }
+    b->Arg(max_threads);
+    b->UseRealTime();
+}
+
+std::vector<std::uint8_t> make_messages()
+{
+    std::vector<std::uint8_t> res(number_of_messages * message_size);
+    std::mt19937 mt;
+    std::uniform_int_distribution<std::uint32_t> dist{
+        0, number_of_instruments - 1};
+    for(std::size_t i = 0; i != number_of_messages; i++)
+    {
+        auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+            res.data() + i * message_size, message_size);
+        sbepp::fill_message_header(m);
+        m.timestamp(i);
+        m.securityId(dist(mt));
+        m.price(static_cast<std::int64_t>(i));
+        m.quantity(dist(mt));
+    }
+    return res;
+}
+
+std::uint64_t handle(const sbepp::routed_message& msg)
+{
+    const auto m = sbepp::make_const_view<benchmark_schema::messages::trade>(
+        msg.data, msg.size);
+    auto h = static_cast<std::uint64_t>(*m.price());
+    for(std::size_t i = 0; i != work_iterations; i++)
+    {
+        h = h * 6364136223846793005u + *m.quantity();
+    }
+    return h;
+}
+
+// each thread polls its shard until stopped
+class consumers
+{
+public:
+    explicit consumers(sbepp::sharding_router<>& router)
+        : router{router}, sums(router.shards())
+    {
+        for(std::size_t i = 0; i != router.shards(); i++)
+        {
+            threads.emplace_back(&consumers::run, this, i);
+        }
+    }
+
+    ~consumers()
+    {
+        stopped.store(true, std::memory_order_release);
+        for(auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+private:
+    sbepp::sharding_router<>& router;
+    std::vector<std::uint64_t> sums;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopped{};
+
+    void run(const std::size_t index)
+    {
+        auto& sum = sums[index];
+        while(!stopped.load(std::memory_order_acquire))
+        {
+            const auto n = router.shard(index).poll(
+                [&sum](const sbepp::routed_message& msg)
+                {
+                    sum += handle(msg);
+                });
+            if(!n)
+            {
+                std::this_thread::yield();
+            }
+        }
+        ::benchmark::DoNotOptimize(sum);
+    }
+};
+
+// waits until all shards are drained
+void wait(sbepp::sharding_router<>& router)
+{
+    for(std::size_t i = 0; i != router.shards(); i++)
+    {
+        while(!router.shard(i).empty())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void sharding_router_benchmark(::benchmark::State& state)
+{
+    const auto messages = make_messages();
+    sbepp::sharding_router<> router{
+        static_cast<std::size_t>(state.range(0)), queue_capacity};
+    consumers c{router};
+
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i != number_of_messages; i++)
+        {
+            while(!sbepp::try_route_message<benchmark_schema::messages::trade>(
+                router,
+                messages.data() + i * message_size,
+                message_size,
+                [](trade_type m)
+                {
+                    return *m.securityId();
+                }))
+            {
+                std::this_thread::yield();
+            }
+        }
+        wait(router);
+    }
+
+    state.SetItemsProcessed(
+        static_cast<std::int64_t>(state.iterations() * number_of_messages));
+    state.counters["stalls"] = static_cast<double>(router.stalls());
+}
+
+BENCHMARK(sharding::sharding_router_benchmark)
+    ->Apply(sharding::configure_benchmark);
+} // namespace sharding
+} // namespace benchmark
+} // namespace sbepp
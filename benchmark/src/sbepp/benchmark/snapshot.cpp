@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/segmented_journal.hpp>
+#include <sbepp/snapshot.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace snapshot
+{
+#if defined(__linux__)
+using trade = benchmark_schema::messages::trade<const std::uint8_t>;
+
+constexpr std::uint32_t number_of_securities = 10000;
+constexpr std::uint64_t number_of_trades = 1000000;
+constexpr std::size_t message_size =
+    8
+    + sbepp::message_traits<benchmark_schema::schema::messages::trade>::
+        block_length();
+
+// the latest trade per security
+struct security_state
+{
+    std::int64_t price;
+    std::uint32_t quantity;
+    std::uint64_t timestamp;
+};
+
+void apply(std::vector<security_state>& state, const trade m)
+{
+    auto& s = state[*m.securityId()];
+    s.price = *m.price();
+    s.quantity = *m.quantity();
+    s.timestamp = *m.timestamp();
+}
+
+void encode_trade(
+    std::uint8_t* ptr,
+    const std::uint32_t security_id,
+    const std::uint64_t timestamp)
+{
+    auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+        ptr, message_size);
+    sbepp::fill_message_header(m);
+    m.securityId(security_id);
+    m.timestamp(timestamp);
+    m.price(static_cast<std::int64_t>(timestamp % 1000));
+    m.quantity(static_cast<std::uint32_t>(timestamp % 100));
+}
+
+// journal of trades and the snapshot of the resulting state, created once
+// and removed at exit
+class environment
+{
+public:
+    std::string dir;
+    std::string snapshot_path;
+
+    environment()
+    {
+        char tmpl[] = "/tmp/sbepp_bench_snapshot_XXXXXX";
+        if(::mkdtemp(tmpl))
+        {
+            dir = tmpl;
+        }
+        snapshot_path = dir + "/state.snapshot";
+
+        std::vector<security_state> state(number_of_securities);
+        sbepp::segmented_journal_options options;
+        options.segment_size = 16 * 1024 * 1024;
+        sbepp::segmented_journal_writer journal{dir, options};
+        for(std::uint64_t i = 0; i != number_of_trades; i++)
+        {
+            const auto ptr = journal.claim(message_size);
+            encode_trade(
+                ptr, static_cast<std::uint32_t>(i % number_of_securities), i);
+            apply(
+                state,
+                sbepp::make_const_view<benchmark_schema::messages::trade>(
+                    ptr, message_size));
+            journal.commit(message_size);
+        }
+
+        sbepp::snapshot_writer writer{snapshot_path};
+        std::array<std::uint8_t, message_size> buf{};
+        for(std::uint32_t id = 0; id != number_of_securities; id++)
+        {
+            auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+                buf.data(), buf.size());
+            sbepp::fill_message_header(m);
+            m.securityId(id);
+            m.price(state[id].price);
+            m.quantity(state[id].quantity);
+            m.timestamp(state[id].timestamp);
+            writer.append(id, m);
+        }
+        writer.finish(journal.next_sequence());
+    }
+
+    environment(const environment&) = delete;
+    environment& operator=(const environment&) = delete;
+
+    ~environment()
+    {
+        for(const auto& path : sbepp::list_journal_segments(dir))
+        {
+            ::unlink(path.c_str());
+        }
+        ::unlink(snapshot_path.c_str());
+        ::rmdir(dir.c_str());
+    }
+};
+
+const environment& get_environment()
+{
+    static const environment env;
+    return env;
+}
+
+// rebuilds state by replaying the whole journal
+void journal_replay_benchmark(::benchmark::State& state)
+{
+    const auto& env = get_environment();
+
+    for(auto _ : state)
+    {
+        std::vector<security_state> securities(number_of_securities);
+        const sbepp::segmented_journal_reader reader{env.dir};
+        reader.for_each(
+            [&securities](
+                std::uint64_t, const std::uint8_t* data, const std::size_t size)
+            {
+                apply(
+                    securities,
+                    sbepp::make_const_view<benchmark_schema::messages::trade>(
+                        data, size));
+            });
+        ::benchmark::DoNotOptimize(securities.data());
+    }
+
+    state.counters["messages"] = static_cast<double>(number_of_trades);
+}
+
+// maps snapshot and restores a single security, the rest is restored lazily
+void snapshot_open_benchmark(::benchmark::State& state)
+{
+    const auto& env = get_environment();
+    std::uint32_t id{};
+
+    for(auto _ : state)
+    {
+        std::vector<security_state> securities(number_of_securities);
+        const sbepp::snapshot_file snapshot{env.snapshot_path};
+        snapshot.for_each_of(
+            id,
+            [&securities](const sbepp::snapshot_entry& e)
+            {
+                apply(
+                    securities,
+                    sbepp::make_const_view<benchmark_schema::messages::trade>(
+                        e.data, e.size));
+            });
+        id = (id + 1) % number_of_securities;
+        ::benchmark::DoNotOptimize(securities.data());
+    }
+
+    state.counters["messages"] = 1;
+}
+
+// maps snapshot and restores the whole state
+void snapshot_rebuild_benchmark(::benchmark::State& state)
+{
+    const auto& env = get_environment();
+
+    for(auto _ : state)
+    {
+        std::vector<security_state> securities(number_of_securities);
+        const sbepp::snapshot_file snapshot{env.snapshot_path};
+        snapshot.for_each(
+            [&securities](const sbepp::snapshot_entry& e)
+            {
+                apply(
+                    securities,
+                    sbepp::make_const_view<benchmark_schema::messages::trade>(
+                        e.data, e.size));
+            });
+        ::benchmark::DoNotOptimize(securities.data());
+    }
+
+    state.counters["messages"] = number_of_securities;
+}
+
+BENCHMARK(snapshot::journal_replay_benchmark)
+    ->Unit(::benchmark::kMicrosecond);
+BENCHMARK(snapshot::snapshot_open_benchmark)->Unit(::benchmark::kMicrosecond);
+BENCHMARK(snapshot::snapshot_rebuild_benchmark)
+    ->Unit(::benchmark::kMicrosecond);
+#endif
+} // namespace snapshot
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <benchmark_schema/benchmark_schema.hpp>
+#include <sbepp/benchmark/latency_histogram.hpp>
+#include <sbepp/tcp_transport.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace sbepp
+{
+namespace benchmark
+{
+namespace tcp_transport
+{
+#if defined(__linux__)
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t message_size =
+    8
+    + sbepp::message_traits<benchmark_schema::schema::messages::trade>::
+        block_length();
+
+// both sides either spin on `poll()` or block in `tcp_poller::wait()`,
+// spinning needs at least two free cores to make sense
+enum class wait_mode
+{
+    busy_poll,
+    epoll
+};
+
+template<typename F>
+void wait_for_messages(
+    sbepp::tcp_connection& conn,
+    sbepp::tcp_poller& poller,
+    const wait_mode mode,
+    F&& f)
+{
+    while(!conn.poll(f) && conn.is_open())
+    {
+        if(mode == wait_mode::epoll)
+        {
+            poller.wait(
+                -1,
+                [](void*, std::uint32_t)
+                {
+                });
+        }
+    }
+}
+
+void echo_server(sbepp::tcp_listener& listener, const wait_mode mode)
+{
+    sbepp::tcp_poller poller;
+    poller.add(listener.native_handle(), nullptr);
+    sbepp::tcp_connection conn;
+    while(!conn)
+    {
+        poller.wait(
+            -1,
+            [&listener, &conn](void*, std::uint32_t)
+            {
+                conn = listener.accept();
+            });
+    }
+    poller.remove(listener.native_handle());
+    poller.add(conn.native_handle(), nullptr);
+
+    while(conn.is_open())
+    {
+        wait_for_messages(
+            conn,
+            poller,
+            mode,
+            [&conn](const std::uint8_t* data, const std::size_t size)
+            {
+                conn.send(data, size);
+            });
+    }
+}
+
+void round_trip_benchmark(::benchmark::State& state, const wait_mode mode)
+{
+    sbepp::tcp_listener listener{"127.0.0.1", 0};
+    std::thread server{echo_server, std::ref(listener), mode};
+    sbepp::tcp_options options;
+    options.busy_poll_us = (mode == wait_mode::busy_poll) ? 50 : 0;
+    {
+        auto conn = sbepp::tcp_connection::connect(
+            "127.0.0.1", listener.port(), options);
+        sbepp::tcp_poller poller;
+        poller.add(conn.native_handle(), nullptr);
+
+        std::array<std::uint8_t, message_size> buf{};
+        auto m = sbepp::make_view<benchmark_schema::messages::trade>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.securityId(123);
+        latency_histogram histogram;
+        std::uint64_t timestamp{};
+
+        for(auto _ : state)
+        {
+            m.timestamp(timestamp++);
+            const auto start = clock_type::now();
+            conn.send(buf.data(), buf.size());
+            wait_for_messages(
+                conn,
+                poller,
+                mode,
+                [](const std::uint8_t* data, const std::size_t size)
+                {
+                    ::benchmark::DoNotOptimize(data[size - 1]);
+                });
+            histogram.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    clock_type::now() - start)
+                    .count()));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["busy_poll"] = conn.is_busy_polling();
+        histogram.report(state);
+    }
+    server.join();
+}
+
+void busy_poll_benchmark(::benchmark::State& state)
+{
+    round_trip_benchmark(state, wait_mode::busy_poll);
+}
+
+void epoll_benchmark(::benchmark::State& state)
+{
+    round_trip_benchmark(state, wait_mode::epoll);
+}
+
+BENCHMARK(tcp_transport::busy_poll_benchmark)->UseRealTime();
+BENCHMARK(tcp_transport::epoll_benchmark)->UseRealTime();
+#endif
+} // namespace tcp_transport
+} // namespace benchmark
+} // namespace sbepp
@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+// Snippets for `zero_overhead.cmake` check. Each `view_<name>` and
+// `cursor_<name>` function is compared against `raw_<name>` by the number of
+// instructions in the disassembly so they must do exactly the same work.
+// Raw versions follow `raw_reader.cpp`.
+
+#include <benchmark_schema/benchmark_schema.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+using message_type = benchmark_schema::messages::msg1<const std::uint8_t>;
+
+constexpr std::size_t message_header_size = sizeof(std::uint16_t) * 4;
+constexpr std::size_t group_header_size = sizeof(std::uint16_t) * 2;
+constexpr std::size_t data_length_size = sizeof(std::uint32_t);
+
+inline std::uint16_t get_u16(const std::uint8_t* ptr)
+{
+    return *(reinterpret_cast<const std::uint16_t*>(ptr));
+}
+
+inline std::uint32_t get_u32(const std::uint8_t* ptr)
+{
+    return *(reinterpret_cast<const std::uint32_t*>(ptr));
+}
+
+inline void set_u32(std::uint8_t* ptr, const std::uint32_t value)
+{
+    *(reinterpret_cast<std::uint32_t*>(ptr)) = value;
+}
+
+inline std::uint64_t get_raw_fields(const std::uint8_t* block)
+{
+    return std::uint64_t{get_u32(block)} + get_u32(block + 4)
+           + get_u32(block + 8) + get_u32(block + 12) + get_u32(block + 16);
+}
+
+template<typename Level>
+inline std::uint64_t get_fields(const Level l)
+{
+    return std::uint64_t{*l.field1()} + *l.field2() + *l.field3()
+           + *l.field4() + *l.field5();
+}
+
+template<typename Level, typename Cursor>
+inline std::uint64_t get_fields(const Level l, Cursor& c)
+{
+    return std::uint64_t{*l.field1(c)} + *l.field2(c) + *l.field3(c)
+           + *l.field4(c) + *l.field5(c);
+}
+
+// skips group with fixed-size entries
+inline const std::uint8_t* skip_raw_flat_group(const std::uint8_t* ptr)
+{
+    return ptr + group_header_size
+           + std::size_t{get_u16(ptr)} * get_u16(ptr + 2);
+}
+
+// skips group with `data` member in entries
+inline const std::uint8_t* skip_raw_nested_group(const std::uint8_t* ptr)
+{
+    const auto block_length = get_u16(ptr);
+    const auto num_in_group = get_u16(ptr + 2);
+    ptr += group_header_size;
+    for(std::size_t i = 0; i != num_in_group; i++)
+    {
+        ptr += block_length;
+        ptr += data_length_size + get_u32(ptr);
+    }
+    return ptr;
+}
+} // namespace
+
+extern "C"
+{
+// top-level fields
+std::uint64_t raw_fields(const std::uint8_t* data, std::size_t)
+{
+    return get_raw_fields(data + message_header_size);
+}
+
+std::uint64_t view_fields(const std::uint8_t* data, const std::size_t size)
+{
+    return get_fields(message_type{data, size});
+}
+
+std::uint64_t cursor_fields(const std::uint8_t* data, const std::size_t size)
+{
+    const message_type m{data, size};
+    auto c = sbepp::init_cursor(m);
+    return get_fields(m, c);
+}
+
+// fields of all `flat_group` entries
+std::uint64_t raw_flat_group(const std::uint8_t* data, std::size_t)
+{
+    auto ptr = data + message_header_size + get_u16(data);
+    const auto block_length = get_u16(ptr);
+    const auto num_in_group = get_u16(ptr + 2);
+    ptr += group_header_size;
+    std::uint64_t res{};
+    for(std::size_t i = 0; i != num_in_group; i++)
+    {
+        res += get_raw_fields(ptr);
+        ptr += block_length;
+    }
+    return res;
+}
+
+std::uint64_t view_flat_group(const std::uint8_t* data, const std::size_t size)
+{
+    std::uint64_t res{};
+    for(const auto entry : message_type{data, size}.flat_group())
+    {
+        res += get_fields(entry);
+    }
+    return res;
+}
+
+std::uint64_t
+    cursor_flat_group(const std::uint8_t* data, const std::size_t size)
+{
+    const message_type m{data, size};
+    auto c = sbepp::init_cursor(m);
+    std::uint64_t res{};
+    for(const auto entry : m.flat_group(c).cursor_range(c))
+    {
+        res += get_fields(entry, c);
+    }
+    return res;
+}
+
+// fields and data sizes of all `nested_group` entries, requires skipping
+// `flat_group`
+std::uint64_t raw_nested_group(const std::uint8_t* data, std::size_t)
+{
+    auto ptr =
+        skip_raw_flat_group(data + message_header_size + get_u16(data));
+    const auto block_length = get_u16(ptr);
+    const auto num_in_group = get_u16(ptr + 2);
+    ptr += group_header_size;
+    std::uint64_t res{};
+    for(std::size_t i = 0; i != num_in_group; i++)
+    {
+        res += get_raw_fields(ptr);
+        ptr += block_length;
+        const auto length = get_u32(ptr);
+        res += length;
+        ptr += data_length_size + length;
+    }
+    return res;
+}
+
+std::uint64_t
+    view_nested_group(const std::uint8_t* data, const std::size_t size)
+{
+    std::uint64_t res{};
+    for(const auto entry : message_type{data, size}.nested_group())
+    {
+        res += get_fields(entry);
+        res += entry.data().size();
+    }
+    return res;
+}
+
+std::uint64_t
+    cursor_nested_group(const std::uint8_t* data, const std::size_t size)
+{
+    const message_type m{data, size};
+    auto c = sbepp::init_cursor(m);
+    std::uint64_t res{};
+    for(const auto entry : m.nested_group(c).cursor_range(c))
+    {
+        res += get_fields(entry, c);
+        res += entry.data(c).size();
+    }
+    return res;
+}
+
+// size of the whole message, walks all groups
+std::uint64_t raw_size_bytes(const std::uint8_t* data, std::size_t)
+{
+    auto ptr = data + message_header_size + get_u16(data);
+    ptr = skip_raw_flat_group(ptr);
+    ptr = skip_raw_nested_group(ptr);
+    const auto block_length = get_u16(ptr);
+    const auto num_in_group = get_u16(ptr + 2);
+    ptr += group_header_size;
+    for(std::size_t i = 0; i != num_in_group; i++)
+    {
+        ptr = skip_raw_nested_group(ptr + block_length);
+    }
+    ptr += data_length_size + get_u32(ptr);
+    return static_cast<std::uint64_t>(ptr - data);
+}
+
+std::uint64_t view_size_bytes(const std::uint8_t* data, const std::size_t size)
+{
+    return sbepp::size_bytes(message_type{data, size});
+}
+
+// top-level fields encoding
+std::uint64_t raw_write_fields(std::uint8_t* data, std::size_t)
+{
+    const auto block = data + message_header_size;
+    set_u32(block, 1);
+    set_u32(block + 4, 2);
+    set_u32(block + 8, 3);
+    set_u32(block + 12, 4);
+    set_u32(block + 16, 5);
+    return 0;
+}
+
+std::uint64_t view_write_fields(std::uint8_t* data, const std::size_t size)
+{
+    const auto m =
+        sbepp::make_view<benchmark_schema::messages::msg1>(data, size);
+    m.field1(1);
+    m.field2(2);
+    m.field3(3);
+    m.field4(4);
+    m.field5(5);
+    return 0;
+}
+
+std::uint64_t cursor_write_fields(std::uint8_t* data, const std::size_t size)
+{
+    const auto m =
+        sbepp::make_view<benchmark_schema::messages::msg1>(data, size);
+    auto c = sbepp::init_cursor(m);
+    m.field1(1, c);
+    m.field2(2, c);
+    m.field3(3, c);
+    m.field4(4, c);
+    m.field5(5, c);
+    return 0;
+}
+} // extern "C"
@@ -0,0 +1,83 @@
+# Checks that sbepp accessors have no overhead compared to raw pointer code.
+#
+# Disassembles `LIBRARY` built from `zero_overhead.cpp` and compares the number
+# of instructions in each `view_<name>` and `cursor_<name>` function with its
+# `raw_<name>` counterpart. Fails if any of them is more than `THRESHOLD`
+# percent larger. No-op instructions used for alignment are not counted.
+#
+# Usage:
+#   cmake -DOBJDUMP=<objdump> -DLIBRARY=<library> -DTHRESHOLD=<percent>
+#       -P zero_overhead.cmake
+
+cmake_minimum_required(VERSION 3.11)
+
+foreach(var IN ITEMS OBJDUMP LIBRARY THRESHOLD)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "${var} is not set")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${OBJDUMP} -d --no-show-raw-insn ${LIBRARY}
+    OUTPUT_VARIABLE disassembly
+    ERROR_VARIABLE error
+    RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "objdump failed: ${error}")
+endif()
+
+# brackets and semicolons have special meaning in CMake lists
+string(REPLACE ";" "," disassembly "${disassembly}")
+string(REPLACE "[" "(" disassembly "${disassembly}")
+string(REPLACE "]" ")" disassembly "${disassembly}")
+string(REPLACE "\n" ";" lines "${disassembly}")
+
+set(functions)
+set(function)
+foreach(line IN LISTS lines)
+    if(line MATCHES "^[0-9a-fA-F]+ <([A-Za-z0-9_]+)>:$")
+        set(function ${CMAKE_MATCH_1})
+        list(APPEND functions ${function})
+        set(count_${function} 0)
+    elseif(line MATCHES "^Disassembly of section")
+        set(function)
+    elseif(function AND (line MATCHES "^ *[0-9a-fA-F]+:\t")
+        AND NOT (line MATCHES "nop"))
+        math(EXPR count_${function} "${count_${function}} + 1")
+    endif()
+endforeach()
+
+set(checked 0)
+set(failed)
+foreach(function IN LISTS functions)
+    if(NOT function MATCHES "^(view|cursor)_(.+)$")
+        continue()
+    endif()
+
+    set(raw "raw_${CMAKE_MATCH_2}")
+    if(NOT DEFINED count_${raw})
+        message(FATAL_ERROR "${function} has no ${raw} counterpart")
+    endif()
+
+    set(count ${count_${function}})
+    set(raw_count ${count_${raw}})
+    math(EXPR limit "${raw_count} * (100 + ${THRESHOLD}) / 100")
+    message(STATUS "${function}: ${count}, ${raw}: ${raw_count}")
+    if(count GREATER limit)
+        list(APPEND failed ${function})
+    endif()
+    math(EXPR checked "${checked} + 1")
+endforeach()
+
+if(checked EQUAL 0)
+    message(FATAL_ERROR "no functions to compare in ${LIBRARY}")
+endif()
+
+if(failed)
+    message(FATAL_ERROR
+        "instruction count exceeds raw code by more than ${THRESHOLD}%: "
+        "${failed}"
+    )
+endif()
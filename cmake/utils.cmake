@@ -43,3 +43,23 @@ function(sbepp_set_strict_warning_options target)
         endif()
     endif()
 endfunction()
+
+# dependencies from a package manager can be shipped with an older GCC
+# runtime library which is then found first via their RPATH, makes target
+# built in the build tree prefer the runtime of the compiler in use
+function(sbepp_prefer_compiler_runtime target)
+    if(NOT CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        return()
+    endif()
+    execute_process(
+        COMMAND ${CMAKE_CXX_COMPILER} -print-file-name=libstdc++.so
+        OUTPUT_VARIABLE runtime_library
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+    )
+    if(NOT IS_ABSOLUTE "${runtime_library}")
+        return()
+    endif()
+    get_filename_component(runtime_library "${runtime_library}" REALPATH)
+    get_filename_component(runtime_dir "${runtime_library}" DIRECTORY)
+    set_target_properties(${target} PROPERTIES BUILD_RPATH "${runtime_dir}")
+endfunction()
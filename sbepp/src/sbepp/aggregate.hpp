@@ -0,0 +1,959 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file aggregate.hpp
+ * @brief Contains `sbepp::group_column` and aggregation kernels which work
+ *  directly on wire bytes of flat group entries
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if !defined(SBEPP_HAS_AVX2) && defined(__AVX2__)
+#    define SBEPP_HAS_AVX2 1
+#endif
+//! @brief `1` if AVX2 aggregation kernels are enabled, `0` otherwise
+#ifndef SBEPP_HAS_AVX2
+#    define SBEPP_HAS_AVX2 0
+#endif
+
+#if SBEPP_HAS_AVX2
+#    include <immintrin.h>
+#endif
+
+namespace sbepp
+{
+namespace detail
+{
+template<typename Value>
+constexpr bool
+    is_column_null(const typename Value::value_type v, std::true_type) noexcept
+{
+    // floating-point null is NaN which is not equal to `null_value()`
+    return !detail::is_not_null(Value{v});
+}
+
+template<typename Value>
+constexpr bool
+    is_column_null(const typename Value::value_type, std::false_type) noexcept
+{
+    return false;
+}
+
+// `true` only for null values of optional types
+template<typename Value>
+constexpr bool is_column_null(const typename Value::value_type v) noexcept
+{
+    return is_column_null<Value>(v, sbepp::is_optional_type<Value>{});
+}
+} // namespace detail
+
+/**
+ * @brief Strided view of a single field across all entries of a flat group.
+ *
+ * Values are read directly from wire bytes, no entry views are created.
+ *
+ * @tparam Value field value type, required or optional type
+ * @tparam ByteOrder schema byte order, there's no default because field
+ *  types don't carry it
+ */
+template<typename Value, endian ByteOrder>
+class group_column
+{
+public:
+    static_assert(
+        sbepp::is_non_array_type<Value>::value,
+        "Only required and optional types are supported");
+
+    //! @brief Field value type
+    using value_type = Value;
+    //! @brief Field primitive type
+    using primitive_type = typename Value::value_type;
+
+    //! @brief Constructs an empty column
+    group_column() = default;
+
+    /**
+     * @brief Constructs column
+     *
+     * @param first pointer to the field in the first entry
+     * @param stride entry size
+     * @param size number of entries
+     */
+    group_column(
+        const void* first,
+        const std::size_t stride,
+        const std::size_t size) noexcept
+        : ptr{static_cast<const std::uint8_t*>(first)},
+          entry_size{stride},
+          length{size}
+    {
+    }
+
+    //! @brief Returns pointer to the field in the first entry
+    const std::uint8_t* data() const noexcept
+    {
+        return ptr;
+    }
+
+    //! @brief Returns entry size
+    std::size_t stride() const noexcept
+    {
+        return entry_size;
+    }
+
+    //! @brief Returns number of entries
+    std::size_t size() const noexcept
+    {
+        return length;
+    }
+
+    //! @brief Checks whether column is empty
+    bool empty() const noexcept
+    {
+        return !length;
+    }
+
+    //! @brief Returns raw value of `i`-th entry
+    //! @pre `i < size()`
+    primitive_type operator[](const std::size_t i) const noexcept
+    {
+        SBEPP_ASSERT(i < size());
+        return detail::get_primitive<primitive_type, ByteOrder>(
+            ptr + i * entry_size);
+    }
+
+    //! @brief Checks whether `i`-th value is null, always `false` for
+    //!  required types
+    //! @pre `i < size()`
+    bool is_null(const std::size_t i) const noexcept
+    {
+        return detail::is_column_null<Value>((*this)[i]);
+    }
+
+private:
+    const std::uint8_t* ptr{};
+    std::size_t entry_size{};
+    std::size_t length{};
+};
+
+namespace detail
+{
+template<typename T, typename = void>
+struct column_sum_type
+{
+    using type = double;
+};
+
+template<typename T>
+struct column_sum_type<
+    T,
+    enable_if_t<std::is_integral<T>::value && std::is_signed<T>::value>>
+{
+    using type = std::int64_t;
+};
+
+template<typename T>
+struct column_sum_type<
+    T,
+    enable_if_t<std::is_integral<T>::value && std::is_unsigned<T>::value>>
+{
+    using type = std::uint64_t;
+};
+} // namespace detail
+
+/**
+ * @brief Creates column for a field of flat group entries
+ *
+ * Example:
+ * ```cpp
+ * auto price = sbepp::make_group_column<
+ *     schema::messages::msg1::trades::price,
+ *     sbepp::schema_traits<schema::schema>::byte_order()>(msg.trades());
+ * ```
+ *
+ * @tparam FieldTag field tag
+ * @tparam ByteOrder schema byte order, must match the schema of `Group`
+ * @param g flat group
+ * @return column of `FieldTag` values
+ */
+template<typename FieldTag, endian ByteOrder, typename Group>
+group_column<typename sbepp::field_traits<FieldTag>::value_type, ByteOrder>
+    make_group_column(Group g) noexcept
+{
+    static_assert(
+        sbepp::is_flat_group<Group>::value,
+        "Columns are supported only for flat groups");
+    return {
+        sbepp::addressof(g) + detail::get_header_size(g)
+            + sbepp::field_traits<FieldTag>::offset(),
+        *sbepp::get_header(g).blockLength(),
+        g.size()};
+}
+
+//! @brief Result of `sbepp::column_min_max()`
+template<typename T>
+struct column_min_max_result
+{
+    //! @brief Minimal value, valid only if `count != 0`
+    T min;
+    //! @brief Maximal value, valid only if `count != 0`
+    T max;
+    //! @brief Number of non-null values
+    std::size_t count;
+};
+
+//! @brief Result of `sbepp::column_weighted_sum()`
+struct column_weighted_sum_result
+{
+    //! @brief Sum of `value * weight`
+    double sum;
+    //! @brief Sum of weights
+    double weight;
+};
+
+namespace detail
+{
+template<typename Value, endian E>
+using column_primitive_t = typename group_column<Value, E>::primitive_type;
+
+template<typename Value, endian E>
+using column_sum_t =
+    typename column_sum_type<column_primitive_t<Value, E>>::type;
+
+// selects kernel implementation, `0` means scalar one, otherwise it's the
+// primitive size for which AVX2 kernel is implemented
+template<typename T>
+using column_kernel_tag = std::integral_constant<
+    std::size_t,
+    (SBEPP_HAS_AVX2 && std::is_integral<T>::value
+     && ((sizeof(T) == 4) || (sizeof(T) == 8)))
+        ? sizeof(T)
+        : 0>;
+
+// weighted sum kernel for 64-bit integer values and 32-bit integer weights,
+// e.g. `int64` price and `uint32` quantity
+struct mixed_width_kernel_tag
+{
+};
+
+template<typename Value, endian E>
+column_primitive_t<Value, E> load_column_value(const std::uint8_t* ptr) noexcept
+{
+    return get_primitive<column_primitive_t<Value, E>, E>(ptr);
+}
+
+// scalar kernels walk entries with a pointer instead of `operator[]` to avoid
+// recalculating offsets and reading the same value twice
+template<typename Value, endian E>
+column_sum_t<Value, E> column_sum_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 0>)
+{
+    const auto stride = c.stride();
+    const auto size = c.size();
+    auto ptr = c.data();
+    column_sum_t<Value, E> res{};
+    for(std::size_t i = 0; i != size; i++, ptr += stride)
+    {
+        const auto v = load_column_value<Value, E>(ptr);
+        if(!is_column_null<Value>(v))
+        {
+            res += v;
+        }
+    }
+    return res;
+}
+
+template<typename Value, endian E>
+std::size_t column_count_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 0>)
+{
+    if(!sbepp::is_optional_type<Value>::value)
+    {
+        return c.size();
+    }
+    const auto stride = c.stride();
+    const auto size = c.size();
+    auto ptr = c.data();
+    std::size_t res{};
+    for(std::size_t i = 0; i != size; i++, ptr += stride)
+    {
+        res += !is_column_null<Value>(load_column_value<Value, E>(ptr));
+    }
+    return res;
+}
+
+template<typename Value, endian E>
+column_min_max_result<column_primitive_t<Value, E>> column_min_max_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 0>)
+{
+    using primitive_type = column_primitive_t<Value, E>;
+    const auto stride = c.stride();
+    const auto size = c.size();
+    auto ptr = c.data();
+    auto min = (std::numeric_limits<primitive_type>::max)();
+    auto max = std::numeric_limits<primitive_type>::lowest();
+    std::size_t count{};
+    for(std::size_t i = 0; i != size; i++, ptr += stride)
+    {
+        const auto v = load_column_value<Value, E>(ptr);
+        if(!is_column_null<Value>(v))
+        {
+            min = (v < min) ? v : min;
+            max = (max < v) ? v : max;
+            count++;
+        }
+    }
+    return {min, max, count};
+}
+
+template<typename Value, typename Weight, endian E>
+column_weighted_sum_result column_weighted_sum_impl(
+    const group_column<Value, E>& values,
+    const group_column<Weight, E>& weights,
+    std::integral_constant<std::size_t, 0>)
+{
+    const auto values_stride = values.stride();
+    const auto weights_stride = weights.stride();
+    const auto size = values.size();
+    auto values_ptr = values.data();
+    auto weights_ptr = weights.data();
+    double sum{};
+    double weight{};
+    for(std::size_t i = 0; i != size;
+        i++, values_ptr += values_stride, weights_ptr += weights_stride)
+    {
+        const auto v = load_column_value<Value, E>(values_ptr);
+        const auto w = load_column_value<Weight, E>(weights_ptr);
+        if(!is_column_null<Value>(v) && !is_column_null<Weight>(w))
+        {
+            sum += static_cast<double>(v) * static_cast<double>(w);
+            weight += static_cast<double>(w);
+        }
+    }
+    return {sum, weight};
+}
+
+#if SBEPP_HAS_AVX2
+// gathers 8 32-bit values from entries starting at `ptr`
+template<endian E>
+__m256i avx2_gather32(const std::uint8_t* ptr, const __m256i index) noexcept
+{
+    auto v = _mm256_i32gather_epi32(
+        reinterpret_cast<const int*>(ptr), index, 1);
+    if(E != endian::native)
+    {
+        v = _mm256_shuffle_epi8(
+            v,
+            _mm256_setr_epi8(
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    }
+    return v;
+}
+
+// gathers 4 32-bit values from entries starting at `ptr`
+template<endian E>
+__m128i avx2_gather32x4(const std::uint8_t* ptr, const __m128i index) noexcept
+{
+    auto v = _mm_i32gather_epi32(reinterpret_cast<const int*>(ptr), index, 1);
+    if(E != endian::native)
+    {
+        v = _mm_shuffle_epi8(
+            v,
+            _mm_setr_epi8(
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    }
+    return v;
+}
+
+// gathers 4 64-bit values from entries starting at `ptr`
+template<endian E>
+__m256i avx2_gather64(const std::uint8_t* ptr, const __m128i index) noexcept
+{
+    auto v = _mm256_i32gather_epi64(
+        reinterpret_cast<const long long*>(ptr), index, 1);
+    if(E != endian::native)
+    {
+        v = _mm256_shuffle_epi8(
+            v,
+            _mm256_setr_epi8(
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+    }
+    return v;
+}
+
+inline __m256i avx2_index32(const std::size_t stride) noexcept
+{
+    return _mm256_mullo_epi32(
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+        _mm256_set1_epi32(static_cast<int>(stride)));
+}
+
+inline __m128i avx2_index64(const std::size_t stride) noexcept
+{
+    return _mm_mullo_epi32(
+        _mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(stride)));
+}
+
+// all bits are set in lanes which hold null value
+template<typename Value>
+__m256i avx2_null_mask32(const __m256i v, std::true_type) noexcept
+{
+    return _mm256_cmpeq_epi32(
+        v, _mm256_set1_epi32(static_cast<int>(Value::null_value())));
+}
+
+template<typename Value>
+__m256i avx2_null_mask32(const __m256i, std::false_type) noexcept
+{
+    return _mm256_setzero_si256();
+}
+
+template<typename Value>
+__m256i avx2_null_mask64(const __m256i v, std::true_type) noexcept
+{
+    return _mm256_cmpeq_epi64(
+        v, _mm256_set1_epi64x(static_cast<long long>(Value::null_value())));
+}
+
+template<typename Value>
+__m256i avx2_null_mask64(const __m256i, std::false_type) noexcept
+{
+    return _mm256_setzero_si256();
+}
+
+inline __m256i avx2_widen_low32(const __m256i v, std::true_type /*signed*/)
+{
+    return _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v));
+}
+
+inline __m256i avx2_widen_low32(const __m256i v, std::false_type)
+{
+    return _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v));
+}
+
+inline __m256i avx2_widen_high32(const __m256i v, std::true_type /*signed*/)
+{
+    return _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1));
+}
+
+inline __m256i avx2_widen_high32(const __m256i v, std::false_type)
+{
+    return _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1));
+}
+
+inline __m256i avx2_min32(const __m256i a, const __m256i b, std::true_type)
+{
+    return _mm256_min_epi32(a, b);
+}
+
+inline __m256i avx2_min32(const __m256i a, const __m256i b, std::false_type)
+{
+    return _mm256_min_epu32(a, b);
+}
+
+inline __m256i avx2_max32(const __m256i a, const __m256i b, std::true_type)
+{
+    return _mm256_max_epi32(a, b);
+}
+
+inline __m256i avx2_max32(const __m256i a, const __m256i b, std::false_type)
+{
+    return _mm256_max_epu32(a, b);
+}
+
+// AVX2 has only signed 64-bit comparison, unsigned values are biased
+inline __m256i avx2_greater64(const __m256i a, const __m256i b, std::true_type)
+{
+    return _mm256_cmpgt_epi64(a, b);
+}
+
+inline __m256i avx2_greater64(const __m256i a, const __m256i b, std::false_type)
+{
+    const auto bias = _mm256_set1_epi64x(
+        static_cast<long long>(UINT64_C(0x8000000000000000)));
+    return _mm256_cmpgt_epi64(
+        _mm256_xor_si256(a, bias), _mm256_xor_si256(b, bias));
+}
+
+// converts 4 32-bit integers to doubles
+inline __m256d avx2_to_double(const __m128i v, std::true_type /*signed*/)
+{
+    return _mm256_cvtepi32_pd(v);
+}
+
+inline __m256d avx2_to_double(const __m128i v, std::false_type)
+{
+    const auto biased = _mm_xor_si128(v, _mm_set1_epi32(INT32_MIN));
+    return _mm256_add_pd(
+        _mm256_cvtepi32_pd(biased), _mm256_set1_pd(2147483648.0));
+}
+
+// AVX2 has no 64-bit integer to double conversion. Value is split into two
+// parts which are exactly representable as doubles with magic exponents,
+// their sum is rounded once so the result is the same as `static_cast`.
+inline __m256d avx2_to_double64(const __m256i v, std::true_type /*signed*/)
+{
+    // high 16 bits scaled by 2^48 with 3*2^67 exponent, low 48 bits with
+    // 2^52 exponent
+    auto high = _mm256_blend_epi16(
+        _mm256_srai_epi32(v, 16), _mm256_setzero_si256(), 0x33);
+    high = _mm256_add_epi64(
+        high, _mm256_castpd_si256(_mm256_set1_pd(442721857769029238784.0)));
+    const auto low = _mm256_blend_epi16(
+        v, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)), 0x88);
+    const auto f = _mm256_sub_pd(
+        _mm256_castsi256_pd(high), _mm256_set1_pd(442726361368656609280.0));
+    return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+}
+
+inline __m256d avx2_to_double64(const __m256i v, std::false_type)
+{
+    // high 32 bits with 2^84 exponent, low 32 bits with 2^52 exponent
+    const auto high = _mm256_or_si256(
+        _mm256_srli_epi64(v, 32),
+        _mm256_castpd_si256(_mm256_set1_pd(19342813113834066795298816.0)));
+    const auto low = _mm256_blend_epi16(
+        v, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)), 0xCC);
+    const auto f = _mm256_sub_pd(
+        _mm256_castsi256_pd(high),
+        _mm256_set1_pd(19342813118337666422669312.0));
+    return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+}
+
+// converts 64-bit integers from [-2^51, 2^51) range, e.g. widened 32-bit ones
+inline __m256d avx2_small64_to_double(const __m256i v)
+{
+    // 2^52 + 2^51
+    const auto magic = _mm256_set1_pd(6755399441055744.0);
+    return _mm256_sub_pd(
+        _mm256_castsi256_pd(
+            _mm256_add_epi64(v, _mm256_castpd_si256(magic))),
+        magic);
+}
+
+inline std::uint64_t avx2_reduce_add64(const __m256i v) noexcept
+{
+    const auto sum = _mm_add_epi64(
+        _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(sum))
+           + static_cast<std::uint64_t>(_mm_extract_epi64(sum, 1));
+}
+
+inline double avx2_reduce_add(const __m256d v) noexcept
+{
+    const auto sum =
+        _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+inline std::size_t avx2_popcount(const int mask) noexcept
+{
+    return static_cast<std::size_t>(
+        _mm_popcnt_u32(static_cast<unsigned>(mask)));
+}
+
+template<typename Value, endian E>
+column_sum_t<Value, E> column_sum_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 4>)
+{
+    using is_signed = std::is_signed<column_primitive_t<Value, E>>;
+    const auto index = avx2_index32(c.stride());
+    auto ptr = c.data();
+    auto acc = _mm256_setzero_si256();
+    std::size_t i{};
+    for(; (i + 8) <= c.size(); i += 8, ptr += 8 * c.stride())
+    {
+        auto v = avx2_gather32<E>(ptr, index);
+        v = _mm256_andnot_si256(
+            avx2_null_mask32<Value>(v, sbepp::is_optional_type<Value>{}), v);
+        acc = _mm256_add_epi64(acc, avx2_widen_low32(v, is_signed{}));
+        acc = _mm256_add_epi64(acc, avx2_widen_high32(v, is_signed{}));
+    }
+
+    auto res = static_cast<column_sum_t<Value, E>>(avx2_reduce_add64(acc));
+    for(; i != c.size(); i++)
+    {
+        if(!c.is_null(i))
+        {
+            res += c[i];
+        }
+    }
+    return res;
+}
+
+template<typename Value, endian E>
+column_sum_t<Value, E> column_sum_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 8>)
+{
+    const auto index = avx2_index64(c.stride());
+    auto ptr = c.data();
+    auto acc = _mm256_setzero_si256();
+    std::size_t i{};
+    for(; (i + 4) <= c.size(); i += 4, ptr += 4 * c.stride())
+    {
+        auto v = avx2_gather64<E>(ptr, index);
+        v = _mm256_andnot_si256(
+            avx2_null_mask64<Value>(v, sbepp::is_optional_type<Value>{}), v);
+        acc = _mm256_add_epi64(acc, v);
+    }
+
+    auto res = static_cast<column_sum_t<Value, E>>(avx2_reduce_add64(acc));
+    for(; i != c.size(); i++)
+    {
+        if(!c.is_null(i))
+        {
+            res += c[i];
+        }
+    }
+    return res;
+}
+
+template<typename Value, endian E>
+std::size_t column_count_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 4>)
+{
+    if(!sbepp::is_optional_type<Value>::value)
+    {
+        return c.size();
+    }
+    const auto index = avx2_index32(c.stride());
+    auto ptr = c.data();
+    std::size_t res{};
+    std::size_t i{};
+    for(; (i + 8) <= c.size(); i += 8, ptr += 8 * c.stride())
+    {
+        const auto mask = avx2_null_mask32<Value>(
+            avx2_gather32<E>(ptr, index), sbepp::is_optional_type<Value>{});
+        res += 8 - avx2_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+    }
+    for(; i != c.size(); i++)
+    {
+        res += !c.is_null(i);
+    }
+    return res;
+}
+
+template<typename Value, endian E>
+std::size_t column_count_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 8>)
+{
+    if(!sbepp::is_optional_type<Value>::value)
+    {
+        return c.size();
+    }
+    const auto index = avx2_index64(c.stride());
+    auto ptr = c.data();
+    std::size_t res{};
+    std::size_t i{};
+    for(; (i + 4) <= c.size(); i += 4, ptr += 4 * c.stride())
+    {
+        const auto mask = avx2_null_mask64<Value>(
+            avx2_gather64<E>(ptr, index), sbepp::is_optional_type<Value>{});
+        res += 4 - avx2_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    }
+    for(; i != c.size(); i++)
+    {
+        res += !c.is_null(i);
+    }
+    return res;
+}
+
+template<typename T>
+column_min_max_result<T> merge_min_max(
+    const column_min_max_result<T>& vector_part,
+    const T (&mins)[32 / sizeof(T)],
+    const T (&maxs)[32 / sizeof(T)]) noexcept
+{
+    auto res = vector_part;
+    for(std::size_t i = 0; i != (32 / sizeof(T)); i++)
+    {
+        res.min = (mins[i] < res.min) ? mins[i] : res.min;
+        res.max = (res.max < maxs[i]) ? maxs[i] : res.max;
+    }
+    return res;
+}
+
+template<typename Value, endian E>
+column_min_max_result<column_primitive_t<Value, E>> column_min_max_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 4>)
+{
+    using primitive_type = column_primitive_t<Value, E>;
+    using is_signed = std::is_signed<primitive_type>;
+    constexpr auto lowest = (std::numeric_limits<primitive_type>::min)();
+    constexpr auto highest = (std::numeric_limits<primitive_type>::max)();
+    const auto index = avx2_index32(c.stride());
+    auto ptr = c.data();
+    auto min = _mm256_set1_epi32(static_cast<int>(highest));
+    auto max = _mm256_set1_epi32(static_cast<int>(lowest));
+    std::size_t count{};
+    std::size_t i{};
+    for(; (i + 8) <= c.size(); i += 8, ptr += 8 * c.stride())
+    {
+        const auto v = avx2_gather32<E>(ptr, index);
+        const auto mask =
+            avx2_null_mask32<Value>(v, sbepp::is_optional_type<Value>{});
+        // null lanes are replaced with neutral values
+        min = avx2_min32(
+            min,
+            _mm256_blendv_epi8(
+                v, _mm256_set1_epi32(static_cast<int>(highest)), mask),
+            is_signed{});
+        max = avx2_max32(
+            max,
+            _mm256_blendv_epi8(
+                v, _mm256_set1_epi32(static_cast<int>(lowest)), mask),
+            is_signed{});
+        count +=
+            8 - avx2_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+    }
+
+    primitive_type mins[8];
+    primitive_type maxs[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(mins), min);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxs), max);
+    const auto tail = column_min_max_impl(
+        group_column<Value, E>{ptr, c.stride(), c.size() - i},
+        std::integral_constant<std::size_t, 0>{});
+    auto res = merge_min_max(tail, mins, maxs);
+    res.count += count;
+    return res;
+}
+
+template<typename Value, endian E>
+column_min_max_result<column_primitive_t<Value, E>> column_min_max_impl(
+    const group_column<Value, E>& c, std::integral_constant<std::size_t, 8>)
+{
+    using primitive_type = column_primitive_t<Value, E>;
+    using is_signed = std::is_signed<primitive_type>;
+    constexpr auto lowest = (std::numeric_limits<primitive_type>::min)();
+    constexpr auto highest = (std::numeric_limits<primitive_type>::max)();
+    const auto index = avx2_index64(c.stride());
+    auto ptr = c.data();
+    const auto lowest_v = _mm256_set1_epi64x(static_cast<long long>(lowest));
+    const auto highest_v = _mm256_set1_epi64x(static_cast<long long>(highest));
+    auto min = highest_v;
+    auto max = lowest_v;
+    std::size_t count{};
+    std::size_t i{};
+    for(; (i + 4) <= c.size(); i += 4, ptr += 4 * c.stride())
+    {
+        const auto v = avx2_gather64<E>(ptr, index);
+        const auto mask =
+            avx2_null_mask64<Value>(v, sbepp::is_optional_type<Value>{});
+        const auto min_candidate = _mm256_blendv_epi8(v, highest_v, mask);
+        const auto max_candidate = _mm256_blendv_epi8(v, lowest_v, mask);
+        min = _mm256_blendv_epi8(
+            min,
+            min_candidate,
+            avx2_greater64(min, min_candidate, is_signed{}));
+        max = _mm256_blendv_epi8(
+            max,
+            max_candidate,
+            avx2_greater64(max_candidate, max, is_signed{}));
+        count +=
+            4 - avx2_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    }
+
+    primitive_type mins[4];
+    primitive_type maxs[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(mins), min);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxs), max);
+    const auto tail = column_min_max_impl(
+        group_column<Value, E>{ptr, c.stride(), c.size() - i},
+        std::integral_constant<std::size_t, 0>{});
+    auto res = merge_min_max(tail, mins, maxs);
+    res.count += count;
+    return res;
+}
+
+// both columns have 32-bit integer values
+template<typename Value, typename Weight, endian E>
+column_weighted_sum_result column_weighted_sum_impl(
+    const group_column<Value, E>& values,
+    const group_column<Weight, E>& weights,
+    std::integral_constant<std::size_t, 4>)
+{
+    using values_signed = std::is_signed<column_primitive_t<Value, E>>;
+    using weights_signed = std::is_signed<column_primitive_t<Weight, E>>;
+    const auto values_index = avx2_index32(values.stride());
+    const auto weights_index = avx2_index32(weights.stride());
+    auto values_ptr = values.data();
+    auto weights_ptr = weights.data();
+    auto sum = _mm256_setzero_pd();
+    auto weight = _mm256_setzero_pd();
+    std::size_t i{};
+    for(; (i + 8) <= values.size(); i += 8,
+                                    values_ptr += 8 * values.stride(),
+                                    weights_ptr += 8 * weights.stride())
+    {
+        auto v = avx2_gather32<E>(values_ptr, values_index);
+        auto w = avx2_gather32<E>(weights_ptr, weights_index);
+        // entry is skipped if either of values is null
+        const auto mask = _mm256_or_si256(
+            avx2_null_mask32<Value>(v, sbepp::is_optional_type<Value>{}),
+            avx2_null_mask32<Weight>(w, sbepp::is_optional_type<Weight>{}));
+        v = _mm256_andnot_si256(mask, v);
+        w = _mm256_andnot_si256(mask, w);
+
+        const auto v_low =
+            avx2_to_double(_mm256_castsi256_si128(v), values_signed{});
+        const auto v_high =
+            avx2_to_double(_mm256_extracti128_si256(v, 1), values_signed{});
+        const auto w_low =
+            avx2_to_double(_mm256_castsi256_si128(w), weights_signed{});
+        const auto w_high =
+            avx2_to_double(_mm256_extracti128_si256(w, 1), weights_signed{});
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(v_low, w_low));
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(v_high, w_high));
+        weight = _mm256_add_pd(weight, _mm256_add_pd(w_low, w_high));
+    }
+
+    auto res = column_weighted_sum_impl(
+        group_column<Value, E>{values_ptr, values.stride(), values.size() - i},
+        group_column<Weight, E>{
+            weights_ptr, weights.stride(), weights.size() - i},
+        std::integral_constant<std::size_t, 0>{});
+    res.sum += avx2_reduce_add(sum);
+    res.weight += avx2_reduce_add(weight);
+    return res;
+}
+
+// 64-bit values and 32-bit weights, weights are widened to 64-bit lanes
+template<typename Value, typename Weight, endian E>
+column_weighted_sum_result column_weighted_sum_impl(
+    const group_column<Value, E>& values,
+    const group_column<Weight, E>& weights,
+    mixed_width_kernel_tag)
+{
+    using values_signed = std::is_signed<column_primitive_t<Value, E>>;
+    using weights_signed = std::is_signed<column_primitive_t<Weight, E>>;
+    const auto values_index = avx2_index64(values.stride());
+    const auto weights_index = avx2_index64(weights.stride());
+    auto values_ptr = values.data();
+    auto weights_ptr = weights.data();
+    auto sum = _mm256_setzero_pd();
+    auto weight = _mm256_setzero_pd();
+    std::size_t i{};
+    for(; (i + 4) <= values.size(); i += 4,
+                                    values_ptr += 4 * values.stride(),
+                                    weights_ptr += 4 * weights.stride())
+    {
+        auto v = avx2_gather64<E>(values_ptr, values_index);
+        // widened null value is equal to the widened `null_value()`
+        auto w = avx2_widen_low32(
+            _mm256_castsi128_si256(
+                avx2_gather32x4<E>(weights_ptr, weights_index)),
+            weights_signed{});
+        const auto mask = _mm256_or_si256(
+            avx2_null_mask64<Value>(v, sbepp::is_optional_type<Value>{}),
+            avx2_null_mask64<Weight>(w, sbepp::is_optional_type<Weight>{}));
+        v = _mm256_andnot_si256(mask, v);
+        w = _mm256_andnot_si256(mask, w);
+
+        const auto v_double = avx2_to_double64(v, values_signed{});
+        const auto w_double = avx2_small64_to_double(w);
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(v_double, w_double));
+        weight = _mm256_add_pd(weight, w_double);
+    }
+
+    auto res = column_weighted_sum_impl(
+        group_column<Value, E>{values_ptr, values.stride(), values.size() - i},
+        group_column<Weight, E>{
+            weights_ptr, weights.stride(), weights.size() - i},
+        std::integral_constant<std::size_t, 0>{});
+    res.sum += avx2_reduce_add(sum);
+    res.weight += avx2_reduce_add(weight);
+    return res;
+}
+
+// AVX2 implementation exists only for 32-bit integers and for 64-bit values
+// with 32-bit weights
+template<typename Value, typename Weight, endian E>
+column_weighted_sum_result column_weighted_sum_impl(
+    const group_column<Value, E>& values,
+    const group_column<Weight, E>& weights,
+    std::integral_constant<std::size_t, 8>)
+{
+    return column_weighted_sum_impl(
+        values, weights, std::integral_constant<std::size_t, 0>{});
+}
+#endif
+
+template<typename Value, typename Weight, endian E>
+using weighted_sum_kernel_tag = typename std::conditional<
+    (column_kernel_tag<column_primitive_t<Value, E>>::value == 8)
+        && (column_kernel_tag<column_primitive_t<Weight, E>>::value == 4),
+    mixed_width_kernel_tag,
+    std::integral_constant<
+        std::size_t,
+        (column_kernel_tag<column_primitive_t<Value, E>>::value
+         == column_kernel_tag<column_primitive_t<Weight, E>>::value)
+            ? column_kernel_tag<column_primitive_t<Value, E>>::value
+            : 0>>::type;
+} // namespace detail
+
+/**
+ * @brief Calculates sum of non-null values
+ *
+ * @param c column
+ * @return sum as `std::int64_t`, `std::uint64_t` or `double` depending on
+ *  the primitive type
+ */
+template<typename Value, endian E>
+detail::column_sum_t<Value, E> column_sum(const group_column<Value, E>& c)
+{
+    return detail::column_sum_impl(
+        c, detail::column_kernel_tag<detail::column_primitive_t<Value, E>>{});
+}
+
+//! @brief Returns the number of non-null values
+template<typename Value, endian E>
+std::size_t column_count_non_null(const group_column<Value, E>& c)
+{
+    return detail::column_count_impl(
+        c, detail::column_kernel_tag<detail::column_primitive_t<Value, E>>{});
+}
+
+//! @brief Calculates minimal and maximal non-null values
+template<typename Value, endian E>
+column_min_max_result<detail::column_primitive_t<Value, E>>
+    column_min_max(const group_column<Value, E>& c)
+{
+    return detail::column_min_max_impl(
+        c, detail::column_kernel_tag<detail::column_primitive_t<Value, E>>{});
+}
+
+/**
+ * @brief Calculates weighted sum of values, entries where either value or
+ *  weight is null are skipped
+ *
+ * VWAP can be calculated as:
+ * ```cpp
+ * auto res = sbepp::column_weighted_sum(prices, quantities);
+ * auto vwap = res.sum / res.weight;
+ * ```
+ *
+ * @param values values column
+ * @param weights weights column
+ * @pre `values.size() == weights.size()`
+ */
+template<typename Value, typename Weight, endian E>
+column_weighted_sum_result column_weighted_sum(
+    const group_column<Value, E>& values,
+    const group_column<Weight, E>& weights)
+{
+    SBEPP_ASSERT(values.size() == weights.size());
+    return detail::column_weighted_sum_impl(
+        values, weights, detail::weighted_sum_kernel_tag<Value, Weight, E>{});
+}
+} // namespace sbepp
@@ -0,0 +1,825 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file any_message.hpp
+ * @brief Contains `sbepp::any_message`, a type-erased message handle
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/validation.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace sbepp
+{
+/**
+ * @brief Type-erased visitor for `sbepp::any_message::visit()`
+ *
+ * All callbacks do nothing by default. `name` is `nullptr` for array
+ * elements.
+ */
+class any_visitor
+{
+public:
+    virtual ~any_visitor() = default;
+
+    //! @brief Called before message members
+    virtual void on_message_begin(const char* /*name*/)
+    {
+    }
+
+    //! @brief Called after message members
+    virtual void on_message_end()
+    {
+    }
+
+    //! @brief Called before group entries
+    virtual void on_group_begin(const char* /*name*/, std::size_t /*size*/)
+    {
+    }
+
+    //! @brief Called after group entries
+    virtual void on_group_end()
+    {
+    }
+
+    //! @brief Called before entry members
+    virtual void on_entry_begin()
+    {
+    }
+
+    //! @brief Called after entry members
+    virtual void on_entry_end()
+    {
+    }
+
+    //! @brief Called before composite members
+    virtual void on_composite_begin(const char* /*name*/)
+    {
+    }
+
+    //! @brief Called after composite members
+    virtual void on_composite_end()
+    {
+    }
+
+    //! @brief Called for null value of optional type
+    virtual void on_null(const char* /*name*/)
+    {
+    }
+
+    //! @brief Called for signed integer value
+    virtual void on_signed(const char* /*name*/, std::int64_t /*value*/)
+    {
+    }
+
+    //! @brief Called for unsigned integer value
+    virtual void on_unsigned(const char* /*name*/, std::uint64_t /*value*/)
+    {
+    }
+
+    //! @brief Called for floating-point value
+    virtual void on_floating_point(const char* /*name*/, double /*value*/)
+    {
+    }
+
+    /**
+     * @brief Called for enum value
+     *
+     * @param name member name
+     * @param enumerator enumerator name or `nullptr` for unknown values
+     * @param value underlying value
+     */
+    virtual void on_enum(
+        const char* /*name*/,
+        const char* /*enumerator*/,
+        std::int64_t /*value*/)
+    {
+    }
+
+    //! @brief Called before set choices
+    virtual void on_set_begin(const char* /*name*/, std::uint64_t /*value*/)
+    {
+    }
+
+    //! @brief Called for each set choice in order of declaration
+    virtual void on_choice(const char* /*name*/, bool /*value*/)
+    {
+    }
+
+    //! @brief Called after set choices
+    virtual void on_set_end()
+    {
+    }
+
+    //! @brief Called for `char` values, arrays and data members. Arrays are
+    //!  truncated at the first `'\0'`
+    virtual void on_string(
+        const char* /*name*/, const char* /*str*/, std::size_t /*size*/)
+    {
+    }
+
+    //! @brief Called before non-`char` array or data elements
+    virtual void on_array_begin(const char* /*name*/, std::size_t /*size*/)
+    {
+    }
+
+    //! @brief Called after non-`char` array or data elements
+    virtual void on_array_end()
+    {
+    }
+};
+
+namespace detail
+{
+// translates `sbepp::visit()` callbacks into `any_visitor` ones. For a final
+// `Visitor`, calls are not virtual
+template<typename Visitor>
+class any_visitor_adapter
+{
+public:
+    explicit any_visitor_adapter(Visitor& visitor) noexcept : visitor{&visitor}
+    {
+    }
+
+    template<typename T, typename Cursor, typename Tag>
+    void on_message(T m, Cursor& c, Tag)
+    {
+        visitor->on_message_begin(sbepp::message_traits<Tag>::name());
+        sbepp::visit_children(m, c, *this);
+        visitor->on_message_end();
+    }
+
+    template<typename T, typename Cursor, typename Tag>
+    bool on_group(T g, Cursor& c, Tag)
+    {
+        visitor->on_group_begin(sbepp::group_traits<Tag>::name(), g.size());
+        sbepp::visit_children(g, c, *this);
+        visitor->on_group_end();
+        return false;
+    }
+
+    template<typename T, typename Cursor>
+    bool on_entry(T e, Cursor& c)
+    {
+        visitor->on_entry_begin();
+        sbepp::visit_children(e, c, *this);
+        visitor->on_entry_end();
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_data(T d, Tag)
+    {
+        on_array(d, sbepp::data_traits<Tag>::name());
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_field(T f, Tag)
+    {
+        on_encoding(f, sbepp::field_traits<Tag>::name());
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_type(T t, Tag)
+    {
+        on_encoding(t, sbepp::type_traits<Tag>::name());
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_enum(T e, Tag)
+    {
+        on_encoding(e, sbepp::enum_traits<Tag>::name());
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_set(T s, Tag)
+    {
+        on_encoding(s, sbepp::set_traits<Tag>::name());
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_composite(T c, Tag)
+    {
+        on_encoding(c, sbepp::composite_traits<Tag>::name());
+        return false;
+    }
+
+private:
+    Visitor* visitor;
+
+    class choice_visitor
+    {
+    public:
+        explicit choice_visitor(Visitor& visitor) noexcept : visitor{&visitor}
+        {
+        }
+
+        void operator()(const bool value, const char* name) const
+        {
+            visitor->on_choice(name, value);
+        }
+
+    private:
+        Visitor* visitor;
+    };
+
+    template<typename T>
+    typename std::enable_if<sbepp::is_required_type<T>::value>::type
+        on_encoding(T value, const char* name)
+    {
+        on_primitive(name, *value);
+    }
+
+    template<typename T>
+    typename std::enable_if<sbepp::is_optional_type<T>::value>::type
+        on_encoding(T value, const char* name)
+    {
+        if(value)
+        {
+            on_primitive(name, *value);
+        }
+        else
+        {
+            visitor->on_null(name);
+        }
+    }
+
+    template<typename T>
+    typename std::enable_if<sbepp::is_enum<T>::value>::type
+        on_encoding(T value, const char* name)
+    {
+        visitor->on_enum(
+            name,
+            sbepp::enum_to_string(value),
+            static_cast<std::int64_t>(sbepp::to_underlying(value)));
+    }
+
+    template<typename T>
+    typename std::enable_if<sbepp::is_set<T>::value>::type
+        on_encoding(T value, const char* name)
+    {
+        visitor->on_set_begin(name, static_cast<std::uint64_t>(*value));
+        sbepp::visit_set(value, choice_visitor{*visitor});
+        visitor->on_set_end();
+    }
+
+    template<typename T>
+    typename std::enable_if<sbepp::is_array_type<T>::value>::type
+        on_encoding(T value, const char* name)
+    {
+        on_array(value, name);
+    }
+
+    template<typename T>
+    typename std::enable_if<sbepp::is_composite<T>::value>::type
+        on_encoding(T value, const char* name)
+    {
+        visitor->on_composite_begin(name);
+        sbepp::visit_children(value, *this);
+        visitor->on_composite_end();
+    }
+
+    template<typename T>
+    void on_array(T a, const char* name)
+    {
+        on_array(
+            a.begin(),
+            a.size(),
+            name,
+            std::is_same<typename T::value_type, char>{});
+    }
+
+    template<typename T>
+    void on_array(
+        const T* ptr, const std::size_t size, const char* name, std::true_type)
+    {
+        const auto str = reinterpret_cast<const char*>(ptr);
+        visitor->on_string(
+            name,
+            str,
+            static_cast<std::size_t>(std::find(str, str + size, '\0') - str));
+    }
+
+    template<typename T>
+    void on_array(
+        const T* ptr, const std::size_t size, const char* name, std::false_type)
+    {
+        visitor->on_array_begin(name, size);
+        for(std::size_t i = 0; i != size; i++)
+        {
+            on_primitive(nullptr, ptr[i]);
+        }
+        visitor->on_array_end();
+    }
+
+    void on_primitive(const char* name, const char value)
+    {
+        visitor->on_string(name, &value, value ? 1 : 0);
+    }
+
+    template<typename T>
+    void on_primitive(const char* name, const T value)
+    {
+        on_primitive(
+            name,
+            value,
+            std::integral_constant<
+                int,
+                std::is_floating_point<T>::value ? 0
+                : std::is_signed<T>::value       ? 1
+                                                 : 2>{});
+    }
+
+    template<typename T>
+    void on_primitive(
+        const char* name, const T value, std::integral_constant<int, 0>)
+    {
+        visitor->on_floating_point(name, static_cast<double>(value));
+    }
+
+    template<typename T>
+    void on_primitive(
+        const char* name, const T value, std::integral_constant<int, 1>)
+    {
+        visitor->on_signed(name, static_cast<std::int64_t>(value));
+    }
+
+    template<typename T>
+    void on_primitive(
+        const char* name, const T value, std::integral_constant<int, 2>)
+    {
+        visitor->on_unsigned(name, static_cast<std::uint64_t>(value));
+    }
+};
+
+// writes message members as `key<key_end>value` pairs separated by
+// `separator`, groups and arrays are written as `[...]`, entries and
+// composites as `{...}`. `Format` defines the rest of the syntax.
+template<typename Format>
+class structure_writer final : public any_visitor
+{
+public:
+    explicit structure_writer(std::string& out) noexcept : out{&out}
+    {
+    }
+
+    void on_message_begin(const char* name) override
+    {
+        if(Format::names_messages)
+        {
+            write_separator();
+            *out += name;
+        }
+        else
+        {
+            *out += '{';
+        }
+    }
+
+    void on_message_end() override
+    {
+        if(!Format::names_messages)
+        {
+            *out += '}';
+        }
+    }
+
+    void on_group_begin(const char* name, std::size_t) override
+    {
+        write_key(name);
+        *out += '[';
+    }
+
+    void on_group_end() override
+    {
+        *out += ']';
+    }
+
+    void on_entry_begin() override
+    {
+        write_separator();
+        *out += '{';
+    }
+
+    void on_entry_end() override
+    {
+        *out += '}';
+    }
+
+    void on_composite_begin(const char* name) override
+    {
+        write_key(name);
+        *out += '{';
+    }
+
+    void on_composite_end() override
+    {
+        *out += '}';
+    }
+
+    void on_null(const char* name) override
+    {
+        write_key(name);
+        *out += "null";
+    }
+
+    void on_signed(const char* name, const std::int64_t value) override
+    {
+        write_key(name);
+        *out += std::to_string(static_cast<long long>(value));
+    }
+
+    void on_unsigned(const char* name, const std::uint64_t value) override
+    {
+        write_key(name);
+        *out += std::to_string(static_cast<unsigned long long>(value));
+    }
+
+    void on_floating_point(const char* name, const double value) override
+    {
+        write_key(name);
+        if(!Format::writes_non_finite && !std::isfinite(value))
+        {
+            *out += "null";
+            return;
+        }
+        char buf[32];
+        const auto n = std::snprintf(
+            buf,
+            sizeof(buf),
+            "%.*g",
+            std::numeric_limits<double>::max_digits10,
+            value);
+        out->append(buf, static_cast<std::size_t>(n));
+    }
+
+    void on_enum(
+        const char* name,
+        const char* enumerator,
+        const std::int64_t value) override
+    {
+        if(enumerator)
+        {
+            write_key(name);
+            Format::write_name(*out, enumerator);
+        }
+        else
+        {
+            on_signed(name, value);
+        }
+    }
+
+    void on_set_begin(const char* name, std::uint64_t) override
+    {
+        write_key(name);
+        *out += Format::set_begin;
+    }
+
+    void on_choice(const char* name, const bool value) override
+    {
+        if(value)
+        {
+            write_separator();
+            Format::write_name(*out, name);
+        }
+    }
+
+    void on_set_end() override
+    {
+        *out += Format::set_end;
+    }
+
+    void on_string(
+        const char* name, const char* str, const std::size_t size) override
+    {
+        write_key(name);
+        Format::write_string(*out, str, size);
+    }
+
+    void on_array_begin(const char* name, std::size_t) override
+    {
+        write_key(name);
+        *out += '[';
+    }
+
+    void on_array_end() override
+    {
+        *out += ']';
+    }
+
+private:
+    std::string* out;
+
+    void write_separator()
+    {
+        if(!out->empty() && Format::needs_separator(out->back()))
+        {
+            *out += Format::separator;
+        }
+    }
+
+    void write_key(const char* name)
+    {
+        write_separator();
+        if(name)
+        {
+            Format::write_name(*out, name);
+            *out += Format::key_end;
+        }
+    }
+};
+
+// message is written as a JSON object. Sets are written as arrays, unknown
+// enum values and NaN/infinity as numbers and `null`
+struct json_format
+{
+    static constexpr bool names_messages = false;
+    static constexpr bool writes_non_finite = false;
+    static constexpr char separator = ',';
+    static constexpr char key_end = ':';
+    static constexpr char set_begin = '[';
+    static constexpr char set_end = ']';
+
+    static bool needs_separator(const char last) noexcept
+    {
+        return (last != '{') && (last != '[');
+    }
+
+    static void write_name(std::string& out, const char* name)
+    {
+        write_string(out, name, std::char_traits<char>::length(name));
+    }
+
+    static void
+        write_string(std::string& out, const char* str, const std::size_t size)
+    {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+        out += '"';
+        for(std::size_t i = 0; i != size; i++)
+        {
+            const auto c = static_cast<unsigned char>(str[i]);
+            if((c == '"') || (c == '\\'))
+            {
+                out += '\\';
+                out += static_cast<char>(c);
+            }
+            else if(c < 0x20)
+            {
+                const char escaped[] = {
+                    '\\',
+                    'u',
+                    '0',
+                    '0',
+                    hex_digits[c >> 4],
+                    hex_digits[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
+            }
+            else
+            {
+                out += static_cast<char>(c);
+            }
+        }
+        out += '"';
+    }
+};
+
+using json_writer = structure_writer<json_format>;
+
+template<typename MessageTag>
+using any_message_view = typename sbepp::message_traits<
+    MessageTag>::template value_type<const std::uint8_t>;
+
+template<typename MessageTag>
+struct any_message_impl
+{
+    static any_message_view<MessageTag>
+        make_view(const void* data, const std::size_t size) noexcept
+    {
+        return {static_cast<const std::uint8_t*>(data), size};
+    }
+
+    static size_bytes_checked_result
+        size_bytes_checked(const void* data, const std::size_t size) noexcept
+    {
+        return sbepp::size_bytes_checked(make_view(data, size), size);
+    }
+
+    static void
+        visit(const void* data, const std::size_t size, any_visitor& visitor)
+    {
+        any_visitor_adapter<any_visitor> adapter{visitor};
+        sbepp::visit(make_view(data, size), adapter);
+    }
+
+    static void
+        to_json(const void* data, const std::size_t size, std::string& out)
+    {
+        json_writer writer{out};
+        any_visitor_adapter<json_writer> adapter{writer};
+        sbepp::visit(make_view(data, size), adapter);
+    }
+
+    static validation_result
+        validate(const void* data, const std::size_t size)
+    {
+        return sbepp::validate(make_view(data, size), size);
+    }
+};
+} // namespace detail
+
+/**
+ * @brief Per-message table of type-erased operations
+ *
+ * Contains only plain data and function pointers so it can be passed across
+ * shared library boundaries. All functions take pointer to the message and
+ * the buffer size.
+ */
+struct any_message_vtable
+{
+    //! @brief Message name
+    const char* name;
+    //! @brief Message id
+    message_id_t id;
+    //! @brief See `sbepp::size_bytes_checked()`
+    size_bytes_checked_result (*size_bytes_checked)(
+        const void* data, std::size_t size);
+    //! @brief Visits message using `sbepp::any_visitor`
+    void (*visit)(const void* data, std::size_t size, any_visitor& visitor);
+    //! @brief Appends JSON representation of message to `out`
+    void (*to_json)(const void* data, std::size_t size, std::string& out);
+    //! @brief See `sbepp::validate()`
+    validation_result (*validate)(const void* data, std::size_t size);
+};
+
+/**
+ * @brief Returns vtable for the given message
+ *
+ * @tparam MessageTag message tag
+ */
+template<typename MessageTag>
+const any_message_vtable& any_message_vtable_for() noexcept
+{
+    static const any_message_vtable vtable{
+        sbepp::message_traits<MessageTag>::name(),
+        sbepp::message_traits<MessageTag>::id(),
+        &detail::any_message_impl<MessageTag>::size_bytes_checked,
+        &detail::any_message_impl<MessageTag>::visit,
+        &detail::any_message_impl<MessageTag>::to_json,
+        &detail::any_message_impl<MessageTag>::validate};
+    return vtable;
+}
+
+/**
+ * @brief Type-erased message handle
+ *
+ * Holds a pointer to message, buffer size and a pointer to message vtable.
+ * Every operation costs a single indirect call, message itself is processed
+ * by a statically typed code. Doesn't own the buffer.
+ *
+ * Example:
+ * ```cpp
+ * auto m = sbepp::make_any_message<schema::schema::messages::msg1>(
+ *     buf.data(), buf.size());
+ * if(m.validate().valid())
+ * {
+ *     plugin.handle(m);
+ * }
+ * ```
+ */
+class any_message
+{
+public:
+    //! @brief Constructs empty handle
+    any_message() = default;
+
+    /**
+     * @brief Constructs handle
+     *
+     * @param data pointer to message
+     * @param size buffer size
+     * @param vtable message vtable
+     */
+    any_message(
+        const void* data,
+        const std::size_t size,
+        const any_message_vtable& vtable) noexcept
+        : ptr{data}, buffer_size{size}, table{&vtable}
+    {
+    }
+
+    //! @brief Returns pointer to message
+    const void* data() const noexcept
+    {
+        return ptr;
+    }
+
+    //! @brief Returns buffer size
+    std::size_t size() const noexcept
+    {
+        return buffer_size;
+    }
+
+    //! @brief Returns vtable, `nullptr` for empty handle
+    const any_message_vtable* vtable() const noexcept
+    {
+        return table;
+    }
+
+    //! @brief Checks whether handle is not empty
+    explicit operator bool() const noexcept
+    {
+        return table != nullptr;
+    }
+
+    //! @brief Returns message name
+    //! @pre `*this` is not empty
+    const char* name() const noexcept
+    {
+        SBEPP_ASSERT(table);
+        return table->name;
+    }
+
+    //! @brief Returns message id
+    //! @pre `*this` is not empty
+    message_id_t id() const noexcept
+    {
+        SBEPP_ASSERT(table);
+        return table->id;
+    }
+
+    //! @brief Calculates message size, see `sbepp::size_bytes_checked()`
+    //! @pre `*this` is not empty
+    size_bytes_checked_result size_bytes_checked() const noexcept
+    {
+        SBEPP_ASSERT(table);
+        return table->size_bytes_checked(ptr, buffer_size);
+    }
+
+    //! @brief Visits message
+    //! @pre `*this` is not empty and `size_bytes_checked().valid == true`
+    void visit(any_visitor& visitor) const
+    {
+        SBEPP_ASSERT(table);
+        table->visit(ptr, buffer_size, visitor);
+    }
+
+    //! @brief Appends JSON representation of message to `out`
+    //! @pre `*this` is not empty and `size_bytes_checked().valid == true`
+    void to_json(std::string& out) const
+    {
+        SBEPP_ASSERT(table);
+        table->to_json(ptr, buffer_size, out);
+    }
+
+    //! @brief Returns JSON representation of message
+    //! @pre `*this` is not empty and `size_bytes_checked().valid == true`
+    std::string to_json() const
+    {
+        std::string res;
+        to_json(res);
+        return res;
+    }
+
+    //! @brief Validates message, see `sbepp::validate()`
+    //! @pre `*this` is not empty
+    validation_result validate() const
+    {
+        SBEPP_ASSERT(table);
+        return table->validate(ptr, buffer_size);
+    }
+
+private:
+    const void* ptr{};
+    std::size_t buffer_size{};
+    const any_message_vtable* table{};
+};
+
+/**
+ * @brief Creates type-erased message handle
+ *
+ * @tparam MessageTag message tag
+ * @param data pointer to message
+ * @param size buffer size
+ */
+template<typename MessageTag>
+any_message make_any_message(const void* data, const std::size_t size) noexcept
+{
+    return {data, size, sbepp::any_message_vtable_for<MessageTag>()};
+}
+} // namespace sbepp
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file batch_encoder.hpp
+ * @brief Contains `sbepp::batch_encoder` which encodes many messages of the
+ *  same type at once
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace sbepp
+{
+namespace detail
+{
+// visiting message with it instantiates `on_group()`/`on_data()` only if
+// message has such members, they make message size variable
+class fixed_size_message_checker
+{
+public:
+    template<typename T, typename Tag>
+    constexpr bool on_field(T, Tag) const noexcept
+    {
+        return false;
+    }
+
+    template<typename T, typename Cursor, typename Tag>
+    constexpr bool on_group(T, Cursor&, Tag) const noexcept
+    {
+        static_assert(
+            sizeof(T) == 0, "batch_encoder: message must not have groups");
+        return true;
+    }
+
+    template<typename T, typename Tag>
+    constexpr bool on_data(T, Tag) const noexcept
+    {
+        static_assert(
+            sizeof(T) == 0, "batch_encoder: message must not have data");
+        return true;
+    }
+};
+} // namespace detail
+
+/**
+ * @brief Encodes a batch of fixed-size messages of the same type into
+ *  consecutive memory.
+ *
+ * Encoding each message via `sbepp::fill_message_header` and setters repeats
+ * identical header stores for every message. Batch encoder prepares a message
+ * image once: header is filled by `sbepp::fill_message_header` and fields
+ * common for the whole batch can be set via `prototype()`. Each message is
+ * then started by storing that image, it's loaded into machine words once
+ * per `encode()` call so each message takes a few word-sized stores, after
+ * which only per-row fields are set by the client.
+ * It pays off when common fields take many separate stores, for messages
+ * with only a couple of common fields it's on par with setting them
+ * directly.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::batch_encoder<schema::schema, schema::schema::messages::quote>
+ *     encoder;
+ * encoder.prototype().securityId(id);
+ *
+ * const auto n = encoder.encode(
+ *     buf, size, rows.begin(), rows.end(),
+ *     [](schema::messages::quote<std::uint8_t> m, const row& r)
+ *     {
+ *         m.price(r.price);
+ *         m.quantity(r.quantity);
+ *     });
+ * send(buf, n * encoder.message_size());
+ * ```
+ *
+ * @tparam SchemaTag schema tag, used to determine message header size
+ * @tparam MessageTag message tag, message must not have groups and data
+ *  members, it's checked at compile time
+ */
+template<typename SchemaTag, typename MessageTag>
+class batch_encoder
+{
+public:
+    //! @brief Message type passed to the row callback
+    using message_type = typename sbepp::message_traits<
+        MessageTag>::template value_type<std::uint8_t>;
+
+    //! @brief Constructs encoder with zeroed message image and filled header
+    batch_encoder() noexcept
+    {
+        sbepp::visit_children(
+            prototype(), detail::fixed_size_message_checker{});
+        sbepp::fill_message_header(prototype());
+    }
+
+    //! @brief Returns the size of each encoded message
+    static constexpr std::size_t message_size() noexcept
+    {
+        return image_size;
+    }
+
+    /**
+     * @brief Returns a view of the message image copied into each message.
+     *  Fields set through it are common for the whole batch.
+     */
+    message_type prototype() noexcept
+    {
+        return {image.data(), image.size()};
+    }
+
+    /**
+     * @brief Encodes a message for each row from `[first, last)`
+     *
+     * Rows which don't fit into the buffer are not encoded.
+     *
+     * @param data buffer start
+     * @param size buffer size
+     * @param first first row
+     * @param last last row
+     * @param fill callback, receives `message_type` and a row, sets per-row
+     *  fields
+     * @return the number of encoded messages, they occupy
+     *  `n * message_size()` bytes from the buffer start
+     */
+    template<typename InputIt, typename F>
+    std::size_t encode(
+        void* data,
+        const std::size_t size,
+        InputIt first,
+        InputIt last,
+        F&& fill) const
+    {
+        auto ptr = static_cast<std::uint8_t*>(data);
+        const auto capacity = size / message_size();
+        // image is loaded into words once, copying it from memory for each
+        // message makes compiler re-materialize it with narrow stores and
+        // then read it back with wide loads which stalls store forwarding
+        std::array<block_type, block_count> blocks{};
+        std::memcpy(blocks.data(), image.data(), image.size());
+        std::size_t n{};
+        for(; (first != last) && (n != capacity); ++first, ++n)
+        {
+            for(std::size_t i = 0; i != full_block_count; i++)
+            {
+                std::memcpy(
+                    ptr + i * sizeof(block_type),
+                    &blocks[i],
+                    sizeof(block_type));
+            }
+            std::memcpy(
+                ptr + full_block_count * sizeof(block_type),
+                blocks.data() + full_block_count,
+                tail_size);
+            fill(message_type{ptr, message_size()}, *first);
+            SBEPP_ASSERT(
+                sbepp::size_bytes(message_type{ptr, message_size()})
+                == message_size());
+            ptr += message_size();
+        }
+
+        return n;
+    }
+
+private:
+    static constexpr std::size_t image_size =
+        sbepp::composite_traits<typename sbepp::schema_traits<
+            SchemaTag>::header_type_tag>::size_bytes()
+        + sbepp::message_traits<MessageTag>::block_length();
+
+    using block_type = std::uint64_t;
+    static constexpr std::size_t full_block_count =
+        image_size / sizeof(block_type);
+    static constexpr std::size_t tail_size = image_size % sizeof(block_type);
+    static constexpr std::size_t block_count =
+        full_block_count + (tail_size ? 1 : 0);
+
+    std::array<std::uint8_t, image_size> image{};
+};
+} // namespace sbepp
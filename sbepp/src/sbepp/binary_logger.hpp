@@ -0,0 +1,502 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file binary_logger.hpp
+ * @brief Contains `sbepp::binary_logger`, a deferred logger which copies raw
+ *  messages on the hot path and formats them in a background thread
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/any_message.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace sbepp
+{
+namespace detail
+{
+// precedes each message in `binary_log_ring`, `vtable == nullptr` marks
+// padding up to the end of the ring
+struct binary_log_record_header
+{
+    const any_message_vtable* vtable;
+    std::int64_t timestamp;
+    std::uint64_t size;
+};
+
+constexpr std::size_t binary_log_record_alignment =
+    alignof(binary_log_record_header);
+
+constexpr std::size_t binary_log_record_size(const std::size_t size) noexcept
+{
+    return (sizeof(binary_log_record_header) + size
+            + binary_log_record_alignment - 1)
+           & ~(binary_log_record_alignment - 1);
+}
+} // namespace detail
+
+/**
+ * @brief Single-producer single-consumer lock-free ring of raw messages.
+ *
+ * Each record contains message bytes, a timestamp and a pointer to
+ * `sbepp::any_message_vtable`, so the consumer can decode messages of
+ * different types without knowing them in advance. Records are stored
+ * contiguously, a record which doesn't fit before the end of the ring starts
+ * from its beginning. Message bytes are aligned to 8 bytes.
+ *
+ * `try_push()` must be called from one thread and `consume()` from another
+ * one, or both from the same thread.
+ */
+class binary_log_ring : public detail::cache_aligned_allocation
+{
+public:
+    /**
+     * @brief Constructs ring
+     *
+     * @param min_capacity minimum capacity, rounded up to the power of two
+     * @param options memory allocation options
+     * @throws std::system_error or std::bad_alloc if memory cannot be
+     *  allocated
+     */
+    explicit binary_log_ring(
+        const std::size_t min_capacity, const memory_options& options = {})
+        : memory{detail::round_up_to_power_of_two(
+                     (std::max)(
+                         min_capacity,
+                         detail::binary_log_record_size(0))),
+                 options}
+    {
+    }
+
+    //! @brief Returns ring capacity
+    std::size_t capacity() const noexcept
+    {
+        return memory.size();
+    }
+
+    /**
+     * @brief Copies message into the ring
+     *
+     * @param vtable message vtable
+     * @param timestamp message timestamp
+     * @param data message data
+     * @param size exact message size
+     * @return `false` if there's not enough free space
+     */
+    bool try_push(
+        const any_message_vtable& vtable,
+        const std::int64_t timestamp,
+        const void* data,
+        const std::size_t size) noexcept
+    {
+        const auto record_size = detail::binary_log_record_size(size);
+        const auto position = head.value.load(std::memory_order_relaxed);
+        const auto offset = static_cast<std::size_t>(position) & mask();
+        const auto tail_space = capacity() - offset;
+        const auto padding = (tail_space < record_size) ? tail_space : 0;
+        const auto required = padding + record_size;
+        if((position + required - head.cached) > capacity())
+        {
+            head.cached = tail.value.load(std::memory_order_acquire);
+            if((position + required - head.cached) > capacity())
+            {
+                return false;
+            }
+        }
+
+        auto ptr = memory.data() + offset;
+        if(padding)
+        {
+            // shorter tail is skipped by the consumer anyway
+            if(padding >= sizeof(detail::binary_log_record_header))
+            {
+                const detail::binary_log_record_header header{
+                    nullptr, 0, 0};
+                std::memcpy(ptr, &header, sizeof(header));
+            }
+            ptr = memory.data();
+        }
+        const detail::binary_log_record_header header{
+            &vtable, timestamp, size};
+        std::memcpy(ptr, &header, sizeof(header));
+        std::memcpy(ptr + sizeof(header), data, size);
+        head.value.store(position + required, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Consumes all available records
+     *
+     * @param f callback with signature
+     *  `void(std::int64_t timestamp, const sbepp::any_message&)`, message
+     *  memory is valid only during the call
+     * @return number of consumed records
+     */
+    template<typename F>
+    std::size_t consume(F&& f)
+    {
+        auto pos = tail.value.load(std::memory_order_relaxed);
+        if(pos == tail.cached)
+        {
+            tail.cached = head.value.load(std::memory_order_acquire);
+        }
+        std::size_t n{};
+        while(pos != tail.cached)
+        {
+            const auto offset = static_cast<std::size_t>(pos) & mask();
+            detail::binary_log_record_header header{};
+            if((capacity() - offset) >= sizeof(header))
+            {
+                std::memcpy(&header, memory.data() + offset, sizeof(header));
+            }
+            if(!header.vtable)
+            {
+                pos += capacity() - offset;
+                continue;
+            }
+
+            f(header.timestamp,
+              sbepp::any_message{
+                  memory.data() + offset + sizeof(header),
+                  static_cast<std::size_t>(header.size),
+                  *header.vtable});
+            pos += detail::binary_log_record_size(
+                static_cast<std::size_t>(header.size));
+            n++;
+        }
+        tail.value.store(pos, std::memory_order_release);
+
+        return n;
+    }
+
+    //! @brief Checks whether all pushed records are consumed
+    bool empty() const noexcept
+    {
+        return tail.value.load(std::memory_order_acquire)
+               == head.value.load(std::memory_order_acquire);
+    }
+
+private:
+    buffer_memory memory;
+    // written by producer, `cached` is producer's copy of `tail`
+    padded_position head;
+    // written by consumer, `cached` is consumer's copy of `head`
+    padded_position tail;
+
+    std::size_t mask() const noexcept
+    {
+        return capacity() - 1;
+    }
+};
+
+//! @brief Output format of `sbepp::binary_logger`
+enum class binary_log_format
+{
+    //! `<seconds>.<nanoseconds> <message> <member>=<value> ...`
+    text,
+    //! `{"timestamp":<nanoseconds>,"message":"<name>","value":{...}}`
+    json
+};
+
+//! @brief Options for `sbepp::binary_logger`
+struct binary_logger_options
+{
+    //! Minimum ring capacity
+    std::size_t capacity{1024 * 1024};
+    //! Output format
+    binary_log_format format{binary_log_format::text};
+    //! How long background thread sleeps when ring is empty
+    std::chrono::microseconds idle_sleep{100};
+    //! Ring memory allocation options
+    memory_options memory;
+};
+
+namespace detail
+{
+// `<message> <member>=<value> ...`, names, enumerators and choices are not
+// quoted, strings are quoted with non-printable bytes escaped as `\xNN`
+struct text_log_format
+{
+    static constexpr bool names_messages = true;
+    static constexpr bool writes_non_finite = true;
+    static constexpr char separator = ' ';
+    static constexpr char key_end = '=';
+    static constexpr char set_begin = '{';
+    static constexpr char set_end = '}';
+
+    static bool needs_separator(const char last) noexcept
+    {
+        return (last != '{') && (last != '[') && (last != '\n');
+    }
+
+    static void write_name(std::string& out, const char* name)
+    {
+        out += name;
+    }
+
+    static void
+        write_string(std::string& out, const char* str, const std::size_t size)
+    {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+        out += '"';
+        for(std::size_t i = 0; i != size; i++)
+        {
+            const auto c = static_cast<unsigned char>(str[i]);
+            if((c < 0x20) || (c >= 0x7F))
+            {
+                const char escaped[] = {
+                    '\\', 'x', hex_digits[c >> 4], hex_digits[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
+            }
+            else
+            {
+                out += static_cast<char>(c);
+            }
+        }
+        out += '"';
+    }
+};
+
+using text_log_writer = structure_writer<text_log_format>;
+
+inline void format_log_record(
+    std::string& out,
+    const binary_log_format format,
+    const std::int64_t timestamp,
+    const any_message& m)
+{
+    if(format == binary_log_format::json)
+    {
+        out += "{\"timestamp\":";
+        out += std::to_string(static_cast<long long>(timestamp));
+        out += ",\"message\":\"";
+        out += m.name();
+        out += "\",\"value\":";
+        m.to_json(out);
+        out += "}\n";
+    }
+    else
+    {
+        constexpr std::int64_t ns_per_second = 1000000000;
+        char buf[32];
+        const auto n = std::snprintf(
+            buf,
+            sizeof(buf),
+            "%lld.%09lld",
+            static_cast<long long>(timestamp / ns_per_second),
+            static_cast<long long>(timestamp % ns_per_second));
+        out.append(buf, static_cast<std::size_t>(n));
+        text_log_writer writer{out};
+        m.visit(writer);
+        out += '\n';
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Deferred binary logger.
+ *
+ * `log()` copies exactly `sbepp::size_bytes()` of the message and a
+ * timestamp into `sbepp::binary_log_ring`. Background thread drains the ring,
+ * formats messages using `sbepp::any_message::visit()` or
+ * `sbepp::any_message::to_json()` and passes text to the sink, one call per
+ * drained batch. Messages which don't fit into the ring are dropped and
+ * counted, the hot path never blocks.
+ *
+ * `log()` must be called from a single thread, use one logger per producer
+ * thread.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::binary_logger logger{
+ *     [](const char* data, std::size_t size)
+ *     {
+ *         std::fwrite(data, 1, size, stdout);
+ *     }};
+ * // hot path
+ * logger.log<schema::schema::messages::msg1>(msg);
+ * ```
+ */
+class binary_logger : public detail::cache_aligned_allocation
+{
+public:
+    //! @brief Receives formatted text, called from the background thread
+    using sink_type = std::function<void(const char* data, std::size_t size)>;
+
+    /**
+     * @brief Constructs logger and starts background thread
+     *
+     * @param sink formatted text sink
+     * @param options logger options
+     * @throws std::system_error or std::bad_alloc if ring memory cannot be
+     *  allocated or thread cannot be started
+     */
+    explicit binary_logger(
+        sink_type sink, const binary_logger_options& options = {})
+        : ring{options.capacity, options.memory},
+          sink{std::move(sink)},
+          format{options.format},
+          idle_sleep{options.idle_sleep},
+          worker{&binary_logger::run, this}
+    {
+    }
+
+    binary_logger(const binary_logger&) = delete;
+    binary_logger& operator=(const binary_logger&) = delete;
+
+    //! @brief Formats remaining messages and stops background thread
+    ~binary_logger()
+    {
+        stopped.store(true, std::memory_order_release);
+        worker.join();
+    }
+
+    /**
+     * @brief Logs message with the current `std::chrono::system_clock` time
+     *
+     * @tparam MessageTag message tag
+     * @param m message view
+     * @return `false` if message was dropped
+     */
+    template<typename MessageTag, typename View>
+    bool log(const View m) noexcept
+    {
+        return log<MessageTag>(
+            m,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count());
+    }
+
+    /**
+     * @brief Logs message with the given timestamp
+     *
+     * @tparam MessageTag message tag
+     * @param m message view
+     * @param timestamp timestamp in nanoseconds
+     * @return `false` if message was dropped
+     */
+    template<typename MessageTag, typename View>
+    bool log(const View m, const std::int64_t timestamp) noexcept
+    {
+        if(!ring.try_push(
+               sbepp::any_message_vtable_for<MessageTag>(),
+               timestamp,
+               sbepp::addressof(m),
+               sbepp::size_bytes(m)))
+        {
+            dropped_count++;
+            return false;
+        }
+        return true;
+    }
+
+    //! @brief Returns the number of dropped messages. Must be called from
+    //!  the producer thread
+    std::uint64_t dropped() const noexcept
+    {
+        return dropped_count;
+    }
+
+    /**
+     * @brief Waits until all previously logged messages are passed to the
+     *  sink
+     *
+     * @throws any exception thrown by the sink, after that logger doesn't
+     *  format messages anymore
+     */
+    void flush()
+    {
+        while(!ring.empty() && !failed.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        // batch is passed to the sink after it's consumed from the ring
+        while(busy.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        if(failed.load(std::memory_order_acquire))
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    binary_log_ring ring;
+    sink_type sink;
+    binary_log_format format;
+    std::chrono::microseconds idle_sleep;
+    std::uint64_t dropped_count{};
+    std::atomic<bool> stopped{};
+    std::atomic<bool> busy{};
+    std::atomic<bool> failed{};
+    std::exception_ptr error;
+    std::string buffer;
+    // must be the last member, thread uses all the above
+    std::thread worker;
+
+    void run() noexcept
+    {
+        try
+        {
+            while(true)
+            {
+                // must be read before draining to not lose the last records
+                const auto stop = stopped.load(std::memory_order_acquire);
+                if(!drain() && stop)
+                {
+                    break;
+                }
+                if(ring.empty() && !stop)
+                {
+                    std::this_thread::sleep_for(idle_sleep);
+                }
+            }
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+            busy.store(false, std::memory_order_release);
+            failed.store(true, std::memory_order_release);
+        }
+    }
+
+    // returns `true` if something was formatted
+    bool drain()
+    {
+        busy.store(true, std::memory_order_release);
+        buffer.clear();
+        const auto n = ring.consume(
+            [this](const std::int64_t timestamp, const any_message& m)
+            {
+                detail::format_log_record(buffer, format, timestamp, m);
+            });
+        if(n)
+        {
+            sink(buffer.data(), buffer.size());
+        }
+        busy.store(false, std::memory_order_release);
+
+        return n != 0;
+    }
+};
+} // namespace sbepp
@@ -0,0 +1,444 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file broadcast_ring.hpp
+ * @brief Contains `sbepp::broadcast_ring`, a single-producer multi-consumer
+ *  ring where each consumer sees every message
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace sbepp
+{
+namespace detail
+{
+// precedes each message, `broadcast_padding_size` marks padding up to the end
+// of the ring
+using broadcast_record_header = std::uint64_t;
+
+constexpr broadcast_record_header broadcast_padding_size =
+    (std::numeric_limits<broadcast_record_header>::max)();
+
+// marks free consumer slot
+constexpr std::uint64_t broadcast_inactive_position =
+    (std::numeric_limits<std::uint64_t>::max)();
+
+constexpr std::size_t broadcast_record_alignment =
+    sizeof(broadcast_record_header);
+
+constexpr std::size_t broadcast_record_size(const std::size_t size) noexcept
+{
+    return (sizeof(broadcast_record_header) + size
+            + broadcast_record_alignment - 1)
+           & ~(broadcast_record_alignment - 1);
+}
+
+// each consumer position is placed into its own cache line
+struct broadcast_consumer_slot : padded_position, cache_aligned_allocation
+{
+    broadcast_consumer_slot() noexcept
+    {
+        value.store(broadcast_inactive_position, std::memory_order_relaxed);
+    }
+};
+} // namespace detail
+
+//! @brief Result of `sbepp::broadcast_ring::slowest_consumer()`
+struct broadcast_consumer_lag
+{
+    //! Consumer index or `max_consumers()` if there are no consumers
+    std::size_t index;
+    //! Number of bytes consumer needs to read to catch up with producer
+    std::uint64_t lag;
+};
+
+/**
+ * @brief Disruptor-style single-producer multi-consumer broadcast ring.
+ *
+ * Producer encodes each message once, in place, and every consumer reads it
+ * as a zero-copy view, tracking its own position. Producer never overwrites
+ * data which is not yet read by all consumers: `try_claim()` fails until the
+ * slowest consumer frees enough space. Slow consumers can be detected with
+ * `slowest_consumer()` and asked to `close()` themselves.
+ *
+ * Records are stored contiguously, a record which doesn't fit before the end
+ * of the ring starts from its beginning. Message bytes are aligned to 8
+ * bytes.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::broadcast_ring ring{1024 * 1024, 16};
+ *
+ * // each consumer thread
+ * auto consumer = ring.add_consumer();
+ * consumer.poll(
+ *     [](const std::uint8_t* data, std::size_t size)
+ *     {
+ *         handle(sbepp::make_const_view<schema::messages::msg1>(data, size));
+ *     });
+ *
+ * // producer thread
+ * if(auto data = ring.try_claim(max_message_size))
+ * {
+ *     auto m = sbepp::make_view<schema::messages::msg1>(
+ *         data, max_message_size);
+ *     // fill message
+ *     ring.publish(sbepp::size_bytes(m));
+ * }
+ * ```
+ */
+class broadcast_ring : public detail::cache_aligned_allocation
+{
+public:
+    /**
+     * @brief Consumer handle, must be used from a single thread.
+     *
+     * Consumer doesn't own ring, it must be closed before ring is destroyed.
+     */
+    class consumer
+    {
+    public:
+        //! @brief Constructs closed consumer
+        consumer() = default;
+
+        consumer(const consumer&) = delete;
+        consumer& operator=(const consumer&) = delete;
+
+        //! @brief Move constructor, `other` is left closed
+        consumer(consumer&& other) noexcept
+            : ring{other.ring}, slot{other.slot}, position{other.position}
+        {
+            other.ring = nullptr;
+        }
+
+        //! @brief Move assignment, `other` is left closed
+        consumer& operator=(consumer&& other) noexcept
+        {
+            if(this != &other)
+            {
+                close();
+                ring = other.ring;
+                slot = other.slot;
+                position = other.position;
+                other.ring = nullptr;
+            }
+            return *this;
+        }
+
+        //! @brief Closes consumer
+        ~consumer()
+        {
+            close();
+        }
+
+        //! @brief Checks whether consumer is attached to the ring
+        explicit operator bool() const noexcept
+        {
+            return ring != nullptr;
+        }
+
+        //! @brief Returns consumer index, see
+        //!  `sbepp::broadcast_ring::slowest_consumer()`
+        std::size_t index() const noexcept
+        {
+            return slot;
+        }
+
+        /**
+         * @brief Reads available messages
+         *
+         * Position is released after all messages are handled, so message
+         * memory is valid until `poll()` returns.
+         *
+         * @param f callback with signature
+         *  `void(const std::uint8_t* data, std::size_t size)`
+         * @param limit maximum number of messages to read
+         * @return the number of read messages
+         * @pre consumer is not closed
+         */
+        template<typename F>
+        std::size_t poll(
+            F&& f,
+            const std::size_t limit =
+                (std::numeric_limits<std::size_t>::max)())
+        {
+            SBEPP_ASSERT(ring);
+            const auto end =
+                ring->published_head.value.load(std::memory_order_acquire);
+            std::size_t n{};
+            while((position != end) && (n != limit))
+            {
+                const auto offset = ring->offset_of(position);
+                detail::broadcast_record_header size;
+                std::memcpy(&size, ring->memory.data() + offset, sizeof(size));
+                if(size == detail::broadcast_padding_size)
+                {
+                    position += ring->capacity() - offset;
+                    continue;
+                }
+
+                f(ring->memory.data() + offset + sizeof(size),
+                  static_cast<std::size_t>(size));
+                position += detail::broadcast_record_size(
+                    static_cast<std::size_t>(size));
+                n++;
+            }
+            ring->slots[slot].value.store(
+                position, std::memory_order_release);
+
+            return n;
+        }
+
+        //! @brief Returns the number of bytes consumer needs to read to catch
+        //!  up with producer
+        //! @pre consumer is not closed
+        std::uint64_t lag() const noexcept
+        {
+            SBEPP_ASSERT(ring);
+            return ring->published_head.value.load(
+                       std::memory_order_acquire)
+                   - position;
+        }
+
+        //! @brief Detaches consumer from the ring so it doesn't block
+        //!  producer anymore
+        void close() noexcept
+        {
+            if(ring)
+            {
+                ring->slots[slot].value.store(
+                    detail::broadcast_inactive_position,
+                    std::memory_order_release);
+                ring = nullptr;
+            }
+        }
+
+    private:
+        friend class broadcast_ring;
+
+        broadcast_ring* ring{};
+        std::size_t slot{};
+        std::uint64_t position{};
+
+        consumer(
+            broadcast_ring& ring,
+            const std::size_t slot,
+            const std::uint64_t position) noexcept
+            : ring{&ring}, slot{slot}, position{position}
+        {
+        }
+    };
+
+    /**
+     * @brief Constructs ring
+     *
+     * @param min_capacity minimum capacity, rounded up to the power of two
+     * @param max_consumers maximum number of simultaneously attached
+     *  consumers
+     * @param options memory allocation options
+     * @throws std::system_error or std::bad_alloc if memory cannot be
+     *  allocated
+     */
+    broadcast_ring(
+        const std::size_t min_capacity,
+        const std::size_t max_consumers,
+        const memory_options& options = {})
+        : memory{detail::round_up_to_power_of_two(
+                     (std::max)(
+                         min_capacity, detail::broadcast_record_size(0))),
+                 options},
+          slots{new detail::broadcast_consumer_slot[max_consumers]},
+          slots_count{max_consumers}
+    {
+    }
+
+    broadcast_ring(const broadcast_ring&) = delete;
+    broadcast_ring& operator=(const broadcast_ring&) = delete;
+
+    //! @brief Returns ring capacity
+    std::size_t capacity() const noexcept
+    {
+        return memory.size();
+    }
+
+    //! @brief Returns maximum number of consumers
+    std::size_t max_consumers() const noexcept
+    {
+        return slots_count;
+    }
+
+    /**
+     * @brief Attaches new consumer, can be called from any thread
+     *
+     * Consumer receives only messages published after this call.
+     *
+     * @throws std::length_error if there are already `max_consumers()`
+     *  consumers
+     */
+    consumer add_consumer()
+    {
+        for(std::size_t i = 0; i != slots_count; i++)
+        {
+            // slot is claimed with a provisional position which holds back
+            // the producer, then the actual start position is read. Producer
+            // which didn't see the slot cached a position not greater than
+            // the start one, see `min_position()`.
+            auto expected = detail::broadcast_inactive_position;
+            const auto provisional =
+                published_head.value.load(std::memory_order_acquire);
+            if(slots[i].value.compare_exchange_strong(
+                   expected, provisional, std::memory_order_seq_cst))
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const auto position =
+                    published_head.value.load(std::memory_order_acquire);
+                slots[i].value.store(position, std::memory_order_release);
+                return {*this, i, position};
+            }
+        }
+        throw std::length_error{"broadcast_ring: too many consumers"};
+    }
+
+    /**
+     * @brief Claims space for the next message
+     *
+     * @param max_size maximum message size
+     * @return pointer to `max_size` bytes aligned to 8 bytes or `nullptr` if
+     *  there's not enough free space
+     */
+    std::uint8_t* try_claim(const std::size_t max_size) noexcept
+    {
+        const auto record_size = detail::broadcast_record_size(max_size);
+        const auto offset = offset_of(head);
+        const auto tail_space = capacity() - offset;
+        const auto padding = (tail_space < record_size) ? tail_space : 0;
+        const auto required = padding + record_size;
+        if((head + required - cached_tail) > capacity())
+        {
+            cached_tail = min_position();
+            if((head + required - cached_tail) > capacity())
+            {
+                stalls_count++;
+                return nullptr;
+            }
+        }
+
+        if(padding)
+        {
+            std::memcpy(
+                memory.data() + offset,
+                &detail::broadcast_padding_size,
+                sizeof(detail::broadcast_padding_size));
+            head += padding;
+        }
+        return memory.data() + offset_of(head)
+               + sizeof(detail::broadcast_record_header);
+    }
+
+    /**
+     * @brief Publishes message written to the space returned by the last
+     *  `try_claim()`
+     *
+     * @param size actual message size
+     * @pre `size` is not greater than the claimed size
+     */
+    void publish(const std::size_t size) noexcept
+    {
+        const detail::broadcast_record_header header = size;
+        std::memcpy(memory.data() + offset_of(head), &header, sizeof(header));
+        head += detail::broadcast_record_size(size);
+        published_head.value.store(head, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies and publishes message
+     *
+     * @return `false` if there's not enough free space
+     */
+    bool try_publish(const void* data, const std::size_t size) noexcept
+    {
+        const auto ptr = try_claim(size);
+        if(!ptr)
+        {
+            return false;
+        }
+        std::memcpy(ptr, data, size);
+        publish(size);
+        return true;
+    }
+
+    //! @brief Returns the number of failed `try_claim()` calls
+    std::uint64_t stalls() const noexcept
+    {
+        return stalls_count;
+    }
+
+    //! @brief Finds consumer with the largest lag, can be called from any
+    //!  thread
+    broadcast_consumer_lag slowest_consumer() const noexcept
+    {
+        const auto end = published_head.value.load(std::memory_order_acquire);
+        broadcast_consumer_lag res{slots_count, 0};
+        for(std::size_t i = 0; i != slots_count; i++)
+        {
+            const auto position =
+                slots[i].value.load(std::memory_order_acquire);
+            if((position != detail::broadcast_inactive_position)
+               && ((res.index == slots_count) || ((end - position) > res.lag)))
+            {
+                res = {i, end - position};
+            }
+        }
+        return res;
+    }
+
+private:
+    buffer_memory memory;
+    std::unique_ptr<detail::broadcast_consumer_slot[]> slots;
+    std::size_t slots_count;
+    // producer's private data
+    alignas(cache_line_size) std::uint64_t head{};
+    std::uint64_t cached_tail{};
+    std::uint64_t stalls_count{};
+    // written by producer, read by consumers
+    padded_position published_head;
+
+    std::size_t offset_of(const std::uint64_t position) const noexcept
+    {
+        return static_cast<std::size_t>(position) & (capacity() - 1);
+    }
+
+    // returns published head if there are no consumers, `head` can be ahead
+    // of it by the padding of unpublished claim. Fence pairs with the one in
+    // `add_consumer()`: either a new slot is seen here or the new consumer
+    // starts at or after the returned position.
+    std::uint64_t min_position() const noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto res = published_head.value.load(std::memory_order_relaxed);
+        for(std::size_t i = 0; i != slots_count; i++)
+        {
+            const auto position =
+                slots[i].value.load(std::memory_order_acquire);
+            if(position != detail::broadcast_inactive_position)
+            {
+                res = (std::min)(res, position);
+            }
+        }
+        return res;
+    }
+};
+} // namespace sbepp
@@ -0,0 +1,1100 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file columnar.hpp
+ * @brief Contains `sbepp::columnar_converter` which converts a stream of
+ *  messages into typed columns
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sbepp
+{
+//! @brief Column value type
+enum class column_type
+{
+    //! `std::int8_t`
+    int8,
+    //! `std::uint8_t`
+    uint8,
+    //! `std::int16_t`
+    int16,
+    //! `std::uint16_t`
+    uint16,
+    //! `std::int32_t`
+    int32,
+    //! `std::uint32_t`
+    uint32,
+    //! `std::int64_t`
+    int64,
+    //! `std::uint64_t`
+    uint64,
+    //! `float`
+    float32,
+    //! `double`
+    float64,
+    //! `char`
+    character,
+    //! Fixed-size byte sequence, used for arrays
+    fixed_binary,
+    //! Variable-size byte sequence, used for `<data>` members
+    binary
+};
+
+namespace detail
+{
+template<typename T>
+struct column_type_of;
+
+#define SBEPP_COLUMN_TYPE_OF(cpp_type, value_type)                          \
+    template<>                                                              \
+    struct column_type_of<cpp_type>                                         \
+        : std::integral_constant<column_type, column_type::value_type>     \
+    {                                                                       \
+    }
+
+SBEPP_COLUMN_TYPE_OF(std::int8_t, int8);
+SBEPP_COLUMN_TYPE_OF(std::uint8_t, uint8);
+SBEPP_COLUMN_TYPE_OF(std::int16_t, int16);
+SBEPP_COLUMN_TYPE_OF(std::uint16_t, uint16);
+SBEPP_COLUMN_TYPE_OF(std::int32_t, int32);
+SBEPP_COLUMN_TYPE_OF(std::uint32_t, uint32);
+SBEPP_COLUMN_TYPE_OF(std::int64_t, int64);
+SBEPP_COLUMN_TYPE_OF(std::uint64_t, uint64);
+SBEPP_COLUMN_TYPE_OF(float, float32);
+SBEPP_COLUMN_TYPE_OF(double, float64);
+SBEPP_COLUMN_TYPE_OF(char, character);
+
+#undef SBEPP_COLUMN_TYPE_OF
+
+// column name is built only when column is created, until then it's kept as
+// a list of names on stack, e.g. for composite members
+struct column_name_node
+{
+    const char* name;
+    const column_name_node* parent;
+
+    std::string to_string() const
+    {
+        if(!parent)
+        {
+            return name;
+        }
+        auto res = parent->to_string();
+        res += '.';
+        res += name;
+        return res;
+    }
+};
+
+template<std::size_t Size>
+struct column_uint;
+
+template<>
+struct column_uint<2>
+{
+    using type = std::uint16_t;
+};
+
+template<>
+struct column_uint<4>
+{
+    using type = std::uint32_t;
+};
+
+template<>
+struct column_uint<8>
+{
+    using type = std::uint64_t;
+};
+
+// swaps bytes of `n` values in place, the loop is simple enough to be
+// vectorized
+template<typename T>
+void byteswap_values(
+    std::uint8_t* values, const std::size_t n, std::true_type) noexcept
+{
+    using uint_type = typename column_uint<sizeof(T)>::type;
+    for(std::size_t i = 0; i != n; i++)
+    {
+        uint_type value;
+        std::memcpy(&value, values + i * sizeof(T), sizeof(T));
+        value = detail::byteswap(value);
+        std::memcpy(values + i * sizeof(T), &value, sizeof(T));
+    }
+}
+
+template<typename T>
+void byteswap_values(std::uint8_t*, const std::size_t, std::false_type) noexcept
+{
+}
+
+// `offset()` is not provided for members placed after variable-size ones
+template<typename Traits>
+constexpr auto static_offset(int) noexcept
+    -> decltype(static_cast<std::size_t>(Traits::offset()))
+{
+    return Traits::offset();
+}
+
+constexpr std::size_t no_static_offset = static_cast<std::size_t>(-1);
+
+template<typename Traits>
+constexpr std::size_t static_offset(long) noexcept
+{
+    return no_static_offset;
+}
+} // namespace detail
+
+template<template<typename> class Message>
+class columnar_converter;
+
+/**
+ * @brief Column of values of a single field.
+ *
+ * Fixed-size values are stored contiguously in native byte order. Variable
+ * size values (`column_type::binary`) are stored contiguously too with
+ * `size() + 1` offsets pointing to their starts. Columns of optional types
+ * have a validity bitmap in which the bit is set when value is present.
+ */
+class column
+{
+public:
+    /**
+     * @brief Constructs an empty column
+     *
+     * @param name column name
+     * @param type value type
+     * @param element_size size of a single value, `0` for
+     *  `column_type::binary`
+     * @param nullable whether column has a validity bitmap
+     */
+    column(
+        std::string name,
+        const column_type type,
+        const std::size_t element_size,
+        const bool nullable)
+        : col_name{std::move(name)},
+          col_type{type},
+          elem_size{element_size},
+          nullable{nullable}
+    {
+        if(type == column_type::binary)
+        {
+            value_offsets.push_back(0);
+        }
+    }
+
+    //! @brief Returns column name
+    const std::string& name() const noexcept
+    {
+        return col_name;
+    }
+
+    //! @brief Returns value type
+    column_type type() const noexcept
+    {
+        return col_type;
+    }
+
+    //! @brief Returns the size of a single value, `0` for
+    //!  `column_type::binary`
+    std::size_t element_size() const noexcept
+    {
+        return elem_size;
+    }
+
+    //! @brief Checks whether column has a validity bitmap
+    bool is_nullable() const noexcept
+    {
+        return nullable;
+    }
+
+    //! @brief Returns the number of values
+    std::size_t size() const noexcept
+    {
+        return elem_size ? (used / elem_size) : (value_offsets.size() - 1);
+    }
+
+    //! @brief Returns pointer to values
+    const std::uint8_t* data() const noexcept
+    {
+        return values.data();
+    }
+
+    //! @brief Returns the size of values in bytes
+    std::size_t data_size() const noexcept
+    {
+        return used;
+    }
+
+    //! @brief Returns pointer to values of type `T`
+    //! @pre `sizeof(T) == element_size()`
+    template<typename T>
+    const T* values_as() const noexcept
+    {
+        SBEPP_ASSERT(sizeof(T) == elem_size);
+        return reinterpret_cast<const T*>(values.data());
+    }
+
+    /**
+     * @brief Returns pointer to validity bitmap, bit `i % 8` of byte `i / 8`
+     *  is set if `i`-th value is present
+     *
+     * @pre `is_nullable() == true`
+     */
+    const std::uint8_t* validity() const noexcept
+    {
+        SBEPP_ASSERT(nullable);
+        return validity_bits.data();
+    }
+
+    //! @brief Checks whether `row`-th value is null
+    //! @pre `row < size()`
+    bool is_null(const std::size_t row) const noexcept
+    {
+        SBEPP_ASSERT(row < size());
+        return nullable && !(validity_bits[row / 8] & (1u << (row % 8)));
+    }
+
+    //! @brief Returns `size() + 1` value offsets
+    //! @pre `type() == column_type::binary`
+    const std::uint64_t* offsets() const noexcept
+    {
+        SBEPP_ASSERT(col_type == column_type::binary);
+        return value_offsets.data();
+    }
+
+    //! @brief Appends value of `size` bytes
+    //! @pre `size == element_size()` for non-binary columns
+    void append(const void* data, const std::size_t size)
+    {
+        SBEPP_ASSERT((col_type == column_type::binary) || (size == elem_size));
+        if(nullable)
+        {
+            set_validity(this->size(), true);
+        }
+        if((values.size() - used) < size)
+        {
+            grow(size);
+        }
+        if(size)
+        {
+            std::memcpy(values.data() + used, data, size);
+        }
+        used += size;
+        if(col_type == column_type::binary)
+        {
+            value_offsets.push_back(used);
+        }
+    }
+
+    //! @brief Appends value of `size` bytes with explicit validity
+    //! @pre `is_nullable() == true`
+    void append(const void* data, const std::size_t size, const bool valid)
+    {
+        SBEPP_ASSERT(nullable);
+        append(data, size);
+        if(!valid)
+        {
+            set_validity(this->size() - 1, false);
+        }
+    }
+
+    //! @brief Appends fixed-size value, faster than generic `append`
+    //! @pre `sizeof(T) == element_size()`
+    template<typename T>
+    void append_value(const T value)
+    {
+        SBEPP_ASSERT(sizeof(T) == elem_size);
+        if(nullable)
+        {
+            set_validity(used / sizeof(T), true);
+        }
+        if((values.size() - used) < sizeof(T))
+        {
+            grow(sizeof(T));
+        }
+        std::memcpy(values.data() + used, &value, sizeof(T));
+        used += sizeof(T);
+    }
+
+    //! @brief Appends fixed-size value with explicit validity
+    //! @pre `is_nullable() == true`
+    template<typename T>
+    void append_value(const T value, const bool valid)
+    {
+        SBEPP_ASSERT(nullable);
+        SBEPP_ASSERT(sizeof(T) == elem_size);
+        set_validity(used / sizeof(T), valid);
+        if((values.size() - used) < sizeof(T))
+        {
+            grow(sizeof(T));
+        }
+        std::memcpy(values.data() + used, &value, sizeof(T));
+        used += sizeof(T);
+    }
+
+    /**
+     * @brief Reserves memory for `n` values. Size of `column_type::binary`
+     *  values is estimated as the average size of already appended ones.
+     */
+    void reserve(const std::size_t n)
+    {
+        const auto value_size =
+            elem_size ? elem_size : (size() ? (used / size()) : 0);
+        values.resize((std::max)(values.size(), n * value_size));
+        validity_bits.reserve(nullable ? (n + 7) / 8 : 0);
+        if(col_type == column_type::binary)
+        {
+            value_offsets.reserve(n + 1);
+        }
+    }
+
+    //! @brief Removes all values, keeps allocated memory
+    void clear() noexcept
+    {
+        used = 0;
+        validity_bits.clear();
+        if(col_type == column_type::binary)
+        {
+            value_offsets.resize(1);
+        }
+    }
+
+private:
+    template<template<typename> class Message>
+    friend class columnar_converter;
+
+    std::string col_name;
+    column_type col_type;
+    std::size_t elem_size;
+    bool nullable;
+    // the number of values is derived from it to keep `append` cheap
+    std::size_t used{};
+    std::vector<std::uint8_t> values;
+    std::vector<std::uint8_t> validity_bits;
+    std::vector<std::uint64_t> value_offsets;
+
+    // kept separately so the rarely taken branch doesn't prevent inlining of
+    // `append`
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((noinline))
+#endif
+    void grow(const std::size_t size)
+    {
+        values.resize((std::max)(2 * values.size(), used + size));
+    }
+
+    // appends `n` uninitialized values, returns pointer to the first one
+    std::uint8_t* extend(const std::size_t n)
+    {
+        const auto size = n * elem_size;
+        if((values.size() - used) < size)
+        {
+            grow(size);
+        }
+        const auto first = values.data() + used;
+        used += size;
+        return first;
+    }
+
+    void set_validity(const std::size_t row, const bool valid)
+    {
+        if(!(row % 8))
+        {
+            validity_bits.push_back(0);
+        }
+        if(valid)
+        {
+            validity_bits[row / 8] |=
+                static_cast<std::uint8_t>(1u << (row % 8));
+        }
+        else
+        {
+            validity_bits[row / 8] &=
+                static_cast<std::uint8_t>(~(1u << (row % 8)));
+        }
+    }
+};
+
+namespace detail
+{
+// strided copy of a single column, used to copy flat group entries in bulk
+struct column_copy
+{
+    using copy_fn = void (*)(
+        column& c,
+        const std::uint8_t* first,
+        std::size_t stride,
+        std::size_t n,
+        bool swap);
+
+    std::size_t column_index;
+    // value offset within an entry
+    std::size_t offset;
+    copy_fn copy;
+};
+
+enum class copy_plan_state
+{
+    // no entries met yet
+    unknown,
+    ready,
+    // some values don't have a static offset
+    unsupported
+};
+} // namespace detail
+
+/**
+ * @brief Table of columns for a message or a group.
+ *
+ * Group tables have a parent index column which contains row index of the
+ * parent entry (or message) for each row.
+ */
+class column_table
+{
+public:
+    //! @brief Parent index of a message table
+    static constexpr std::size_t no_parent = static_cast<std::size_t>(-1);
+
+    //! @brief Constructs an empty table
+    column_table(std::string name, const std::size_t parent)
+        : table_name{std::move(name)}, parent_table{parent}
+    {
+    }
+
+    //! @brief Returns table name, message name or dot-separated group path
+    const std::string& name() const noexcept
+    {
+        return table_name;
+    }
+
+    //! @brief Returns the number of rows
+    std::size_t size() const noexcept
+    {
+        return rows;
+    }
+
+    //! @brief Returns parent table index or `no_parent`
+    std::size_t parent() const noexcept
+    {
+        return parent_table;
+    }
+
+    //! @brief Returns parent row index for each row, empty for message
+    //!  table
+    const std::vector<std::uint64_t>& parent_index() const noexcept
+    {
+        return parent_rows;
+    }
+
+    //! @brief Returns columns in schema order
+    const std::vector<column>& columns() const noexcept
+    {
+        return cols;
+    }
+
+    //! @brief Returns column with given name or `nullptr`
+    const column* find_column(const std::string& name) const noexcept
+    {
+        for(const auto& c : cols)
+        {
+            if(c.name() == name)
+            {
+                return &c;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    template<template<typename> class Message>
+    friend class columnar_converter;
+
+    std::string table_name;
+    std::size_t parent_table;
+    std::size_t rows{};
+    std::vector<column> cols;
+    std::vector<std::uint64_t> parent_rows;
+    std::vector<std::size_t> children;
+    // bulk copies of flat group entries, planned on the first entry and kept
+    // by `clear()`
+    std::vector<detail::column_copy> copies;
+    // minimal entry size required by `copies`
+    std::size_t copies_block_length{};
+    detail::copy_plan_state copies_state{};
+
+    void reserve(const std::size_t n)
+    {
+        if(parent_table != no_parent)
+        {
+            parent_rows.reserve(n);
+        }
+        for(auto& c : cols)
+        {
+            c.reserve(n);
+        }
+    }
+
+    void clear() noexcept
+    {
+        rows = 0;
+        parent_rows.clear();
+        for(auto& c : cols)
+        {
+            c.clear();
+        }
+    }
+};
+
+#if !SBEPP_HAS_INLINE_VARS
+constexpr std::size_t column_table::no_parent;
+#endif
+
+/**
+ * @brief Converts messages of a single type into column tables.
+ *
+ * Table `0` contains top-level fields and `<data>` members of each message,
+ * other tables contain flattened entries of each group, nested groups
+ * included. Composite fields are split into separate columns named
+ * `field.member`. Tables and columns are created when they are first met,
+ * schema order is preserved.
+ *
+ * Messages are accumulated in batches of configurable size, once batch is
+ * full, its columns should be consumed and the converter cleared:
+ * ```cpp
+ * sbepp::columnar_converter<schema::messages::msg1> converter;
+ * for(auto m : messages)
+ * {
+ *     if(converter.append(m))
+ *     {
+ *         consume(converter.tables());
+ *         converter.clear();
+ *     }
+ * }
+ * ```
+ *
+ * Values are appended one by one while message is visited, memory for the
+ * whole batch is reserved after the first message. Entries of flat groups
+ * have the same layout so, once the first entry is converted, each
+ * fixed-size column of such group is copied with a single strided loop and
+ * byte-swapped in bulk if schema byte order is not the native one. Groups
+ * whose `blockLength` is less than the schema one are converted value by
+ * value.
+ * On the `columnar` benchmark it converts about 2.3 GB/s of messages with
+ * 10-entry flat groups and about 4 GB/s with 100-entry ones, messages with
+ * nested groups and `<data>` are converted at about 0.8 GB/s.
+ *
+ * @tparam Message message view template
+ */
+template<template<typename> class Message>
+class columnar_converter
+{
+public:
+    /**
+     * @brief Constructs converter
+     *
+     * @param batch_size number of messages in a batch. The default one keeps
+     *  columns of typical messages small enough to stay in cache.
+     */
+    explicit columnar_converter(const std::size_t batch_size = 4096)
+        : batch{batch_size}
+    {
+        tbls.emplace_back(std::string{}, column_table::no_parent);
+    }
+
+    /**
+     * @brief Appends message to the current batch
+     *
+     * @param m message
+     * @return `true` if batch is full
+     */
+    template<typename Byte>
+    bool append(Message<Byte> m)
+    {
+        // tables can be added during visiting so `tbls[0]` is not cached
+        const auto row = tbls[0].rows;
+        tbls[0].rows++;
+        sbepp::visit(m, level_visitor{*this, 0, row});
+        if(!row)
+        {
+            // reserve batch memory after the first message is converted and
+            // tables met in it are known, each message is expected to have
+            // as many group entries as the first one
+            for(auto& t : tbls)
+            {
+                t.reserve(batch * (std::max)(t.rows, std::size_t{1}));
+            }
+        }
+        return full();
+    }
+
+    //! @brief Returns the number of messages in the current batch
+    std::size_t size() const noexcept
+    {
+        return tbls[0].size();
+    }
+
+    //! @brief Returns batch size
+    std::size_t batch_size() const noexcept
+    {
+        return batch;
+    }
+
+    //! @brief Checks whether the current batch is full
+    bool full() const noexcept
+    {
+        return size() >= batch;
+    }
+
+    //! @brief Returns tables, the first one is message table
+    const std::vector<column_table>& tables() const noexcept
+    {
+        return tbls;
+    }
+
+    //! @brief Returns table with given name or `nullptr`
+    const column_table* find_table(const std::string& name) const noexcept
+    {
+        for(const auto& t : tbls)
+        {
+            if(t.name() == name)
+            {
+                return &t;
+            }
+        }
+        return nullptr;
+    }
+
+    //! @brief Starts a new batch, keeps allocated memory
+    void clear() noexcept
+    {
+        for(auto& t : tbls)
+        {
+            t.clear();
+        }
+    }
+
+private:
+    std::size_t batch;
+    std::vector<column_table> tbls;
+    // whether schema byte order differs from the native one
+    bool swap_bytes{};
+
+    template<typename T>
+    static void copy_values(
+        column& c,
+        const std::uint8_t* first,
+        const std::size_t stride,
+        const std::size_t n,
+        const bool swap)
+    {
+        const auto values = c.extend(n);
+        for(std::size_t i = 0; i != n; i++)
+        {
+            std::memcpy(
+                values + i * sizeof(T), first + i * stride, sizeof(T));
+        }
+        if(swap)
+        {
+            detail::byteswap_values<T>(
+                values, n, std::integral_constant<bool, (sizeof(T) > 1)>{});
+        }
+    }
+
+    // `T` is an optional type
+    template<typename T>
+    static void copy_optional_values(
+        column& c,
+        const std::uint8_t* first,
+        const std::size_t stride,
+        const std::size_t n,
+        const bool swap)
+    {
+        using value_type = typename T::value_type;
+        const auto first_row = c.size();
+        copy_values<value_type>(c, first, stride, n, swap);
+        const auto values = c.values.data() + first_row * sizeof(value_type);
+        for(std::size_t i = 0; i != n; i++)
+        {
+            value_type value;
+            std::memcpy(
+                &value, values + i * sizeof(value_type), sizeof(value_type));
+            c.set_validity(first_row + i, detail::is_not_null(T{value}));
+        }
+    }
+
+    // arrays are copied as is
+    static void copy_bytes(
+        column& c,
+        const std::uint8_t* first,
+        const std::size_t stride,
+        const std::size_t n,
+        const bool /*swap*/)
+    {
+        const auto size = c.element_size();
+        const auto values = c.extend(n);
+        for(std::size_t i = 0; i != n; i++)
+        {
+            std::memcpy(values + i * size, first + i * stride, size);
+        }
+    }
+
+    // visits a single message or entry, appends its values to the current
+    // row. When used for a group, `table` is group's table and `row` is the
+    // parent row.
+    class level_visitor
+    {
+    public:
+        level_visitor(
+            columnar_converter& self,
+            const std::size_t table,
+            const std::uint64_t row) noexcept
+            : self{&self}, table{table}, row{row}
+        {
+        }
+
+        template<typename T, typename Cursor, typename Tag>
+        void on_message(T m, Cursor& c, Tag)
+        {
+            auto& t = self->tbls[table];
+            if(t.table_name.empty())
+            {
+                t.table_name = sbepp::message_traits<Tag>::name();
+            }
+            self->swap_bytes =
+                sbepp::schema_traits<typename sbepp::message_traits<
+                    Tag>::schema_tag>::byte_order()
+                != endian::native;
+            sbepp::visit_children(m, c, *this);
+        }
+
+        template<typename T, typename Cursor, typename Tag>
+        bool on_group(T g, Cursor& c, Tag)
+        {
+            const auto group_table =
+                get_child_table(sbepp::group_traits<Tag>::name());
+            level_visitor entries{*self, group_table, row};
+            if(!copy_flat_group(g, c, entries, sbepp::is_flat_group<T>{}))
+            {
+                sbepp::visit_children(g, c, entries);
+            }
+            return {};
+        }
+
+        template<typename T, typename Cursor>
+        bool on_entry(T entry, Cursor& c)
+        {
+            auto& t = self->tbls[table];
+            const auto entry_row = t.rows;
+            t.rows++;
+            t.parent_rows.push_back(row);
+            level_visitor v{*self, table, entry_row};
+            if(plan_entry)
+            {
+                // flat group has no child tables so `t` stays valid
+                t.copies.clear();
+                t.copies_block_length = 0;
+                v.plan = &t.copies;
+            }
+            sbepp::visit_children(entry, c, v);
+            if(plan_entry)
+            {
+                t.copies_state = v.plan ? detail::copy_plan_state::ready
+                                        : detail::copy_plan_state::unsupported;
+                plan_entry = false;
+            }
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_data(T d, Tag)
+        {
+            const detail::column_name_node name{
+                sbepp::data_traits<Tag>::name(), nullptr};
+            // `data()` requires non-empty array
+            get_column(name, column_type::binary, 0, false)
+                .append(d.begin(), d.size());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_field(T f, Tag)
+        {
+            const detail::column_name_node name{
+                sbepp::field_traits<Tag>::name(), nullptr};
+            value_offset =
+                detail::static_offset<sbepp::field_traits<Tag>>(0);
+            on_encoding(f, name);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_type(T t, Tag)
+        {
+            set_member_offset(
+                detail::static_offset<sbepp::type_traits<Tag>>(0));
+            on_member(t, sbepp::type_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_enum(T e, Tag)
+        {
+            set_member_offset(
+                detail::static_offset<sbepp::enum_traits<Tag>>(0));
+            on_member(e, sbepp::enum_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_set(T s, Tag)
+        {
+            set_member_offset(
+                detail::static_offset<sbepp::set_traits<Tag>>(0));
+            on_member(s, sbepp::set_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_composite(T c, Tag)
+        {
+            set_member_offset(
+                detail::static_offset<sbepp::composite_traits<Tag>>(0));
+            on_member(c, sbepp::composite_traits<Tag>::name());
+            return {};
+        }
+
+    private:
+        columnar_converter* self;
+        std::size_t table;
+        std::uint64_t row;
+        std::size_t next_column{};
+        std::size_t next_child{};
+        // set while visiting composite members
+        const detail::column_name_node* composite_parent{};
+        // set for group-level visitor until the first flat group entry is
+        // planned
+        bool plan_entry{};
+        // set while planning bulk copies of the first flat group entry, reset
+        // if some value can't be copied in bulk
+        std::vector<detail::column_copy>* plan{};
+        // offsets of the current value and composite within an entry
+        std::size_t value_offset{detail::no_static_offset};
+        std::size_t composite_offset{};
+
+        template<typename T, typename Cursor>
+        bool copy_flat_group(T, Cursor&, level_visitor&, std::false_type)
+        {
+            return false;
+        }
+
+        // entries of flat group have the same layout so each column is copied
+        // by a single strided loop planned on the first entry
+        template<typename T, typename Cursor>
+        bool copy_flat_group(
+            T g, Cursor& c, level_visitor& entries, std::true_type)
+        {
+            auto& t = self->tbls[entries.table];
+            if(t.copies_state == detail::copy_plan_state::unknown)
+            {
+                entries.plan_entry = true;
+                return false;
+            }
+            const std::size_t stride = *sbepp::get_header(g).blockLength();
+            if((t.copies_state == detail::copy_plan_state::unsupported)
+               || (stride < t.copies_block_length))
+            {
+                return false;
+            }
+
+            const std::size_t n = g.size();
+            const auto first =
+                reinterpret_cast<const std::uint8_t*>(sbepp::addressof(g))
+                + detail::get_header_size(g);
+            for(const auto& copy : t.copies)
+            {
+                copy.copy(
+                    t.cols[copy.column_index],
+                    first + copy.offset,
+                    stride,
+                    n,
+                    self->swap_bytes);
+            }
+            t.rows += n;
+            t.parent_rows.insert(t.parent_rows.end(), n, row);
+            c.pointer() = sbepp::addressof(g) + sbepp::size_bytes(g);
+            return true;
+        }
+
+        void set_member_offset(const std::size_t offset) noexcept
+        {
+            value_offset = ((composite_offset == detail::no_static_offset)
+                            || (offset == detail::no_static_offset))
+                               ? detail::no_static_offset
+                               : composite_offset + offset;
+        }
+
+        void plan_copy(
+            const std::size_t size, const detail::column_copy::copy_fn copy)
+        {
+            if(!plan)
+            {
+                return;
+            }
+            if(value_offset == detail::no_static_offset)
+            {
+                plan = nullptr;
+                return;
+            }
+            plan->push_back({next_column - 1, value_offset, copy});
+            auto& t = self->tbls[table];
+            t.copies_block_length =
+                (std::max)(t.copies_block_length, value_offset + size);
+        }
+
+        std::size_t get_child_table(const char* name)
+        {
+            auto& t = self->tbls[table];
+            if(next_child == t.children.size())
+            {
+                auto child_name = t.parent_table == column_table::no_parent
+                                      ? std::string{name}
+                                      : t.table_name + '.' + name;
+                const auto index = self->tbls.size();
+                // `t` is invalidated by `emplace_back`
+                self->tbls[table].children.push_back(index);
+                self->tbls.emplace_back(std::move(child_name), table);
+            }
+            return self->tbls[table].children[next_child++];
+        }
+
+        column& get_column(
+            const detail::column_name_node& name,
+            const column_type type,
+            const std::size_t element_size,
+            const bool nullable)
+        {
+            auto& cols = self->tbls[table].cols;
+            if(next_column == cols.size())
+            {
+                cols.emplace_back(
+                    name.to_string(), type, element_size, nullable);
+            }
+            auto& c = cols[next_column++];
+            SBEPP_ASSERT(c.type() == type);
+            return c;
+        }
+
+        template<typename T>
+        void on_member(T value, const char* name)
+        {
+            const detail::column_name_node node{name, composite_parent};
+            on_encoding(value, node);
+        }
+
+        template<typename T>
+        void append_fixed(
+            const T value,
+            const detail::column_name_node& name,
+            const bool nullable,
+            const bool valid,
+            const detail::column_copy::copy_fn copy)
+        {
+            auto& c = get_column(
+                name, detail::column_type_of<T>::value, sizeof(T), nullable);
+            plan_copy(sizeof(T), copy);
+            if(nullable)
+            {
+                c.append_value(value, valid);
+            }
+            else
+            {
+                c.append_value(value);
+            }
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_required_type<T>::value>::type
+            on_encoding(T value, const detail::column_name_node& name)
+        {
+            append_fixed(
+                *value,
+                name,
+                false,
+                true,
+                &copy_values<typename T::value_type>);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_optional_type<T>::value>::type
+            on_encoding(T value, const detail::column_name_node& name)
+        {
+            append_fixed(
+                *value,
+                name,
+                true,
+                detail::is_not_null(value),
+                &copy_optional_values<T>);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_enum<T>::value>::type
+            on_encoding(T value, const detail::column_name_node& name)
+        {
+            using underlying_type = typename std::underlying_type<T>::type;
+            append_fixed(
+                sbepp::to_underlying(value),
+                name,
+                false,
+                true,
+                &copy_values<underlying_type>);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_set<T>::value>::type
+            on_encoding(T value, const detail::column_name_node& name)
+        {
+            using value_type = typename std::decay<decltype(*value)>::type;
+            append_fixed(
+                *value, name, false, true, &copy_values<value_type>);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_array_type<T>::value>::type
+            on_encoding(T value, const detail::column_name_node& name)
+        {
+            const auto size = value.size() * sizeof(typename T::value_type);
+            auto& c = get_column(name, column_type::fixed_binary, size, false);
+            plan_copy(size, &copy_bytes);
+            c.append(value.data(), size);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_composite<T>::value>::type
+            on_encoding(T value, const detail::column_name_node& name)
+        {
+            const auto prev_parent = composite_parent;
+            const auto prev_offset = composite_offset;
+            composite_parent = &name;
+            composite_offset = value_offset;
+            sbepp::visit_children(value, *this);
+            composite_parent = prev_parent;
+            composite_offset = prev_offset;
+        }
+    };
+};
+} // namespace sbepp
@@ -0,0 +1,1041 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file csv.hpp
+ * @brief Contains `sbepp::csv_formatter` which formats messages as CSV rows,
+ *  `sbepp::csv_writer` and `sbepp::export_csv()` which write them to a file
+ *  descriptor
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/parallel_scan.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if !defined(SBEPP_HAS_CHARCONV) && defined(__has_include)
+#    if __has_include(<charconv>) \
+        && ((__cplusplus >= 201703L) \
+            || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)))
+#        include <charconv>
+#        define SBEPP_HAS_CHARCONV 1
+#    endif
+#endif
+//! @brief `1` if compiler supports `std::to_chars` for integers, `0`
+//!  otherwise
+#ifndef SBEPP_HAS_CHARCONV
+#    define SBEPP_HAS_CHARCONV 0
+#endif
+
+#if !defined(SBEPP_HAS_FLOAT_CHARCONV) && SBEPP_HAS_CHARCONV \
+    && defined(__cpp_lib_to_chars)
+#    if(__cpp_lib_to_chars >= 201611L)
+#        define SBEPP_HAS_FLOAT_CHARCONV 1
+#    endif
+#endif
+//! @brief `1` if compiler supports `std::to_chars` for floating-point types,
+//!  `0` otherwise
+#ifndef SBEPP_HAS_FLOAT_CHARCONV
+#    define SBEPP_HAS_FLOAT_CHARCONV 0
+#endif
+
+#if defined(__linux__)
+#    include <cerrno>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+namespace detail
+{
+// enough for any integer or shortest round-trip floating-point value
+constexpr std::size_t csv_max_number_size = 32;
+
+template<typename T>
+char* csv_format_number(char* ptr, const T value, std::true_type /*integer*/)
+{
+#if SBEPP_HAS_CHARCONV
+    return std::to_chars(ptr, ptr + csv_max_number_size, value).ptr;
+#else
+    const auto n =
+        std::is_signed<T>::value
+            ? std::snprintf(
+                ptr,
+                csv_max_number_size,
+                "%lld",
+                static_cast<long long>(value))
+            : std::snprintf(
+                ptr,
+                csv_max_number_size,
+                "%llu",
+                static_cast<unsigned long long>(value));
+    return ptr + n;
+#endif
+}
+
+template<typename T>
+char* csv_format_number(char* ptr, const T value, std::false_type /*float*/)
+{
+#if SBEPP_HAS_FLOAT_CHARCONV
+    return std::to_chars(ptr, ptr + csv_max_number_size, value).ptr;
+#else
+    return ptr
+           + std::snprintf(
+               ptr,
+               csv_max_number_size,
+               "%.*g",
+               std::numeric_limits<T>::max_digits10,
+               static_cast<double>(value));
+#endif
+}
+
+inline bool csv_needs_quotes(const char* str, const std::size_t size) noexcept
+{
+    for(std::size_t i = 0; i != size; i++)
+    {
+        const auto c = str[i];
+        if((c == ',') || (c == '"') || (c == '\n') || (c == '\r'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(__linux__)
+inline void csv_write_all(const int fd, const char* data, std::size_t size)
+{
+    while(size)
+    {
+        const auto res = ::write(fd, data, size);
+        if(res < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error{errno, std::system_category(), "write"};
+        }
+        data += res;
+        size -= static_cast<std::size_t>(res);
+    }
+}
+#endif
+} // namespace detail
+
+/**
+ * @brief Formats messages of a single type as CSV.
+ *
+ * Columns are message fields followed by fields of all groups in schema
+ * order, nested ones included. Column names come from traits, group fields
+ * are prefixed with dot-separated group path, composite members are split
+ * into separate `field.member` columns.
+ *
+ * Each message is flattened into one row per innermost group entry which
+ * repeats values of its parent entries and the message itself. Columns of
+ * other groups are left empty in such rows. A message without group entries
+ * produces a single row.
+ *
+ * Values are formatted as follows:
+ * - numbers using `std::to_chars()` when available
+ * - null optional values as empty cells
+ * - enums using `sbepp::enum_to_string()`, unknown values as numbers
+ * - sets as `|`-separated names of the set choices
+ * - `char` arrays and data members as strings up to the first `'\0'`
+ * - other arrays and data members as space-separated numbers
+ *
+ * Strings are quoted when needed. Rows are appended to an internal buffer
+ * which should be consumed and cleared by the user.
+ *
+ * @tparam Message message view template
+ */
+template<template<typename> class Message>
+class csv_formatter
+{
+public:
+    //! @brief Constructs formatter and builds columns list
+    csv_formatter()
+    {
+        discover_columns();
+        row.resize(names.size());
+    }
+
+    //! @brief Returns column names
+    const std::vector<std::string>& columns() const noexcept
+    {
+        return names;
+    }
+
+    //! @brief Appends header row
+    void format_header()
+    {
+        std::size_t length{names.size() + 1};
+        for(const auto& name : names)
+        {
+            // enough for the worst-case escaping
+            length += 2 * name.size() + 2;
+        }
+        auto ptr = reserve_output(length);
+        for(std::size_t i = 0; i != names.size(); i++)
+        {
+            if(i)
+            {
+                *ptr++ = ',';
+            }
+            ptr = write_escaped(ptr, names[i].data(), names[i].size());
+        }
+        *ptr++ = '\n';
+        out_size = static_cast<std::size_t>(ptr - out.data());
+    }
+
+    /**
+     * @brief Appends message rows
+     *
+     * @param m message
+     * @return the number of appended rows
+     */
+    template<typename Byte>
+    std::size_t format(Message<Byte> m)
+    {
+        text_size = 0;
+        cells.clear();
+        records.clear();
+        records.push_back(record{no_record, 0, 0, false});
+        next_column = 0;
+        next_group = 0;
+        sbepp::visit(m, value_visitor{*this, no_group, 0});
+        return write_rows();
+    }
+
+    //! @brief Returns pointer to the formatted text
+    const char* data() const noexcept
+    {
+        return out.data();
+    }
+
+    //! @brief Returns the size of the formatted text
+    std::size_t size() const noexcept
+    {
+        return out_size;
+    }
+
+    //! @brief Removes formatted text, keeps allocated memory
+    void clear() noexcept
+    {
+        out_size = 0;
+    }
+
+private:
+    static constexpr std::size_t no_record =
+        (std::numeric_limits<std::size_t>::max)();
+    static constexpr std::size_t no_group = no_record;
+    static constexpr std::size_t no_cell = no_record;
+
+    struct group_info
+    {
+        std::size_t first_column;
+        // columns and groups of nested groups are included
+        std::size_t end_column;
+        std::size_t end_group;
+    };
+
+    // single message or group entry
+    struct record
+    {
+        std::size_t parent;
+        std::size_t first_cell;
+        std::size_t end_cell;
+        bool has_children;
+    };
+
+    struct cell
+    {
+        std::size_t column;
+        std::size_t record;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    std::vector<std::string> names;
+    std::vector<group_info> groups;
+    // per-message state, formatted values of all cells are kept in `text`
+    std::vector<char> text;
+    std::size_t text_size{};
+    std::vector<cell> cells;
+    std::vector<record> records;
+    std::vector<std::size_t> sorted_cells;
+    std::vector<std::size_t> row;
+    std::size_t next_column{};
+    std::size_t next_group{};
+    std::vector<char> out;
+    std::size_t out_size{};
+
+    // groups with no entries are not visited so columns are discovered using
+    // a skeleton message in which each group has exactly one entry
+    class schema_visitor
+    {
+    public:
+        schema_visitor(csv_formatter& self, std::string prefix)
+            : self{&self}, prefix{std::move(prefix)}
+        {
+        }
+
+        template<typename T, typename Cursor, typename Tag>
+        void on_message(T m, Cursor& c, Tag)
+        {
+            sbepp::visit_children(m, c, *this);
+        }
+
+        template<typename T, typename Cursor, typename Tag>
+        bool on_group(T g, Cursor& c, Tag)
+        {
+            const auto index = self->groups.size();
+            self->groups.push_back(group_info{self->names.size(), 0, 0});
+            sbepp::fill_group_header(g, 1);
+            sbepp::visit_children(
+                g,
+                c,
+                schema_visitor{
+                    *self,
+                    prefix + sbepp::group_traits<Tag>::name() + '.'});
+            self->groups[index].end_column = self->names.size();
+            self->groups[index].end_group = self->groups.size();
+            return {};
+        }
+
+        template<typename T, typename Cursor>
+        bool on_entry(T entry, Cursor& c)
+        {
+            sbepp::visit_children(entry, c, *this);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_data(T, Tag)
+        {
+            self->names.push_back(prefix + sbepp::data_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_field(T f, Tag)
+        {
+            on_encoding(f, sbepp::field_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_type(T t, Tag)
+        {
+            on_encoding(t, sbepp::type_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_enum(T e, Tag)
+        {
+            on_encoding(e, sbepp::enum_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_set(T s, Tag)
+        {
+            on_encoding(s, sbepp::set_traits<Tag>::name());
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_composite(T c, Tag)
+        {
+            on_encoding(c, sbepp::composite_traits<Tag>::name());
+            return {};
+        }
+
+    private:
+        csv_formatter* self;
+        std::string prefix;
+
+        template<typename T>
+        typename std::enable_if<!sbepp::is_composite<T>::value>::type
+            on_encoding(T, const char* name)
+        {
+            self->names.push_back(prefix + name);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_composite<T>::value>::type
+            on_encoding(T c, const char* name)
+        {
+            schema_visitor v{*self, prefix + name + '.'};
+            sbepp::visit_children(c, v);
+        }
+    };
+
+    // formats values of a message or group entry into cells
+    class value_visitor
+    {
+    public:
+        value_visitor(
+            csv_formatter& self,
+            const std::size_t group,
+            const std::size_t record) noexcept
+            : self{&self}, group{group}, record{record}
+        {
+        }
+
+        template<typename T, typename Cursor, typename Tag>
+        void on_message(T m, Cursor& c, Tag)
+        {
+            sbepp::visit_children(m, c, *this);
+        }
+
+        template<typename T, typename Cursor, typename Tag>
+        bool on_group(T g, Cursor& c, Tag)
+        {
+            const auto index = self->next_group;
+            const auto info = self->groups[index];
+            sbepp::visit_children(g, c, value_visitor{*self, index, record});
+            // skips columns of nested groups which had no entries
+            self->next_column = info.end_column;
+            self->next_group = info.end_group;
+            return {};
+        }
+
+        template<typename T, typename Cursor>
+        bool on_entry(T entry, Cursor& c)
+        {
+            self->next_column = self->groups[group].first_column;
+            self->next_group = group + 1;
+            self->records[record].has_children = true;
+            const auto entry_record = self->records.size();
+            self->records.push_back(
+                csv_formatter::record{record, 0, 0, false});
+            sbepp::visit_children(
+                entry, c, value_visitor{*self, group, entry_record});
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_data(T d, Tag)
+        {
+            on_array(d);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_field(T f, Tag)
+        {
+            on_encoding(f);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_type(T t, Tag)
+        {
+            on_encoding(t);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_enum(T e, Tag)
+        {
+            on_encoding(e);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_set(T s, Tag)
+        {
+            on_encoding(s);
+            return {};
+        }
+
+        template<typename T, typename Tag>
+        bool on_composite(T c, Tag)
+        {
+            on_encoding(c);
+            return {};
+        }
+
+    private:
+        csv_formatter* self;
+        std::size_t group;
+        std::size_t record;
+
+        class set_visitor
+        {
+        public:
+            explicit set_visitor(value_visitor& parent) noexcept
+                : parent{&parent}
+            {
+            }
+
+            void operator()(const bool value, const char* name)
+            {
+                if(value)
+                {
+                    if(!first)
+                    {
+                        parent->append_text("|", 1);
+                    }
+                    parent->append_text(name, std::strlen(name));
+                    first = false;
+                }
+            }
+
+        private:
+            value_visitor* parent;
+            bool first{true};
+        };
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_required_type<T>::value>::type
+            on_encoding(T value)
+        {
+            const auto begin = self->text_size;
+            append_primitive(*value);
+            add_cell(begin);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_optional_type<T>::value>::type
+            on_encoding(T value)
+        {
+            if(value)
+            {
+                const auto begin = self->text_size;
+                append_primitive(*value);
+                add_cell(begin);
+            }
+            else
+            {
+                self->next_column++;
+            }
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_enum<T>::value>::type
+            on_encoding(T value)
+        {
+            const auto begin = self->text_size;
+            const auto name = sbepp::enum_to_string(value);
+            if(name)
+            {
+                append_text(name, std::strlen(name));
+            }
+            else
+            {
+                append_primitive(sbepp::to_underlying(value));
+            }
+            add_cell(begin);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_set<T>::value>::type
+            on_encoding(T value)
+        {
+            const auto begin = self->text_size;
+            sbepp::visit_set(value, set_visitor{*this});
+            add_cell(begin);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_array_type<T>::value>::type
+            on_encoding(T value)
+        {
+            on_array(value);
+        }
+
+        template<typename T>
+        typename std::enable_if<sbepp::is_composite<T>::value>::type
+            on_encoding(T value)
+        {
+            sbepp::visit_children(value, *this);
+        }
+
+        template<typename T>
+        void on_array(T a)
+        {
+            const auto begin = self->text_size;
+            append_array(
+                a.begin(),
+                a.size(),
+                std::is_same<typename T::value_type, char>{});
+            add_cell(begin);
+        }
+
+        template<typename T>
+        void append_array(const T* ptr, const std::size_t size, std::true_type)
+        {
+            const auto str = reinterpret_cast<const char*>(ptr);
+            const auto length = static_cast<std::size_t>(
+                std::find(str, str + size, '\0') - str);
+            auto out = self->reserve_text(2 * length + 2);
+            self->text_size =
+                static_cast<std::size_t>(write_escaped(out, str, length)
+                                         - self->text.data());
+        }
+
+        template<typename T>
+        void append_array(const T* ptr, const std::size_t size, std::false_type)
+        {
+            for(std::size_t i = 0; i != size; i++)
+            {
+                if(i)
+                {
+                    append_text(" ", 1);
+                }
+                append_primitive(ptr[i]);
+            }
+        }
+
+        void append_text(const char* str, const std::size_t size)
+        {
+            std::memcpy(self->reserve_text(size), str, size);
+            self->text_size += size;
+        }
+
+        void append_primitive(const char value)
+        {
+            const auto out = self->reserve_text(4);
+            self->text_size = static_cast<std::size_t>(
+                write_escaped(out, &value, value ? 1 : 0)
+                - self->text.data());
+        }
+
+        template<typename T>
+        void append_primitive(const T value)
+        {
+            const auto out = self->reserve_text(detail::csv_max_number_size);
+            const auto end = detail::csv_format_number(
+                out, value, std::is_integral<T>{});
+            self->text_size =
+                static_cast<std::size_t>(end - self->text.data());
+        }
+
+        void add_cell(const std::size_t begin)
+        {
+            self->cells.push_back(
+                cell{self->next_column, record, begin, self->text_size});
+            self->next_column++;
+        }
+    };
+
+    void discover_columns()
+    {
+        // fields, group headers and data headers of a single-entry skeleton
+        std::vector<std::uint8_t> skeleton(0x10000);
+        auto m =
+            sbepp::make_view<Message>(skeleton.data(), skeleton.size());
+        sbepp::fill_message_header(m);
+        sbepp::visit(m, schema_visitor{*this, {}});
+    }
+
+    char* reserve_text(const std::size_t n)
+    {
+        if((text.size() - text_size) < n)
+        {
+            text.resize((std::max)(2 * text.size(), text_size + n));
+        }
+        return text.data() + text_size;
+    }
+
+    char* reserve_output(const std::size_t n)
+    {
+        if((out.size() - out_size) < n)
+        {
+            out.resize((std::max)(2 * out.size(), out_size + n));
+        }
+        return out.data() + out_size;
+    }
+
+    // requires `2 * size + 2` bytes
+    static char*
+        write_escaped(char* out, const char* str, const std::size_t size)
+    {
+        if(!detail::csv_needs_quotes(str, size))
+        {
+            if(size)
+            {
+                std::memcpy(out, str, size);
+            }
+            return out + size;
+        }
+        *out++ = '"';
+        for(std::size_t i = 0; i != size; i++)
+        {
+            if(str[i] == '"')
+            {
+                *out++ = '"';
+            }
+            *out++ = str[i];
+        }
+        *out++ = '"';
+        return out;
+    }
+
+    std::size_t write_rows()
+    {
+        // groups cell indexes by record, keeping their order
+        for(const auto& c : cells)
+        {
+            records[c.record].end_cell++;
+        }
+        std::size_t first{};
+        for(auto& r : records)
+        {
+            r.first_cell = first;
+            first += r.end_cell;
+            r.end_cell = r.first_cell;
+        }
+        sorted_cells.resize(cells.size());
+        for(std::size_t i = 0; i != cells.size(); i++)
+        {
+            sorted_cells[records[cells[i].record].end_cell++] = i;
+        }
+
+        std::size_t rows{};
+        for(std::size_t i = 0; i != records.size(); i++)
+        {
+            if(!records[i].has_children)
+            {
+                write_row(i);
+                rows++;
+            }
+        }
+        return rows;
+    }
+
+    void write_row(const std::size_t leaf)
+    {
+        std::fill(row.begin(), row.end(), no_cell);
+        std::size_t length{names.size() + 1};
+        for(auto r = leaf; r != no_record; r = records[r].parent)
+        {
+            for(auto i = records[r].first_cell; i != records[r].end_cell; i++)
+            {
+                const auto& c = cells[sorted_cells[i]];
+                row[c.column] = sorted_cells[i];
+                length += c.end - c.begin;
+            }
+        }
+
+        auto ptr = reserve_output(length);
+        for(std::size_t column = 0; column != row.size(); column++)
+        {
+            if(column)
+            {
+                *ptr++ = ',';
+            }
+            if(row[column] != no_cell)
+            {
+                const auto& c = cells[row[column]];
+                std::memcpy(ptr, text.data() + c.begin, c.end - c.begin);
+                ptr += c.end - c.begin;
+            }
+        }
+        *ptr++ = '\n';
+        out_size = static_cast<std::size_t>(ptr - out.data());
+    }
+};
+
+template<template<typename> class Message>
+constexpr std::size_t csv_formatter<Message>::no_record;
+
+template<template<typename> class Message>
+constexpr std::size_t csv_formatter<Message>::no_group;
+
+template<template<typename> class Message>
+constexpr std::size_t csv_formatter<Message>::no_cell;
+
+#if defined(__linux__)
+/**
+ * @brief Writes messages as CSV to a file descriptor.
+ *
+ * Rows are accumulated in a buffer which is written using a single `write()`
+ * call once it exceeds the specified size.
+ *
+ * @tparam Message message view template
+ */
+template<template<typename> class Message>
+class csv_writer
+{
+public:
+    /**
+     * @brief Constructs writer
+     *
+     * @param fd file descriptor, not owned by the writer
+     * @param buffer_size buffer size after which it's flushed
+     */
+    explicit csv_writer(const int fd, const std::size_t buffer_size = 0x100000)
+        : fd{fd}, buffer_size{buffer_size}
+    {
+    }
+
+    //! @brief Writes header row
+    void write_header()
+    {
+        formatter.format_header();
+        flush_if_full();
+    }
+
+    //! @brief Writes message rows
+    //! @throws std::system_error if buffer is flushed and `write()` fails
+    template<typename Byte>
+    void write(Message<Byte> m)
+    {
+        formatter.format(m);
+        flush_if_full();
+    }
+
+    //! @brief Writes buffered rows. Must be called before destruction.
+    //! @throws std::system_error if `write()` fails
+    void flush()
+    {
+        detail::csv_write_all(fd, formatter.data(), formatter.size());
+        formatter.clear();
+    }
+
+private:
+    int fd;
+    std::size_t buffer_size;
+    csv_formatter<Message> formatter;
+
+    void flush_if_full()
+    {
+        if(formatter.size() >= buffer_size)
+        {
+            flush();
+        }
+    }
+};
+
+namespace detail
+{
+// Journal chunks are claimed in order by pool tasks and written by whichever
+// worker completes the chunk which is next to write, so formatting and
+// writing overlap and a slow chunk delays only the output after it. At most
+// `window` chunks are kept formatted but not yet written. Formatters of
+// written chunks are reused to keep their buffers warm.
+template<template<typename> class Message>
+class csv_ordered_export
+{
+public:
+    csv_ordered_export(
+        const int fd,
+        const std::uint8_t* data,
+        const std::vector<journal_range>& chunks,
+        const std::size_t window)
+        : fd{fd}, data{data}, chunks{chunks}, pending(window)
+    {
+    }
+
+    // formats the next unclaimed chunk
+    void run_task()
+    {
+        const auto index = next_chunk.fetch_add(1, std::memory_order_relaxed);
+        try
+        {
+            const auto formatter = acquire_formatter(index);
+            if(!formatter)
+            {
+                return;
+            }
+            const auto& chunk = chunks[index];
+            std::size_t n{};
+            auto offset = chunk.begin;
+            while(offset != chunk.end)
+            {
+                const auto m = sbepp::make_const_view<Message>(
+                    data + offset, chunk.end - offset);
+                formatter->format(m);
+                offset += sbepp::size_bytes(m);
+                n++;
+            }
+            complete(index, formatter, n);
+        }
+        catch(...)
+        {
+            fail();
+            throw;
+        }
+    }
+
+    std::size_t message_count() const noexcept
+    {
+        return messages;
+    }
+
+private:
+    using formatter_type = csv_formatter<Message>;
+
+    int fd;
+    const std::uint8_t* data;
+    const std::vector<journal_range>& chunks;
+    std::atomic<std::size_t> next_chunk{};
+    std::mutex mutex;
+    std::condition_variable chunk_written;
+    // fields below are protected by `mutex`
+    std::vector<std::unique_ptr<formatter_type>> formatters;
+    std::vector<formatter_type*> free_formatters;
+    // formatted chunks by `index % window`, `nullptr` if not ready
+    std::vector<formatter_type*> pending;
+    std::size_t written{};
+    std::size_t messages{};
+    bool writing{};
+    bool failed{};
+
+    // returns `nullptr` if export has failed
+    formatter_type* acquire_formatter(const std::size_t index)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        chunk_written.wait(
+            lock,
+            [this, index]
+            {
+                return failed || (index < written + pending.size());
+            });
+        if(failed)
+        {
+            return nullptr;
+        }
+        if(free_formatters.empty())
+        {
+            formatters.emplace_back(new formatter_type);
+            return formatters.back().get();
+        }
+        const auto formatter = free_formatters.back();
+        free_formatters.pop_back();
+        return formatter;
+    }
+
+    void complete(
+        const std::size_t index,
+        formatter_type* formatter,
+        const std::size_t n)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        messages += n;
+        pending[index % pending.size()] = formatter;
+        // current writer picks the chunk up
+        if(writing)
+        {
+            return;
+        }
+        writing = true;
+        while(!failed && (written != chunks.size())
+              && pending[written % pending.size()])
+        {
+            const auto next = pending[written % pending.size()];
+            lock.unlock();
+            // on failure, `run_task()` stops all pending tasks
+            csv_write_all(fd, next->data(), next->size());
+            next->clear();
+            lock.lock();
+            pending[written % pending.size()] = nullptr;
+            free_formatters.push_back(next);
+            written++;
+            chunk_written.notify_all();
+        }
+        writing = false;
+    }
+
+    void fail()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            failed = true;
+        }
+        chunk_written.notify_all();
+    }
+};
+} // namespace detail
+
+//! @brief Options for `sbepp::export_csv()`
+struct csv_export_options
+{
+    //! @brief Number of threads, `0` means `std::thread::hardware_concurrency`
+    std::size_t threads{};
+    //! @brief Approximate size of journal chunk formatted by a single task
+    std::size_t chunk_size{0x400000};
+    //! @brief Maximum number of formatted chunks waiting to be written, `0`
+    //!  means `4 * threads`
+    std::size_t max_pending_chunks{};
+    //! @brief Whether to write header row
+    bool header{true};
+};
+
+/**
+ * @brief Writes journal of messages as CSV to a file descriptor.
+ *
+ * Journal is a sequence of back-to-back messages of the same type. It's split
+ * into chunks using `sbepp::split_journal()`, all chunks are formatted by a
+ * single `sbepp::work_stealing_pool::run()`. Chunks are claimed in journal
+ * order and each one is written using a single `write()` call as soon as all
+ * preceding chunks are written, by the worker which completed it, so
+ * formatting and writing overlap. Chunks order is preserved. Trailing
+ * incomplete message is ignored.
+ *
+ * @tparam Message message view template
+ * @param fd file descriptor
+ * @param journal journal start
+ * @param size journal size
+ * @param options export options
+ * @return the number of exported messages
+ * @throws std::system_error if `write()` fails
+ */
+template<template<typename> class Message>
+std::size_t export_csv(
+    const int fd,
+    const void* journal,
+    const std::size_t size,
+    const csv_export_options& options = {})
+{
+    const auto chunks =
+        sbepp::split_journal<Message>(journal, size, options.chunk_size);
+
+    if(options.header)
+    {
+        csv_formatter<Message> formatter;
+        formatter.format_header();
+        detail::csv_write_all(fd, formatter.data(), formatter.size());
+    }
+
+    auto threads = options.threads ? options.threads
+                                   : std::thread::hardware_concurrency();
+    threads = (std::max)(std::size_t{1}, (std::min)(threads, chunks.size()));
+    const auto window = options.max_pending_chunks
+                            ? options.max_pending_chunks
+                            : 4 * threads;
+
+    detail::csv_ordered_export<Message> exporter{
+        fd, static_cast<const std::uint8_t*>(journal), chunks, window};
+    work_stealing_pool pool{threads};
+    pool.run(
+        chunks.size(),
+        [&exporter](std::size_t, std::size_t)
+        {
+            exporter.run_task();
+        });
+
+    return exporter.message_count();
+}
+#endif
+} // namespace sbepp
@@ -0,0 +1,480 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file fragmentation.hpp
+ * @brief Contains `sbepp::fragmenter` and `sbepp::reassembler` which transfer
+ *  messages larger than a single transport frame
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace sbepp
+{
+/**
+ * @brief Size of the fragment header.
+ *
+ * Fragment header layout (little-endian):
+ * - `messageId`, `uint32`, incremented for each fragmented message
+ * - `messageSize`, `uint32`, size of the whole message
+ * - `fragmentIndex`, `uint16`
+ * - `fragmentCount`, `uint16`
+ */
+constexpr std::size_t fragment_header_size = 12;
+
+//! @brief Decoded fragment header
+struct fragment_header
+{
+    //! @brief ID of the message this fragment belongs to
+    std::uint32_t message_id;
+    //! @brief Size of the whole message
+    std::uint32_t message_size;
+    //! @brief Fragment index within message
+    std::uint16_t fragment_index;
+    //! @brief Total number of fragments in message
+    std::uint16_t fragment_count;
+};
+
+/**
+ * @brief Reads fragment header
+ *
+ * @param ptr fragment start
+ * @return decoded header
+ * @pre `ptr` points to at least `fragment_header_size` bytes
+ */
+template<typename Byte>
+SBEPP_CPP20_CONSTEXPR fragment_header read_fragment_header(Byte* ptr) noexcept
+{
+    return {
+        detail::get_primitive<std::uint32_t, endian::little>(ptr),
+        detail::get_primitive<std::uint32_t, endian::little>(ptr + 4),
+        detail::get_primitive<std::uint16_t, endian::little>(ptr + 8),
+        detail::get_primitive<std::uint16_t, endian::little>(ptr + 10)};
+}
+
+/**
+ * @brief Writes fragment header
+ *
+ * @param ptr fragment start
+ * @param header header to write
+ * @pre `ptr` points to at least `fragment_header_size` bytes
+ */
+template<typename Byte>
+SBEPP_CPP20_CONSTEXPR void
+    write_fragment_header(Byte* ptr, const fragment_header& header) noexcept
+{
+    detail::set_primitive<endian::little>(ptr, header.message_id);
+    detail::set_primitive<endian::little>(ptr + 4, header.message_size);
+    detail::set_primitive<endian::little>(ptr + 8, header.fragment_index);
+    detail::set_primitive<endian::little>(ptr + 10, header.fragment_count);
+}
+
+/**
+ * @brief Splits messages into fragments of up to `max_payload_size` bytes.
+ *
+ * Each fragmented message gets its own sequential ID. Fragments are
+ * not copied anywhere, they are passed to the user-provided callback as a
+ * header and a pointer into the original message. This allows to send them
+ * without an extra copy using scatter/gather I/O or to write them directly
+ * into a transport buffer, see `write_fragment_header()`.
+ */
+class fragmenter
+{
+public:
+    /**
+     * @brief Constructs fragmenter
+     *
+     * @param max_payload_size maximum fragment size, excluding header
+     * @param first_message_id ID of the first fragmented message
+     */
+    explicit fragmenter(
+        const std::size_t max_payload_size,
+        const std::uint32_t first_message_id = 0) noexcept
+        : max_payload_size{max_payload_size}, message_id{first_message_id}
+    {
+        SBEPP_ASSERT(max_payload_size != 0);
+    }
+
+    //! @brief Returns maximum fragment size, excluding header
+    std::size_t get_max_payload_size() const noexcept
+    {
+        return max_payload_size;
+    }
+
+    //! @brief Returns the number of fragments needed for a message of given
+    //!  size
+    std::size_t get_fragment_count(const std::size_t size) const noexcept
+    {
+        return size ? (size + max_payload_size - 1) / max_payload_size : 1;
+    }
+
+    //! @brief Returns the ID the next fragmented message will get
+    std::uint32_t next_message_id() const noexcept
+    {
+        return message_id;
+    }
+
+    /**
+     * @brief Splits message into fragments
+     *
+     * @param data message data
+     * @param size message size
+     * @param f callback, receives `const fragment_header&`,
+     *  `const std::uint8_t*` payload and `std::size_t` payload size
+     * @return ID of the fragmented message
+     * @pre the number of fragments fits into `std::uint16_t` and `size` fits
+     *  into `std::uint32_t`
+     */
+    template<typename F>
+    std::uint32_t fragment(const void* data, const std::size_t size, F&& f)
+    {
+        const auto count = get_fragment_count(size);
+        SBEPP_ASSERT(count <= (std::numeric_limits<std::uint16_t>::max)());
+        SBEPP_ASSERT(size <= (std::numeric_limits<std::uint32_t>::max)());
+
+        fragment_header header{
+            message_id,
+            static_cast<std::uint32_t>(size),
+            0,
+            static_cast<std::uint16_t>(count)};
+        auto ptr = static_cast<const std::uint8_t*>(data);
+        auto remaining = size;
+        for(std::size_t i = 0; i != count; i++)
+        {
+            const auto payload_size = (std::min)(remaining, max_payload_size);
+            header.fragment_index = static_cast<std::uint16_t>(i);
+            f(header, ptr, payload_size);
+            ptr += payload_size;
+            remaining -= payload_size;
+        }
+
+        return message_id++;
+    }
+
+    //! @brief Splits `sbepp::size_bytes(m)` bytes of `m` into fragments
+    template<typename Message, typename F>
+    std::uint32_t fragment(Message m, F&& f)
+    {
+        return fragment(
+            sbepp::addressof(m), sbepp::size_bytes(m), std::forward<F>(f));
+    }
+
+private:
+    std::size_t max_payload_size;
+    std::uint32_t message_id;
+};
+
+//! @brief `reassembler` options
+struct reassembler_options
+{
+    //! @brief Maximum size of reassembled message, larger ones are dropped
+    std::size_t max_message_size{0x10000};
+    /**
+     * @brief Whether fragments memory stays valid until the message they
+     *  belong to is completed. When `true`, fragments which follow each other
+     *  in memory are not copied.
+     */
+    bool stable_fragments{};
+    //! @brief Reassembly buffer allocation options
+    memory_options memory;
+};
+
+/**
+ * @brief Reassembles messages split by `fragmenter`.
+ *
+ * Fragments of a message are expected to arrive in order, any gap in message
+ * IDs or fragment indexes is treated as a loss and the affected message is
+ * dropped. Late or duplicated fragments are dropped too, duplicate of an
+ * already accepted fragment doesn't affect the current message. Message is
+ * copied into internal buffer only when its fragments are not contiguous in
+ * memory, single-fragment messages are never copied.
+ *
+ * Example:
+ * ```cpp
+ * if(r.on_fragment(ptr, size) == sbepp::reassembler::status::complete)
+ * {
+ *     auto m = r.get_message<schema::messages::msg1>();
+ * }
+ * ```
+ */
+class reassembler
+{
+public:
+    //! @brief Result of fragment handling
+    enum class status
+    {
+        //! Fragment is accepted, message is not completed yet
+        incomplete,
+        //! Message is completed and can be accessed
+        complete,
+        //! Fragment is dropped because it's malformed, late or message is lost
+        dropped
+    };
+
+    //! @brief Constructs reassembler with given options
+    explicit reassembler(const reassembler_options& options)
+        : options{options}, buffer{options.max_message_size, options.memory}
+    {
+    }
+
+    /**
+     * @brief Handles fragment which consists of header and payload
+     *
+     * @param data fragment data
+     * @param size fragment size
+     * @return fragment handling status
+     */
+    status on_fragment(const void* data, const std::size_t size)
+    {
+        if(size < fragment_header_size)
+        {
+            dropped_fragments++;
+            return status::dropped;
+        }
+        auto ptr = static_cast<const std::uint8_t*>(data);
+        return on_fragment(
+            read_fragment_header(ptr),
+            ptr + fragment_header_size,
+            size - fragment_header_size);
+    }
+
+    /**
+     * @brief Handles fragment which header and payload are stored separately,
+     *  e.g. when they are received using scatter/gather I/O
+     *
+     * @param header decoded header
+     * @param payload payload data
+     * @param size payload size
+     * @return fragment handling status
+     */
+    status on_fragment(
+        const fragment_header& header,
+        const std::uint8_t* payload,
+        const std::size_t size)
+    {
+        is_completed = false;
+        if(!is_valid(header, size))
+        {
+            dropped_fragments++;
+            return status::dropped;
+        }
+
+        if(in_progress && is_accepted(header))
+        {
+            // duplicate of already accepted fragment, message is not affected
+            dropped_fragments++;
+            return status::dropped;
+        }
+
+        if(in_progress
+           && ((header.message_id != current.message_id)
+               || (header.fragment_index != next_index)
+               || (header.message_size != current.message_size)
+               || (header.fragment_count != current.fragment_count)))
+        {
+            // the rest of the current message is lost
+            lost_messages++;
+            in_progress = false;
+        }
+
+        if(!in_progress && !begin_message(header))
+        {
+            dropped_fragments++;
+            return status::dropped;
+        }
+
+        if((current.message_size - received) < size)
+        {
+            lost_messages++;
+            in_progress = false;
+            dropped_fragments++;
+            return status::dropped;
+        }
+
+        append(payload, size);
+        next_index++;
+        if(next_index != current.fragment_count)
+        {
+            return status::incomplete;
+        }
+
+        in_progress = false;
+        if(received != current.message_size)
+        {
+            lost_messages++;
+            return status::dropped;
+        }
+        is_completed = true;
+        return status::complete;
+    }
+
+    /**
+     * @brief Returns pointer to the completed message
+     *
+     * @pre the last `on_fragment()` returned `status::complete`
+     * @note pointer is valid until the next `on_fragment()` call and, if
+     *  message wasn't copied, while its fragments are valid
+     */
+    const std::uint8_t* message_data() const noexcept
+    {
+        SBEPP_ASSERT(is_completed);
+        return contiguous ? contiguous_start : buffer.data();
+    }
+
+    //! @brief Returns the size of the completed message
+    //! @pre the last `on_fragment()` returned `status::complete`
+    std::size_t message_size() const noexcept
+    {
+        SBEPP_ASSERT(is_completed);
+        return received;
+    }
+
+    /**
+     * @brief Returns read-only view of the completed message
+     *
+     * @tparam View view template
+     * @pre the last `on_fragment()` returned `status::complete`
+     */
+    template<template<typename> class View>
+    View<const std::uint8_t> get_message() const noexcept
+    {
+        return sbepp::make_const_view<View>(message_data(), message_size());
+    }
+
+    //! @brief Checks whether the last completed message was copied into
+    //!  internal buffer
+    bool is_copied() const noexcept
+    {
+        return !contiguous;
+    }
+
+    //! @brief Returns the number of detected lost messages
+    std::uint64_t get_lost_messages() const noexcept
+    {
+        return lost_messages;
+    }
+
+    //! @brief Returns the number of dropped fragments
+    std::uint64_t get_dropped_fragments() const noexcept
+    {
+        return dropped_fragments;
+    }
+
+    //! @brief Abandons the current message and forgets the expected message
+    //!  ID, e.g. after reconnection
+    void reset() noexcept
+    {
+        in_progress = false;
+        is_completed = false;
+        has_expected_id = false;
+    }
+
+private:
+    reassembler_options options;
+    buffer_memory buffer;
+    fragment_header current{};
+    const std::uint8_t* contiguous_start{};
+    std::size_t received{};
+    std::uint64_t lost_messages{};
+    std::uint64_t dropped_fragments{};
+    std::uint32_t expected_id{};
+    std::uint16_t next_index{};
+    bool has_expected_id{};
+    bool in_progress{};
+    bool is_completed{};
+    bool contiguous{};
+
+    bool is_valid(
+        const fragment_header& header, const std::size_t size) const noexcept
+    {
+        return (header.fragment_index < header.fragment_count)
+               && (header.message_size <= options.max_message_size)
+               && (size <= header.message_size);
+    }
+
+    bool is_accepted(const fragment_header& header) const noexcept
+    {
+        return (header.message_id == current.message_id)
+               && (header.message_size == current.message_size)
+               && (header.fragment_count == current.fragment_count)
+               && (header.fragment_index < next_index);
+    }
+
+    bool begin_message(const fragment_header& header) noexcept
+    {
+        if(has_expected_id)
+        {
+            const auto distance =
+                static_cast<std::int32_t>(header.message_id - expected_id);
+            if(distance < 0)
+            {
+                // late or duplicated fragment
+                return false;
+            }
+            lost_messages += static_cast<std::uint32_t>(distance);
+        }
+        has_expected_id = true;
+        expected_id = header.message_id + 1;
+
+        if(header.fragment_index != 0)
+        {
+            // message is lost because its beginning is lost
+            lost_messages++;
+            return false;
+        }
+
+        in_progress = true;
+        current = header;
+        next_index = 0;
+        received = 0;
+        contiguous = true;
+        contiguous_start = nullptr;
+        return true;
+    }
+
+    void append(const std::uint8_t* payload, const std::size_t size)
+    {
+        if(contiguous)
+        {
+            if(next_index == 0)
+            {
+                if(options.stable_fragments || (current.fragment_count == 1))
+                {
+                    contiguous_start = payload;
+                    received = size;
+                    return;
+                }
+            }
+            else if(
+                options.stable_fragments
+                && (payload == (contiguous_start + received)))
+            {
+                received += size;
+                return;
+            }
+            // fragments memory cannot be referenced anymore
+            if(received)
+            {
+                std::memcpy(buffer.data(), contiguous_start, received);
+            }
+            contiguous = false;
+        }
+
+        if(size)
+        {
+            std::memcpy(buffer.data() + received, payload, size);
+        }
+        received += size;
+    }
+};
+} // namespace sbepp
@@ -0,0 +1,527 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file journal_index.hpp
+ * @brief Contains per-chunk journal index which allows scans to skip chunks
+ *  without matching messages
+ */
+
+#pragma once
+
+#include <sbepp/memory.hpp>
+#include <sbepp/sbepp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sbepp
+{
+//! @brief Options for `sbepp::journal_index_builder`
+struct journal_index_options
+{
+    //! @brief Approximate chunk size, chunk is closed after the message which
+    //!     makes it at least that large
+    std::size_t chunk_size{0x10000};
+    //! @brief Bloom filter size per chunk in bits, rounded up to a power of
+    //!     two, at least 64
+    std::size_t bloom_bits{0x4000};
+    //! @brief Number of Bloom filter hash functions
+    std::size_t hash_count{4};
+};
+
+//! @brief Journal chunk description from `sbepp::journal_index_view`
+struct journal_chunk
+{
+    //! Offset of the first chunk message in journal
+    std::uint64_t begin;
+    //! Offset past the last chunk message in journal
+    std::uint64_t end;
+    //! Minimum timestamp of chunk messages
+    std::uint64_t min_timestamp;
+    //! Maximum timestamp of chunk messages
+    std::uint64_t max_timestamp;
+    //! Number of chunk messages
+    std::uint64_t message_count;
+};
+
+namespace detail
+{
+// index layout, all values are little-endian:
+//  header: magic, version(u32), hash_count(u32), bloom_bytes, chunk_size,
+//      chunk_count, journal_size
+//  chunk entries: begin, end, min_timestamp, max_timestamp, message_count,
+//      Bloom filter bits
+constexpr std::uint64_t journal_index_magic = 0x5844495050454253; // SBEPPIDX
+constexpr std::uint32_t journal_index_version = 1;
+constexpr std::size_t journal_index_header_size = 48;
+constexpr std::size_t journal_chunk_header_size = 40;
+
+inline std::uint64_t mix_journal_key_hash(std::uint64_t h) noexcept
+{
+    // SplitMix64 finalizer
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+template<typename T>
+typename std::enable_if<
+    std::is_integral<T>::value || std::is_enum<T>::value,
+    std::uint64_t>::type
+    hash_journal_key(const T key) noexcept
+{
+    return mix_journal_key_hash(static_cast<std::uint64_t>(key));
+}
+
+// contiguous ranges like `static_array_ref` or `std::string` are hashed
+// bytewise
+template<typename T>
+auto hash_journal_key(const T& key) noexcept
+    -> decltype(key.data(), key.size(), std::uint64_t{})
+{
+    const auto ptr = reinterpret_cast<const std::uint8_t*>(key.data());
+    const auto size = key.size() * sizeof(*key.data());
+    // FNV-1a
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for(std::size_t i = 0; i != size; i++)
+    {
+        h = (h ^ ptr[i]) * 0x100000001B3ull;
+    }
+    return mix_journal_key_hash(h);
+}
+
+// double hashing: i-th bit is `h1 + i * h2`, `h2` is odd so it doesn't
+// degenerate for power-of-two filter sizes
+template<typename F>
+void for_each_bloom_bit(
+    const std::uint64_t hash,
+    const std::size_t hash_count,
+    const std::size_t bloom_bits,
+    F&& f)
+{
+    const auto h2 = ((hash >> 32) | (hash << 32)) | 1;
+    auto bit = hash;
+    for(std::size_t i = 0; i != hash_count; i++)
+    {
+        f(static_cast<std::size_t>(bit & (bloom_bits - 1)));
+        bit += h2;
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Builds journal index.
+ *
+ * Journal is a sequence of back-to-back messages. It's split into chunks,
+ * for each chunk the index stores its bounds, the number of messages, min/max
+ * timestamp and a Bloom filter over a user-chosen key. Resulting index is a
+ * plain byte sequence with fixed little-endian layout, it can be stored in a
+ * sidecar file and `mmap`-ed for `sbepp::journal_index_view`.
+ *
+ * Supported keys are integral and enum values or contiguous ranges with
+ * `data()` and `size()` like `sbepp::static_array_ref` or `std::string`,
+ * ranges are hashed bytewise so query key must have the same bytes.
+ */
+class journal_index_builder
+{
+public:
+    //! @brief Constructs builder
+    explicit journal_index_builder(const journal_index_options& options = {})
+        : chunk_size{options.chunk_size},
+          bloom_bits{(std::max)(
+              std::size_t{64},
+              detail::round_up_to_power_of_two(options.bloom_bits))},
+          hash_count{(std::max)(std::size_t{1}, options.hash_count)}
+    {
+        reset();
+    }
+
+    /**
+     * @brief Adds the next journal message
+     *
+     * @param size message size
+     * @param key message key
+     * @param timestamp message timestamp
+     */
+    template<typename Key>
+    void add(
+        const std::size_t size, const Key& key, const std::uint64_t timestamp)
+    {
+        if(!chunk_open)
+        {
+            open_chunk(timestamp);
+        }
+        const auto entry = data.data() + chunk_entry;
+        const auto bloom = entry + detail::journal_chunk_header_size;
+        detail::for_each_bloom_bit(
+            detail::hash_journal_key(key),
+            hash_count,
+            bloom_bits,
+            [bloom](const std::size_t bit)
+            {
+                bloom[bit / 8] |= static_cast<std::uint8_t>(1u << (bit % 8));
+            });
+        offset += size;
+        min_timestamp = (std::min)(min_timestamp, timestamp);
+        max_timestamp = (std::max)(max_timestamp, timestamp);
+        message_count++;
+        if((offset - chunk_begin) >= chunk_size)
+        {
+            close_chunk();
+        }
+    }
+
+    /**
+     * @brief Returns built index and resets builder for the next journal
+     *
+     * @return index bytes
+     */
+    std::vector<std::uint8_t> finish()
+    {
+        if(chunk_open)
+        {
+            close_chunk();
+        }
+        const auto ptr = data.data();
+        set_u64(ptr + 32, chunk_count);
+        set_u64(ptr + 40, offset);
+        auto res = std::move(data);
+        reset();
+        return res;
+    }
+
+private:
+    std::vector<std::uint8_t> data;
+    std::size_t chunk_size;
+    std::size_t bloom_bits;
+    std::size_t hash_count;
+    std::uint64_t offset{};
+    std::uint64_t chunk_count{};
+    // current chunk state
+    bool chunk_open{};
+    std::size_t chunk_entry{};
+    std::uint64_t chunk_begin{};
+    std::uint64_t min_timestamp{};
+    std::uint64_t max_timestamp{};
+    std::uint64_t message_count{};
+
+    static void set_u64(std::uint8_t* ptr, const std::uint64_t value) noexcept
+    {
+        detail::set_primitive<endian::little>(ptr, value);
+    }
+
+    void reset()
+    {
+        data.clear();
+        data.resize(detail::journal_index_header_size);
+        const auto ptr = data.data();
+        set_u64(ptr, detail::journal_index_magic);
+        detail::set_primitive<endian::little>(
+            ptr + 8, detail::journal_index_version);
+        detail::set_primitive<endian::little>(
+            ptr + 12, static_cast<std::uint32_t>(hash_count));
+        set_u64(ptr + 16, bloom_bits / 8);
+        set_u64(ptr + 24, chunk_size);
+        offset = 0;
+        chunk_count = 0;
+        chunk_open = false;
+    }
+
+    void open_chunk(const std::uint64_t timestamp)
+    {
+        chunk_entry = data.size();
+        data.resize(
+            data.size() + detail::journal_chunk_header_size + bloom_bits / 8);
+        chunk_open = true;
+        chunk_begin = offset;
+        min_timestamp = timestamp;
+        max_timestamp = timestamp;
+        message_count = 0;
+    }
+
+    void close_chunk()
+    {
+        const auto ptr = data.data() + chunk_entry;
+        set_u64(ptr, chunk_begin);
+        set_u64(ptr + 8, offset);
+        set_u64(ptr + 16, min_timestamp);
+        set_u64(ptr + 24, max_timestamp);
+        set_u64(ptr + 32, message_count);
+        chunk_count++;
+        chunk_open = false;
+    }
+};
+
+/**
+ * @brief Reads index built by `sbepp::journal_index_builder` in place.
+ *
+ * Doesn't own the memory, it can point directly to `mmap`-ed sidecar file.
+ */
+class journal_index_view
+{
+public:
+    //! @brief Constructs empty view
+    journal_index_view() = default;
+
+    /**
+     * @brief Constructs view from index bytes
+     *
+     * If index is malformed or has an unsupported version, view is empty and
+     * `operator bool` returns `false`.
+     *
+     * @param data index start
+     * @param size index size
+     */
+    journal_index_view(const void* data, const std::size_t size) noexcept
+    {
+        const auto ptr = static_cast<const std::uint8_t*>(data);
+        if((size < detail::journal_index_header_size)
+           || (detail::get_u64(ptr) != detail::journal_index_magic)
+           || (detail::get_primitive<std::uint32_t, endian::little>(ptr + 8)
+               != detail::journal_index_version))
+        {
+            return;
+        }
+        const auto count =
+            detail::get_primitive<std::uint32_t, endian::little>(ptr + 12);
+        const auto bloom_bytes = detail::get_u64(ptr + 16);
+        if(!count || (bloom_bytes < 8) || (bloom_bytes & (bloom_bytes - 1)))
+        {
+            return;
+        }
+        const auto chunks = detail::get_u64(ptr + 32);
+        const auto entry = detail::journal_chunk_header_size + bloom_bytes;
+        if(chunks > (size - detail::journal_index_header_size) / entry)
+        {
+            return;
+        }
+
+        this->data = ptr;
+        hash_count = count;
+        bloom_bits = static_cast<std::size_t>(bloom_bytes * 8);
+        entry_size = static_cast<std::size_t>(entry);
+        chunks_number = static_cast<std::size_t>(chunks);
+    }
+
+    //! @brief Checks whether view refers to a valid index
+    explicit operator bool() const noexcept
+    {
+        return data != nullptr;
+    }
+
+    //! @brief Returns the number of chunks
+    std::size_t chunk_count() const noexcept
+    {
+        return chunks_number;
+    }
+
+    //! @brief Returns size of the indexed part of journal
+    std::uint64_t journal_size() const noexcept
+    {
+        return data ? detail::get_u64(data + 40) : 0;
+    }
+
+    //! @brief Returns chunk description
+    //! @pre `index < chunk_count()`
+    journal_chunk chunk(const std::size_t index) const noexcept
+    {
+        SBEPP_ASSERT(index < chunk_count());
+        const auto ptr = entry(index);
+        return {
+            detail::get_u64(ptr),
+            detail::get_u64(ptr + 8),
+            detail::get_u64(ptr + 16),
+            detail::get_u64(ptr + 24),
+            detail::get_u64(ptr + 32)};
+    }
+
+    /**
+     * @brief Checks whether chunk may contain the key. No false negatives,
+     *  false positive rate depends on Bloom filter parameters.
+     *
+     * @pre `index < chunk_count()`
+     */
+    template<typename Key>
+    bool may_contain(const std::size_t index, const Key& key) const noexcept
+    {
+        SBEPP_ASSERT(index < chunk_count());
+        return may_contain(entry(index), detail::hash_journal_key(key));
+    }
+
+    /**
+     * @brief Calls `f(const journal_chunk&)` for each chunk which may contain
+     *  messages with the key and timestamp in `[min_timestamp,
+     *  max_timestamp]`
+     *
+     * @param key key to look for
+     * @param min_timestamp minimum timestamp, inclusive
+     * @param max_timestamp maximum timestamp, inclusive
+     * @param f callback
+     * @return the number of candidate chunks
+     */
+    template<typename Key, typename F>
+    std::size_t for_each_candidate(
+        const Key& key,
+        const std::uint64_t min_timestamp,
+        const std::uint64_t max_timestamp,
+        F&& f) const
+    {
+        const auto hash = detail::hash_journal_key(key);
+        std::size_t candidates{};
+        for(std::size_t i = 0; i != chunks_number; i++)
+        {
+            const auto ptr = entry(i);
+            if((detail::get_u64(ptr + 16) > max_timestamp)
+               || (detail::get_u64(ptr + 24) < min_timestamp)
+               || !may_contain(ptr, hash))
+            {
+                continue;
+            }
+            candidates++;
+            f(chunk(i));
+        }
+        return candidates;
+    }
+
+private:
+    const std::uint8_t* data{};
+    std::size_t hash_count{};
+    std::size_t bloom_bits{};
+    std::size_t entry_size{};
+    std::size_t chunks_number{};
+
+    const std::uint8_t* entry(const std::size_t index) const noexcept
+    {
+        return data + detail::journal_index_header_size + index * entry_size;
+    }
+
+    bool may_contain(
+        const std::uint8_t* entry, const std::uint64_t hash) const noexcept
+    {
+        const auto bloom = entry + detail::journal_chunk_header_size;
+        bool res = true;
+        detail::for_each_bloom_bit(
+            hash,
+            hash_count,
+            bloom_bits,
+            [bloom, &res](const std::size_t bit)
+            {
+                res = res && (bloom[bit / 8] & (1u << (bit % 8)));
+            });
+        return res;
+    }
+};
+
+/**
+ * @brief Builds index for a journal of messages of the same type
+ *
+ * Trailing incomplete message is not indexed.
+ *
+ * @tparam Message message view template
+ * @param journal journal start
+ * @param size journal size
+ * @param key callback which returns key for `Message<const std::uint8_t>`
+ * @param timestamp callback which returns `std::uint64_t` timestamp for
+ *  `Message<const std::uint8_t>`
+ * @param options index options
+ * @return index bytes
+ */
+template<
+    template<typename>
+    class Message,
+    typename KeyFunction,
+    typename TimestampFunction>
+std::vector<std::uint8_t> build_journal_index(
+    const void* journal,
+    const std::size_t size,
+    KeyFunction&& key,
+    TimestampFunction&& timestamp,
+    const journal_index_options& options = {})
+{
+    const auto data = static_cast<const std::uint8_t*>(journal);
+    journal_index_builder builder{options};
+    std::size_t offset{};
+    while(offset != size)
+    {
+        const auto m =
+            sbepp::make_const_view<Message>(data + offset, size - offset);
+        const auto checked = sbepp::size_bytes_checked(m, size - offset);
+        if(!checked.valid)
+        {
+            break;
+        }
+        builder.add(checked.size, key(m), timestamp(m));
+        offset += checked.size;
+    }
+    return builder.finish();
+}
+
+/**
+ * @brief Calls `f(Message<const std::uint8_t>)` for each message of chunks
+ *  which may contain messages with the key and timestamp in
+ *  `[min_timestamp, max_timestamp]`. `f` still has to check them.
+ *
+ * @tparam Message message view template
+ * @param journal journal start
+ * @param journal_size journal size, can be greater than the indexed part
+ * @param index journal index
+ * @param key key to look for
+ * @param min_timestamp minimum timestamp, inclusive
+ * @param max_timestamp maximum timestamp, inclusive
+ * @param f callback
+ * @return the number of scanned chunks
+ * @throws std::runtime_error if index doesn't match the journal: journal is
+ *  shorter than the indexed part, chunk is out of journal bounds or doesn't
+ *  end on a message boundary
+ */
+template<template<typename> class Message, typename Key, typename F>
+std::size_t scan_journal(
+    const void* journal,
+    const std::size_t journal_size,
+    const journal_index_view& index,
+    const Key& key,
+    const std::uint64_t min_timestamp,
+    const std::uint64_t max_timestamp,
+    F&& f)
+{
+    if(index.journal_size() > journal_size)
+    {
+        throw std::runtime_error{"scan_journal: journal is shorter than index"};
+    }
+    const auto data = static_cast<const std::uint8_t*>(journal);
+    return index.for_each_candidate(
+        key,
+        min_timestamp,
+        max_timestamp,
+        [data, journal_size, &f](const journal_chunk& chunk)
+        {
+            if((chunk.begin > chunk.end) || (chunk.end > journal_size))
+            {
+                throw std::runtime_error{
+                    "scan_journal: chunk is out of journal bounds"};
+            }
+            auto offset = static_cast<std::size_t>(chunk.begin);
+            const auto end = static_cast<std::size_t>(chunk.end);
+            while(offset < end)
+            {
+                const auto m = sbepp::make_const_view<Message>(
+                    data + offset, end - offset);
+                const auto checked =
+                    sbepp::size_bytes_checked(m, end - offset);
+                if(!checked.valid)
+                {
+                    throw std::runtime_error{
+                        "scan_journal: chunk ends inside a message"};
+                }
+                f(m);
+                offset += checked.size;
+            }
+        });
+}
+} // namespace sbepp
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file magic_ring.hpp
+ * @brief Contains `sbepp::magic_ring`, a ring buffer mapped twice in virtual
+ *  memory. Available only on Linux.
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+#if defined(__linux__) || defined(SBEPP_DOXYGEN)
+/**
+ * @brief Byte ring buffer which memory is mapped twice back-to-back.
+ *
+ * Any `capacity()` bytes starting at any position within the ring are
+ * contiguous in virtual memory, so a message that wraps around the end of
+ * the ring can still be accessed using a regular sbepp view without padding
+ * or copying.
+ *
+ * Ring works as a single-threaded byte queue:
+ * ```cpp
+ * sbepp::magic_ring ring{1024 * 1024};
+ * // write
+ * auto n = ::recv(fd, ring.write_data(), ring.free_space(), 0);
+ * ring.commit(n);
+ * // read
+ * auto m = sbepp::make_const_view<schema::messages::msg1>(
+ *     ring.read_data(), ring.size());
+ * ring.consume(sbepp::size_bytes(m));
+ * ```
+ *
+ * @note available only on Linux
+ */
+class magic_ring
+{
+public:
+    //! @brief Constructs an empty ring without memory
+    magic_ring() = default;
+
+    /**
+     * @brief Constructs ring with at least `min_capacity` bytes
+     *
+     * @param min_capacity minimum capacity, rounded up to page size or huge
+     *  page size if huge pages are used
+     * @param options memory allocation options, applied on the best-effort
+     *  basis like in `buffer_memory`
+     * @throws std::system_error if memory cannot be mapped
+     */
+    explicit magic_ring(
+        const std::size_t min_capacity, const memory_options& options = {})
+    {
+#    if defined(MFD_HUGETLB)
+        const auto huge_page_size = detail::get_huge_page_size();
+        if((options.pages == huge_pages::preferred) && huge_page_size)
+        {
+            cap = detail::round_up(
+                (std::max)(min_capacity, std::size_t{1}), huge_page_size);
+            hugetlb = try_map_memory(MFD_HUGETLB, huge_page_size);
+        }
+#    endif
+        if(!hugetlb)
+        {
+            const auto page_size = detail::get_page_size();
+            cap = detail::round_up(
+                (std::max)(min_capacity, std::size_t{1}), page_size);
+            if(!try_map_memory(0, page_size))
+            {
+                detail::throw_system_error("magic_ring");
+            }
+            if(options.pages != huge_pages::disabled)
+            {
+                detail::advise_huge_pages(base, 2 * cap);
+            }
+        }
+
+        if(options.numa_node >= 0)
+        {
+            numa_bound =
+                detail::bind_to_numa_node(base, 2 * cap, options.numa_node);
+        }
+        if(options.prefault)
+        {
+            detail::prefault(base, cap);
+        }
+    }
+
+    magic_ring(const magic_ring&) = delete;
+    magic_ring& operator=(const magic_ring&) = delete;
+
+    //! @brief Move constructor, `other` is left without memory
+    magic_ring(magic_ring&& other) noexcept
+        : base{other.base},
+          cap{other.cap},
+          read_offset{other.read_offset},
+          used{other.used},
+          hugetlb{other.hugetlb},
+          numa_bound{other.numa_bound}
+    {
+        other.base = nullptr;
+        other.cap = 0;
+        other.read_offset = 0;
+        other.used = 0;
+        other.hugetlb = false;
+        other.numa_bound = false;
+    }
+
+    //! @brief Move assignment, `other` is left without memory
+    magic_ring& operator=(magic_ring&& other) noexcept
+    {
+        magic_ring tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~magic_ring()
+    {
+        if(base)
+        {
+            ::munmap(base, 2 * cap);
+        }
+    }
+
+    //! @brief Swaps two rings
+    void swap(magic_ring& other) noexcept
+    {
+        std::swap(base, other.base);
+        std::swap(cap, other.cap);
+        std::swap(read_offset, other.read_offset);
+        std::swap(used, other.used);
+        std::swap(hugetlb, other.hugetlb);
+        std::swap(numa_bound, other.numa_bound);
+    }
+
+    //! @brief Returns ring capacity
+    std::size_t capacity() const noexcept
+    {
+        return cap;
+    }
+
+    //! @brief Checks whether ring is allocated from the reserved huge pages
+    //!  pool. Transparent huge pages are not reported.
+    bool uses_huge_pages() const noexcept
+    {
+        return hugetlb;
+    }
+
+    //! @brief Checks whether ring is bound to the requested NUMA node
+    bool is_numa_bound() const noexcept
+    {
+        return numa_bound;
+    }
+
+    //! @brief Returns the number of readable bytes
+    std::size_t size() const noexcept
+    {
+        return used;
+    }
+
+    //! @brief Returns the number of writable bytes
+    std::size_t free_space() const noexcept
+    {
+        return cap - used;
+    }
+
+    //! @brief Checks if there are no readable bytes
+    bool empty() const noexcept
+    {
+        return !used;
+    }
+
+    //! @brief Returns pointer to `size()` contiguous readable bytes
+    const std::uint8_t* read_data() const noexcept
+    {
+        return base + read_offset;
+    }
+
+    //! @brief Returns pointer to `free_space()` contiguous writable bytes
+    std::uint8_t* write_data() noexcept
+    {
+        const auto offset = read_offset + used;
+        return base + ((offset < cap) ? offset : (offset - cap));
+    }
+
+    //! @brief Makes `n` bytes written to `write_data()` readable
+    //! @pre `n <= free_space()`
+    void commit(const std::size_t n) noexcept
+    {
+        SBEPP_ASSERT(n <= free_space());
+        used += n;
+    }
+
+    //! @brief Releases `n` read bytes
+    //! @pre `n <= size()`
+    void consume(const std::size_t n) noexcept
+    {
+        SBEPP_ASSERT(n <= size());
+        used -= n;
+        read_offset += n;
+        if(read_offset >= cap)
+        {
+            read_offset -= cap;
+        }
+    }
+
+    //! @brief Releases all bytes
+    void clear() noexcept
+    {
+        read_offset = 0;
+        used = 0;
+    }
+
+private:
+    std::uint8_t* base{};
+    std::size_t cap{};
+    std::size_t read_offset{};
+    std::size_t used{};
+    bool hugetlb{};
+    bool numa_bound{};
+
+    // maps `cap` bytes twice at `alignment`-aligned address, returns `false`
+    // and preserves `errno` on failure. `MAP_FIXED` mapping of huge pages
+    // requires huge page alignment while anonymous reservation is only page
+    // aligned, so reservation is extended by `alignment` and trimmed.
+    bool try_map_memory(
+        const unsigned int memfd_flags, const std::size_t alignment) noexcept
+    {
+        // mappings keep the memory alive after `fd` is closed
+        const detail::unique_fd fd{
+            ::memfd_create("sbepp_magic_ring", MFD_CLOEXEC | memfd_flags)};
+        if(!fd)
+        {
+            return false;
+        }
+
+        // reserve address space for both mappings first
+        const auto reserved_size = 2 * cap + alignment;
+        void* addr = MAP_FAILED;
+        if(::ftruncate(fd.get(), static_cast<off_t>(cap)) == 0)
+        {
+            addr = ::mmap(
+                nullptr,
+                reserved_size,
+                PROT_NONE,
+                MAP_PRIVATE | MAP_ANONYMOUS,
+                -1,
+                0);
+        }
+
+        if(addr != MAP_FAILED)
+        {
+            const auto reserved = static_cast<std::uint8_t*>(addr);
+            base = reinterpret_cast<std::uint8_t*>(detail::round_up(
+                reinterpret_cast<std::uintptr_t>(reserved), alignment));
+            const auto prefix = static_cast<std::size_t>(base - reserved);
+            if(prefix)
+            {
+                ::munmap(reserved, prefix);
+            }
+            ::munmap(base + 2 * cap, alignment - prefix);
+
+            for(std::size_t i = 0; i != 2; i++)
+            {
+                if(::mmap(
+                       base + i * cap,
+                       cap,
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED,
+                       fd.get(),
+                       0)
+                   == MAP_FAILED)
+                {
+                    const auto error = errno;
+                    ::munmap(base, 2 * cap);
+                    base = nullptr;
+                    errno = error;
+                    break;
+                }
+            }
+        }
+
+        return base != nullptr;
+    }
+};
+#endif
+} // namespace sbepp
@@ -0,0 +1,732 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file memfd_transport.hpp
+ * @brief Contains `sbepp::memfd_transport` which passes large messages
+ *  between processes as shared memory file descriptors. Available only on
+ *  Linux.
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/socket.h>
+#    include <sys/stat.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+#if defined(__linux__) || defined(SBEPP_DOXYGEN)
+//! @brief Options for `sbepp::memfd_transport`
+struct memfd_transport_options
+{
+    //! @brief Messages larger than this are passed via shared memory, the
+    //!     rest are copied through the socket. Must fit into socket buffer.
+    std::size_t inline_threshold{0x10000};
+    //! @brief The number of memfd regions `memfd_transport::send()` keeps
+    //!     for reuse, `0` creates a new region for each message
+    std::size_t max_pooled_regions{4};
+};
+
+namespace detail
+{
+// each packet starts with a frame header, all values are little-endian:
+//  magic(u32), kind(u32), message size(u64)
+// inline message bytes follow the header, shared message is passed as a
+// single memfd attached via `SCM_RIGHTS`. Shared frame of a pooled region is
+// followed by region id(u64), receiver returns it in a release frame when
+// message is released.
+constexpr std::uint32_t memfd_frame_magic = 0x44464D53; // SMFD
+constexpr std::uint32_t memfd_frame_inline = 1;
+constexpr std::uint32_t memfd_frame_shared = 2;
+constexpr std::uint32_t memfd_frame_release = 3;
+constexpr std::size_t memfd_frame_header_size = 16;
+constexpr std::size_t memfd_region_id_size = 8;
+constexpr std::size_t memfd_id_frame_size =
+    memfd_frame_header_size + memfd_region_id_size;
+constexpr int memfd_payload_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+} // namespace detail
+
+/**
+ * @brief Memory-mapped memfd which holds a single message.
+ *
+ * Sender creates the region, encodes message directly into it and passes it
+ * to `sbepp::memfd_transport::send_shared()`.
+ */
+class memfd_region
+{
+public:
+    //! @brief Constructs an empty region
+    memfd_region() = default;
+
+    /**
+     * @brief Creates writable region
+     *
+     * @param size region size, must be greater than `0`
+     * @throws std::system_error on failure
+     */
+    explicit memfd_region(const std::size_t size)
+    {
+        file.reset(::memfd_create(
+            "sbepp_memfd_region", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+        if(!file)
+        {
+            detail::throw_system_error("memfd_create");
+        }
+        if(::ftruncate(file.get(), static_cast<off_t>(size)) == -1)
+        {
+            detail::throw_system_error("ftruncate");
+        }
+        // populating pages in one go is much cheaper than faulting them in
+        // one by one during encoding
+        map(size, PROT_READ | PROT_WRITE, MAP_POPULATE);
+    }
+
+    memfd_region(const memfd_region&) = delete;
+    memfd_region& operator=(const memfd_region&) = delete;
+
+    //! @brief Move constructor, `other` is left empty
+    memfd_region(memfd_region&& other) noexcept
+        : file{std::move(other.file)},
+          ptr{other.ptr},
+          region_size{other.region_size}
+    {
+        other.ptr = nullptr;
+        other.region_size = 0;
+    }
+
+    //! @brief Move assignment, `other` is left empty
+    memfd_region& operator=(memfd_region&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            file = std::move(other.file);
+            ptr = other.ptr;
+            region_size = other.region_size;
+            other.ptr = nullptr;
+            other.region_size = 0;
+        }
+        return *this;
+    }
+
+    ~memfd_region()
+    {
+        reset();
+    }
+
+    //! @brief Checks whether region is mapped
+    explicit operator bool() const noexcept
+    {
+        return ptr != nullptr;
+    }
+
+    //! @brief Returns region memory
+    std::uint8_t* data() const noexcept
+    {
+        return ptr;
+    }
+
+    //! @brief Returns region size
+    std::size_t size() const noexcept
+    {
+        return region_size;
+    }
+
+    //! @brief Returns memfd or `-1` if region doesn't own it
+    int native_handle() const noexcept
+    {
+        return file.get();
+    }
+
+private:
+    friend class memfd_transport;
+
+    detail::unique_fd file;
+    std::uint8_t* ptr{};
+    std::size_t region_size{};
+
+    // maps received memfd read-only, `fd` is closed since mapping keeps the
+    // file alive
+    memfd_region(detail::unique_fd fd, const std::size_t size)
+        : file{std::move(fd)}
+    {
+        map(size, PROT_READ, 0);
+        file.reset();
+    }
+
+    void map(const std::size_t size, const int prot, const int flags)
+    {
+        const auto addr =
+            ::mmap(nullptr, size, prot, MAP_SHARED | flags, file.get(), 0);
+        if(addr == MAP_FAILED)
+        {
+            detail::throw_system_error("mmap");
+        }
+        ptr = static_cast<std::uint8_t*>(addr);
+        region_size = size;
+    }
+
+    void reset() noexcept
+    {
+        if(ptr)
+        {
+            ::munmap(ptr, region_size);
+            ptr = nullptr;
+            region_size = 0;
+        }
+        file.reset();
+    }
+};
+
+/**
+ * @brief Message received by `sbepp::memfd_transport`.
+ *
+ * Message memory is either the internal buffer or a read-only mapping of
+ * the received memfd, in both cases a regular sbepp view can be created over
+ * it. Object can be reused for subsequent `receive()` calls.
+ */
+class received_message
+{
+public:
+    //! @brief Returns message start
+    const std::uint8_t* data() const noexcept
+    {
+        return ptr;
+    }
+
+    //! @brief Returns message size
+    std::size_t size() const noexcept
+    {
+        return message_size;
+    }
+
+    //! @brief Checks whether message was passed via shared memory
+    bool is_shared() const noexcept
+    {
+        return static_cast<bool>(region);
+    }
+
+private:
+    friend class memfd_transport;
+
+    std::vector<std::uint8_t> buffer;
+    memfd_region region;
+    const std::uint8_t* ptr{};
+    std::size_t message_size{};
+    // set if region belongs to sender's pool and must be released
+    bool pooled{};
+    std::uint64_t region_id{};
+};
+
+/**
+ * @brief Passes messages over a `SOCK_SEQPACKET` Unix socket, large messages
+ *  are passed as memfd.
+ *
+ * Messages up to `memfd_transport_options::inline_threshold` bytes are
+ * copied through the socket. Larger messages are placed into a
+ * `sbepp::memfd_region`, only a small frame with message size goes through
+ * the socket while the memfd itself is passed using `SCM_RIGHTS`. Receiver
+ * maps it and gets a zero-copy view regardless of message size. Memfd is
+ * sealed against resizing before it's sent, receiver rejects memfds which
+ * are not sealed so it can't get `SIGBUS` on access.
+ *
+ * `send()` keeps up to `memfd_transport_options::max_pooled_regions`
+ * regions and reuses them, so in steady state it only copies the message
+ * into already mapped memory. Receiver returns the region when message is
+ * released by the next `receive()` or by `release()`, until then `send()`
+ * doesn't touch it and uses another region. Regions sent via
+ * `send_shared()` are not reused. Since both `send()` and `receive()` handle
+ * release frames, they must not be called concurrently on the same
+ * transport.
+ *
+ * Example:
+ * ```cpp
+ * auto transports = sbepp::memfd_transport::make_pair();
+ *
+ * // sender
+ * sbepp::memfd_region region{max_size};
+ * auto m = sbepp::make_view<schema::messages::msg1>(
+ *     region.data(), region.size());
+ * // fill message
+ * transports.first.send_shared(std::move(region), sbepp::size_bytes(m));
+ *
+ * // receiver
+ * sbepp::received_message msg;
+ * while(transports.second.receive(msg))
+ * {
+ *     handle(sbepp::make_const_view<schema::messages::msg1>(
+ *         msg.data(), msg.size()));
+ * }
+ * ```
+ */
+class memfd_transport
+{
+public:
+    /**
+     * @brief Constructs transport over connected socket
+     *
+     * @param socket_fd connected `SOCK_SEQPACKET` Unix socket, transport
+     *  takes its ownership
+     * @param options transport options
+     */
+    explicit memfd_transport(
+        const int socket_fd, const memfd_transport_options& options = {})
+        : sock{socket_fd}, opts(options)
+    {
+    }
+
+    /**
+     * @brief Creates a pair of connected transports
+     *
+     * @param options options for both transports
+     * @throws std::system_error on failure
+     */
+    static std::pair<memfd_transport, memfd_transport>
+        make_pair(const memfd_transport_options& options = {})
+    {
+        int fds[2];
+        if(::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) == -1)
+        {
+            detail::throw_system_error("socketpair");
+        }
+        return {memfd_transport{fds[0], options},
+                memfd_transport{fds[1], options}};
+    }
+
+    memfd_transport(const memfd_transport&) = delete;
+    memfd_transport& operator=(const memfd_transport&) = delete;
+
+    //! @brief Move constructor, `other` is left without socket
+    memfd_transport(memfd_transport&&) = default;
+
+    //! @brief Move assignment, `other` is left without socket
+    memfd_transport& operator=(memfd_transport&&) = default;
+
+    //! @brief Returns socket or `-1` if transport was moved from
+    int native_handle() const noexcept
+    {
+        return sock.get();
+    }
+
+    //! @brief Shuts down sending side, peer's `receive()` returns `false`
+    void shutdown() noexcept
+    {
+        ::shutdown(sock.get(), SHUT_WR);
+    }
+
+    /**
+     * @brief Sends message, copies it into a pooled `sbepp::memfd_region` if
+     *  it's larger than the inline threshold
+     *
+     * @param message message start
+     * @param size message size
+     * @throws std::system_error on failure
+     */
+    void send(const void* message, const std::size_t size)
+    {
+        if(size <= opts.inline_threshold)
+        {
+            std::uint8_t header[detail::memfd_frame_header_size];
+            set_frame_header(header, detail::memfd_frame_inline, size);
+            iovec iov[2];
+            iov[0].iov_base = header;
+            iov[0].iov_len = sizeof(header);
+            iov[1].iov_base = const_cast<void*>(message);
+            iov[1].iov_len = size;
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = size ? 2 : 1;
+            send_message(msg);
+        }
+        else
+        {
+            collect_released_regions();
+            const auto index = acquire_region(size);
+            if(index == pool.size())
+            {
+                memfd_region region{size};
+                std::memcpy(region.data(), message, size);
+                send_shared(std::move(region), size);
+                return;
+            }
+            auto& pooled = pool[index];
+            std::memcpy(pooled.region.data(), message, size);
+            send_region(pooled.region, size, true, index);
+            pooled.in_use = true;
+        }
+    }
+
+    /**
+     * @brief Sends message encoded in `region` without copying it
+     *
+     * Region is sealed against resizing and released, sender must not
+     * modify its memory after this call.
+     *
+     * @param region region which contains message
+     * @param size message size
+     * @throws std::system_error on failure
+     * @pre `0 < size <= region.size()`
+     */
+    void send_shared(memfd_region&& region, const std::size_t size)
+    {
+        SBEPP_ASSERT(size && (size <= region.size()));
+        const memfd_region released{std::move(region)};
+        seal(released);
+        send_region(released, size, false, 0);
+    }
+
+    /**
+     * @brief Receives the next message, blocks if socket is blocking
+     *
+     * @param msg message to receive into, previous message is released
+     * @return `false` if peer has shut down sending side
+     * @throws std::system_error on failure
+     * @throws std::runtime_error on invalid frame or memfd
+     */
+    bool receive(received_message& msg)
+    {
+        release(msg);
+        msg.buffer.resize(
+            detail::memfd_frame_header_size
+            + (std::max)(opts.inline_threshold, detail::memfd_region_id_size));
+        // release frames are handled internally
+        while(!receive_frame(msg))
+        {
+        }
+        return msg.ptr != nullptr;
+    }
+
+    /**
+     * @brief Releases message memory, pooled region is returned to the
+     *  sender
+     *
+     * @param msg message received from this transport
+     */
+    void release(received_message& msg) noexcept
+    {
+        msg.region = memfd_region{};
+        msg.ptr = nullptr;
+        msg.message_size = 0;
+        if(msg.pooled)
+        {
+            msg.pooled = false;
+            send_release(msg.region_id);
+        }
+    }
+
+private:
+    struct pooled_region
+    {
+        memfd_region region;
+        bool in_use;
+    };
+
+    detail::unique_fd sock;
+    memfd_transport_options opts;
+    std::vector<pooled_region> pool;
+
+    // returns `false` if release frame was received, `msg.ptr` is left
+    // `nullptr` if peer has shut down sending side
+    bool receive_frame(received_message& msg)
+    {
+        iovec iov;
+        iov.iov_base = msg.buffer.data();
+        iov.iov_len = msg.buffer.size();
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr hdr{};
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+        ssize_t res;
+        do
+        {
+            res = ::recvmsg(sock.get(), &hdr, MSG_CMSG_CLOEXEC);
+        } while((res == -1) && (errno == EINTR));
+        if(res == -1)
+        {
+            detail::throw_system_error("recvmsg");
+        }
+        detail::unique_fd fd{get_passed_fd(hdr)};
+        if(!res)
+        {
+            return true;
+        }
+
+        const auto received = static_cast<std::size_t>(res);
+        const auto data = msg.buffer.data();
+        const auto kind = detail::get_primitive<std::uint32_t, endian::little>(
+            data + 4);
+        const auto size = static_cast<std::size_t>(detail::get_u64(data + 8));
+        if((hdr.msg_flags & (MSG_TRUNC | MSG_CTRUNC))
+           || (received < detail::memfd_frame_header_size)
+           || (detail::get_primitive<std::uint32_t, endian::little>(data)
+               != detail::memfd_frame_magic))
+        {
+            throw std::runtime_error{"memfd_transport: invalid frame"};
+        }
+
+        if(kind == detail::memfd_frame_inline)
+        {
+            fd.reset();
+            if(size != (received - detail::memfd_frame_header_size))
+            {
+                throw std::runtime_error{"memfd_transport: invalid frame"};
+            }
+            msg.ptr = data + detail::memfd_frame_header_size;
+            msg.message_size = size;
+            return true;
+        }
+
+        const auto has_id = (received == detail::memfd_id_frame_size);
+        if(has_id && (kind == detail::memfd_frame_release) && !fd)
+        {
+            on_region_released(
+                detail::get_u64(data + detail::memfd_frame_header_size));
+            return false;
+        }
+
+        if((kind != detail::memfd_frame_shared) || !fd || !size
+           || (!has_id && (received != detail::memfd_frame_header_size)))
+        {
+            throw std::runtime_error{"memfd_transport: invalid frame"};
+        }
+        validate_memfd(fd.get(), size);
+        msg.region = memfd_region{std::move(fd), size};
+        msg.ptr = msg.region.data();
+        msg.message_size = size;
+        msg.pooled = has_id;
+        if(has_id)
+        {
+            msg.region_id =
+                detail::get_u64(data + detail::memfd_frame_header_size);
+        }
+        return true;
+    }
+
+    static void seal(const memfd_region& region)
+    {
+        if(::fcntl(
+               region.native_handle(),
+               F_ADD_SEALS,
+               detail::memfd_payload_seals)
+           == -1)
+        {
+            detail::throw_system_error("fcntl");
+        }
+    }
+
+    // returns index of a free pooled region which fits `size` bytes,
+    // `pool.size()` if there's no such region and pool can't grow
+    std::size_t acquire_region(const std::size_t size)
+    {
+        auto free_index = pool.size();
+        for(std::size_t i = 0; i != pool.size(); i++)
+        {
+            if(pool[i].in_use)
+            {
+                continue;
+            }
+            if(pool[i].region.size() >= size)
+            {
+                return i;
+            }
+            free_index = i;
+        }
+
+        // size is rounded up so region fits slightly larger messages too
+        const auto region_size = detail::round_up_to_power_of_two(size);
+        if(pool.size() < opts.max_pooled_regions)
+        {
+            memfd_region region{region_size};
+            seal(region);
+            pool.push_back(pooled_region{std::move(region), false});
+            return pool.size() - 1;
+        }
+        if(free_index != pool.size())
+        {
+            // the free region is too small, replace it
+            memfd_region region{region_size};
+            seal(region);
+            pool[free_index].region = std::move(region);
+        }
+        return free_index;
+    }
+
+    // handles release frames queued by the receiver, other frames are left
+    // for `receive()`
+    void collect_released_regions() noexcept
+    {
+        std::uint8_t frame[detail::memfd_id_frame_size];
+        while(true)
+        {
+            const auto res = ::recv(
+                sock.get(), frame, sizeof(frame), MSG_PEEK | MSG_DONTWAIT);
+            if((res != static_cast<ssize_t>(sizeof(frame)))
+               || (detail::get_primitive<std::uint32_t, endian::little>(frame)
+                   != detail::memfd_frame_magic)
+               || (detail::get_primitive<std::uint32_t, endian::little>(
+                       frame + 4)
+                   != detail::memfd_frame_release))
+            {
+                return;
+            }
+            if(::recv(sock.get(), frame, sizeof(frame), MSG_DONTWAIT)
+               != static_cast<ssize_t>(sizeof(frame)))
+            {
+                return;
+            }
+            on_region_released(
+                detail::get_u64(frame + detail::memfd_frame_header_size));
+        }
+    }
+
+    void on_region_released(const std::uint64_t index) noexcept
+    {
+        if(index < pool.size())
+        {
+            pool[static_cast<std::size_t>(index)].in_use = false;
+        }
+    }
+
+    // release is best-effort, if peer is gone there's nothing to release.
+    // The number of pending release frames is limited by the sender's pool
+    // size so they always fit into the socket buffer.
+    void send_release(const std::uint64_t id) noexcept
+    {
+        std::uint8_t frame[detail::memfd_id_frame_size];
+        set_frame_header(frame, detail::memfd_frame_release, 0);
+        detail::set_primitive<endian::little>(
+            frame + detail::memfd_frame_header_size, id);
+        while((::send(
+                   sock.get(),
+                   frame,
+                   sizeof(frame),
+                   MSG_NOSIGNAL | MSG_DONTWAIT)
+               == -1)
+              && (errno == EINTR))
+        {
+        }
+    }
+
+    void send_region(
+        const memfd_region& region,
+        const std::size_t size,
+        const bool pooled,
+        const std::uint64_t id)
+    {
+        std::uint8_t frame[detail::memfd_id_frame_size];
+        set_frame_header(frame, detail::memfd_frame_shared, size);
+        detail::set_primitive<endian::little>(
+            frame + detail::memfd_frame_header_size, id);
+        iovec iov;
+        iov.iov_base = frame;
+        iov.iov_len = pooled ? sizeof(frame) : detail::memfd_frame_header_size;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        const auto cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        const auto fd = region.native_handle();
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(fd));
+        send_message(msg);
+    }
+
+    static void set_frame_header(
+        std::uint8_t* header,
+        const std::uint32_t kind,
+        const std::size_t size) noexcept
+    {
+        detail::set_primitive<endian::little>(
+            header, detail::memfd_frame_magic);
+        detail::set_primitive<endian::little>(header + 4, kind);
+        detail::set_primitive<endian::little>(
+            header + 8, static_cast<std::uint64_t>(size));
+    }
+
+    void send_message(const msghdr& msg)
+    {
+        ssize_t res;
+        do
+        {
+            res = ::sendmsg(sock.get(), &msg, MSG_NOSIGNAL);
+        } while((res == -1) && (errno == EINTR));
+        if(res == -1)
+        {
+            detail::throw_system_error("sendmsg");
+        }
+    }
+
+    // returns the first passed descriptor and closes the rest
+    static int get_passed_fd(msghdr& msg) noexcept
+    {
+        int res = -1;
+        for(auto cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+            cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if((cmsg->cmsg_level != SOL_SOCKET)
+               || (cmsg->cmsg_type != SCM_RIGHTS))
+            {
+                continue;
+            }
+            const auto count =
+                (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for(std::size_t i = 0; i != count; i++)
+            {
+                int fd;
+                std::memcpy(
+                    &fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(fd));
+                if(res == -1)
+                {
+                    res = fd;
+                }
+                else
+                {
+                    ::close(fd);
+                }
+            }
+        }
+        return res;
+    }
+
+    // sender could shrink unsealed memfd while it's mapped which would make
+    // access to its tail raise `SIGBUS`
+    static void validate_memfd(const int fd, const std::size_t size)
+    {
+        const auto seals = ::fcntl(fd, F_GET_SEALS);
+        struct stat st;
+        if((seals == -1) || ((seals & F_SEAL_SHRINK) != F_SEAL_SHRINK)
+           || (::fstat(fd, &st) == -1)
+           || (static_cast<std::size_t>(st.st_size) < size))
+        {
+            throw std::runtime_error{
+                "memfd_transport: memfd is not sealed or is too small"};
+        }
+    }
+};
+#endif
+} // namespace sbepp
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file memoized_view.hpp
+ * @brief Contains `sbepp::memoized_view` which caches positions of groups and
+ *  data members
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <cstddef>
+
+namespace sbepp
+{
+namespace detail
+{
+// address of `value` identifies member tag at runtime
+template<typename Tag>
+struct memoized_member_id
+{
+    static const char value;
+};
+
+template<typename Tag>
+const char memoized_member_id<Tag>::value{};
+
+template<typename Byte>
+struct memoized_member
+{
+    const char* id;
+    Byte* begin;
+    Byte* end;
+};
+} // namespace detail
+
+/**
+ * @brief Wraps message or group entry view and remembers where its groups and
+ *  data members start.
+ *
+ * Members of a level are laid out one after another so a plain view computes
+ * position of a group or data member by walking all the preceding groups
+ * every time it's accessed, it's `O(N)` per access. Cursors avoid that but
+ * require members to be accessed strictly in schema order. `memoized_view`
+ * walks preceding members once, on the first access, and stores positions of
+ * all the members it has passed on the way. Subsequent accesses to any of
+ * them are `O(1)`, in any order. Members already known are skipped without
+ * walking their entries when a further member is requested.
+ *
+ * Positions are stored inside the object itself, it's intended to be a
+ * short-lived local variable, one per message. Members beyond `MaxMembers`
+ * are still accessible but not cached.
+ *
+ * Example:
+ * ```cpp
+ * auto m = sbepp::make_memoized_view(
+ *     sbepp::make_const_view<schema::messages::msg>(ptr, size));
+ * auto field = m->field();
+ * auto group = m.group<schema::schema::messages::msg::group>();
+ * auto data = m.data<schema::schema::messages::msg::data>();
+ * // no more walking through `group`
+ * auto data_again = m.data<schema::schema::messages::msg::data>();
+ * ```
+ *
+ * @tparam View message or group entry view
+ * @tparam MaxMembers maximum number of cached groups and data members
+ */
+template<typename View, std::size_t MaxMembers = 8>
+class memoized_view
+{
+public:
+    static_assert(MaxMembers != 0, "MaxMembers must be greater than 0");
+
+    //! @brief Wrapped view type
+    using view_type = View;
+    //! @brief Byte type of the wrapped view
+    using byte_type = byte_type_t<View>;
+
+    //! @brief Wraps `view`
+    explicit memoized_view(const View view) noexcept : wrapped{view}
+    {
+    }
+
+    //! @brief Returns wrapped view
+    const View& view() const noexcept
+    {
+        return wrapped;
+    }
+
+    //! @brief Provides access to wrapped view members, e.g. fields
+    const View& operator*() const noexcept
+    {
+        return wrapped;
+    }
+
+    //! @brief Provides access to wrapped view members, e.g. fields
+    const View* operator->() const noexcept
+    {
+        return &wrapped;
+    }
+
+    /**
+     * @brief Returns group view
+     *
+     * @tparam GroupTag group tag, must be a member of the wrapped view
+     */
+    template<typename GroupTag>
+    typename group_traits<GroupTag>::template value_type<byte_type> group()
+    {
+        return {get_member<GroupTag>().begin, wrapped(detail::end_ptr_tag{})};
+    }
+
+    /**
+     * @brief Returns data view
+     *
+     * @tparam DataTag data tag, must be a member of the wrapped view
+     */
+    template<typename DataTag>
+    typename data_traits<DataTag>::template value_type<byte_type> data()
+    {
+        return {get_member<DataTag>().begin, wrapped(detail::end_ptr_tag{})};
+    }
+
+    //! @brief Returns number of currently cached members
+    std::size_t cached_members() const noexcept
+    {
+        return cached;
+    }
+
+private:
+    using member_type = detail::memoized_member<byte_type>;
+
+    template<typename Tag>
+    class member_finder
+    {
+    public:
+        explicit member_finder(memoized_view& owner) noexcept : self{&owner}
+        {
+        }
+
+        template<typename T, typename Cursor, typename GroupTag>
+        bool on_group(T g, Cursor& c, GroupTag)
+        {
+            const auto is_cached = (index < self->cached);
+            const auto m =
+                (is_cached ? self->members[index] : make_member<GroupTag>(g));
+            // cursor is left at the first entry, move it past the group
+            c.pointer() = m.end;
+            return on_member(m);
+        }
+
+        template<typename T, typename DataTag>
+        bool on_data(T d, DataTag)
+        {
+            // cursor is already moved past the data
+            return on_member(make_member<DataTag>(d));
+        }
+
+        template<typename T, typename FieldTag>
+        bool on_field(T, FieldTag) noexcept
+        {
+            return false;
+        }
+
+        const member_type& get() const noexcept
+        {
+            return found;
+        }
+
+    private:
+        memoized_view* self;
+        std::size_t index{};
+        member_type found{};
+
+        template<typename MemberTag, typename T>
+        static member_type make_member(const T v) noexcept
+        {
+            const auto begin = sbepp::addressof(v);
+            return {
+                &detail::memoized_member_id<MemberTag>::value,
+                begin,
+                begin + sbepp::size_bytes(v)};
+        }
+
+        bool on_member(const member_type& m) noexcept
+        {
+            if((index < MaxMembers) && (index == self->cached))
+            {
+                self->members[index] = m;
+                self->cached++;
+            }
+            index++;
+            if(m.id == &detail::memoized_member_id<Tag>::value)
+            {
+                found = m;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    View wrapped;
+    member_type members[MaxMembers];
+    std::size_t cached{};
+
+    template<typename Tag>
+    member_type get_member()
+    {
+        const auto id = &detail::memoized_member_id<Tag>::value;
+        for(std::size_t i = 0; i != cached; i++)
+        {
+            if(members[i].id == id)
+            {
+                return members[i];
+            }
+        }
+
+        auto c = sbepp::init_cursor(wrapped);
+        member_finder<Tag> finder{*this};
+        sbepp::visit_children(wrapped, c, finder);
+        SBEPP_ASSERT(finder.get().begin && "Tag is not a member of View");
+        return finder.get();
+    }
+};
+
+/**
+ * @brief Constructs `sbepp::memoized_view` for given view
+ *
+ * @param view message or group entry view
+ * @return memoized view
+ */
+template<std::size_t MaxMembers = 8, typename View>
+memoized_view<View, MaxMembers> make_memoized_view(const View view) noexcept
+{
+    return memoized_view<View, MaxMembers>{view};
+}
+} // namespace sbepp
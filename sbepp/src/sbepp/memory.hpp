@@ -0,0 +1,564 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file memory.hpp
+ * @brief Contains `sbepp::buffer_memory` which allocates large buffers with
+ *  huge pages and NUMA binding
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+//! @brief Huge pages usage policy
+enum class huge_pages
+{
+    //! Regular pages only
+    disabled,
+    //! Asks kernel to back memory with transparent huge pages
+    transparent,
+    /**
+     * Tries to allocate from the reserved huge pages pool (`MAP_HUGETLB`),
+     * falls back to `huge_pages::transparent` if the pool is empty or not
+     * configured
+     */
+    preferred
+};
+
+//! @brief Options used to allocate buffer memory
+struct memory_options
+{
+    //! @brief Huge pages usage policy
+    huge_pages pages{huge_pages::disabled};
+    //! @brief NUMA node to bind memory to, negative value means no binding
+    int numa_node{-1};
+    //! @brief Whether to touch all pages on allocation to avoid page faults
+    //!  on the hot path
+    bool prefault{};
+};
+
+//! @brief Cache line size used to separate data written by different threads
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * @brief Position shared between threads which occupies its own cache line.
+ *
+ * `value` is written by a single owner thread and read by others. `cached`
+ * is private to the owner, usually it's the owner's copy of the position
+ * written by the other side so the owner doesn't touch the other cache line
+ * on each operation.
+ */
+struct alignas(cache_line_size) padded_position
+{
+    //! Shared position
+    std::atomic<std::uint64_t> value{};
+    //! Owner's private data
+    std::uint64_t cached{};
+};
+
+namespace detail
+{
+inline std::size_t round_up_to_power_of_two(const std::size_t n) noexcept
+{
+    std::size_t res = 1;
+    while(res < n)
+    {
+        res <<= 1;
+    }
+    return res;
+}
+
+// reads little-endian `std::uint64_t` used by on-disk formats
+inline std::uint64_t get_u64(const std::uint8_t* ptr) noexcept
+{
+    return get_primitive<std::uint64_t, endian::little>(ptr);
+}
+
+// `operator new` doesn't respect extended alignment before C++17, the
+// original pointer is stored right before the aligned block
+inline void* allocate_cache_aligned(const std::size_t size)
+{
+    const auto raw = ::operator new(size + cache_line_size);
+    const auto addr =
+        (reinterpret_cast<std::uintptr_t>(raw) + cache_line_size)
+        & ~static_cast<std::uintptr_t>(cache_line_size - 1);
+    reinterpret_cast<void**>(addr)[-1] = raw;
+    return reinterpret_cast<void*>(addr);
+}
+
+inline void deallocate_cache_aligned(void* ptr) noexcept
+{
+    if(ptr)
+    {
+        ::operator delete(static_cast<void**>(ptr)[-1]);
+    }
+}
+
+// base for types with `padded_position` members, makes them safe to allocate
+// dynamically in all standard versions
+struct cache_aligned_allocation
+{
+    static void* operator new(const std::size_t size)
+    {
+        return allocate_cache_aligned(size);
+    }
+
+    static void* operator new[](const std::size_t size)
+    {
+        return allocate_cache_aligned(size);
+    }
+
+    static void operator delete(void* ptr) noexcept
+    {
+        deallocate_cache_aligned(ptr);
+    }
+
+    static void operator delete[](void* ptr) noexcept
+    {
+        deallocate_cache_aligned(ptr);
+    }
+};
+
+#if defined(__linux__)
+// reads the default huge page size from `/proc/meminfo`, returns 0 if it's
+// not available
+inline std::size_t get_huge_page_size() noexcept
+{
+    static const std::size_t size = []() -> std::size_t
+    {
+        std::size_t res{};
+        auto file = std::fopen("/proc/meminfo", "r");
+        if(!file)
+        {
+            return res;
+        }
+
+        char line[128];
+        while(std::fgets(line, sizeof(line), file))
+        {
+            unsigned long kb{};
+            if(std::sscanf(line, "Hugepagesize: %lu kB", &kb) == 1)
+            {
+                res = static_cast<std::size_t>(kb) * 1024;
+                break;
+            }
+        }
+        std::fclose(file);
+        return res;
+    }();
+
+    return size;
+}
+
+inline std::size_t get_page_size() noexcept
+{
+    return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+inline std::size_t round_up(const std::size_t size, const std::size_t n)
+{
+    return ((size + n - 1) / n) * n;
+}
+
+// uses raw syscall to avoid libnuma dependency
+inline bool bind_to_numa_node(
+    void* addr, const std::size_t size, const int node) noexcept
+{
+#    if defined(SYS_mbind)
+    constexpr int mpol_bind = 2;
+    constexpr std::size_t bits_per_word = 8 * sizeof(unsigned long);
+    constexpr std::size_t max_nodes = 1024;
+    if((node < 0) || (static_cast<std::size_t>(node) >= max_nodes))
+    {
+        return false;
+    }
+
+    unsigned long mask[max_nodes / bits_per_word]{};
+    mask[node / bits_per_word] = 1UL << (node % bits_per_word);
+    return ::syscall(SYS_mbind, addr, size, mpol_bind, mask, max_nodes + 1, 0)
+           == 0;
+#    else
+    (void)addr;
+    (void)size;
+    (void)node;
+    return false;
+#    endif
+}
+
+inline bool advise_huge_pages(void* addr, const std::size_t size) noexcept
+{
+#    if defined(MADV_HUGEPAGE)
+    return ::madvise(addr, size, MADV_HUGEPAGE) == 0;
+#    else
+    (void)addr;
+    (void)size;
+    return false;
+#    endif
+}
+
+inline void prefault(void* addr, const std::size_t size) noexcept
+{
+    const auto page_size = get_page_size();
+    auto ptr = static_cast<volatile std::uint8_t*>(addr);
+    for(std::size_t offset = 0; offset < size; offset += page_size)
+    {
+        ptr[offset] = 0;
+    }
+}
+
+[[noreturn]] inline void throw_system_error(const char* what)
+{
+    throw std::system_error{errno, std::system_category(), what};
+}
+
+// used on error paths where `errno` must be reported
+inline void close_preserving_errno(const int fd) noexcept
+{
+    const auto error = errno;
+    ::close(fd);
+    errno = error;
+}
+
+// owns file descriptor
+class unique_fd
+{
+public:
+    unique_fd() = default;
+
+    explicit unique_fd(const int fd) noexcept : fd{fd}
+    {
+    }
+
+    unique_fd(const unique_fd&) = delete;
+    unique_fd& operator=(const unique_fd&) = delete;
+
+    unique_fd(unique_fd&& other) noexcept : fd{other.release()}
+    {
+    }
+
+    unique_fd& operator=(unique_fd&& other) noexcept
+    {
+        reset(other.release());
+        return *this;
+    }
+
+    ~unique_fd()
+    {
+        reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return fd != -1;
+    }
+
+    int get() const noexcept
+    {
+        return fd;
+    }
+
+    int release() noexcept
+    {
+        const auto res = fd;
+        fd = -1;
+        return res;
+    }
+
+    // preserves `errno` so it can be used while handling errors
+    void reset(const int new_fd = -1) noexcept
+    {
+        if(fd != -1)
+        {
+            close_preserving_errno(fd);
+        }
+        fd = new_fd;
+    }
+
+private:
+    int fd{-1};
+};
+
+// owns read-only shared mapping of the whole file, empty file is not mapped
+class read_only_mapping
+{
+public:
+    read_only_mapping() = default;
+
+    // throws `std::system_error` if file cannot be opened or mapped
+    explicit read_only_mapping(const std::string& path)
+    {
+        const unique_fd fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+        if(!fd)
+        {
+            throw_system_error("open");
+        }
+        struct stat st;
+        if(::fstat(fd.get(), &st) == -1)
+        {
+            throw_system_error("fstat");
+        }
+        const auto file_size = static_cast<std::size_t>(st.st_size);
+        if(!file_size)
+        {
+            return;
+        }
+        const auto addr =
+            ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd.get(), 0);
+        if(addr == MAP_FAILED)
+        {
+            throw_system_error("mmap");
+        }
+        ptr = static_cast<const std::uint8_t*>(addr);
+        mapping_size = file_size;
+    }
+
+    read_only_mapping(const read_only_mapping&) = delete;
+    read_only_mapping& operator=(const read_only_mapping&) = delete;
+
+    read_only_mapping(read_only_mapping&& other) noexcept
+        : ptr{other.ptr}, mapping_size{other.mapping_size}
+    {
+        other.ptr = nullptr;
+        other.mapping_size = 0;
+    }
+
+    read_only_mapping& operator=(read_only_mapping&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            std::swap(ptr, other.ptr);
+            std::swap(mapping_size, other.mapping_size);
+        }
+        return *this;
+    }
+
+    ~read_only_mapping()
+    {
+        reset();
+    }
+
+    const std::uint8_t* data() const noexcept
+    {
+        return ptr;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return mapping_size;
+    }
+
+    void reset() noexcept
+    {
+        if(ptr)
+        {
+            ::munmap(const_cast<std::uint8_t*>(ptr), mapping_size);
+            ptr = nullptr;
+            mapping_size = 0;
+        }
+    }
+
+private:
+    const std::uint8_t* ptr{};
+    std::size_t mapping_size{};
+};
+#endif
+} // namespace detail
+
+/**
+ * @brief Owns a large memory buffer allocated according to `memory_options`.
+ *
+ * On Linux memory is mapped directly using `mmap`, huge pages and NUMA
+ * binding are applied on the best-effort basis: if they are not available,
+ * regular memory is used, see `uses_huge_pages()` and `is_numa_bound()`. On
+ * other platforms memory is allocated using `operator new` and options are
+ * ignored. Memory is zero-initialized.
+ */
+class buffer_memory
+{
+public:
+    //! @brief Constructs an empty buffer
+    buffer_memory() = default;
+
+    /**
+     * @brief Allocates buffer
+     *
+     * @param size buffer size
+     * @param options allocation options
+     * @throws std::system_error or std::bad_alloc if memory cannot be
+     *  allocated
+     */
+    explicit buffer_memory(
+        const std::size_t size, const memory_options& options = {})
+        : buffer_size{size}
+    {
+        if(size)
+        {
+            allocate(options);
+        }
+    }
+
+    buffer_memory(const buffer_memory&) = delete;
+    buffer_memory& operator=(const buffer_memory&) = delete;
+
+    //! @brief Move constructor, `other` is left empty
+    buffer_memory(buffer_memory&& other) noexcept
+    {
+        swap(other);
+    }
+
+    //! @brief Move assignment, `other` is left empty
+    buffer_memory& operator=(buffer_memory&& other) noexcept
+    {
+        buffer_memory tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~buffer_memory()
+    {
+        deallocate();
+    }
+
+    //! @brief Swaps two buffers
+    void swap(buffer_memory& other) noexcept
+    {
+        std::swap(ptr, other.ptr);
+        std::swap(buffer_size, other.buffer_size);
+        std::swap(mapped_size, other.mapped_size);
+        std::swap(hugetlb, other.hugetlb);
+        std::swap(numa_bound, other.numa_bound);
+    }
+
+    //! @brief Returns buffer start
+    std::uint8_t* data() noexcept
+    {
+        return ptr;
+    }
+
+    //! @brief Returns buffer start
+    const std::uint8_t* data() const noexcept
+    {
+        return ptr;
+    }
+
+    //! @brief Returns buffer size
+    std::size_t size() const noexcept
+    {
+        return buffer_size;
+    }
+
+    //! @brief Checks whether buffer is allocated from the reserved huge pages
+    //!  pool. Transparent huge pages are not reported.
+    bool uses_huge_pages() const noexcept
+    {
+        return hugetlb;
+    }
+
+    //! @brief Checks whether buffer is bound to the requested NUMA node
+    bool is_numa_bound() const noexcept
+    {
+        return numa_bound;
+    }
+
+private:
+    std::uint8_t* ptr{};
+    std::size_t buffer_size{};
+    std::size_t mapped_size{};
+    bool hugetlb{};
+    bool numa_bound{};
+
+#if defined(__linux__)
+    void allocate(const memory_options& options)
+    {
+        void* addr = MAP_FAILED;
+        const auto huge_page_size = detail::get_huge_page_size();
+        if((options.pages == huge_pages::preferred) && huge_page_size)
+        {
+            mapped_size = detail::round_up(buffer_size, huge_page_size);
+            addr = ::mmap(
+                nullptr,
+                mapped_size,
+                PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                -1,
+                0);
+            hugetlb = (addr != MAP_FAILED);
+        }
+
+        if(addr == MAP_FAILED)
+        {
+            mapped_size =
+                detail::round_up(buffer_size, detail::get_page_size());
+            addr = ::mmap(
+                nullptr,
+                mapped_size,
+                PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS,
+                -1,
+                0);
+            if(addr == MAP_FAILED)
+            {
+                detail::throw_system_error("mmap");
+            }
+            if(options.pages != huge_pages::disabled)
+            {
+                detail::advise_huge_pages(addr, mapped_size);
+            }
+        }
+        ptr = static_cast<std::uint8_t*>(addr);
+
+        if(options.numa_node >= 0)
+        {
+            numa_bound =
+                detail::bind_to_numa_node(addr, mapped_size, options.numa_node);
+        }
+        if(options.prefault)
+        {
+            detail::prefault(addr, mapped_size);
+        }
+    }
+
+    void deallocate() noexcept
+    {
+        if(ptr)
+        {
+            ::munmap(ptr, mapped_size);
+        }
+    }
+#else
+    void allocate(const memory_options&)
+    {
+        ptr = static_cast<std::uint8_t*>(::operator new(buffer_size));
+        std::memset(ptr, 0, buffer_size);
+    }
+
+    void deallocate() noexcept
+    {
+        ::operator delete(ptr);
+    }
+#endif
+};
+} // namespace sbepp
@@ -0,0 +1,464 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file packet_batcher.hpp
+ * @brief Contains `sbepp::packet_batcher` which packs encoded messages into
+ *  MTU-sized packets
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__)
+#    include <sys/socket.h>
+#    include <sys/uio.h>
+#endif
+
+namespace sbepp
+{
+/**
+ * @brief Size of the optional packet header.
+ *
+ * Packet header layout (little-endian):
+ * - `sequenceNumber`, `uint64`
+ * - `messageCount`, `uint16`
+ */
+constexpr std::size_t packet_header_size = 10;
+
+/**
+ * @brief Size of the length prefix which precedes each message in a packet.
+ *  Contains little-endian `uint16` message size, prefix is not included.
+ */
+constexpr std::size_t packet_message_prefix_size = 2;
+
+//! @brief Decoded packet header
+struct packet_header
+{
+    //! @brief Packet sequence number
+    std::uint64_t sequence_number;
+    //! @brief Number of messages in packet
+    std::uint16_t message_count;
+};
+
+/**
+ * @brief Reads packet header
+ *
+ * @param ptr packet start
+ * @return decoded header
+ * @pre `ptr` points to at least `packet_header_size` bytes
+ */
+template<typename Byte>
+SBEPP_CPP20_CONSTEXPR packet_header read_packet_header(Byte* ptr) noexcept
+{
+    return {
+        detail::get_primitive<std::uint64_t, endian::little>(ptr),
+        detail::get_primitive<std::uint16_t, endian::little>(ptr + 8)};
+}
+
+/**
+ * @brief Calls `f(ptr, size)` for each message in a packet produced by
+ *  `packet_batcher`
+ *
+ * @param ptr packet start
+ * @param size packet size
+ * @param has_header whether packet starts with a header
+ * @param f callback, receives message pointer and size
+ * @return `false` if packet is truncated or malformed, `true` otherwise.
+ *  Messages preceding the malformed one are still passed to `f`.
+ */
+template<typename Byte, typename F>
+bool for_each_packet_message(
+    Byte* ptr, const std::size_t size, const bool has_header, F&& f)
+{
+    static_assert(sizeof(Byte) == 1, "Byte must represent a single byte");
+
+    std::size_t offset{};
+    std::size_t count{};
+    std::size_t expected_count{};
+    if(has_header)
+    {
+        if(size < packet_header_size)
+        {
+            return false;
+        }
+        expected_count = read_packet_header(ptr).message_count;
+        offset = packet_header_size;
+    }
+
+    while(offset != size)
+    {
+        if((size - offset) < packet_message_prefix_size)
+        {
+            return false;
+        }
+        const std::size_t message_size =
+            detail::get_primitive<std::uint16_t, endian::little>(ptr + offset);
+        offset += packet_message_prefix_size;
+        if((size - offset) < message_size)
+        {
+            return false;
+        }
+        f(ptr + offset, message_size);
+        offset += message_size;
+        count++;
+    }
+
+    return !has_header || (count == expected_count);
+}
+
+//! @brief `packet_batcher` options
+struct packet_batcher_options
+{
+    /**
+     * @brief Maximum packet size, including packet header. The default one
+     *  fits into a single Ethernet frame with IPv4 and UDP headers. Must not
+     *  exceed `65535`.
+     */
+    std::size_t mtu{1472};
+    //! @brief Number of completed packets that can be held until they are
+    //!  released
+    std::size_t max_packets{64};
+    //! @brief Whether packets start with a header, see `packet_header_size`
+    bool use_packet_header{};
+    //! @brief Sequence number of the first packet
+    std::uint64_t first_sequence_number{};
+    /**
+     * @brief Maximum time a non-empty packet can be kept open before
+     *  `packet_batcher::poll()` closes it. Zero disables time-based flushing.
+     */
+    std::chrono::nanoseconds max_delay{};
+    //! @brief Packets memory allocation options
+    memory_options memory;
+};
+
+/**
+ * @brief Packs encoded messages into packets up to a configured MTU.
+ *
+ * Each message is preceded by a 2-byte length prefix, packets optionally start
+ * with a header containing sequence number and message count. A packet is
+ * closed when the next message doesn't fit into it, on `flush()` or when it
+ * stays open longer than `packet_batcher_options::max_delay`, see `poll()`.
+ * Completed packets stay in the batcher until they are `release()`-d which
+ * allows to send them all at once, e.g. using `sendmmsg`.
+ *
+ * Messages can be either encoded in-place:
+ * ```cpp
+ * auto ptr = batcher.prepare(max_size);
+ * auto m = sbepp::make_view<schema::messages::msg1>(ptr, max_size);
+ * // fill the message
+ * batcher.commit(sbepp::size_bytes(m));
+ * ```
+ * or copied from an existing buffer using `push()`.
+ */
+class packet_batcher
+{
+public:
+    //! @brief Clock used to measure packet age
+    using clock_type = std::chrono::steady_clock;
+
+    //! @brief Constructs batcher with given options
+    explicit packet_batcher(const packet_batcher_options& options)
+        : options{options},
+          buffer{options.mtu * options.max_packets, options.memory},
+          sizes(options.max_packets),
+          sequence_number{options.first_sequence_number}
+    {
+        SBEPP_ASSERT(options.mtu <= 65535);
+        SBEPP_ASSERT(options.mtu > get_packet_overhead());
+        SBEPP_ASSERT(options.max_packets != 0);
+    }
+
+    //! @brief Returns options batcher was constructed with
+    const packet_batcher_options& get_options() const noexcept
+    {
+        return options;
+    }
+
+    //! @brief Returns the maximum message size which fits into a packet
+    std::size_t max_message_size() const noexcept
+    {
+        return options.mtu - get_packet_overhead();
+    }
+
+    /**
+     * @brief Reserves space for a message of up to `size` bytes. Closes the
+     *  current packet if there's not enough space in it.
+     *
+     * @param size maximum message size
+     * @return pointer to the reserved space or `nullptr` if message is larger
+     *  than `max_message_size()` or all packets are completed and should be
+     *  released first
+     */
+    std::uint8_t* prepare(const std::size_t size) noexcept
+    {
+        if(size > max_message_size())
+        {
+            return nullptr;
+        }
+
+        if(is_open
+           && ((options.mtu - used) < (packet_message_prefix_size + size)))
+        {
+            close_packet();
+        }
+
+        if(!is_open)
+        {
+            if(completed == options.max_packets)
+            {
+                return nullptr;
+            }
+            open_packet();
+        }
+
+        reserved = size;
+        return get_packet(completed) + used + packet_message_prefix_size;
+    }
+
+    /**
+     * @brief Commits message previously reserved by `prepare()`
+     *
+     * @param size actual message size
+     * @pre `size` is not greater than the size passed to `prepare()`
+     */
+    void commit(const std::size_t size) noexcept
+    {
+        SBEPP_ASSERT(is_open);
+        SBEPP_ASSERT(size <= reserved);
+        detail::set_primitive<endian::little>(
+            get_packet(completed) + used, static_cast<std::uint16_t>(size));
+        used += packet_message_prefix_size + size;
+        message_count++;
+        reserved = 0;
+
+        if((options.mtu - used) <= packet_message_prefix_size)
+        {
+            close_packet();
+        }
+    }
+
+    /**
+     * @brief Copies `size` bytes of encoded message into the batch
+     *
+     * @param data message data
+     * @param size message size
+     * @return `true` on success, `false` if message cannot be accepted, see
+     *  `prepare()`
+     */
+    bool push(const void* data, const std::size_t size) noexcept
+    {
+        auto ptr = prepare(size);
+        if(!ptr)
+        {
+            return false;
+        }
+        std::memcpy(ptr, data, size);
+        commit(size);
+        return true;
+    }
+
+    //! @brief Copies `sbepp::size_bytes(m)` bytes of `m` into the batch
+    template<typename Message>
+    bool push(Message m) noexcept
+    {
+        return push(sbepp::addressof(m), sbepp::size_bytes(m));
+    }
+
+    //! @brief Closes the current packet if it's not empty
+    void flush() noexcept
+    {
+        if(is_open && message_count)
+        {
+            close_packet();
+        }
+    }
+
+    /**
+     * @brief Closes the current packet if it has been open for at least
+     *  `packet_batcher_options::max_delay`. Does nothing if time-based
+     *  flushing is disabled.
+     *
+     * @param now current time
+     * @return `true` if packet was closed
+     */
+    bool poll(const clock_type::time_point now) noexcept
+    {
+        if(is_open && message_count
+           && (options.max_delay != std::chrono::nanoseconds::zero())
+           && ((now - opened_at) >= options.max_delay))
+        {
+            close_packet();
+            return true;
+        }
+        return false;
+    }
+
+    //! @brief Same as `poll(clock_type::now())`
+    bool poll() noexcept
+    {
+        return poll(clock_type::now());
+    }
+
+    //! @brief Returns the number of completed packets
+    std::size_t packet_count() const noexcept
+    {
+        return completed;
+    }
+
+    //! @brief Returns pointer to `n`-th completed packet
+    //! @pre `n < packet_count()`
+    const std::uint8_t* packet_data(const std::size_t n) const noexcept
+    {
+        SBEPP_ASSERT(n < completed);
+        return buffer.data() + n * options.mtu;
+    }
+
+    //! @brief Returns the size of `n`-th completed packet
+    //! @pre `n < packet_count()`
+    std::size_t packet_size(const std::size_t n) const noexcept
+    {
+        SBEPP_ASSERT(n < completed);
+        return sizes[n];
+    }
+
+    //! @brief Checks if there are no completed packets and the current one is
+    //!  empty
+    bool empty() const noexcept
+    {
+        return !completed && !message_count;
+    }
+
+    /**
+     * @brief Releases the first `n` completed packets, e.g. after they were
+     *  sent. The remaining packets, including the open one, are preserved.
+     *
+     * @pre `n <= packet_count()`
+     */
+    void release(const std::size_t n) noexcept
+    {
+        SBEPP_ASSERT(n <= completed);
+        if(!n)
+        {
+            return;
+        }
+
+        const auto remaining = completed - n + (is_open ? 1 : 0);
+        std::memmove(
+            buffer.data(),
+            buffer.data() + n * options.mtu,
+            remaining * options.mtu);
+        std::memmove(
+            sizes.data(),
+            sizes.data() + n,
+            (completed - n) * sizeof(std::size_t));
+        completed -= n;
+    }
+
+    //! @brief Releases all completed packets
+    void release() noexcept
+    {
+        release(completed);
+    }
+
+    //! @brief Returns the sequence number the next packet will get
+    std::uint64_t next_sequence_number() const noexcept
+    {
+        return sequence_number;
+    }
+
+private:
+    packet_batcher_options options;
+    buffer_memory buffer;
+    std::vector<std::size_t> sizes;
+    std::uint64_t sequence_number{};
+    // number of completed packets, the open one has the same index
+    std::size_t completed{};
+    // number of bytes used in the open packet
+    std::size_t used{};
+    std::size_t reserved{};
+    std::uint16_t message_count{};
+    bool is_open{};
+    clock_type::time_point opened_at{};
+
+    std::size_t get_packet_overhead() const noexcept
+    {
+        return packet_message_prefix_size
+               + (options.use_packet_header ? packet_header_size : 0);
+    }
+
+    std::uint8_t* get_packet(const std::size_t n) noexcept
+    {
+        return buffer.data() + n * options.mtu;
+    }
+
+    void open_packet() noexcept
+    {
+        is_open = true;
+        used = options.use_packet_header ? packet_header_size : 0;
+        message_count = 0;
+        if(options.max_delay != std::chrono::nanoseconds::zero())
+        {
+            opened_at = clock_type::now();
+        }
+    }
+
+    void close_packet() noexcept
+    {
+        auto packet = get_packet(completed);
+        if(options.use_packet_header)
+        {
+            detail::set_primitive<endian::little>(packet, sequence_number);
+            detail::set_primitive<endian::little>(packet + 8, message_count);
+        }
+        sequence_number++;
+        sizes[completed] = used;
+        completed++;
+        is_open = false;
+        used = 0;
+        message_count = 0;
+    }
+};
+
+#if defined(__linux__) || defined(SBEPP_DOXYGEN)
+/**
+ * @brief Prepares completed packets of `batcher` for `sendmmsg`. Only message
+ *  buffers are initialized, other fields of `mmsghdr::msg_hdr` are
+ *  zero-initialized.
+ *
+ * @param batcher packet batcher
+ * @param msgs output `mmsghdr` array
+ * @param iovs output `iovec` array, one per packet
+ * @param n size of `msgs` and `iovs`
+ * @return number of initialized entries, `min(n, batcher.packet_count())`
+ * @note available only on Linux
+ */
+inline std::size_t make_mmsghdrs(
+    const packet_batcher& batcher,
+    mmsghdr* msgs,
+    iovec* iovs,
+    const std::size_t n) noexcept
+{
+    const auto count = (std::min)(n, batcher.packet_count());
+    for(std::size_t i = 0; i != count; i++)
+    {
+        // `sendmmsg` doesn't modify message buffers
+        iovs[i].iov_base = const_cast<std::uint8_t*>(batcher.packet_data(i));
+        iovs[i].iov_len = batcher.packet_size(i);
+        msgs[i] = {};
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    return count;
+}
+#endif
+} // namespace sbepp
@@ -0,0 +1,408 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file parallel_scan.hpp
+ * @brief Contains `sbepp::work_stealing_pool` and
+ *  `sbepp::parallel_scan_journal` which processes journal chunks in parallel
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sbepp
+{
+/**
+ * @brief Executes batches of indexed tasks on a fixed set of threads.
+ *
+ * Tasks of a batch are split into contiguous ranges, one per worker. Worker
+ * takes tasks from the front of its own queue and, when it's empty, steals
+ * from the back of other workers' queues, so a worker which got cheap tasks
+ * helps the one stuck with expensive tasks. Caller thread is one of the
+ * workers.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::work_stealing_pool pool{std::thread::hardware_concurrency()};
+ * std::vector<std::uint64_t> sums(pool.concurrency());
+ * pool.run(
+ *     tasks.size(),
+ *     [&](std::size_t task, std::size_t worker)
+ *     {
+ *         sums[worker] += process(tasks[task]);
+ *     });
+ * ```
+ */
+class work_stealing_pool
+{
+public:
+    /**
+     * @brief Constructs pool
+     *
+     * @param concurrency number of workers including caller thread, zero is
+     *  treated as one
+     */
+    explicit work_stealing_pool(const std::size_t concurrency)
+    {
+        const auto n = concurrency ? concurrency : 1;
+        for(std::size_t i = 0; i != n; i++)
+        {
+            queues.emplace_back(new worker_queue);
+        }
+        for(std::size_t i = 1; i != n; i++)
+        {
+            threads.emplace_back(&work_stealing_pool::worker_loop, this, i);
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    //! @brief Stops and joins worker threads
+    ~work_stealing_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        start_cv.notify_all();
+        for(auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    //! @brief Returns the number of workers including caller thread
+    std::size_t concurrency() const noexcept
+    {
+        return queues.size();
+    }
+
+    //! @brief Returns the number of tasks taken from other workers' queues
+    std::uint64_t steals() const noexcept
+    {
+        return steal_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Calls `f(task, worker)` for each task in `[0, task_count)` and
+     *  waits until all of them are done
+     *
+     * `worker` is in `[0, concurrency())` and is unique among concurrently
+     * running tasks which makes it suitable to index per-worker state. If
+     * `f` throws, remaining tasks are still executed and the first exception
+     * is rethrown.
+     *
+     * @pre must not be called concurrently or from inside a task
+     */
+    template<typename F>
+    void run(const std::size_t task_count, F&& f)
+    {
+        if(!task_count)
+        {
+            return;
+        }
+        for(std::size_t i = 0; i != concurrency(); i++)
+        {
+            auto& q = *queues[i];
+            std::lock_guard<std::mutex> lock{q.mutex};
+            for(auto task = task_count * i / concurrency();
+                task != task_count * (i + 1) / concurrency();
+                task++)
+            {
+                q.tasks.push_back(task);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            job = std::ref(f);
+            busy = threads.size();
+            generation++;
+        }
+        start_cv.notify_all();
+        work(0);
+        std::unique_lock<std::mutex> lock{mutex};
+        done_cv.wait(
+            lock,
+            [this]
+            {
+                return !busy;
+            });
+        job = nullptr;
+        if(error)
+        {
+            std::rethrow_exception(std::move(error));
+        }
+    }
+
+private:
+    struct worker_queue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    // fields below are protected by `mutex`
+    std::function<void(std::size_t, std::size_t)> job;
+    std::uint64_t generation{};
+    std::size_t busy{};
+    bool stopping{};
+    std::exception_ptr error;
+
+    std::atomic<std::uint64_t> steal_count{};
+
+    void worker_loop(const std::size_t index)
+    {
+        std::uint64_t seen_generation{};
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                start_cv.wait(
+                    lock,
+                    [this, seen_generation]
+                    {
+                        return stopping || (generation != seen_generation);
+                    });
+                if(stopping)
+                {
+                    return;
+                }
+                seen_generation = generation;
+            }
+            work(index);
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                busy--;
+            }
+            done_cv.notify_one();
+        }
+    }
+
+    // once all queues are empty no new tasks appear in the current batch
+    void work(const std::size_t index)
+    {
+        std::size_t task{};
+        while(pop(index, task) || steal(index, task))
+        {
+            try
+            {
+                job(task, index);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    bool pop(const std::size_t index, std::size_t& task)
+    {
+        auto& q = *queues[index];
+        std::lock_guard<std::mutex> lock{q.mutex};
+        if(q.tasks.empty())
+        {
+            return false;
+        }
+        task = q.tasks.front();
+        q.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(const std::size_t index, std::size_t& task)
+    {
+        for(std::size_t i = 1; i != concurrency(); i++)
+        {
+            auto& q = *queues[(index + i) % concurrency()];
+            std::lock_guard<std::mutex> lock{q.mutex};
+            if(!q.tasks.empty())
+            {
+                task = q.tasks.back();
+                q.tasks.pop_back();
+                steal_count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+//! @brief Range of journal messages
+struct journal_range
+{
+    //! Offset of the first message
+    std::size_t begin;
+    //! Offset past the last message
+    std::size_t end;
+};
+
+/**
+ * @brief Splits journal of messages of the same type into ranges of whole
+ *  messages
+ *
+ * Journal messages are not framed so a message boundary can't be found from
+ * an arbitrary offset. Instead, requested split points are moved forward to
+ * the nearest message boundary by walking message sizes which is much
+ * cheaper than processing messages. Ranges from `sbepp::journal_index_view`
+ * chunks can be used directly instead.
+ *
+ * @tparam Message message view template
+ * @param journal journal start
+ * @param size journal size
+ * @param chunk_size approximate range size, range is closed after the
+ *  message which makes it at least that large
+ * @return ranges which cover the journal except trailing incomplete message
+ */
+template<template<typename> class Message>
+std::vector<journal_range> split_journal(
+    const void* journal, const std::size_t size, const std::size_t chunk_size)
+{
+    const auto data = static_cast<const std::uint8_t*>(journal);
+    std::vector<journal_range> res;
+    journal_range range{};
+    while(range.end != size)
+    {
+        const auto checked = sbepp::size_bytes_checked(
+            sbepp::make_const_view<Message>(
+                data + range.end, size - range.end),
+            size - range.end);
+        if(!checked.valid)
+        {
+            break;
+        }
+        range.end += checked.size;
+        if((range.end - range.begin) >= chunk_size)
+        {
+            res.push_back(range);
+            range.begin = range.end;
+        }
+    }
+    if(range.end != range.begin)
+    {
+        res.push_back(range);
+    }
+    return res;
+}
+
+namespace detail
+{
+// each worker updates its reducer on every message, keeping reducers in
+// separate cache lines avoids false sharing between workers
+template<typename Reducer>
+struct alignas(cache_line_size) padded_reducer : cache_aligned_allocation
+{
+    Reducer value;
+};
+} // namespace detail
+
+/**
+ * @brief Processes journal ranges in parallel using per-worker reducers
+ *
+ * Each worker gets its own copy of `init` placed in a separate cache line,
+ * `f(reducer, message)` is called for each message with the reducer of the
+ * worker which processes its range. After all ranges are done, reducers of
+ * other workers are combined into the first worker's one via
+ * `merge(result, reducer)` in worker order. Since ranges are distributed
+ * between workers dynamically, `f` and `merge` should form an order-
+ * independent reduction and `init` must be its identity value, e.g. zero for
+ * a sum, because it's merged once per worker.
+ *
+ * Example:
+ * ```cpp
+ * const auto ranges = sbepp::split_journal<schema::messages::trade>(
+ *     journal, size, 0x100000);
+ * const auto volume = sbepp::parallel_scan_journal<schema::messages::trade>(
+ *     pool, journal, ranges, std::uint64_t{},
+ *     [](std::uint64_t& sum, schema::messages::trade<const std::uint8_t> m)
+ *     {
+ *         sum += *m.quantity();
+ *     },
+ *     [](std::uint64_t& res, const std::uint64_t& sum)
+ *     {
+ *         res += sum;
+ *     });
+ * ```
+ *
+ * @tparam Message message view template
+ * @param pool pool to run on
+ * @param journal journal start
+ * @param ranges message ranges
+ * @param init identity reducer value, `Reducer` must be
+ *  default-constructible and copy-assignable
+ * @param f callback, receives `Reducer&` and `Message<const std::uint8_t>`
+ * @param merge callback, receives `Reducer&` result and `const Reducer&`
+ *  worker's reducer
+ * @return merged reducer
+ */
+template<
+    template<typename>
+    class Message,
+    typename Reducer,
+    typename F,
+    typename Merge>
+Reducer parallel_scan_journal(
+    work_stealing_pool& pool,
+    const void* journal,
+    const std::vector<journal_range>& ranges,
+    const Reducer& init,
+    F&& f,
+    Merge&& merge)
+{
+    const auto data = static_cast<const std::uint8_t*>(journal);
+    const auto n = pool.concurrency();
+    std::unique_ptr<detail::padded_reducer<Reducer>[]> reducers{
+        new detail::padded_reducer<Reducer>[n]};
+    for(std::size_t i = 0; i != n; i++)
+    {
+        reducers[i].value = init;
+    }
+    pool.run(
+        ranges.size(),
+        [data, &ranges, &reducers, &f](
+            const std::size_t task, const std::size_t worker)
+        {
+            auto& reducer = reducers[worker].value;
+            auto offset = ranges[task].begin;
+            const auto end = ranges[task].end;
+            while(offset != end)
+            {
+                const auto m = sbepp::make_const_view<Message>(
+                    data + offset, end - offset);
+                f(reducer, m);
+                offset += sbepp::size_bytes(m);
+            }
+        });
+
+    auto& res = reducers[0].value;
+    for(std::size_t i = 1; i != n; i++)
+    {
+        merge(res, static_cast<const Reducer&>(reducers[i].value));
+    }
+    return std::move(res);
+}
+} // namespace sbepp
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file reorder.hpp
+ * @brief Contains `sbepp::template_id_reorderer` which groups batch messages
+ *  by `templateId`
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sbepp
+{
+//! @brief Message stored by `sbepp::template_id_reorderer`
+struct reordered_message
+{
+    //! Message start
+    const std::uint8_t* data;
+    //! Buffer size
+    std::size_t size;
+    //! Message `templateId`
+    message_id_t template_id;
+};
+
+/**
+ * @brief Groups messages of a batch by `templateId` so each handler can be
+ *  invoked over all messages of its type at once.
+ *
+ * Dispatching interleaved message types in arrival order constantly switches
+ * between handlers which is unfriendly to instruction cache and branch
+ * predictor. Reorderer peeks `templateId` from the message header and buckets
+ * messages using a stable counting sort: order of messages with the same
+ * `templateId` is preserved, order across different types is not. Use it only
+ * for handlers which don't depend on that order.
+ *
+ * Memory is reused between batches, reorderer doesn't own messages.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::template_id_reorderer<schema::schema> reorderer;
+ * sbepp::for_each_packet_message(
+ *     packet, size, true,
+ *     [&](const std::uint8_t* ptr, std::size_t size)
+ *     {
+ *         reorderer.push(ptr, size);
+ *     });
+ * reorderer.for_each<schema::schema::messages::msg1>(handle_msg1);
+ * reorderer.for_each<schema::schema::messages::msg2>(handle_msg2);
+ * reorderer.clear();
+ * ```
+ *
+ * @tparam SchemaTag schema tag, used to read message header
+ */
+template<typename SchemaTag>
+class template_id_reorderer
+{
+public:
+    /**
+     * @brief Constructs reorderer
+     *
+     * @param max_template_id maximum `templateId` which gets its own bucket,
+     *  memory is proportional to it. Messages with larger `templateId` are
+     *  placed into a common bucket after all other ones.
+     */
+    explicit template_id_reorderer(const message_id_t max_template_id = 255)
+        : counts(static_cast<std::size_t>(max_template_id) + 2),
+          offsets(counts.size() + 1),
+          positions(counts.size())
+    {
+    }
+
+    //! @brief Returns maximum `templateId` which gets its own bucket
+    message_id_t max_template_id() const noexcept
+    {
+        return static_cast<message_id_t>(counts.size() - 2);
+    }
+
+    /**
+     * @brief Adds message to the batch
+     *
+     * @param data message start
+     * @param size buffer size
+     * @return `false` if buffer is too small for the message header, such
+     *  message is not added
+     */
+    bool push(const void* data, const std::size_t size)
+    {
+        if(size < header_size())
+        {
+            return false;
+        }
+        const auto ptr = static_cast<const std::uint8_t*>(data);
+        messages.emplace_back();
+        auto& m = messages.back();
+        m.data = ptr;
+        m.size = size;
+        m.template_id =
+            static_cast<message_id_t>(*header_type{ptr, size}.templateId());
+        counts[bucket_of(m.template_id)]++;
+        is_sorted = false;
+
+        return true;
+    }
+
+    //! @brief Returns the number of messages in the batch
+    std::size_t size() const noexcept
+    {
+        return messages.size();
+    }
+
+    //! @brief Checks whether the batch is empty
+    bool empty() const noexcept
+    {
+        return messages.empty();
+    }
+
+    //! @brief Removes all messages
+    void clear() noexcept
+    {
+        messages.clear();
+        sorted.clear();
+        std::fill(counts.begin(), counts.end(), 0);
+        is_sorted = false;
+    }
+
+    /**
+     * @brief Calls `f(view)` for each message with `MessageTag`'s
+     *  `templateId`, in arrival order
+     *
+     * @tparam MessageTag message tag
+     * @param f callback, receives
+     *  `message_traits<MessageTag>::value_type<const std::uint8_t>`
+     * @return the number of handled messages
+     * @pre `message_traits<MessageTag>::id() <= max_template_id()`
+     */
+    template<typename MessageTag, typename F>
+    std::size_t for_each(F&& f)
+    {
+        using message_type = typename sbepp::message_traits<
+            MessageTag>::template value_type<const std::uint8_t>;
+        SBEPP_ASSERT(
+            sbepp::message_traits<MessageTag>::id() <= max_template_id());
+        sort();
+        const auto bucket = bucket_of(sbepp::message_traits<MessageTag>::id());
+        for(auto i = offsets[bucket]; i != offsets[bucket + 1]; i++)
+        {
+            f(message_type{sorted[i].data, sorted[i].size});
+        }
+        return offsets[bucket + 1] - offsets[bucket];
+    }
+
+    /**
+     * @brief Calls `f(const reordered_message&)` for each message grouped by
+     *  `templateId` in ascending order
+     *
+     * @param f callback
+     */
+    template<typename F>
+    void for_each(F&& f)
+    {
+        sort();
+        for(const auto& m : sorted)
+        {
+            f(m);
+        }
+    }
+
+private:
+    using header_type = typename sbepp::schema_traits<
+        SchemaTag>::template header_type<const std::uint8_t>;
+
+    std::vector<reordered_message> messages;
+    std::vector<reordered_message> sorted;
+    // number of messages in each bucket
+    std::vector<std::size_t> counts;
+    // bucket boundaries in `sorted`, valid only if `is_sorted == true`
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> positions;
+    bool is_sorted{};
+
+    static constexpr std::size_t header_size() noexcept
+    {
+        return sbepp::composite_traits<typename sbepp::schema_traits<
+            SchemaTag>::header_type_tag>::size_bytes();
+    }
+
+    std::size_t bucket_of(const message_id_t template_id) const noexcept
+    {
+        return (std::min)(
+            static_cast<std::size_t>(template_id), counts.size() - 1);
+    }
+
+    void sort()
+    {
+        if(is_sorted)
+        {
+            return;
+        }
+
+        for(std::size_t i = 0; i != counts.size(); i++)
+        {
+            offsets[i + 1] = offsets[i] + counts[i];
+        }
+        std::copy(offsets.begin(), offsets.end() - 1, positions.begin());
+        sorted.resize(messages.size());
+        for(const auto& m : messages)
+        {
+            sorted[positions[bucket_of(m.template_id)]++] = m;
+        }
+        is_sorted = true;
+    }
+};
+} // namespace sbepp
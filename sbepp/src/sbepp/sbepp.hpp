@@ -11,6 +11,7 @@
 
 #include <array>
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -583,6 +584,11 @@ struct addressof_tag
     explicit addressof_tag() = default;
 };
 
+struct presence_mask_tag
+{
+    explicit presence_mask_tag() = default;
+};
+
 struct end_ptr_tag
 {
     explicit end_ptr_tag() = default;
@@ -633,6 +639,16 @@ struct visit_set_tag
     explicit visit_set_tag() = default;
 };
 
+struct enum_is_valid_tag
+{
+    explicit enum_is_valid_tag() = default;
+};
+
+struct reserved_bits_tag
+{
+    explicit reserved_bits_tag() = default;
+};
+
 template<typename T, typename U, endian E, typename View>
 SBEPP_CPP20_CONSTEXPR T
     get_value(const View view, const std::size_t offset) noexcept
@@ -1438,6 +1454,136 @@ private:
     sbepp::cursor<Byte>* cursor{};
 };
 
+template<typename Byte>
+class absolute_cursor_wrapper
+{
+public:
+    using byte_type = Byte;
+
+    template<typename T>
+    using result_type = T;
+
+    absolute_cursor_wrapper() = default;
+
+    explicit constexpr absolute_cursor_wrapper(sbepp::cursor<Byte>& cursor)
+        : cursor{&cursor}
+    {
+    }
+
+    // fields are accessed relative to the level start so consecutive reads
+    // don't depend on each other. Cursor is always moved to the end of the
+    // block, it doesn't depend on the accessed value either.
+    template<typename T, typename U, endian E, typename View>
+    SBEPP_CPP20_CONSTEXPR T get_value(
+        const View view,
+        const std::size_t /*offset*/,
+        const std::size_t absolute_offset) noexcept
+    {
+        SBEPP_SIZE_CHECK(
+            view(addressof_tag{}),
+            view(end_ptr_tag{}),
+            absolute_offset,
+            sizeof(U));
+        T res{get_primitive<U, E>(view(addressof_tag{}) + absolute_offset)};
+        move_to_block_end(view);
+        return res;
+    }
+
+    template<endian E, typename T, typename View>
+    SBEPP_CPP20_CONSTEXPR void set_value(
+        const View view,
+        const std::size_t /*offset*/,
+        const std::size_t absolute_offset,
+        const T value) noexcept
+    {
+        SBEPP_SIZE_CHECK(
+            view(addressof_tag{}),
+            view(end_ptr_tag{}),
+            absolute_offset,
+            sizeof(T));
+        set_primitive<E>(view(addressof_tag{}) + absolute_offset, value);
+        move_to_block_end(view);
+    }
+
+    template<typename T, typename U, endian E, typename View>
+    SBEPP_CPP20_CONSTEXPR T get_last_value(
+        const View view,
+        const std::size_t offset,
+        const std::size_t absolute_offset) noexcept
+    {
+        return get_value<T, U, E>(view, offset, absolute_offset);
+    }
+
+    template<endian E, typename T, typename View>
+    SBEPP_CPP20_CONSTEXPR void set_last_value(
+        const View view,
+        const std::size_t offset,
+        const std::size_t absolute_offset,
+        const T value) noexcept
+    {
+        set_value<E>(view, offset, absolute_offset, value);
+    }
+
+    template<typename Res, typename View>
+    SBEPP_CPP20_CONSTEXPR Res get_static_field_view(
+        const View view,
+        const std::size_t /*offset*/,
+        const std::size_t absolute_offset) noexcept
+    {
+        SBEPP_SIZE_CHECK(
+            view(addressof_tag{}), view(end_ptr_tag{}), absolute_offset, 0);
+        move_to_block_end(view);
+        return {view(addressof_tag{}) + absolute_offset, view(end_ptr_tag{})};
+    }
+
+    template<typename Res, typename View>
+    SBEPP_CPP20_CONSTEXPR Res get_last_static_field_view(
+        const View view,
+        const std::size_t offset,
+        const std::size_t absolute_offset) noexcept
+    {
+        return get_static_field_view<Res>(view, offset, absolute_offset);
+    }
+
+    template<typename ResView, typename View>
+    SBEPP_CPP20_CONSTEXPR ResView get_first_group_view(const View view) noexcept
+    {
+        return cursor->template get_first_group_view<ResView>(view);
+    }
+
+    template<typename ResView, typename View>
+    SBEPP_CPP20_CONSTEXPR ResView get_first_data_view(const View view) noexcept
+    {
+        return cursor->template get_first_data_view<ResView>(view);
+    }
+
+    template<typename ResView, typename View, typename Getter>
+    SBEPP_CPP20_CONSTEXPR ResView
+        get_group_view(const View view, Getter&& getter) noexcept
+    {
+        return cursor->template get_group_view<ResView>(
+            view, std::forward<Getter>(getter));
+    }
+
+    template<typename ResView, typename View, typename Getter>
+    SBEPP_CPP20_CONSTEXPR ResView
+        get_data_view(const View view, Getter&& getter) noexcept
+    {
+        return cursor->template get_data_view<ResView>(
+            view, std::forward<Getter>(getter));
+    }
+
+private:
+    sbepp::cursor<Byte>* cursor{};
+
+    template<typename View>
+    SBEPP_CPP14_CONSTEXPR void move_to_block_end(const View view) noexcept
+    {
+        cursor->pointer() =
+            view(get_level_tag{}) + view(get_block_length_tag{});
+    }
+};
+
 template<typename Cursor, typename T>
 using cursor_result_type_t =
     typename remove_reference_t<Cursor>::template result_type<T>;
@@ -1486,6 +1632,43 @@ constexpr std::size_t size_bytes(T v, cursor<Byte> c) noexcept
     return v(detail::size_bytes_tag{}, c);
 }
 
+/**
+ * @brief Returns a bitmask of non-null optional fields of message/group entry
+ *
+ * Each optional field, except arrays and composites, has its own bit,
+ * available as `sbepp::field_traits::presence_bit()`. Bits are assigned in
+ * schema order starting from 0. The mask is computed for all fields at once
+ * without branches so it's cheaper than checking each `has_value()` separately
+ * when only a few of many optional fields are set. Like `null_value()` of
+ * floating-point types, any NaN is treated as null. Available only for levels
+ * with at most 64 optional fields.
+ *
+ * Example:
+ * ```cpp
+ * auto mask = sbepp::presence_mask(msg);
+ * while(mask)
+ * {
+ *     const auto bit = std::countr_zero(mask);
+ *     mask &= mask - 1;
+ *     switch(bit)
+ *     {
+ *     case sbepp::field_traits<msg_tag::field1>::presence_bit():
+ *         handle(*msg.field1());
+ *         break;
+ *     // ...
+ *     }
+ * }
+ * ```
+ *
+ * @param v message/group entry view
+ * @return bitmask of present optional fields
+ */
+template<typename T>
+constexpr std::uint64_t presence_mask(T v) noexcept
+{
+    return v(detail::presence_mask_tag{});
+}
+
 /**
  * @brief Returns the header of a message/group
  *
@@ -1618,6 +1801,40 @@ constexpr detail::skip_cursor_wrapper<Byte> skip(cursor<Byte>& c) noexcept
 {
     return detail::skip_cursor_wrapper<Byte>{c};
 }
+
+/**
+ * @brief Returns a wrapper which accesses fields using their offset from the
+ *  start of the message/entry instead of the cursor position.
+ *
+ * Normal cursor reads field at the cursor position and then moves the cursor
+ * past it so each field read depends on the previous one. With this wrapper,
+ * field reads are independent from each other and the cursor, any subset of
+ * fields can be accessed in any order. After a field access, the cursor is
+ * moved to the end of the block so it can be used for the following `group`
+ * or `data` member. Groups and data are accessed as with the original cursor.
+ * Example:
+ * ```cpp
+ * schema::messages::msg1<char> m{ptr, size};
+ * auto c = sbepp::init_cursor(m);
+ * auto field2 = m.field2(sbepp::cursor_ops::absolute(c));
+ * auto field1 = m.field1(sbepp::cursor_ops::absolute(c));
+ * for(const auto entry : m.group(c).cursor_range(c))
+ * {
+ *     // cursor is moved to the next entry
+ *     entry.field(sbepp::cursor_ops::absolute(c));
+ * }
+ * auto d = m.data(c);
+ * ```
+ *
+ * @param c original cursor
+ * @return unspecified cursor wrapper
+ */
+template<typename Byte>
+constexpr detail::absolute_cursor_wrapper<Byte>
+    absolute(cursor<Byte>& c) noexcept
+{
+    return detail::absolute_cursor_wrapper<Byte>{c};
+}
 } // namespace cursor_ops
 
 namespace detail
@@ -2410,13 +2627,29 @@ public:
 
     SBEPP_CPP20_CONSTEXPR std::size_t operator()(size_bytes_tag) const noexcept
     {
-        std::size_t size{sbepp::size_bytes((*this)(get_header_tag{}))};
-        for(const auto entry : *this)
+        // entries are walked directly because iterator increment computes
+        // entry size too, doing it twice per level is exponential in nesting
+        // depth
+        const auto dimension = (*this)(get_header_tag{});
+        const auto block_length = dimension.blockLength().value();
+        const auto num_in_group = dimension.numInGroup().value();
+        const auto end = (*this)(end_ptr_tag{});
+        const auto begin = (*this)(addressof_tag{});
+        auto ptr = begin + sbepp::size_bytes(dimension);
+        for(size_type i = 0; i != num_in_group; i++)
         {
-            size += sbepp::size_bytes(entry);
+#if SBEPP_SIZE_CHECKS_ENABLED
+            const Entry entry{ptr, end, block_length};
+#else
+            const Entry entry{ptr, nullptr, block_length};
+#endif
+            const auto entry_size = sbepp::size_bytes(entry);
+            SBEPP_SIZE_CHECK(ptr, end, 0, entry_size);
+            ptr += entry_size;
         }
+        (void)end;
 
-        return size;
+        return static_cast<std::size_t>(ptr - begin);
     }
 
     //! @brief Returns header's `numInGroup`
@@ -3546,6 +3779,27 @@ public:
 private:
     value_type val{Derived::null_value()};
 };
+
+template<typename T>
+constexpr bool is_not_null(const T t, std::false_type) noexcept
+{
+    return t.has_value();
+}
+
+template<typename T>
+bool is_not_null(const T t, std::true_type) noexcept
+{
+    return !std::isnan(*t);
+}
+
+// `has_value()` compares with `null_value()` which never works for
+// floating-point types because their null value is NaN
+//! @brief Checks if optional value is not null, treats any NaN as null
+template<typename T>
+constexpr bool is_not_null(const T t) noexcept
+{
+    return is_not_null(t, std::is_floating_point<typename T::value_type>{});
+}
 } // namespace detail
 
 /**
@@ -3931,6 +4185,8 @@ public:
      */
     template<typename Byte>
     using value_type = MessageType<Byte>;
+    //! @brief Schema tag
+    using schema_tag = SchemaTag;
 };
 #endif
 
@@ -3964,6 +4220,9 @@ public:
     static constexpr field_presence presence() noexcept;
     //! Returns actual offset
     static constexpr offset_t offset() noexcept;
+    //! @brief Returns field's bit in `sbepp::presence_mask()`. Available only
+    //!  for optional non-array, non-composite fields
+    static constexpr std::size_t presence_bit() noexcept;
     //! @brief Returns `addedSince` attribute
     static constexpr version_t since_version() noexcept;
     //! @brief Returns `deprecated` attribute. Available only if provided in
@@ -4106,10 +4365,12 @@ public:
                                                                       \
     /** @brief Built-in `NAME` optional type */                       \
     /** Also works as a tag for its traits */                         \
-    class NAME##_opt_t : public detail::optional_base<TYPE, NAME##_t> \
+    class NAME##_opt_t                                                \
+        : public detail::optional_base<TYPE, NAME##_opt_t>            \
     {                                                                 \
     public:                                                           \
-        using detail::optional_base<TYPE, NAME##_t>::optional_base;   \
+        using detail::optional_base<TYPE,                             \
+                                    NAME##_opt_t>::optional_base;     \
                                                                       \
         /** @brief Returns `minValue` attribute */                    \
         static constexpr value_type min_value() noexcept              \
@@ -4615,6 +4876,32 @@ constexpr auto visit_set(const Set s, Visitor&& visitor) noexcept
     return s(detail::visit_set_tag{}, std::forward<Visitor>(visitor));
 }
 
+/**
+ * @brief Checks whether enum holds one of the values listed in schema
+ *
+ * @param e enum to check
+ * @returns `true` if `e` is a known enumerator, `false` otherwise
+ */
+template<typename E>
+constexpr auto enum_is_valid(const E e) noexcept
+    -> decltype(tag_invoke(detail::enum_is_valid_tag{}, e))
+{
+    return tag_invoke(detail::enum_is_valid_tag{}, e);
+}
+
+/**
+ * @brief Checks whether set has bits which don't correspond to any choice
+ *
+ * @param s set to check
+ * @returns `true` if any reserved bit is set, `false` otherwise
+ */
+template<typename Set>
+constexpr auto set_has_reserved_bits(const Set s) noexcept
+    -> decltype(s(detail::reserved_bits_tag{}))
+{
+    return s(detail::reserved_bits_tag{});
+}
+
 namespace detail
 {
 template<typename Derived>
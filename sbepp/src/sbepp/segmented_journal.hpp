@@ -0,0 +1,770 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file segmented_journal.hpp
+ * @brief Contains `sbepp::segmented_journal_writer` which writes messages
+ *  into preallocated segment files and `sbepp::segmented_journal_reader`.
+ *  Available only on Linux.
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <dirent.h>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+#if defined(__linux__) || defined(SBEPP_DOXYGEN)
+//! @brief Options for `sbepp::segmented_journal_writer`
+struct segmented_journal_options
+{
+    //! @brief Segment file size including its header, file space is
+    //!     allocated upfront
+    std::size_t segment_size{0x4000000};
+    //! @brief Maximum number of segment files in directory, the oldest ones
+    //!     are removed when a new segment is created. `0` means no limit.
+    std::size_t max_segments{};
+    //! @brief Schema id stored in segment header
+    schema_id_t schema_id{};
+    //! @brief Schema version stored in segment header
+    version_t schema_version{};
+    //! @brief Whether the next segment is created, mapped and prefaulted by
+    //!     a background thread, otherwise it's created by `claim()` which
+    //!     switches segments
+    bool prepare_in_background{true};
+};
+
+//! @brief Segment header
+struct journal_segment_header
+{
+    //! Schema id
+    schema_id_t schema_id;
+    //! Schema version
+    version_t schema_version;
+    //! Sequence number of the first segment message
+    std::uint64_t first_sequence;
+    //! Segment file size
+    std::uint64_t segment_size;
+};
+
+namespace detail
+{
+// segment layout, all values are little-endian:
+//  header: magic, format version(u32), reserved(u32), schema_id(u32),
+//      reserved(u32), schema_version, first_sequence, segment_size, padding
+//      up to `journal_segment_header_size`
+//  records: message size(u32) followed by message bytes, zero size or the
+//      end of file marks the end of records
+constexpr std::uint64_t journal_segment_magic = 0x4745535050454253; // SBEPPSEG
+constexpr std::uint32_t journal_segment_version = 1;
+constexpr std::size_t journal_segment_header_size = 64;
+constexpr std::size_t journal_record_prefix_size = 4;
+constexpr const char* journal_segment_extension = ".sbeseg";
+// 20 digits of the first sequence + extension
+constexpr std::size_t journal_segment_name_size = 27;
+// the next segment is prepared under this name and renamed when it's used
+constexpr const char* journal_next_segment_name = "next.sbeseg.tmp";
+
+inline std::string make_journal_segment_path(
+    const std::string& directory, const std::uint64_t first_sequence)
+{
+    char name[journal_segment_name_size + 1];
+    std::snprintf(
+        name,
+        sizeof(name),
+        "%020" PRIu64 "%s",
+        first_sequence,
+        journal_segment_extension);
+    return directory + '/' + name;
+}
+
+inline bool is_journal_segment_name(const char* name) noexcept
+{
+    if(std::strlen(name) != journal_segment_name_size)
+    {
+        return false;
+    }
+    for(std::size_t i = 0; i != 20; i++)
+    {
+        if((name[i] < '0') || (name[i] > '9'))
+        {
+            return false;
+        }
+    }
+    return !std::strcmp(name + 20, journal_segment_extension);
+}
+} // namespace detail
+
+/**
+ * @brief Returns paths of segment files in `directory` ordered by their first
+ *  sequence number
+ *
+ * @throws std::system_error if directory cannot be opened
+ */
+inline std::vector<std::string>
+    list_journal_segments(const std::string& directory)
+{
+    const auto dir = ::opendir(directory.c_str());
+    if(!dir)
+    {
+        detail::throw_system_error("opendir");
+    }
+    std::vector<std::string> res;
+    while(const auto entry = ::readdir(dir))
+    {
+        if(detail::is_journal_segment_name(entry->d_name))
+        {
+            res.push_back(directory + '/' + entry->d_name);
+        }
+    }
+    ::closedir(dir);
+    // names have fixed width so lexicographical order is sequence order
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+/**
+ * @brief Read-only memory-mapped journal segment.
+ *
+ * Messages are passed to the client as pointers into the mapping, they are
+ * valid while segment is alive.
+ */
+class journal_segment
+{
+public:
+    //! @brief Constructs an empty segment
+    journal_segment() = default;
+
+    /**
+     * @brief Maps segment file
+     *
+     * @param path segment file path
+     * @throws std::system_error if file cannot be opened or mapped
+     * @throws std::runtime_error if file is not a valid segment
+     */
+    explicit journal_segment(const std::string& path) : mapping{path}
+    {
+        if(mapping.size() < detail::journal_segment_header_size)
+        {
+            throw std::runtime_error{"journal_segment: file is too small"};
+        }
+        const auto data = mapping.data();
+        if((detail::get_u64(data) != detail::journal_segment_magic)
+           || (detail::get_primitive<std::uint32_t, endian::little>(data + 8)
+               != detail::journal_segment_version))
+        {
+            throw std::runtime_error{"journal_segment: invalid header"};
+        }
+        segment_header.schema_id =
+            detail::get_primitive<std::uint32_t, endian::little>(data + 16);
+        segment_header.schema_version = detail::get_u64(data + 24);
+        segment_header.first_sequence = detail::get_u64(data + 32);
+        segment_header.segment_size = detail::get_u64(data + 40);
+    }
+
+    journal_segment(const journal_segment&) = delete;
+    journal_segment& operator=(const journal_segment&) = delete;
+
+    //! @brief Move constructor, `other` is left empty
+    journal_segment(journal_segment&&) = default;
+
+    //! @brief Move assignment, `other` is left empty
+    journal_segment& operator=(journal_segment&&) = default;
+
+    //! @brief Checks whether segment is mapped
+    explicit operator bool() const noexcept
+    {
+        return mapping.data() != nullptr;
+    }
+
+    //! @brief Returns segment header
+    const journal_segment_header& header() const noexcept
+    {
+        return segment_header;
+    }
+
+    /**
+     * @brief Calls `f(sequence, data, size)` for each segment message
+     *
+     * Truncated record at the end of segment is ignored.
+     *
+     * @param f callback, receives `std::uint64_t` sequence number,
+     *  `const std::uint8_t*` message start and `std::size_t` message size
+     * @return the number of messages
+     */
+    template<typename F>
+    std::uint64_t for_each(F&& f) const
+    {
+        const auto data = mapping.data();
+        const auto size = mapping.size();
+        auto sequence = segment_header.first_sequence;
+        auto offset = detail::journal_segment_header_size;
+        while(detail::journal_record_prefix_size <= (size - offset))
+        {
+            const auto message_size = static_cast<std::size_t>(
+                detail::get_primitive<std::uint32_t, endian::little>(
+                    data + offset));
+            offset += detail::journal_record_prefix_size;
+            if(!message_size || (message_size > (size - offset)))
+            {
+                break;
+            }
+            f(sequence, data + offset, message_size);
+            offset += message_size;
+            sequence++;
+        }
+        return sequence - segment_header.first_sequence;
+    }
+
+private:
+    detail::read_only_mapping mapping;
+    journal_segment_header segment_header{};
+};
+
+/**
+ * @brief Reads messages from a sequence of journal segments.
+ *
+ * Segments are mapped one at a time, messages are passed as zero-copy
+ * pointers into the mapping.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::segmented_journal_reader reader{"/var/journal"};
+ * reader.for_each(
+ *     [](std::uint64_t sequence, const std::uint8_t* data, std::size_t size)
+ *     {
+ *         handle(sbepp::make_const_view<schema::messages::msg1>(data, size));
+ *     });
+ * ```
+ */
+class segmented_journal_reader
+{
+public:
+    /**
+     * @brief Constructs reader over segments currently present in
+     *  `directory`
+     *
+     * @throws std::system_error if directory cannot be opened
+     */
+    explicit segmented_journal_reader(const std::string& directory)
+        : paths{list_journal_segments(directory)}
+    {
+    }
+
+    //! @brief Returns the number of segments
+    std::size_t segment_count() const noexcept
+    {
+        return paths.size();
+    }
+
+    //! @brief Returns segment file path
+    const std::string& segment_path(const std::size_t index) const noexcept
+    {
+        SBEPP_ASSERT(index < segment_count());
+        return paths[index];
+    }
+
+    /**
+     * @brief Maps segment
+     *
+     * @throws see `journal_segment::journal_segment()`
+     */
+    journal_segment open_segment(const std::size_t index) const
+    {
+        return journal_segment{segment_path(index)};
+    }
+
+    /**
+     * @brief Calls `f(sequence, data, size)` for each message of all
+     *  segments in sequence order. Message pointers are valid only during the
+     *  call.
+     *
+     * @return the number of messages
+     * @throws see `journal_segment::journal_segment()`
+     */
+    template<typename F>
+    std::uint64_t for_each(F&& f) const
+    {
+        std::uint64_t res{};
+        for(std::size_t i = 0; i != segment_count(); i++)
+        {
+            res += open_segment(i).for_each(f);
+        }
+        return res;
+    }
+
+private:
+    std::vector<std::string> paths;
+};
+
+/**
+ * @brief Writes messages into fixed-size preallocated segment files.
+ *
+ * Growing a single file costs a block allocation and metadata update from
+ * time to time which shows up as write latency spikes. Writer instead
+ * allocates the whole segment upfront using `fallocate`, maps it and copies
+ * messages into the mapping. Each segment starts with a header containing
+ * schema id and version and the sequence number of its first message,
+ * segment file name is derived from that sequence number. When
+ * `max_segments` is set, the oldest segments are removed after a new one is
+ * created.
+ *
+ * By default, a background thread creates, maps and prefaults the next
+ * segment under a temporary name while the current one is written. It also
+ * unmaps full segments and removes the oldest ones. Writing a message has no
+ * system calls, switching to the next segment costs a `rename` and a mutex
+ * lock. If the next segment is not prepared yet, `claim()` waits for it.
+ * There are still costs outside writer's control: when the kernel writes
+ * dirty pages back, it write-protects them again so the next write to such
+ * page takes a minor fault, and the prefaulted segment is not locked in
+ * memory. Without `prepare_in_background`, `claim()` creates the next
+ * segment itself. This means `open`, `fallocate` and `mmap` calls, and a
+ * page fault on the first write to each page.
+ *
+ * Writer always starts a new segment, sequence numbers continue after the
+ * last message of existing segments in directory. Writes become durable
+ * after `sync()` or when the kernel flushes the mapping.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::segmented_journal_writer writer{"/var/journal", options};
+ * auto data = writer.claim(max_message_size);
+ * auto m = sbepp::make_view<schema::messages::msg1>(data, max_message_size);
+ * // fill message
+ * writer.commit(sbepp::size_bytes(m));
+ * ```
+ */
+class segmented_journal_writer
+{
+public:
+    /**
+     * @brief Constructs writer and creates the first segment
+     *
+     * @param directory existing directory for segment files
+     * @param options writer options
+     * @throws std::invalid_argument if `segment_size` is too small or
+     *  `max_segments` is `1`
+     * @throws std::system_error if segment cannot be created
+     * @throws std::runtime_error if directory contains an invalid segment
+     */
+    explicit segmented_journal_writer(
+        std::string directory, const segmented_journal_options& options = {})
+        : dir{std::move(directory)}, opts(options)
+    {
+        if(opts.segment_size
+           <= (detail::journal_segment_header_size
+               + detail::journal_record_prefix_size))
+        {
+            throw std::invalid_argument{
+                "segmented_journal_writer: segment_size is too small"};
+        }
+        if(opts.max_segments == 1)
+        {
+            // the only segment would be removed together with its data
+            throw std::invalid_argument{
+                "segmented_journal_writer: max_segments must not be 1"};
+        }
+        for(auto& path : list_journal_segments(dir))
+        {
+            segments.push_back(std::move(path));
+        }
+        if(!segments.empty())
+        {
+            journal_segment last{segments.back()};
+            const auto count = last.for_each(
+                [](std::uint64_t, const std::uint8_t*, std::size_t)
+                {
+                });
+            sequence = last.header().first_sequence + count;
+            if(!count)
+            {
+                // new segment gets the same name
+                ::unlink(segments.back().c_str());
+                segments.pop_back();
+            }
+        }
+        // left by a writer which was not destroyed properly
+        ::unlink(next_segment_path().c_str());
+        if(opts.prepare_in_background)
+        {
+            const auto path =
+                detail::make_journal_segment_path(dir, sequence);
+            auto addr = map_new_segment(path);
+            detail::prefault(addr, opts.segment_size);
+            start_segment(addr, path);
+            // removed by `preparer`
+            remove_old_segments(segments.size());
+            preparer =
+                std::thread{&segmented_journal_writer::prepare_segments, this};
+        }
+        else
+        {
+            open_segment();
+        }
+    }
+
+    segmented_journal_writer(const segmented_journal_writer&) = delete;
+    segmented_journal_writer& operator=(const segmented_journal_writer&) =
+        delete;
+
+    ~segmented_journal_writer()
+    {
+        if(preparer.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                stopping = true;
+            }
+            cv.notify_all();
+            preparer.join();
+            if(retired)
+            {
+                ::munmap(retired, opts.segment_size);
+            }
+            for(const auto& path : removed)
+            {
+                ::unlink(path.c_str());
+            }
+            if(prepared)
+            {
+                ::munmap(prepared, opts.segment_size);
+                ::unlink(next_segment_path().c_str());
+            }
+        }
+        close_segment();
+    }
+
+    //! @brief Returns sequence number of the next message
+    std::uint64_t next_sequence() const noexcept
+    {
+        return sequence;
+    }
+
+    //! @brief Returns the number of segments in directory
+    std::size_t segment_count() const noexcept
+    {
+        return segments.size();
+    }
+
+    //! @brief Returns the maximum message size which fits into a segment
+    std::size_t max_message_size() const noexcept
+    {
+        return opts.segment_size - detail::journal_segment_header_size
+               - detail::journal_record_prefix_size;
+    }
+
+    /**
+     * @brief Returns space for the next message, switches to the next
+     *  segment if there's not enough space in the current one
+     *
+     * @param max_size maximum message size
+     * @return pointer to at least `max_size` bytes
+     * @throws std::length_error if `max_size > max_message_size()`
+     * @throws std::system_error if next segment cannot be created
+     */
+    std::uint8_t* claim(const std::size_t max_size)
+    {
+        if(max_size > max_message_size())
+        {
+            throw std::length_error{
+                "segmented_journal_writer: message is too large"};
+        }
+        if((detail::journal_record_prefix_size + max_size)
+           > (opts.segment_size - offset))
+        {
+            if(opts.prepare_in_background)
+            {
+                switch_to_prepared_segment();
+            }
+            else
+            {
+                close_segment();
+                open_segment();
+            }
+        }
+        return data + offset + detail::journal_record_prefix_size;
+    }
+
+    /**
+     * @brief Commits message written to the space returned by the last
+     *  `claim()`
+     *
+     * @param size actual message size
+     * @return message sequence number
+     * @pre `0 < size <= max_size` passed to the last `claim()`
+     */
+    std::uint64_t commit(const std::size_t size) noexcept
+    {
+        SBEPP_ASSERT(size);
+        SBEPP_ASSERT(
+            (detail::journal_record_prefix_size + size)
+            <= (opts.segment_size - offset));
+        detail::set_primitive<endian::little>(
+            data + offset, static_cast<std::uint32_t>(size));
+        offset += detail::journal_record_prefix_size + size;
+        return sequence++;
+    }
+
+    /**
+     * @brief Copies and commits message
+     *
+     * @return message sequence number
+     * @throws see `claim()`
+     */
+    std::uint64_t append(const void* message, const std::size_t size)
+    {
+        std::memcpy(claim(size), message, size);
+        return commit(size);
+    }
+
+    /**
+     * @brief Synchronously flushes written part of the current segment to
+     *  disk
+     *
+     * @throws std::system_error on failure
+     */
+    void sync()
+    {
+        if(::msync(data, offset, MS_SYNC) == -1)
+        {
+            detail::throw_system_error("msync");
+        }
+    }
+
+private:
+    std::string dir;
+    segmented_journal_options opts;
+    std::deque<std::string> segments;
+    std::uint8_t* data{};
+    std::size_t offset{};
+    std::uint64_t sequence{};
+    // state shared with `preparer`, guarded by `mutex`
+    std::mutex mutex;
+    std::condition_variable cv;
+    // mapped and prefaulted segment at `next_segment_path()`
+    std::uint8_t* prepared{};
+    // error of the last preparation, rethrown by `claim()`
+    std::exception_ptr error;
+    // full segment to unmap
+    std::uint8_t* retired{};
+    // segment files to remove
+    std::vector<std::string> removed;
+    bool stopping{};
+    std::thread preparer;
+
+    std::string next_segment_path() const
+    {
+        return dir + '/' + detail::journal_next_segment_name;
+    }
+
+    void open_segment()
+    {
+        const auto path = detail::make_journal_segment_path(dir, sequence);
+        start_segment(map_new_segment(path), path);
+        remove_old_segments(segments.size());
+        for(const auto& old_path : removed)
+        {
+            ::unlink(old_path.c_str());
+        }
+        removed.clear();
+    }
+
+    // makes segments beyond `max_segments` limit pending for removal
+    void remove_old_segments(std::size_t count)
+    {
+        while(opts.max_segments && (count > opts.max_segments))
+        {
+            removed.push_back(std::move(segments.front()));
+            segments.pop_front();
+            count--;
+        }
+    }
+
+    void start_segment(std::uint8_t* addr, const std::string& path)
+    {
+        data = addr;
+        offset = detail::journal_segment_header_size;
+        write_header();
+        segments.push_back(path);
+    }
+
+    void switch_to_prepared_segment()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait(
+            lock,
+            [this]
+            {
+                return prepared || error;
+            });
+        if(error)
+        {
+            // preparation is retried on the next `claim()`
+            const auto e = error;
+            error = nullptr;
+            cv.notify_all();
+            std::rethrow_exception(e);
+        }
+        const auto path = detail::make_journal_segment_path(dir, sequence);
+        if(::rename(next_segment_path().c_str(), path.c_str()) == -1)
+        {
+            detail::throw_system_error("rename");
+        }
+        retired = data;
+        const auto next = prepared;
+        prepared = nullptr;
+        // `segments` is accessed only by this thread, the new segment is
+        // added after unlocking
+        remove_old_segments(segments.size() + 1);
+        lock.unlock();
+        cv.notify_all();
+
+        start_segment(next, path);
+    }
+
+    // runs in `preparer` thread
+    void prepare_segments()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        while(true)
+        {
+            cv.wait(
+                lock,
+                [this]
+                {
+                    return stopping || retired || !removed.empty()
+                           || (!prepared && !error);
+                });
+            if(stopping)
+            {
+                return;
+            }
+            const auto to_unmap = retired;
+            retired = nullptr;
+            auto to_remove = std::move(removed);
+            removed.clear();
+            const auto prepare = !prepared && !error;
+            lock.unlock();
+
+            if(to_unmap)
+            {
+                ::munmap(to_unmap, opts.segment_size);
+            }
+            for(const auto& path : to_remove)
+            {
+                ::unlink(path.c_str());
+            }
+            std::uint8_t* next{};
+            std::exception_ptr next_error;
+            if(prepare)
+            {
+                try
+                {
+                    next = map_new_segment(next_segment_path());
+                    detail::prefault(next, opts.segment_size);
+                }
+                catch(...)
+                {
+                    next_error = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if(prepare)
+            {
+                prepared = next;
+                error = next_error;
+                cv.notify_all();
+            }
+        }
+    }
+
+    // creates, allocates and maps segment file
+    std::uint8_t* map_new_segment(const std::string& path) const
+    {
+        const detail::unique_fd fd{::open(
+            path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644)};
+        if(!fd)
+        {
+            detail::throw_system_error("open");
+        }
+        const auto size = static_cast<off_t>(opts.segment_size);
+        // not every file system supports `fallocate`, file is still usable
+        // but its blocks are allocated on first write
+        if((::fallocate(fd.get(), 0, 0, size) == -1)
+           && ((errno != EOPNOTSUPP) || (::ftruncate(fd.get(), size) == -1)))
+        {
+            const auto error = errno;
+            ::unlink(path.c_str());
+            errno = error;
+            detail::throw_system_error("fallocate");
+        }
+        const auto addr = ::mmap(
+            nullptr,
+            opts.segment_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            fd.get(),
+            0);
+        if(addr == MAP_FAILED)
+        {
+            const auto error = errno;
+            ::unlink(path.c_str());
+            errno = error;
+            detail::throw_system_error("mmap");
+        }
+        return static_cast<std::uint8_t*>(addr);
+    }
+
+    void close_segment() noexcept
+    {
+        if(data)
+        {
+            ::munmap(data, opts.segment_size);
+            data = nullptr;
+        }
+    }
+
+    void write_header() noexcept
+    {
+        std::memset(data, 0, detail::journal_segment_header_size);
+        detail::set_primitive<endian::little>(
+            data, detail::journal_segment_magic);
+        detail::set_primitive<endian::little>(
+            data + 8, detail::journal_segment_version);
+        detail::set_primitive<endian::little>(data + 16, opts.schema_id);
+        detail::set_primitive<endian::little>(
+            data + 24, static_cast<std::uint64_t>(opts.schema_version));
+        detail::set_primitive<endian::little>(data + 32, sequence);
+        detail::set_primitive<endian::little>(
+            data + 40, static_cast<std::uint64_t>(opts.segment_size));
+    }
+};
+#endif
+} // namespace sbepp
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file sharding_router.hpp
+ * @brief Contains `sbepp::sharding_router` which partitions messages by key
+ *  between per-core queues
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace sbepp
+{
+namespace detail
+{
+// splitmix64 finalizer, `std::hash` is an identity for integers in common
+// implementations which gives poor distribution for sequential keys
+inline std::uint64_t mix_shard_hash(std::uint64_t h) noexcept
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111eb;
+    h ^= h >> 31;
+    return h;
+}
+} // namespace detail
+
+//! @brief Reference to a message passed by `sbepp::sharding_router`
+struct routed_message
+{
+    //! Message start
+    const std::uint8_t* data;
+    //! Message size
+    std::size_t size;
+};
+
+/**
+ * @brief Bounded lock-free single-producer single-consumer queue
+ *
+ * @tparam T element type, must be default-constructible and copyable
+ */
+template<typename T>
+class spsc_queue : public detail::cache_aligned_allocation
+{
+public:
+    /**
+     * @brief Constructs queue
+     *
+     * @param min_capacity minimum capacity, rounded up to the power of two
+     */
+    explicit spsc_queue(const std::size_t min_capacity)
+        : items(detail::round_up_to_power_of_two((std::max)(
+            min_capacity, static_cast<std::size_t>(1))))
+    {
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    //! @brief Returns queue capacity
+    std::size_t capacity() const noexcept
+    {
+        return items.size();
+    }
+
+    //! @brief Returns the number of elements, can be called from any thread
+    std::size_t size() const noexcept
+    {
+        // `tail` is loaded first, it never overtakes the later `head`
+        const auto position = tail.value.load(std::memory_order_acquire);
+        return static_cast<std::size_t>(
+            head.value.load(std::memory_order_acquire) - position);
+    }
+
+    //! @brief Checks whether queue is empty, can be called from any thread
+    bool empty() const noexcept
+    {
+        return !size();
+    }
+
+    /**
+     * @brief Pushes element, must be called only from producer thread
+     *
+     * @return `false` if queue is full
+     */
+    bool try_push(T value)
+    {
+        const auto position = head.value.load(std::memory_order_relaxed);
+        if((position - head.cached) == capacity())
+        {
+            head.cached = tail.value.load(std::memory_order_acquire);
+            if((position - head.cached) == capacity())
+            {
+                return false;
+            }
+        }
+        items[index_of(position)] = std::move(value);
+        head.value.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pops available elements, must be called only from consumer
+     *  thread
+     *
+     * Each element is reset to `T{}` right after `f` returns.
+     *
+     * @param f callback, receives `T&`
+     * @param max_count maximum number of elements to pop
+     * @return the number of popped elements
+     */
+    template<typename F>
+    std::size_t poll(
+        F&& f,
+        const std::size_t max_count = (std::numeric_limits<std::size_t>::max)())
+    {
+        const auto position = tail.value.load(std::memory_order_relaxed);
+        if(position == tail.cached)
+        {
+            tail.cached = head.value.load(std::memory_order_acquire);
+        }
+        const auto n = static_cast<std::size_t>(
+            (std::min)(tail.cached - position, std::uint64_t{max_count}));
+        for(std::size_t i = 0; i != n; i++)
+        {
+            auto& item = items[index_of(position + i)];
+            f(item);
+            // releases resources held by element, e.g. `shared_message`'s
+            // slab, instead of waiting until producer overwrites it
+            item = T{};
+        }
+        tail.value.store(position + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<T> items;
+    // written by producer, `cached` is producer's copy of `tail`
+    padded_position head;
+    // written by consumer, `cached` is consumer's copy of `head`
+    padded_position tail;
+
+    std::size_t index_of(const std::uint64_t position) const noexcept
+    {
+        return static_cast<std::size_t>(position) & (capacity() - 1);
+    }
+};
+
+/**
+ * @brief Partitions messages by key between per-shard queues.
+ *
+ * Each message is passed to the queue selected by its key hash so messages
+ * with the same key always land in the same queue and are processed by a
+ * single consumer in the order they were routed. Router doesn't copy
+ * messages, `T` is a reference to the message memory, e.g.
+ * `sbepp::routed_message` which points into a receive buffer or
+ * `sbepp::shared_message` with `sbepp::atomic_ref_count` which keeps a
+ * receive slab alive. In the former case, client must keep the buffer intact
+ * until all consumers processed its messages.
+ *
+ * Routing must be done from a single thread, each shard queue must be
+ * polled from a single thread.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::sharding_router<> router{number_of_cores, 4096};
+ *
+ * // receiver thread
+ * sbepp::try_route_message<schema::messages::trade>(
+ *     router, data, size,
+ *     [](schema::messages::trade<const std::uint8_t> m)
+ *     {
+ *         return *m.securityId();
+ *     });
+ *
+ * // consumer thread `i`
+ * router.shard(i).poll(
+ *     [](const sbepp::routed_message& msg)
+ *     {
+ *         handle(sbepp::make_const_view<schema::messages::trade>(
+ *             msg.data, msg.size));
+ *     });
+ * ```
+ *
+ * @tparam T element type
+ */
+template<typename T = routed_message>
+class sharding_router
+{
+public:
+    //! @brief Shard queue type
+    using queue_type = spsc_queue<T>;
+
+    /**
+     * @brief Constructs router
+     *
+     * @param shards number of shards
+     * @param queue_capacity minimum capacity of each shard queue
+     * @throws std::invalid_argument if `shards` is zero
+     */
+    sharding_router(const std::size_t shards, const std::size_t queue_capacity)
+    {
+        if(!shards)
+        {
+            throw std::invalid_argument{"sharding_router: no shards"};
+        }
+        for(std::size_t i = 0; i != shards; i++)
+        {
+            queues.emplace_back(new queue_type{queue_capacity});
+        }
+    }
+
+    //! @brief Returns the number of shards
+    std::size_t shards() const noexcept
+    {
+        return queues.size();
+    }
+
+    //! @brief Returns shard queue
+    queue_type& shard(const std::size_t index) noexcept
+    {
+        SBEPP_ASSERT(index < shards());
+        return *queues[index];
+    }
+
+    //! @brief Returns shard index for the given key
+    template<typename Key>
+    std::size_t shard_of(const Key& key) const noexcept
+    {
+        const auto h = detail::mix_shard_hash(std::hash<Key>{}(key));
+        return static_cast<std::size_t>(h % queues.size());
+    }
+
+    /**
+     * @brief Pushes element to the queue of the key's shard
+     *
+     * @return `false` if queue is full, client decides whether to retry or
+     *  drop the message. To preserve per-key order, the same message must be
+     *  retried before routing the next one with the same key.
+     */
+    template<typename Key>
+    bool try_route(const Key& key, T value)
+    {
+        if(shard(shard_of(key)).try_push(std::move(value)))
+        {
+            return true;
+        }
+        stalls_count++;
+        return false;
+    }
+
+    //! @brief Returns the number of failed `try_route()` calls
+    std::uint64_t stalls() const noexcept
+    {
+        return stalls_count;
+    }
+
+private:
+    std::vector<std::unique_ptr<queue_type>> queues;
+    std::uint64_t stalls_count{};
+};
+
+/**
+ * @brief Routes message by the key extracted from its view
+ *
+ * @tparam Message message template
+ * @param router router
+ * @param data message start
+ * @param size message size
+ * @param get_key callback, receives `Message<const std::uint8_t>` and
+ *  returns hashable key, usually the value of a generated field accessor
+ * @return `false` if shard queue is full
+ */
+template<template<typename> class Message, typename KeyFn>
+bool try_route_message(
+    sharding_router<routed_message>& router,
+    const void* data,
+    const std::size_t size,
+    KeyFn&& get_key)
+{
+    const auto ptr = static_cast<const std::uint8_t*>(data);
+    return router.try_route(
+        get_key(sbepp::make_const_view<Message>(ptr, size)),
+        routed_message{ptr, size});
+}
+} // namespace sbepp
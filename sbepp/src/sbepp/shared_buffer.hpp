@@ -0,0 +1,343 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file shared_buffer.hpp
+ * @brief Contains `sbepp::buffer_slab`, a reference-counted buffer, and
+ *  `sbepp::shared_message` which keeps it alive
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sbepp
+{
+/**
+ * @brief Non-atomic reference counter. Slabs that use it must not be shared
+ *  between threads.
+ */
+class local_ref_count
+{
+public:
+    //! @brief Increments counter
+    void add() noexcept
+    {
+        count++;
+    }
+
+    //! @brief Decrements counter, returns `true` if it reached zero
+    bool release() noexcept
+    {
+        return --count == 0;
+    }
+
+    //! @brief Returns current value
+    std::size_t get() const noexcept
+    {
+        return count;
+    }
+
+private:
+    std::size_t count{1};
+};
+
+//! @brief Atomic reference counter, allows to share slabs between threads
+class atomic_ref_count
+{
+public:
+    //! @brief Increments counter
+    void add() noexcept
+    {
+        // new reference is always created from an existing one so no
+        // synchronization is needed
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! @brief Decrements counter, returns `true` if it reached zero
+    bool release() noexcept
+    {
+        // makes all writes to the buffer visible to the thread which frees it
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    //! @brief Returns current value
+    std::size_t get() const noexcept
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::size_t> count{1};
+};
+
+/**
+ * @brief Reference-counted byte buffer.
+ *
+ * Counter and data are stored in a single allocation. Copying a slab adds a
+ * reference, the buffer is freed when the last one is gone. Typical use is to
+ * receive a packet into a slab and hand out `shared_message`-s for each
+ * message inside it without copying them.
+ *
+ * Counter kind is chosen at compile time per slab type rather than switched
+ * at runtime when a reference crosses threads: slabs which never leave the
+ * receiving thread use a plain increment, slabs whose messages are passed to
+ * other threads (e.g. via `sbepp::sharding_router`) pay for atomic
+ * operations on every copy. Runtime switching would require each copy to
+ * check the owning thread, which costs about as much as the uncontended
+ * atomic increment it tries to avoid.
+ *
+ * @tparam RefCount either `local_ref_count` or `atomic_ref_count`. Use the
+ *  latter only when references are destroyed on different threads.
+ */
+template<typename RefCount = local_ref_count>
+class buffer_slab
+{
+public:
+    //! @brief Reference counter type
+    using ref_count_type = RefCount;
+
+    //! @brief Constructs an empty slab
+    buffer_slab() = default;
+
+    /**
+     * @brief Allocates a new slab
+     *
+     * @param size buffer size
+     * @throws std::bad_alloc if memory cannot be allocated
+     */
+    explicit buffer_slab(const std::size_t size)
+        : control{new(::operator new(data_offset + size)) control_block{size}}
+    {
+    }
+
+    //! @brief Adds a reference
+    buffer_slab(const buffer_slab& other) noexcept : control{other.control}
+    {
+        if(control)
+        {
+            control->ref_count.add();
+        }
+    }
+
+    //! @brief Takes `other`'s reference, `other` is left empty
+    buffer_slab(buffer_slab&& other) noexcept : control{other.control}
+    {
+        other.control = nullptr;
+    }
+
+    //! @brief Releases the current reference and adds a reference to `other`
+    buffer_slab& operator=(const buffer_slab& other) noexcept
+    {
+        buffer_slab tmp{other};
+        swap(tmp);
+        return *this;
+    }
+
+    //! @brief Releases the current reference and takes `other`'s one
+    buffer_slab& operator=(buffer_slab&& other) noexcept
+    {
+        buffer_slab tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    //! @brief Releases reference
+    ~buffer_slab()
+    {
+        reset();
+    }
+
+    //! @brief Swaps two slabs
+    void swap(buffer_slab& other) noexcept
+    {
+        std::swap(control, other.control);
+    }
+
+    //! @brief Releases reference, slab becomes empty
+    void reset() noexcept
+    {
+        if(control && control->ref_count.release())
+        {
+            destroy(control);
+        }
+        control = nullptr;
+    }
+
+    //! @brief Returns buffer start or `nullptr` for an empty slab
+    std::uint8_t* data() const noexcept
+    {
+        return control ? reinterpret_cast<std::uint8_t*>(control) + data_offset
+                       : nullptr;
+    }
+
+    //! @brief Returns buffer size
+    std::size_t size() const noexcept
+    {
+        return control ? control->size : 0;
+    }
+
+    //! @brief Returns the number of references, `0` for an empty slab
+    std::size_t use_count() const noexcept
+    {
+        return control ? control->ref_count.get() : 0;
+    }
+
+    //! @brief Checks whether slab is not empty
+    explicit operator bool() const noexcept
+    {
+        return control != nullptr;
+    }
+
+private:
+    struct control_block
+    {
+        explicit control_block(const std::size_t size) noexcept : size{size}
+        {
+        }
+
+        std::size_t size;
+        RefCount ref_count;
+    };
+
+    // data is aligned as if it was allocated by `operator new`
+    static constexpr std::size_t data_offset =
+        ((sizeof(control_block) + alignof(std::max_align_t) - 1)
+         / alignof(std::max_align_t))
+        * alignof(std::max_align_t);
+
+    control_block* control{};
+
+    // kept out of line so the rarely taken branch doesn't bloat copies and
+    // GCC doesn't see deallocation next to the counter accesses it can't
+    // reason about, otherwise it reports false-positive use-after-free
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((noinline))
+#endif
+    static void destroy(control_block* block) noexcept
+    {
+        block->~control_block();
+        ::operator delete(block);
+    }
+};
+
+template<typename RefCount>
+constexpr std::size_t buffer_slab<RefCount>::data_offset;
+
+/**
+ * @brief Message view which keeps its buffer slab alive.
+ *
+ * Unlike a plain view, it can be safely passed to another thread or stored
+ * for later processing, all the messages that share the same slab are freed
+ * together.
+ *
+ * @tparam View message view type, e.g. `schema::messages::msg1<const
+ *  std::uint8_t>`
+ * @tparam RefCount slab reference counter type
+ */
+template<typename View, typename RefCount = local_ref_count>
+class shared_message
+{
+public:
+    //! @brief View type
+    using view_type = View;
+    //! @brief Slab type
+    using slab_type = buffer_slab<RefCount>;
+
+    //! @brief Constructs an empty shared message
+    shared_message() = default;
+
+    /**
+     * @brief Constructs shared message from a slab and a view which points
+     *  into it
+     *
+     * @pre `view` points into `slab`
+     */
+    shared_message(slab_type slab, View view) noexcept
+        : slab{std::move(slab)}, view{view}
+    {
+        SBEPP_ASSERT(
+            (sbepp::addressof(view) >= this->slab.data())
+            && (sbepp::addressof(view)
+                <= (this->slab.data() + this->slab.size())));
+    }
+
+    //! @brief Returns message view
+    View get() const noexcept
+    {
+        return view;
+    }
+
+    //! @brief Returns message view
+    View operator*() const noexcept
+    {
+        return view;
+    }
+
+    //! @brief Provides access to the view's members
+    const View* operator->() const noexcept
+    {
+        return &view;
+    }
+
+    //! @brief Returns slab which keeps message alive
+    const slab_type& get_slab() const noexcept
+    {
+        return slab;
+    }
+
+    //! @brief Releases slab reference
+    void reset() noexcept
+    {
+        slab.reset();
+        view = {};
+    }
+
+    //! @brief Checks whether message is not empty
+    explicit operator bool() const noexcept
+    {
+        return static_cast<bool>(slab);
+    }
+
+private:
+    slab_type slab;
+    View view;
+};
+
+/**
+ * @brief Creates read-only shared message from a slab
+ *
+ * Example:
+ * ```cpp
+ * sbepp::buffer_slab<> slab{1500};
+ * auto n = ::recv(fd, slab.data(), slab.size(), 0);
+ * auto m = sbepp::make_shared_message<schema::messages::msg1>(slab, 0, n);
+ * ```
+ *
+ * @tparam View view template
+ * @param slab buffer slab
+ * @param offset message offset within slab
+ * @param size message buffer size
+ * @return shared message which holds a new slab reference
+ * @pre `offset + size <= slab.size()`
+ */
+template<template<typename> class View, typename RefCount>
+shared_message<View<const std::uint8_t>, RefCount> make_shared_message(
+    const buffer_slab<RefCount>& slab,
+    const std::size_t offset,
+    const std::size_t size)
+{
+    SBEPP_ASSERT((offset <= slab.size()) && (size <= (slab.size() - offset)));
+    return {
+        slab,
+        sbepp::make_const_view<View>(
+            static_cast<const std::uint8_t*>(slab.data()) + offset, size)};
+}
+} // namespace sbepp
@@ -0,0 +1,543 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file snapshot.hpp
+ * @brief Contains `sbepp::snapshot_writer` which serializes state as keyed
+ *  messages and `sbepp::snapshot_file` which maps it for lazy access.
+ *  Available only on Linux.
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+#if defined(__linux__) || defined(SBEPP_DOXYGEN)
+//! @brief Options for `sbepp::snapshot_writer`
+struct snapshot_options
+{
+    //! @brief Schema id stored in snapshot header
+    schema_id_t schema_id{};
+    //! @brief Schema version stored in snapshot header
+    version_t schema_version{};
+    //! @brief Size of the write buffer
+    std::size_t buffer_size{0x100000};
+};
+
+//! @brief Snapshot header
+struct snapshot_header
+{
+    //! Schema id
+    schema_id_t schema_id;
+    //! Schema version
+    version_t schema_version;
+    //! Journal sequence number the snapshot corresponds to
+    std::uint64_t sequence;
+    //! Number of snapshot messages
+    std::uint64_t message_count;
+};
+
+//! @brief Snapshot message from `sbepp::snapshot_file`
+struct snapshot_entry
+{
+    //! Message key
+    std::uint64_t key;
+    //! Message start, points into the mapping
+    const std::uint8_t* data;
+    //! Message size
+    std::size_t size;
+};
+
+namespace detail
+{
+// snapshot layout, all values are little-endian:
+//  header: magic, format version(u32), reserved(u32), schema_id(u32),
+//      reserved(u32), schema_version, sequence, message_count, index_offset,
+//      padding up to `snapshot_header_size`
+//  messages back-to-back
+//  index: entries sorted by key, duplicates keep append order:
+//      key, offset, size(u32), reserved(u32)
+constexpr std::uint64_t snapshot_magic = 0x504E535050454253; // SBEPPSNP
+constexpr std::uint32_t snapshot_version = 1;
+constexpr std::size_t snapshot_header_size = 64;
+constexpr std::size_t snapshot_index_entry_size = 24;
+} // namespace detail
+
+/**
+ * @brief Writes snapshot file.
+ *
+ * Data is written to `<path>.tmp` which is renamed to `path` by `finish()`,
+ * so readers never see a partially written snapshot. Unfinished temporary
+ * file is removed by destructor.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::snapshot_writer writer{"/var/state/book.snapshot"};
+ * for(const auto& book : books)
+ * {
+ *     auto m = encode_book(buf, book);
+ *     writer.append(book.security_id, buf.data(), sbepp::size_bytes(m));
+ * }
+ * writer.finish(journal.next_sequence());
+ * ```
+ */
+class snapshot_writer
+{
+public:
+    /**
+     * @brief Creates temporary file
+     *
+     * @param path snapshot path
+     * @param options writer options
+     * @throws std::system_error on failure
+     */
+    explicit snapshot_writer(
+        std::string path, const snapshot_options& options = {})
+        : target{std::move(path)},
+          temp{target + ".tmp"},
+          opts(options),
+          buffer((std::max)(options.buffer_size, detail::snapshot_header_size))
+    {
+        fd.reset(::open(
+            temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        if(!fd)
+        {
+            detail::throw_system_error("open");
+        }
+        // header is written by `finish()`
+        std::memset(buffer.data(), 0, detail::snapshot_header_size);
+        buffered = detail::snapshot_header_size;
+        offset = detail::snapshot_header_size;
+    }
+
+    snapshot_writer(const snapshot_writer&) = delete;
+    snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+    //! @brief Removes temporary file if snapshot is not finished
+    ~snapshot_writer()
+    {
+        if(fd)
+        {
+            fd.reset();
+            ::unlink(temp.c_str());
+        }
+    }
+
+    //! @brief Returns the number of appended messages
+    std::size_t message_count() const noexcept
+    {
+        return index.size();
+    }
+
+    /**
+     * @brief Appends message
+     *
+     * @param key message key, `sbepp::snapshot_file` looks up messages by it
+     * @param message message start
+     * @param size message size
+     * @throws std::system_error on failure
+     * @throws std::length_error if message is larger than 4GiB
+     * @pre `finish()` is not called yet
+     */
+    void append(
+        const std::uint64_t key, const void* message, const std::size_t size)
+    {
+        SBEPP_ASSERT(fd);
+        if(size > 0xFFFFFFFFu)
+        {
+            throw std::length_error{"snapshot_writer: message is too large"};
+        }
+        index.push_back({key, offset, static_cast<std::uint32_t>(size)});
+        write(message, size);
+        offset += size;
+    }
+
+    /**
+     * @brief Appends message using `sbepp::size_bytes()` as its size
+     *
+     * @param key message key
+     * @param m message view
+     * @throws see the overload above
+     */
+    template<typename Message>
+    void append(const std::uint64_t key, const Message m)
+    {
+        append(key, sbepp::addressof(m), sbepp::size_bytes(m));
+    }
+
+    /**
+     * @brief Writes index and header, flushes file to disk, renames it to
+     *  the snapshot path and syncs the containing directory
+     *
+     * @param sequence journal sequence number the snapshot corresponds to,
+     *  replay continues from it after snapshot is loaded
+     * @throws std::system_error on failure
+     * @pre `finish()` is not called yet
+     */
+    void finish(const std::uint64_t sequence)
+    {
+        SBEPP_ASSERT(fd);
+        std::stable_sort(
+            index.begin(),
+            index.end(),
+            [](const index_entry& lhs, const index_entry& rhs)
+            {
+                return lhs.key < rhs.key;
+            });
+        for(const auto& e : index)
+        {
+            std::uint8_t entry[detail::snapshot_index_entry_size]{};
+            detail::set_primitive<endian::little>(entry, e.key);
+            detail::set_primitive<endian::little>(entry + 8, e.offset);
+            detail::set_primitive<endian::little>(entry + 16, e.size);
+            write(entry, sizeof(entry));
+        }
+        flush();
+
+        std::uint8_t header[detail::snapshot_header_size]{};
+        detail::set_primitive<endian::little>(header, detail::snapshot_magic);
+        detail::set_primitive<endian::little>(
+            header + 8, detail::snapshot_version);
+        detail::set_primitive<endian::little>(header + 16, opts.schema_id);
+        detail::set_primitive<endian::little>(
+            header + 24, static_cast<std::uint64_t>(opts.schema_version));
+        detail::set_primitive<endian::little>(header + 32, sequence);
+        detail::set_primitive<endian::little>(
+            header + 40, static_cast<std::uint64_t>(index.size()));
+        detail::set_primitive<endian::little>(header + 48, offset);
+        if(::pwrite(fd.get(), header, sizeof(header), 0)
+           != static_cast<ssize_t>(sizeof(header)))
+        {
+            detail::throw_system_error("pwrite");
+        }
+        if(::fsync(fd.get()) == -1)
+        {
+            detail::throw_system_error("fsync");
+        }
+        if(::rename(temp.c_str(), target.c_str()) == -1)
+        {
+            detail::throw_system_error("rename");
+        }
+        fd.reset();
+        sync_directory();
+    }
+
+private:
+    struct index_entry
+    {
+        std::uint64_t key;
+        std::uint64_t offset;
+        std::uint32_t size;
+    };
+
+    std::string target;
+    std::string temp;
+    snapshot_options opts;
+    std::vector<std::uint8_t> buffer;
+    std::size_t buffered{};
+    std::uint64_t offset{};
+    std::vector<index_entry> index;
+    detail::unique_fd fd;
+
+    void write(const void* data, std::size_t size)
+    {
+        auto ptr = static_cast<const std::uint8_t*>(data);
+        while(size)
+        {
+            if(buffered == buffer.size())
+            {
+                flush();
+            }
+            const auto n = (std::min)(size, buffer.size() - buffered);
+            std::memcpy(buffer.data() + buffered, ptr, n);
+            buffered += n;
+            ptr += n;
+            size -= n;
+        }
+    }
+
+    void flush()
+    {
+        std::size_t written{};
+        while(written != buffered)
+        {
+            const auto res =
+                ::write(fd.get(), buffer.data() + written, buffered - written);
+            if(res == -1)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                detail::throw_system_error("write");
+            }
+            written += static_cast<std::size_t>(res);
+        }
+        buffered = 0;
+    }
+    // makes the rename durable, otherwise it can be lost on power failure
+    void sync_directory() const
+    {
+        const auto slash = target.rfind('/');
+        // root directory keeps its slash
+        const auto dir =
+            (slash == std::string::npos)
+                ? std::string{"."}
+                : target.substr(0, (std::max)(slash, std::size_t{1}));
+        const detail::unique_fd dir_fd{
+            ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+        if(!dir_fd)
+        {
+            detail::throw_system_error("open");
+        }
+        if(::fsync(dir_fd.get()) == -1)
+        {
+            detail::throw_system_error("fsync");
+        }
+    }
+};
+
+/**
+ * @brief Read-only memory-mapped snapshot.
+ *
+ * Opening costs a single `mmap` regardless of snapshot size, pages are read
+ * on first access. Entries are sorted by key so a single entry can be found
+ * without touching the rest of the file, which allows to rebuild state
+ * lazily. Entry bounds are checked on access rather than upfront.
+ *
+ * Example:
+ * ```cpp
+ * const sbepp::snapshot_file snapshot{"/var/state/book.snapshot"};
+ * snapshot.for_each_of(
+ *     security_id,
+ *     [](const sbepp::snapshot_entry& e)
+ *     {
+ *         restore(sbepp::make_const_view<schema::messages::book>(
+ *             e.data, e.size));
+ *     });
+ * replay_journal_from(snapshot.header().sequence);
+ * ```
+ */
+class snapshot_file
+{
+public:
+    //! @brief Constructs an empty snapshot
+    snapshot_file() = default;
+
+    /**
+     * @brief Maps snapshot file
+     *
+     * @param path snapshot path
+     * @throws std::system_error if file cannot be opened or mapped
+     * @throws std::runtime_error if file is not a valid snapshot
+     */
+    explicit snapshot_file(const std::string& path) : mapping{path}
+    {
+        if(mapping.size() < detail::snapshot_header_size)
+        {
+            throw std::runtime_error{"snapshot_file: file is too small"};
+        }
+        const auto data = mapping.data();
+        const auto size = mapping.size();
+        const auto count = detail::get_u64(data + 40);
+        const auto index_offset = detail::get_u64(data + 48);
+        if((detail::get_u64(data) != detail::snapshot_magic)
+           || (detail::get_primitive<std::uint32_t, endian::little>(data + 8)
+               != detail::snapshot_version)
+           || (index_offset < detail::snapshot_header_size)
+           || (index_offset > size)
+           || (count != (size - index_offset)
+                            / detail::snapshot_index_entry_size)
+           || ((size - index_offset) % detail::snapshot_index_entry_size))
+        {
+            throw std::runtime_error{"snapshot_file: invalid header"};
+        }
+        snapshot_hdr.schema_id =
+            detail::get_primitive<std::uint32_t, endian::little>(data + 16);
+        snapshot_hdr.schema_version = detail::get_u64(data + 24);
+        snapshot_hdr.sequence = detail::get_u64(data + 32);
+        snapshot_hdr.message_count = count;
+        index = data + index_offset;
+        messages_end = static_cast<std::size_t>(index_offset);
+    }
+
+    snapshot_file(const snapshot_file&) = delete;
+    snapshot_file& operator=(const snapshot_file&) = delete;
+
+    //! @brief Move constructor, `other` is left empty
+    snapshot_file(snapshot_file&& other) noexcept
+        : mapping{std::move(other.mapping)},
+          index{other.index},
+          messages_end{other.messages_end},
+          snapshot_hdr(other.snapshot_hdr)
+    {
+        other.snapshot_hdr = {};
+    }
+
+    //! @brief Move assignment, `other` is left empty
+    snapshot_file& operator=(snapshot_file&& other) noexcept
+    {
+        if(this != &other)
+        {
+            mapping = std::move(other.mapping);
+            index = other.index;
+            messages_end = other.messages_end;
+            snapshot_hdr = other.snapshot_hdr;
+            other.snapshot_hdr = {};
+        }
+        return *this;
+    }
+
+    //! @brief Checks whether snapshot is mapped
+    explicit operator bool() const noexcept
+    {
+        return mapping.data() != nullptr;
+    }
+
+    //! @brief Returns snapshot header
+    const snapshot_header& header() const noexcept
+    {
+        return snapshot_hdr;
+    }
+
+    //! @brief Returns the number of messages
+    std::size_t message_count() const noexcept
+    {
+        return static_cast<std::size_t>(snapshot_hdr.message_count);
+    }
+
+    /**
+     * @brief Returns entry in key order
+     *
+     * @throws std::runtime_error if entry points outside of messages area
+     * @pre `index < message_count()`
+     */
+    snapshot_entry entry(const std::size_t index) const
+    {
+        SBEPP_ASSERT(index < message_count());
+        const auto ptr =
+            this->index + index * detail::snapshot_index_entry_size;
+        const auto offset = detail::get_u64(ptr + 8);
+        const auto message_size =
+            detail::get_primitive<std::uint32_t, endian::little>(ptr + 16);
+        if((offset < detail::snapshot_header_size) || (offset > messages_end)
+           || (message_size > (messages_end - offset)))
+        {
+            throw std::runtime_error{"snapshot_file: invalid index entry"};
+        }
+        return {
+            detail::get_u64(ptr),
+            mapping.data() + offset,
+            static_cast<std::size_t>(message_size)};
+    }
+
+    /**
+     * @brief Returns index of the first entry which key is not less than
+     *  `key`, `message_count()` if there's no such entry
+     */
+    std::size_t lower_bound(const std::uint64_t key) const noexcept
+    {
+        std::size_t first{};
+        auto count = message_count();
+        while(count)
+        {
+            const auto step = count / 2;
+            const auto middle = first + step;
+            if(key_at(middle) < key)
+            {
+                first = middle + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * @brief Calls `f(const snapshot_entry&)` for each entry in key order
+     *
+     * @return the number of entries
+     * @throws see `entry()`
+     */
+    template<typename F>
+    std::size_t for_each(F&& f) const
+    {
+        for(std::size_t i = 0; i != message_count(); i++)
+        {
+            f(entry(i));
+        }
+        return message_count();
+    }
+
+    /**
+     * @brief Calls `f(const snapshot_entry&)` for each entry with the key in
+     *  append order
+     *
+     * @return the number of entries
+     * @throws see `entry()`
+     */
+    template<typename F>
+    std::size_t for_each_of(const std::uint64_t key, F&& f) const
+    {
+        const auto first = lower_bound(key);
+        auto last = first;
+        while((last != message_count()) && (key_at(last) == key))
+        {
+            f(entry(last));
+            last++;
+        }
+        return last - first;
+    }
+
+    /**
+     * @brief Asks the kernel to read the whole snapshot in background, it
+     *  doesn't block
+     */
+    void prefetch() const noexcept
+    {
+        if(mapping.data())
+        {
+            ::madvise(
+                const_cast<std::uint8_t*>(mapping.data()),
+                mapping.size(),
+                MADV_WILLNEED);
+        }
+    }
+
+private:
+    detail::read_only_mapping mapping;
+    const std::uint8_t* index{};
+    std::size_t messages_end{};
+    snapshot_header snapshot_hdr{};
+
+    std::uint64_t key_at(const std::size_t i) const noexcept
+    {
+        return detail::get_u64(index + i * detail::snapshot_index_entry_size);
+    }
+};
+#endif
+} // namespace sbepp
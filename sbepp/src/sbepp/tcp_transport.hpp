@@ -0,0 +1,783 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file tcp_transport.hpp
+ * @brief Contains `sbepp::tcp_connection`, `sbepp::tcp_listener` and
+ *  `sbepp::tcp_poller` which transfer framed messages over non-blocking TCP
+ *  sockets. Available only on Linux.
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+#include <sbepp/memory.hpp>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <netdb.h>
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/epoll.h>
+#    include <sys/socket.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+#endif
+
+namespace sbepp
+{
+#if defined(__linux__) || defined(SBEPP_DOXYGEN)
+/**
+ * @brief Size of the Simple Open Framing Header which precedes each message.
+ *
+ * Header layout (big-endian):
+ * - `messageLength`, `uint32`, includes the header itself
+ * - `encodingType`, `uint16`
+ */
+constexpr std::size_t sofh_size = 6;
+
+//! @brief SOFH encoding type for little-endian SBE messages
+constexpr std::uint16_t sofh_sbe_little_endian = 0x5BE0;
+
+//! @brief SOFH encoding type for big-endian SBE messages
+constexpr std::uint16_t sofh_sbe_big_endian = 0xEB50;
+
+//! @brief Options for `sbepp::tcp_connection`
+struct tcp_options
+{
+    //! @brief Disables Nagle's algorithm using `TCP_NODELAY`
+    bool no_delay{true};
+    //! @brief `SO_BUSY_POLL` value in microseconds, `0` disables it. Applied
+    //!     on the best-effort basis since raising it usually requires
+    //!     `CAP_NET_ADMIN`, see `tcp_connection::is_busy_polling()`.
+    int busy_poll_us{};
+    //! @brief Receive buffer size, the largest frame must fit into it
+    std::size_t receive_buffer_size{0x10000};
+    //! @brief SOFH encoding type of sent and accepted frames
+    std::uint16_t encoding_type{sofh_sbe_little_endian};
+};
+
+namespace detail
+{
+struct addrinfo_deleter
+{
+    void operator()(addrinfo* info) const noexcept
+    {
+        ::freeaddrinfo(info);
+    }
+};
+
+inline std::unique_ptr<addrinfo, addrinfo_deleter> resolve_tcp_address(
+    const std::string& host, const std::uint16_t port, const int flags)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags | AI_NUMERICSERV;
+    addrinfo* info{};
+    const auto service = std::to_string(port);
+    const auto res = ::getaddrinfo(
+        host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &info);
+    if(res != 0)
+    {
+        throw std::runtime_error{
+            std::string{"getaddrinfo: "} + ::gai_strerror(res)};
+    }
+    return std::unique_ptr<addrinfo, addrinfo_deleter>{info};
+}
+} // namespace detail
+
+//! @brief Result of `sbepp::tcp_receive_buffer::read_from()`
+enum class tcp_read_status
+{
+    //! socket has no more data
+    would_block,
+    //! buffer is full, socket may have more data
+    buffer_full,
+    //! peer has closed the connection
+    closed
+};
+
+/**
+ * @brief Receive buffer which yields complete SOFH-framed messages.
+ *
+ * Messages are passed to the client as pointers into the buffer, no copying
+ * is involved. Only the incomplete tail is moved to the buffer start before
+ * the next read.
+ */
+class tcp_receive_buffer
+{
+public:
+    /**
+     * @brief Constructs buffer
+     *
+     * @param capacity buffer capacity, the largest frame must fit into it
+     * @param encoding_type expected SOFH encoding type
+     * @pre `capacity > sofh_size`
+     */
+    explicit tcp_receive_buffer(
+        const std::size_t capacity,
+        const std::uint16_t encoding_type = sofh_sbe_little_endian)
+        : buffer(capacity), encoding{encoding_type}
+    {
+        SBEPP_ASSERT(capacity > sofh_size);
+    }
+
+    //! @brief Returns buffer capacity
+    std::size_t capacity() const noexcept
+    {
+        return buffer.size();
+    }
+
+    //! @brief Returns the number of buffered bytes
+    std::size_t size() const noexcept
+    {
+        return write_pos - read_pos;
+    }
+
+    /**
+     * @brief Reads from socket until it has no more data or buffer is full
+     *
+     * Works with edge-triggered notifications as long as the client calls it
+     * again after `tcp_read_status::buffer_full`.
+     *
+     * @param fd non-blocking socket
+     * @return read status
+     * @throws std::system_error on failure
+     */
+    tcp_read_status read_from(const int fd)
+    {
+        if(read_pos)
+        {
+            std::memmove(buffer.data(), buffer.data() + read_pos, size());
+            write_pos -= read_pos;
+            read_pos = 0;
+        }
+        while(write_pos != buffer.size())
+        {
+            const auto res = ::recv(
+                fd, buffer.data() + write_pos, buffer.size() - write_pos, 0);
+            if(res > 0)
+            {
+                write_pos += static_cast<std::size_t>(res);
+            }
+            else if(!res)
+            {
+                return tcp_read_status::closed;
+            }
+            else if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                return tcp_read_status::would_block;
+            }
+            else if(errno != EINTR)
+            {
+                detail::throw_system_error("recv");
+            }
+        }
+        return tcp_read_status::buffer_full;
+    }
+
+    /**
+     * @brief Calls `f(data, size)` for each complete buffered message and
+     *  consumes it
+     *
+     * @param f callback, receives `const std::uint8_t*` message start and
+     *  `std::size_t` message size without SOFH. Pointer is valid until the
+     *  next `read_from()`.
+     * @return the number of messages
+     * @throws std::runtime_error if frame has unexpected encoding type or
+     *  doesn't fit into the buffer
+     */
+    template<typename F>
+    std::size_t for_each_frame(F&& f)
+    {
+        std::size_t count{};
+        while(size() >= sofh_size)
+        {
+            const auto frame = buffer.data() + read_pos;
+            const auto length = static_cast<std::size_t>(
+                detail::get_primitive<std::uint32_t, endian::big>(frame));
+            const auto type =
+                detail::get_primitive<std::uint16_t, endian::big>(frame + 4);
+            if((type != encoding) || (length < sofh_size)
+               || (length > buffer.size()))
+            {
+                throw std::runtime_error{"tcp_receive_buffer: invalid frame"};
+            }
+            if(length > size())
+            {
+                break;
+            }
+            read_pos += length;
+            count++;
+            f(static_cast<const std::uint8_t*>(frame + sofh_size),
+              length - sofh_size);
+        }
+        if(read_pos == write_pos)
+        {
+            read_pos = 0;
+            write_pos = 0;
+        }
+        return count;
+    }
+
+private:
+    std::vector<std::uint8_t> buffer;
+    std::size_t read_pos{};
+    std::size_t write_pos{};
+    std::uint16_t encoding;
+};
+
+/**
+ * @brief Non-blocking TCP connection which sends and receives SOFH-framed
+ *  messages.
+ *
+ * Received messages are passed as zero-copy pointers into the receive
+ * buffer. Sent data which doesn't fit into the socket buffer is queued and
+ * written by `flush()`. `poll()` drains the socket so the connection can be
+ * used either with `sbepp::tcp_poller` in edge-triggered mode or in a
+ * busy-poll loop.
+ *
+ * Example:
+ * ```cpp
+ * auto conn = sbepp::tcp_connection::connect("127.0.0.1", 9000);
+ * conn.send(order.data(), order.size());
+ * while(conn.is_open())
+ * {
+ *     conn.poll(
+ *         [](const std::uint8_t* data, std::size_t size)
+ *         {
+ *             handle(sbepp::make_const_view<schema::messages::msg1>(
+ *                 data, size));
+ *         });
+ * }
+ * ```
+ */
+class tcp_connection
+{
+public:
+    //! @brief Constructs an empty connection
+    tcp_connection() = default;
+
+    /**
+     * @brief Takes ownership of connected socket and configures it
+     *
+     * @param fd connected TCP socket, it's closed if constructor throws
+     * @param options connection options
+     * @throws std::system_error on failure
+     */
+    explicit tcp_connection(const int fd, const tcp_options& options = {})
+        : sock{fd},
+          rx{options.receive_buffer_size, options.encoding_type},
+          encoding{options.encoding_type},
+          open{true}
+    {
+        const auto flags = ::fcntl(sock.get(), F_GETFL);
+        if((flags == -1)
+           || (::fcntl(sock.get(), F_SETFL, flags | O_NONBLOCK) == -1))
+        {
+            detail::throw_system_error("fcntl");
+        }
+        const int no_delay = options.no_delay;
+        if(::setsockopt(
+               sock.get(),
+               IPPROTO_TCP,
+               TCP_NODELAY,
+               &no_delay,
+               sizeof(no_delay))
+           == -1)
+        {
+            detail::throw_system_error("setsockopt");
+        }
+        if(options.busy_poll_us > 0)
+        {
+            busy_poll = (::setsockopt(
+                             sock.get(),
+                             SOL_SOCKET,
+                             SO_BUSY_POLL,
+                             &options.busy_poll_us,
+                             sizeof(options.busy_poll_us))
+                         == 0);
+        }
+    }
+
+    /**
+     * @brief Connects to the server
+     *
+     * Connection is established in blocking mode, socket is switched to
+     * non-blocking mode afterwards.
+     *
+     * @param host host name or address
+     * @param port port
+     * @param options connection options
+     * @throws std::system_error if connection fails
+     * @throws std::runtime_error if address cannot be resolved
+     */
+    static tcp_connection connect(
+        const std::string& host,
+        const std::uint16_t port,
+        const tcp_options& options = {})
+    {
+        const auto info = detail::resolve_tcp_address(host, port, 0);
+        int error{};
+        for(auto ai = info.get(); ai; ai = ai->ai_next)
+        {
+            detail::unique_fd fd{::socket(
+                ai->ai_family,
+                ai->ai_socktype | SOCK_CLOEXEC,
+                ai->ai_protocol)};
+            if(!fd)
+            {
+                error = errno;
+                continue;
+            }
+            if(::connect(fd.get(), ai->ai_addr, ai->ai_addrlen) == 0)
+            {
+                return tcp_connection{fd.release(), options};
+            }
+            error = errno;
+        }
+        errno = error;
+        detail::throw_system_error("connect");
+    }
+
+    tcp_connection(const tcp_connection&) = delete;
+    tcp_connection& operator=(const tcp_connection&) = delete;
+
+    //! @brief Move constructor, `other` is left empty
+    tcp_connection(tcp_connection&& other) noexcept
+        : sock{std::move(other.sock)},
+          rx{std::move(other.rx)},
+          pending{std::move(other.pending)},
+          pending_offset{other.pending_offset},
+          encoding{other.encoding},
+          open{other.open},
+          busy_poll{other.busy_poll}
+    {
+        other.open = false;
+    }
+
+    //! @brief Move assignment, `other` is left empty
+    tcp_connection& operator=(tcp_connection&& other) noexcept
+    {
+        if(this != &other)
+        {
+            sock = std::move(other.sock);
+            rx = std::move(other.rx);
+            pending = std::move(other.pending);
+            pending_offset = other.pending_offset;
+            encoding = other.encoding;
+            open = other.open;
+            busy_poll = other.busy_poll;
+            other.open = false;
+        }
+        return *this;
+    }
+
+    //! @brief Checks whether connection owns a socket
+    explicit operator bool() const noexcept
+    {
+        return static_cast<bool>(sock);
+    }
+
+    //! @brief Returns socket or `-1` for empty connection
+    int native_handle() const noexcept
+    {
+        return sock.get();
+    }
+
+    //! @brief Checks whether peer hasn't closed the connection yet
+    bool is_open() const noexcept
+    {
+        return open;
+    }
+
+    //! @brief Checks whether `SO_BUSY_POLL` was applied
+    bool is_busy_polling() const noexcept
+    {
+        return busy_poll;
+    }
+
+    //! @brief Checks whether there's queued output, see `flush()`
+    bool has_pending_output() const noexcept
+    {
+        return pending_offset != pending.size();
+    }
+
+    /**
+     * @brief Sends message prefixed with SOFH
+     *
+     * Writes directly to the socket if there's no queued output, the part
+     * which doesn't fit into the socket buffer is queued.
+     *
+     * @param message message start
+     * @param size message size
+     * @throws std::system_error on failure
+     */
+    void send(const void* message, const std::size_t size)
+    {
+        std::uint8_t header[sofh_size];
+        detail::set_primitive<endian::big>(
+            header, static_cast<std::uint32_t>(sofh_size + size));
+        detail::set_primitive<endian::big>(header + 4, encoding);
+        const auto bytes = static_cast<const std::uint8_t*>(message);
+
+        std::size_t written{};
+        if(!has_pending_output())
+        {
+            iovec iov[2];
+            iov[0].iov_base = header;
+            iov[0].iov_len = sizeof(header);
+            iov[1].iov_base = const_cast<std::uint8_t*>(bytes);
+            iov[1].iov_len = size;
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = 2;
+            written = write_some(msg);
+        }
+        if(written < sofh_size)
+        {
+            pending.insert(
+                pending.end(), header + written, header + sofh_size);
+            pending.insert(pending.end(), bytes, bytes + size);
+        }
+        else if(written < (sofh_size + size))
+        {
+            pending.insert(
+                pending.end(), bytes + (written - sofh_size), bytes + size);
+        }
+    }
+
+    /**
+     * @brief Writes queued output
+     *
+     * @return `true` if all queued output is written
+     * @throws std::system_error on failure
+     */
+    bool flush()
+    {
+        while(has_pending_output())
+        {
+            iovec iov;
+            iov.iov_base = pending.data() + pending_offset;
+            iov.iov_len = pending.size() - pending_offset;
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            const auto written = write_some(msg);
+            if(!written)
+            {
+                return false;
+            }
+            pending_offset += written;
+        }
+        pending.clear();
+        pending_offset = 0;
+        return true;
+    }
+
+    /**
+     * @brief Reads all available data and calls `f(data, size)` for each
+     *  complete message
+     *
+     * Sets `is_open()` to `false` when peer closes the connection, incomplete
+     * message is discarded in this case.
+     *
+     * @param f callback, receives `const std::uint8_t*` message start and
+     *  `std::size_t` message size. Pointer is valid only during the call.
+     * @return the number of messages
+     * @throws std::system_error on failure
+     * @throws std::runtime_error on invalid frame
+     */
+    template<typename F>
+    std::size_t poll(F&& f)
+    {
+        std::size_t count{};
+        while(open)
+        {
+            const auto status = rx.read_from(sock.get());
+            count += rx.for_each_frame(f);
+            if(status == tcp_read_status::closed)
+            {
+                open = false;
+            }
+            else if(status == tcp_read_status::would_block)
+            {
+                break;
+            }
+        }
+        return count;
+    }
+
+private:
+    detail::unique_fd sock;
+    tcp_receive_buffer rx{sofh_size + 1};
+    std::vector<std::uint8_t> pending;
+    std::size_t pending_offset{};
+    std::uint16_t encoding{sofh_sbe_little_endian};
+    bool open{};
+    bool busy_poll{};
+
+    // returns the number of written bytes, `0` if socket buffer is full
+    std::size_t write_some(const msghdr& msg)
+    {
+        while(true)
+        {
+            const auto res = ::sendmsg(sock.get(), &msg, MSG_NOSIGNAL);
+            if(res >= 0)
+            {
+                return static_cast<std::size_t>(res);
+            }
+            if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                return 0;
+            }
+            if(errno != EINTR)
+            {
+                detail::throw_system_error("sendmsg");
+            }
+        }
+    }
+};
+
+/**
+ * @brief Non-blocking listening TCP socket.
+ */
+class tcp_listener
+{
+public:
+    /**
+     * @brief Binds and listens
+     *
+     * @param host address to bind to, empty string means any address
+     * @param port port, `0` means any free port, see `port()`
+     * @param backlog `listen()` backlog
+     * @throws std::system_error on failure
+     * @throws std::runtime_error if address cannot be resolved
+     */
+    tcp_listener(
+        const std::string& host,
+        const std::uint16_t port,
+        const int backlog = SOMAXCONN)
+    {
+        const auto info = detail::resolve_tcp_address(host, port, AI_PASSIVE);
+        const auto ai = info.get();
+        sock.reset(::socket(
+            ai->ai_family,
+            ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+            ai->ai_protocol));
+        if(!sock)
+        {
+            detail::throw_system_error("socket");
+        }
+        const int reuse = 1;
+        if(::setsockopt(
+               sock.get(), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse))
+           == -1)
+        {
+            detail::throw_system_error("setsockopt");
+        }
+        if(::bind(sock.get(), ai->ai_addr, ai->ai_addrlen) == -1)
+        {
+            detail::throw_system_error("bind");
+        }
+        if(::listen(sock.get(), backlog) == -1)
+        {
+            detail::throw_system_error("listen");
+        }
+    }
+
+    tcp_listener(const tcp_listener&) = delete;
+    tcp_listener& operator=(const tcp_listener&) = delete;
+
+    //! @brief Move constructor, `other` is left without socket
+    tcp_listener(tcp_listener&&) = default;
+
+    //! @brief Move assignment, `other` is left without socket
+    tcp_listener& operator=(tcp_listener&&) = default;
+
+    //! @brief Returns socket or `-1` if listener was moved from
+    int native_handle() const noexcept
+    {
+        return sock.get();
+    }
+
+    /**
+     * @brief Returns bound port
+     *
+     * @throws std::system_error on failure
+     */
+    std::uint16_t port() const
+    {
+        sockaddr_storage addr{};
+        socklen_t size = sizeof(addr);
+        if(::getsockname(
+               sock.get(), reinterpret_cast<sockaddr*>(&addr), &size)
+           == -1)
+        {
+            detail::throw_system_error("getsockname");
+        }
+        if(addr.ss_family == AF_INET6)
+        {
+            return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+        }
+        return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    }
+
+    /**
+     * @brief Accepts pending connection
+     *
+     * @param options options for accepted connection
+     * @return accepted connection or empty connection if there's no pending
+     *  one
+     * @throws std::system_error on failure
+     */
+    tcp_connection accept(const tcp_options& options = {})
+    {
+        while(true)
+        {
+            const auto fd =
+                ::accept4(sock.get(), nullptr, nullptr, SOCK_CLOEXEC);
+            if(fd != -1)
+            {
+                return tcp_connection{fd, options};
+            }
+            if((errno == EAGAIN) || (errno == EWOULDBLOCK)
+               || (errno == ECONNABORTED))
+            {
+                return {};
+            }
+            if(errno != EINTR)
+            {
+                detail::throw_system_error("accept4");
+            }
+        }
+    }
+
+private:
+    detail::unique_fd sock;
+};
+
+/**
+ * @brief Edge-triggered `epoll` wrapper.
+ *
+ * Since notifications are edge-triggered, ready socket must be drained
+ * before the next `wait()`, `tcp_connection::poll()` and repeated
+ * `tcp_listener::accept()` until it returns empty connection do that.
+ *
+ * Example:
+ * ```cpp
+ * sbepp::tcp_poller poller;
+ * poller.add(conn.native_handle(), &conn);
+ * while(conn.is_open())
+ * {
+ *     poller.wait(
+ *         -1,
+ *         [](void* user_data, std::uint32_t)
+ *         {
+ *             static_cast<sbepp::tcp_connection*>(user_data)->poll(handle);
+ *         });
+ * }
+ * ```
+ */
+class tcp_poller
+{
+public:
+    /**
+     * @brief Creates `epoll` instance
+     *
+     * @throws std::system_error on failure
+     */
+    tcp_poller() : epoll{::epoll_create1(EPOLL_CLOEXEC)}
+    {
+        if(!epoll)
+        {
+            detail::throw_system_error("epoll_create1");
+        }
+    }
+
+    tcp_poller(const tcp_poller&) = delete;
+    tcp_poller& operator=(const tcp_poller&) = delete;
+
+    /**
+     * @brief Registers socket
+     *
+     * @param fd socket
+     * @param user_data pointer passed to `wait()` callback
+     * @param events `epoll` events, `EPOLLET` is always added
+     * @throws std::system_error on failure
+     */
+    void add(
+        const int fd,
+        void* user_data,
+        const std::uint32_t events = EPOLLIN | EPOLLRDHUP)
+    {
+        epoll_event ev{};
+        ev.events = events | EPOLLET;
+        ev.data.ptr = user_data;
+        if(::epoll_ctl(epoll.get(), EPOLL_CTL_ADD, fd, &ev) == -1)
+        {
+            detail::throw_system_error("epoll_ctl");
+        }
+    }
+
+    /**
+     * @brief Unregisters socket
+     *
+     * @param fd socket
+     * @throws std::system_error on failure
+     */
+    void remove(const int fd)
+    {
+        if(::epoll_ctl(epoll.get(), EPOLL_CTL_DEL, fd, nullptr) == -1)
+        {
+            detail::throw_system_error("epoll_ctl");
+        }
+    }
+
+    /**
+     * @brief Waits for events and calls `f(user_data, events)` for each
+     *  ready socket
+     *
+     * @param timeout_ms timeout in milliseconds, `-1` waits indefinitely,
+     *  `0` returns immediately which suits busy-poll loops
+     * @param f callback, receives `void*` user data and `std::uint32_t`
+     *  events
+     * @return the number of ready sockets, `0` on timeout or interrupt
+     * @throws std::system_error on failure
+     */
+    template<typename F>
+    std::size_t wait(const int timeout_ms, F&& f)
+    {
+        epoll_event events[64];
+        const auto res = ::epoll_wait(epoll.get(), events, 64, timeout_ms);
+        if(res == -1)
+        {
+            if(errno == EINTR)
+            {
+                return 0;
+            }
+            detail::throw_system_error("epoll_wait");
+        }
+        for(int i = 0; i != res; i++)
+        {
+            f(events[i].data.ptr, static_cast<std::uint32_t>(events[i].events));
+        }
+        return static_cast<std::size_t>(res);
+    }
+
+private:
+    detail::unique_fd epoll;
+};
+#endif
+} // namespace sbepp
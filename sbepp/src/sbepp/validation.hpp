@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+/**
+ * @file validation.hpp
+ * @brief Contains `sbepp::validate()`, a semantic message validator
+ */
+
+#pragma once
+
+#include <sbepp/sbepp.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sbepp
+{
+//! @brief Error found by `sbepp::validate()`
+enum class validation_error
+{
+    //! Message is valid
+    none,
+    //! Message doesn't fit into the buffer, see `sbepp::size_bytes_checked()`
+    size,
+    //! Enum holds a value which is not listed in schema
+    enum_value,
+    //! Set has bits which don't correspond to any choice
+    reserved_bits,
+    //! Non-null value is outside of `[min_value(); max_value()]` range
+    out_of_range
+};
+
+//! @brief Result type of `sbepp::validate()`
+struct validation_result
+{
+    //! First found error
+    validation_error error;
+    //! Path to the first invalid field, e.g. `group[2].composite.x`. Empty
+    //! if message is valid or for `validation_error::size`
+    std::string path;
+    //! Message size, valid only if `valid() == true`
+    std::size_t size;
+
+    //! @brief Checks whether message is valid
+    bool valid() const noexcept
+    {
+        return error == validation_error::none;
+    }
+};
+
+namespace detail
+{
+template<typename T>
+using validation_kind = std::integral_constant<
+    int,
+    sbepp::is_non_array_type<T>::value ? 1
+    : sbepp::is_enum<T>::value         ? 2
+    : sbepp::is_set<T>::value          ? 3
+    : sbepp::is_composite<T>::value    ? 4
+                                       : 0>;
+
+class validation_visitor
+{
+public:
+    template<typename T, typename Cursor, typename Tag>
+    void on_message(T m, Cursor& c, Tag)
+    {
+        sbepp::visit_children(m, c, *this);
+    }
+
+    template<typename T, typename Cursor, typename Tag>
+    bool on_group(T g, Cursor& c, Tag)
+    {
+        const auto prev_index = entry_index;
+        entry_index = 0;
+        sbepp::visit_children(g, c, *this);
+        if(!is_valid())
+        {
+            reversed_path.push_back(
+                sbepp::group_traits<Tag>::name() + ('['
+                + std::to_string(entry_index) + ']'));
+        }
+        entry_index = prev_index;
+
+        return !is_valid();
+    }
+
+    template<typename T, typename Cursor>
+    bool on_entry(T e, Cursor& c)
+    {
+        if(!sbepp::visit_children(e, c, *this).is_valid())
+        {
+            return true;
+        }
+        entry_index++;
+
+        return false;
+    }
+
+    // all bytes are valid for data
+    template<typename T, typename Tag>
+    bool on_data(T, Tag) const noexcept
+    {
+        return false;
+    }
+
+    template<typename T, typename Tag>
+    bool on_field(T f, Tag)
+    {
+        return check(f, sbepp::field_traits<Tag>::name());
+    }
+
+    template<typename T, typename Tag>
+    bool on_type(T t, Tag)
+    {
+        return check(t, sbepp::type_traits<Tag>::name());
+    }
+
+    template<typename T, typename Tag>
+    bool on_enum(T e, Tag)
+    {
+        return check(e, sbepp::enum_traits<Tag>::name());
+    }
+
+    template<typename T, typename Tag>
+    bool on_set(T s, Tag)
+    {
+        return check(s, sbepp::set_traits<Tag>::name());
+    }
+
+    template<typename T, typename Tag>
+    bool on_composite(T c, Tag)
+    {
+        return check(c, sbepp::composite_traits<Tag>::name());
+    }
+
+    bool is_valid() const noexcept
+    {
+        return error == validation_error::none;
+    }
+
+    validation_error get_error() const noexcept
+    {
+        return error;
+    }
+
+    std::string get_path() const
+    {
+        std::string path;
+        for(auto it = reversed_path.rbegin(); it != reversed_path.rend(); ++it)
+        {
+            if(!path.empty())
+            {
+                path += '.';
+            }
+            path += *it;
+        }
+        return path;
+    }
+
+private:
+    validation_error error{};
+    // path components are collected while unwinding from the failed field
+    std::vector<std::string> reversed_path;
+    std::size_t entry_index{};
+
+    // returns `true` to stop visitation
+    template<typename T>
+    bool check(T value, const char* name)
+    {
+        if(!is_valid_value(value, validation_kind<T>{}))
+        {
+            // for composites, error is already set by the failed member
+            if(is_valid())
+            {
+                error = validation_error_of(validation_kind<T>{});
+            }
+            reversed_path.emplace_back(name);
+            return true;
+        }
+        return false;
+    }
+
+    // arrays are not checked
+    template<typename T>
+    static bool is_valid_value(T, std::integral_constant<int, 0>) noexcept
+    {
+        return true;
+    }
+
+    template<typename T>
+    static bool is_valid_value(T t, std::integral_constant<int, 1>) noexcept
+    {
+        return is_in_range(t, sbepp::is_optional_type<T>{});
+    }
+
+    template<typename T>
+    static bool is_valid_value(T e, std::integral_constant<int, 2>) noexcept
+    {
+        return sbepp::enum_is_valid(e);
+    }
+
+    template<typename T>
+    static bool is_valid_value(T s, std::integral_constant<int, 3>) noexcept
+    {
+        return !sbepp::set_has_reserved_bits(s);
+    }
+
+    template<typename T>
+    bool is_valid_value(T c, std::integral_constant<int, 4>)
+    {
+        return sbepp::visit_children(c, *this).is_valid();
+    }
+
+    // null is a valid value for optional types
+    template<typename T>
+    static bool is_in_range(T t, std::true_type) noexcept
+    {
+        return !sbepp::detail::is_not_null(t) || is_in_range(t);
+    }
+
+    template<typename T>
+    static bool is_in_range(T t, std::false_type) noexcept
+    {
+        return is_in_range(t);
+    }
+
+    template<typename T>
+    static bool is_in_range(T t) noexcept
+    {
+        return is_in_range(
+            t, *t, std::is_floating_point<typename T::value_type>{});
+    }
+
+    template<typename T, typename Value>
+    static bool is_in_range(T t, Value, std::false_type) noexcept
+    {
+        return t.in_range();
+    }
+
+    // built-in floating-point `min_value()` is the smallest positive value,
+    // bounds are checked only if schema overrides them
+    template<typename T, typename Value>
+    static bool is_in_range(T, const Value value, std::true_type) noexcept
+    {
+        using limits = std::numeric_limits<Value>;
+        return ((T::min_value() == limits::min()) || (T::min_value() <= value))
+               && ((T::max_value() == limits::max())
+                   || (value <= T::max_value()));
+    }
+
+    template<int Kind>
+    static validation_error
+        validation_error_of(std::integral_constant<int, Kind>) noexcept
+    {
+        return (Kind == 2)   ? validation_error::enum_value
+               : (Kind == 3) ? validation_error::reserved_bits
+                             : validation_error::out_of_range;
+    }
+};
+} // namespace detail
+
+/**
+ * @brief Validates message or group content in a single pass
+ *
+ * First, checks that `view` fits into `size` using
+ * `sbepp::size_bytes_checked()`. Then visits all non-constant fields,
+ * including group entries and composite members, and checks that:
+ * - enums hold one of the values listed in schema
+ * - sets don't have bits which don't correspond to any choice, using mask
+ *  precomputed by `sbeppc`
+ * - non-null values of required and optional types are within
+ *  `[min_value(); max_value()]` range, for required types it also means
+ *  they are not null. For floating-point types, any NaN is treated as null
+ *  and only bounds set by schema's `minValue`/`maxValue` are checked
+ *
+ * Stops at the first invalid field. Arrays and data members are not checked.
+ *
+ * Example:
+ * ```cpp
+ * auto res = sbepp::validate(msg, size);
+ * if(!res.valid())
+ * {
+ *     log_error("invalid field: {}", res.path);
+ * }
+ * ```
+ *
+ * @param view message or group view
+ * @param size buffer size
+ */
+template<typename View>
+validation_result validate(View view, const std::size_t size)
+{
+    const auto checked_size = sbepp::size_bytes_checked(view, size);
+    if(!checked_size.valid)
+    {
+        return {validation_error::size, {}, 0};
+    }
+
+    detail::validation_visitor visitor;
+    sbepp::visit(view, visitor);
+    return {visitor.get_error(), visitor.get_path(), checked_size.size};
+}
+} // namespace sbepp
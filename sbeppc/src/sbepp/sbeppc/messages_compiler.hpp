@@ -629,7 +629,7 @@ public:
     SBEPP_CPP14_CONSTEXPR bool operator()(
         ::sbepp::detail::visit_tag, Visitor& v, Cursor& c)
     {{
-        return v.template on_group(*this, c, "{public_name}");
+        return v.template on_group(*this, c, {tag}{{}});
     }}
 }};
 )",
@@ -640,7 +640,7 @@ public:
             fmt::arg("base_class", base_class),
             fmt::arg("header_filler", make_group_header_filler(g)),
             fmt::arg("entry_impl", entry_impl),
-            fmt::arg("public_name", g.name));
+            fmt::arg("tag", g.tag));
     }
 
     static std::string make_group_accessors(std::vector<sbe::group>& groups)
@@ -1547,12 +1547,62 @@ R"(
         return res;
     }
 
+    static bool has_presence_bit(const sbe::field& f)
+    {
+        return (f.actual_presence == field_presence::optional)
+               && !f.is_template;
+    }
+
+    static std::string make_presence_mask_impl(std::vector<sbe::field>& fields)
+    {
+        constexpr std::size_t max_presence_bits = 64;
+        const auto optional_fields = std::count_if(
+            std::begin(fields), std::end(fields), has_presence_bit);
+        if(static_cast<std::size_t>(optional_fields) > max_presence_bits)
+        {
+            return {};
+        }
+
+        std::vector<std::string> bits;
+        for(auto& f : fields)
+        {
+            if(has_presence_bit(f))
+            {
+                f.presence_bit = bits.size();
+                // `has_value()` doesn't detect NaN null of floating-point
+                // types
+                bits.push_back(fmt::format(
+                    "(::std::uint64_t{{::sbepp::detail::is_not_null("
+                    "this->{}())}} << {})",
+                    f.name,
+                    *f.presence_bit));
+            }
+        }
+        if(bits.empty())
+        {
+            bits.emplace_back("0");
+        }
+
+        return fmt::format(
+            // clang-format off
+R"(
+    SBEPP_CPP20_CONSTEXPR ::std::uint64_t operator()(
+        ::sbepp::detail::presence_mask_tag) const noexcept
+    {{
+        return {bits};
+    }}
+)",
+            // clang-format on
+            fmt::arg("bits", fmt::join(bits, "\n| ")));
+    }
+
     std::string make_level_accessors(
         sbe::level_members& members, const std::size_t header_size)
     {
         std::string res;
 
         res += make_field_accessors(members.fields, header_size);
+        res += make_presence_mask_impl(members.fields);
         res += make_group_accessors(members.groups);
         res += make_data_accessors(members);
 
@@ -221,6 +221,8 @@ struct field
     std::string value_type;
     std::string value_type_tag;
     bool is_template;
+    // bit in level's presence mask, only for optional non-array fields
+    std::optional<std::size_t> presence_bit;
 };
 
 struct group
@@ -617,7 +617,7 @@ public:
             fmt::arg("deprecated_impl", make_deprecated(r.deprecated_since)));
     }
 
-    static std::string make_message_root_traits(const sbe::message& m)
+    std::string make_message_root_traits(const sbe::message& m) const
     {
         return fmt::format(
             // clang-format off
@@ -658,6 +658,7 @@ public:
 
     {deprecated_impl}
     {value_type}
+    {schema_tag}
 }};
 )",
             // clang-format on
@@ -671,6 +672,8 @@ public:
             fmt::arg(
                 "value_type",
                 utils::make_alias_template("value_type", m.public_type)),
+            fmt::arg(
+                "schema_tag", utils::make_type_alias("schema_tag", schema->tag)),
             fmt::arg("deprecated_impl", make_deprecated(m.deprecated_since)));
     }
 
@@ -696,6 +699,23 @@ public:
         return {};
     }
 
+    static std::string make_presence_bit_impl(const sbe::field& f)
+    {
+        if(f.presence_bit)
+        {
+            return fmt::format(
+                // clang-format off
+R"(static constexpr std::size_t presence_bit() noexcept
+    {{
+        return {presence_bit};
+    }}
+)",
+                // clang-format on
+                fmt::arg("presence_bit", *f.presence_bit));
+        }
+        return {};
+    }
+
     static std::string make_traits(const sbe::field& f)
     {
         return fmt::format(
@@ -726,6 +746,7 @@ public:
     }}
     
     {offset_impl}
+    {presence_bit_impl}
 
     static constexpr version_t since_version() noexcept
     {{
@@ -744,6 +765,7 @@ public:
             fmt::arg("description", f.description),
             fmt::arg("presence", utils::presence_to_string(f.actual_presence)),
             fmt::arg("offset_impl", make_offset_impl(f.actual_offset)),
+            fmt::arg("presence_bit_impl", make_presence_bit_impl(f)),
             fmt::arg("since_version", f.added_since),
             fmt::arg("value_type", make_field_value_type(f)),
             fmt::arg("value_type_tag", make_field_value_type_tag(f)),
@@ -357,6 +357,46 @@ inline SBEPP_CPP14_CONSTEXPR const char*
             fmt::arg("switch_cases", switch_cases));
     }
 
+    static std::string make_enum_is_valid(sbe::enumeration& e)
+    {
+        std::string switch_cases;
+        for(const auto& valid_value : e.valid_values)
+        {
+            switch_cases.append(fmt::format(
+                // clang-format off
+R"(
+    case {enum_type}::{enumerator}:)",
+                // clang-format on
+                fmt::arg("enum_type", e.impl_name),
+                fmt::arg("enumerator", valid_value.name)));
+        }
+        if(!switch_cases.empty())
+        {
+            switch_cases.append(R"(
+        return true;)");
+        }
+
+        return fmt::format(
+            // clang-format off
+R"(
+inline SBEPP_CPP14_CONSTEXPR bool
+    tag_invoke(
+        ::sbepp::detail::enum_is_valid_tag,
+        {enum} e) noexcept
+{{
+    switch(e)
+    {{
+    {switch_cases}
+    default:
+        return false;
+    }}
+}}
+)",
+            // clang-format on
+            fmt::arg("enum", e.impl_name),
+            fmt::arg("switch_cases", switch_cases));
+    }
+
     std::string compile_encoding(sbe::enumeration& e)
     {
         e.impl_type =
@@ -376,12 +416,14 @@ enum class {name} : {type}
 }};
 
 {enum_to_string_impl}
+{enum_is_valid_impl}
 )",
             // clang-format on
             fmt::arg("name", e.impl_name),
             fmt::arg("type", e.underlying_type),
             fmt::arg("enumerators", enumerators),
-            fmt::arg("enum_to_string_impl", make_enum_to_string(e)));
+            fmt::arg("enum_to_string_impl", make_enum_to_string(e)),
+            fmt::arg("enum_is_valid_impl", make_enum_is_valid(e)));
     }
 
     static bool is_unsigned(const std::string_view type)
@@ -460,6 +502,32 @@ SBEPP_CPP14_CONSTEXPR Visitor&& operator()(
             fmt::arg("choice_visitors", choice_visitors));
     }
 
+    // bits which don't correspond to any choice
+    static std::string make_reserved_bits_impl(const sbe::set& s)
+    {
+        static constexpr auto bits_per_byte = 8;
+        const auto bit_length = s.size * bits_per_byte;
+        std::uint64_t reserved_mask =
+            (bit_length < 64) ? ((std::uint64_t{1} << bit_length) - 1)
+                              : ~std::uint64_t{};
+        for(const auto& choice : s.choices)
+        {
+            reserved_mask &= ~(std::uint64_t{1} << choice.value);
+        }
+
+        return fmt::format(
+            // clang-format off
+R"(
+constexpr bool operator()(
+    ::sbepp::detail::reserved_bits_tag) const noexcept
+{{
+    return (**this & {mask:#x}u) != 0;
+}}
+)",
+            // clang-format on
+            fmt::arg("mask", reserved_mask));
+    }
+
     std::string compile_encoding(sbe::set& s)
     {
         s.impl_type =
@@ -484,13 +552,15 @@ public:
 
     {accessors}
     {visit_set_impl}
+    {reserved_bits_impl}
 }};
 )",
             // clang-format on
             fmt::arg("name", s.impl_name),
             fmt::arg("type", s.underlying_type),
             fmt::arg("accessors", make_set_accessors(s)),
-            fmt::arg("visit_set_impl", make_visit_set_impl(s)));
+            fmt::arg("visit_set_impl", make_visit_set_impl(s)),
+            fmt::arg("reserved_bits_impl", make_reserved_bits_impl(s)));
     }
 
     static std::string get_const_impl_type(const sbe::encoding& enc)
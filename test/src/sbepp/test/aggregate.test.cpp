@@ -0,0 +1,414 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg29.hpp>
+#endif
+
+#include <sbepp/aggregate.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#ifdef SBEPP_TEST_AVX2
+static_assert(SBEPP_HAS_AVX2, "AVX2 kernels are not enabled");
+#endif
+
+namespace
+{
+using group_tags = test_schema::schema::messages::msg29::group;
+
+constexpr sbepp::endian byte_order =
+    sbepp::schema_traits<test_schema::schema>::byte_order();
+
+// column of `msg29.group` field
+template<typename Tag, typename Group>
+auto make_column(Group g) noexcept
+    -> decltype(sbepp::make_group_column<Tag, byte_order>(g))
+{
+    return sbepp::make_group_column<Tag, byte_order>(g);
+}
+
+class AggregateTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 4096> buf{};
+    test_schema::messages::msg29<std::uint8_t> m;
+
+    void SetUp() override
+    {
+        m = sbepp::make_view<test_schema::messages::msg29>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+    }
+
+    // fills `n` entries, every third entry has null optional fields
+    void fill(const std::size_t n)
+    {
+        auto g = m.group();
+        sbepp::fill_group_header(g, n);
+        std::size_t i{};
+        for(auto e : g)
+        {
+            const auto value = static_cast<std::int32_t>(i);
+            e.price(1000 + value);
+            e.quantity(static_cast<std::uint32_t>(i + 1));
+            e.delta(((i % 2) ? -1 : 1) * value);
+            e.real(0.5 * value);
+            if(i % 3)
+            {
+                e.optional(static_cast<std::uint32_t>(100 + i));
+                e.optional64(-value);
+                e.optional_real(0.25f * static_cast<float>(value));
+            }
+            else
+            {
+                e.optional(sbepp::nullopt);
+                e.optional64(sbepp::nullopt);
+                e.optional_real(sbepp::nullopt);
+            }
+            i++;
+        }
+    }
+};
+
+TEST_F(AggregateTest, ColumnReadsWireValues)
+{
+    fill(5);
+    const auto c =
+        sbepp::make_group_column<group_tags::price, byte_order>(m.group());
+
+    ASSERT_EQ(c.size(), 5);
+    ASSERT_EQ(c.stride(), *sbepp::get_header(m.group()).blockLength());
+    std::size_t i{};
+    for(const auto e : m.group())
+    {
+        ASSERT_EQ(c[i], *e.price());
+        ASSERT_FALSE(c.is_null(i));
+        i++;
+    }
+
+    const auto opt = make_column<group_tags::optional>(m.group());
+    ASSERT_TRUE(opt.is_null(0));
+    ASSERT_FALSE(opt.is_null(1));
+}
+
+TEST_F(AggregateTest, EmptyGroup)
+{
+    fill(0);
+    const auto c = make_column<group_tags::quantity>(m.group());
+
+    ASSERT_TRUE(c.empty());
+    ASSERT_EQ(sbepp::column_sum(c), 0);
+    ASSERT_EQ(sbepp::column_count_non_null(c), 0);
+    ASSERT_EQ(sbepp::column_min_max(c).count, 0);
+    const auto res = sbepp::column_weighted_sum(c, c);
+    ASSERT_EQ(res.sum, 0);
+    ASSERT_EQ(res.weight, 0);
+}
+
+TEST_F(AggregateTest, SumSkipsNulls)
+{
+    // odd size to exercise both vector and scalar parts
+    const std::size_t n = 37;
+    fill(n);
+    std::int64_t price{};
+    std::uint64_t quantity{};
+    std::uint64_t optional{};
+    std::int64_t delta{};
+    std::int64_t optional64{};
+    double real{};
+    for(const auto e : m.group())
+    {
+        price += *e.price();
+        quantity += *e.quantity();
+        if(e.optional())
+        {
+            optional += *e.optional();
+        }
+        delta += *e.delta();
+        if(e.optional64())
+        {
+            optional64 += *e.optional64();
+        }
+        real += *e.real();
+    }
+    const auto g = m.group();
+
+    ASSERT_EQ(
+        sbepp::column_sum(make_column<group_tags::price>(g)),
+        price);
+    ASSERT_EQ(
+        sbepp::column_sum(make_column<group_tags::quantity>(g)),
+        quantity);
+    ASSERT_EQ(
+        sbepp::column_sum(make_column<group_tags::optional>(g)),
+        optional);
+    ASSERT_EQ(
+        sbepp::column_sum(make_column<group_tags::delta>(g)),
+        delta);
+    ASSERT_EQ(
+        sbepp::column_sum(make_column<group_tags::optional64>(g)),
+        optional64);
+    ASSERT_DOUBLE_EQ(
+        sbepp::column_sum(make_column<group_tags::real>(g)),
+        real);
+}
+
+TEST_F(AggregateTest, CountsNonNullValues)
+{
+    const std::size_t n = 37;
+    fill(n);
+    const auto g = m.group();
+    // every third entry starting from the first one is null
+    const std::size_t non_null = n - (n + 2) / 3;
+
+    ASSERT_EQ(
+        sbepp::column_count_non_null(make_column<group_tags::quantity>(g)),
+        n);
+    ASSERT_EQ(
+        sbepp::column_count_non_null(make_column<group_tags::optional>(g)),
+        non_null);
+    ASSERT_EQ(
+        sbepp::column_count_non_null(make_column<group_tags::optional64>(g)),
+        non_null);
+}
+
+TEST_F(AggregateTest, FindsMinMax)
+{
+    const std::size_t n = 37;
+    fill(n);
+    const auto g = m.group();
+
+    const auto delta = sbepp::column_min_max(make_column<group_tags::delta>(g));
+    ASSERT_EQ(delta.min, -35);
+    ASSERT_EQ(delta.max, 36);
+    ASSERT_EQ(delta.count, n);
+
+    const auto optional = sbepp::column_min_max(
+        make_column<group_tags::optional>(g));
+    ASSERT_EQ(optional.min, 101);
+    ASSERT_EQ(optional.max, 135);
+    ASSERT_EQ(optional.count, n - (n + 2) / 3);
+
+    const auto optional64 = sbepp::column_min_max(
+        make_column<group_tags::optional64>(g));
+    ASSERT_EQ(optional64.min, -35);
+    ASSERT_EQ(optional64.max, -1);
+
+    const auto price = sbepp::column_min_max(make_column<group_tags::price>(g));
+    ASSERT_EQ(price.min, 1000);
+    ASSERT_EQ(price.max, 1036);
+
+    const auto real = sbepp::column_min_max(make_column<group_tags::real>(g));
+    ASSERT_EQ(real.min, 0);
+    ASSERT_EQ(real.max, 18);
+}
+
+TEST_F(AggregateTest, MinMaxHandlesUnsignedRange)
+{
+    fill(10);
+    std::uint32_t values[] = {
+        0x80000000, 1, 0xFFFFFFFE, 7, 0x7FFFFFFF, 3, 2, 0x80000001, 9, 5};
+    std::size_t i{};
+    for(auto e : m.group())
+    {
+        e.quantity(values[i]);
+        i++;
+    }
+
+    const auto res = sbepp::column_min_max(
+        make_column<group_tags::quantity>(m.group()));
+
+    ASSERT_EQ(res.min, 1);
+    ASSERT_EQ(res.max, 0xFFFFFFFE);
+}
+
+TEST_F(AggregateTest, CalculatesWeightedSum)
+{
+    const std::size_t n = 37;
+    fill(n);
+    double sum{};
+    double weight{};
+    double optional_sum{};
+    double optional_weight{};
+    for(const auto e : m.group())
+    {
+        sum += static_cast<double>(*e.delta()) * *e.quantity();
+        weight += *e.quantity();
+        if(e.optional())
+        {
+            optional_sum += static_cast<double>(*e.delta()) * *e.optional();
+            optional_weight += *e.optional();
+        }
+    }
+    const auto g = m.group();
+    const auto delta = make_column<group_tags::delta>(g);
+
+    const auto res = sbepp::column_weighted_sum(
+        delta, make_column<group_tags::quantity>(g));
+    ASSERT_EQ(res.sum, sum);
+    ASSERT_EQ(res.weight, weight);
+
+    // entries with null weight are skipped
+    const auto optional_res = sbepp::column_weighted_sum(
+        delta, make_column<group_tags::optional>(g));
+    ASSERT_EQ(optional_res.sum, optional_sum);
+    ASSERT_EQ(optional_res.weight, optional_weight);
+
+    // VWAP
+    const auto vwap = sbepp::column_weighted_sum(
+        make_column<group_tags::price>(g),
+        make_column<group_tags::quantity>(g));
+    ASSERT_DOUBLE_EQ(vwap.sum / vwap.weight, (1000.0 * 703 + 16872) / 703);
+}
+
+TEST_F(AggregateTest, KernelsHandleAnyGroupSize)
+{
+    // covers vector body and scalar tail of both 4- and 8-lane kernels
+    for(std::size_t n = 0; n != 41; n++)
+    {
+        fill(n);
+        const auto g = m.group();
+        std::uint64_t quantity{};
+        std::uint64_t optional{};
+        std::int64_t optional64{};
+        std::size_t non_null{};
+        auto min_delta = (std::numeric_limits<std::int32_t>::max)();
+        auto max_delta = (std::numeric_limits<std::int32_t>::min)();
+        double weighted{};
+        double vwap_sum{};
+        double optional_weighted{};
+        double optional_real{};
+        for(const auto e : g)
+        {
+            quantity += *e.quantity();
+            if(e.optional())
+            {
+                optional += *e.optional();
+                optional64 += *e.optional64();
+                non_null++;
+            }
+            min_delta = (std::min)(min_delta, *e.delta());
+            max_delta = (std::max)(max_delta, *e.delta());
+            weighted += static_cast<double>(*e.delta()) * *e.quantity();
+            vwap_sum += static_cast<double>(*e.price()) * *e.quantity();
+            if(e.optional())
+            {
+                optional_weighted +=
+                    static_cast<double>(*e.optional64()) * *e.optional();
+                optional_real += *e.optional_real();
+            }
+        }
+
+        ASSERT_EQ(
+            sbepp::column_sum(make_column<group_tags::quantity>(g)), quantity)
+            << n;
+        ASSERT_EQ(
+            sbepp::column_sum(make_column<group_tags::optional>(g)), optional)
+            << n;
+        ASSERT_EQ(
+            sbepp::column_sum(make_column<group_tags::optional64>(g)),
+            optional64)
+            << n;
+        ASSERT_EQ(
+            sbepp::column_count_non_null(make_column<group_tags::optional>(g)),
+            non_null)
+            << n;
+        const auto delta =
+            sbepp::column_min_max(make_column<group_tags::delta>(g));
+        ASSERT_EQ(delta.count, n);
+        if(n)
+        {
+            ASSERT_EQ(delta.min, min_delta) << n;
+            ASSERT_EQ(delta.max, max_delta) << n;
+        }
+        ASSERT_EQ(
+            sbepp::column_weighted_sum(
+                make_column<group_tags::delta>(g),
+                make_column<group_tags::quantity>(g))
+                .sum,
+            weighted)
+            << n;
+        // mixed-width kernel
+        ASSERT_EQ(
+            sbepp::column_weighted_sum(
+                make_column<group_tags::price>(g),
+                make_column<group_tags::quantity>(g))
+                .sum,
+            vwap_sum)
+            << n;
+        const auto optional_res = sbepp::column_weighted_sum(
+            make_column<group_tags::optional64>(g),
+            make_column<group_tags::optional>(g));
+        ASSERT_EQ(optional_res.sum, optional_weighted) << n;
+        ASSERT_EQ(optional_res.weight, static_cast<double>(optional)) << n;
+        // NaN is null
+        ASSERT_EQ(
+            sbepp::column_sum(make_column<group_tags::optional_real>(g)),
+            optional_real)
+            << n;
+        ASSERT_EQ(
+            sbepp::column_count_non_null(
+                make_column<group_tags::optional_real>(g)),
+            non_null)
+            << n;
+    }
+}
+
+TEST_F(AggregateTest, WeightedSumConvertsFullValueRange)
+{
+    // only one entry has non-zero weight so the sum is exact
+    const std::int64_t prices[] = {
+        (std::numeric_limits<std::int64_t>::min)(),
+        (std::numeric_limits<std::int64_t>::max)(),
+        -1,
+        (INT64_C(1) << 53) + 1,
+        -(INT64_C(1) << 53) - 1,
+        INT64_C(0x7FFFFFFFFFFFFC01),
+        INT64_C(-0x123456789ABCDEF)};
+    const std::size_t n = 8;
+    fill(n);
+    auto g = m.group();
+    for(const auto price : prices)
+    {
+        for(std::size_t i = 0; i != n; i++)
+        {
+            for(std::size_t j = 0; j != n; j++)
+            {
+                g[j].price((i == j) ? price : 1);
+                g[j].quantity((i == j) ? 0xFFFFFFFF : 0);
+            }
+            const auto res = sbepp::column_weighted_sum(
+                make_column<group_tags::price>(g),
+                make_column<group_tags::quantity>(g));
+            ASSERT_EQ(res.sum, static_cast<double>(price) * 0xFFFFFFFF)
+                << price << ' ' << i;
+            ASSERT_EQ(res.weight, 0xFFFFFFFF);
+        }
+    }
+}
+
+TEST(GroupColumnTest, SupportsBigEndian)
+{
+    // two 6-byte entries with big-endian 4-byte value at offset 2
+    const std::uint8_t data[] = {
+        0xFF, 0xFF, 0x00, 0x00, 0x01, 0x02, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE};
+    using column_type = sbepp::
+        group_column<test_schema::types::uint32_opt, sbepp::endian::big>;
+    const column_type c{data + 2, 6, 2};
+
+    ASSERT_EQ(c[0], 0x0102);
+    ASSERT_EQ(c[1], 0xFFFFFFFE);
+    ASSERT_EQ(sbepp::column_sum(c), 0x0102 + UINT64_C(0xFFFFFFFE));
+    const auto res = sbepp::column_min_max(c);
+    ASSERT_EQ(res.min, 0x0102);
+    ASSERT_EQ(res.max, 0xFFFFFFFE);
+}
+} // namespace
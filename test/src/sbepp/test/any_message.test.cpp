@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#    include <test_schema/messages/msg28.hpp>
+#    include <test_schema/messages/msg30.hpp>
+#endif
+
+#include <sbepp/any_message.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+class AnyMessageTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 1024> buf{};
+
+    sbepp::any_message fill_msg2()
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number(1);
+        m.array()[0] = 'a';
+        m.enumeration(test_schema::types::numbers_enum::Two);
+        m.set(test_schema::types::options_set{}.A(true));
+        m.composite().x(2);
+        m.composite().y(3);
+        auto g = m.group();
+        sbepp::fill_group_header(g, 1);
+        for(auto e : g)
+        {
+            e.number(10);
+            sbepp::fill_group_header(e.group(), 0);
+            e.data().resize(0);
+        }
+        const char str[] = "hi";
+        m.data().assign(std::begin(str), std::end(str) - 1);
+
+        return sbepp::make_any_message<test_schema::schema::messages::msg2>(
+            buf.data(), sbepp::size_bytes(m));
+    }
+};
+
+// records callbacks as strings
+class recording_visitor : public sbepp::any_visitor
+{
+public:
+    std::vector<std::string> events;
+
+    void on_message_begin(const char* name) override
+    {
+        events.push_back(std::string{"message "} + name);
+    }
+
+    void on_group_begin(const char* name, const std::size_t size) override
+    {
+        events.push_back(
+            std::string{"group "} + name + ' ' + std::to_string(size));
+    }
+
+    void on_entry_begin() override
+    {
+        events.emplace_back("entry");
+    }
+
+    void on_composite_begin(const char* name) override
+    {
+        events.push_back(std::string{"composite "} + name);
+    }
+
+    void on_unsigned(const char* name, const std::uint64_t value) override
+    {
+        events.push_back(
+            std::string{name ? name : "-"} + '=' + std::to_string(value));
+    }
+
+    void on_enum(const char* name, const char* enumerator, std::int64_t)
+        override
+    {
+        events.push_back(
+            std::string{name} + '=' + (enumerator ? enumerator : "?"));
+    }
+
+    void on_choice(const char* name, const bool value) override
+    {
+        events.push_back(std::string{name} + '=' + (value ? "1" : "0"));
+    }
+
+    void on_string(
+        const char* name, const char* str, const std::size_t size) override
+    {
+        events.push_back(std::string{name} + "='" + std::string{str, size}
+                         + '\'');
+    }
+};
+
+TEST_F(AnyMessageTest, DefaultConstructedIsEmpty)
+{
+    sbepp::any_message m;
+
+    ASSERT_FALSE(m);
+    ASSERT_EQ(m.vtable(), nullptr);
+    ASSERT_EQ(m.data(), nullptr);
+    ASSERT_EQ(m.size(), 0);
+}
+
+TEST_F(AnyMessageTest, ProvidesMessageInfo)
+{
+    const auto m = fill_msg2();
+
+    ASSERT_TRUE(m);
+    ASSERT_EQ(m.data(), buf.data());
+    ASSERT_STREQ(m.name(), "msg2");
+    ASSERT_EQ(m.id(), 2);
+    ASSERT_EQ(
+        m.vtable(),
+        &sbepp::any_message_vtable_for<
+            test_schema::schema::messages::msg2>());
+}
+
+TEST_F(AnyMessageTest, CalculatesSize)
+{
+    const auto m = fill_msg2();
+
+    const auto res = m.size_bytes_checked();
+    ASSERT_TRUE(res.valid);
+    ASSERT_EQ(res.size, m.size());
+
+    const sbepp::any_message truncated{
+        m.data(), m.size() - 1, *m.vtable()};
+    ASSERT_FALSE(truncated.size_bytes_checked().valid);
+}
+
+TEST_F(AnyMessageTest, VisitsMessage)
+{
+    const auto m = fill_msg2();
+    recording_visitor visitor;
+
+    m.visit(visitor);
+
+    const std::vector<std::string> expected{
+        "message msg2",
+        "number=1",
+        "array='a'",
+        "enumeration=Two",
+        "A=1",
+        "B=0",
+        "composite composite",
+        "x=2",
+        "y=3",
+        "group group 1",
+        "entry",
+        "number=10",
+        "array=''",
+        "enumeration=?",
+        "A=0",
+        "B=0",
+        "composite composite",
+        "x=0",
+        "y=0",
+        "group group 0",
+        "-=104",
+        "-=105"};
+    ASSERT_EQ(visitor.events, expected);
+}
+
+TEST_F(AnyMessageTest, ConvertsToJson)
+{
+    const auto m = fill_msg2();
+
+    ASSERT_EQ(
+        m.to_json(),
+        R"({"number":1,"array":"a","enumeration":"Two","set":["A"],)"
+        R"("composite":{"x":2,"y":3},"group":[{"number":10,"array":"",)"
+        R"("enumeration":0,"set":[],"composite":{"x":0,"y":0},"group":[],)"
+        R"("data":[]}],"data":[104,105]})");
+}
+
+TEST_F(AnyMessageTest, JsonEscapesStringsAndWritesNulls)
+{
+    auto m =
+        sbepp::make_view<test_schema::messages::msg28>(buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.required(1);
+    m.optional1(sbepp::nullopt);
+    m.optional2(5);
+    m.number(test_schema::types::numbers_enum::One);
+    m.option(test_schema::types::options_set{}.A(true).B(true));
+    const char str[] = "a\"b\\\n";
+    std::copy(std::begin(str), std::end(str), m.string().begin());
+    m.array()[0] = 1;
+    sbepp::fill_group_header(m.group(), 0);
+    m.varData().resize(0);
+    m.varStr().push_back('x');
+
+    std::string json{"prefix"};
+    sbepp::make_any_message<test_schema::schema::messages::msg28>(
+        buf.data(), buf.size())
+        .to_json(json);
+
+    ASSERT_EQ(
+        json,
+        R"(prefix{"required":1,"optional1":null,"optional2":5,)"
+        R"("number":"One","option":["A","B"],"string":"a\"b\\\u000a",)"
+        R"("array":[1,0,0,0,0,0,0,0],"group":[],"varData":[],)"
+        R"("varStr":"x"})");
+}
+
+TEST_F(AnyMessageTest, Validates)
+{
+    auto m =
+        sbepp::make_view<test_schema::messages::msg30>(buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.required(11);
+    m.enumeration(test_schema::types::numbers_enum::One);
+    m.composite().enumeration(test_schema::types::numbers_enum::One);
+    sbepp::fill_group_header(m.group(), 0);
+    m.data().resize(0);
+
+    const auto res =
+        sbepp::make_any_message<test_schema::schema::messages::msg30>(
+            buf.data(), buf.size())
+            .validate();
+
+    ASSERT_EQ(res.error, sbepp::validation_error::out_of_range);
+    ASSERT_EQ(res.path, "required");
+}
+} // namespace
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg4.hpp>
+#    include <test_schema/schema/schema.hpp>
+#endif
+
+#include <sbepp/batch_encoder.hpp>
+#include <sbepp/test/utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using schema_tag = test_schema::schema;
+using msg4_tag = test_schema::schema::messages::msg4;
+using encoder_type = sbepp::batch_encoder<schema_tag, msg4_tag>;
+using message_type = test_schema::messages::msg4<std::uint8_t>;
+
+constexpr std::size_t header_size = 8;
+
+void set_number2(message_type m, const std::uint32_t number)
+{
+    m.number2(number);
+}
+
+class BatchEncoderTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 256> buf{};
+    encoder_type encoder;
+
+    test_schema::messages::msg4<const std::uint8_t>
+        get_message(const std::size_t index) const
+    {
+        return sbepp::make_const_view<test_schema::messages::msg4>(
+            buf.data() + index * encoder.message_size(),
+            encoder.message_size());
+    }
+};
+
+TEST_F(BatchEncoderTest, MessageSizeIsHeaderSizePlusBlockLength)
+{
+    STATIC_ASSERT(
+        encoder_type::message_size()
+        == header_size + sbepp::message_traits<msg4_tag>::block_length());
+}
+
+TEST_F(BatchEncoderTest, EncodesMessageForEachRow)
+{
+    const std::vector<std::uint32_t> rows{1, 2, 3};
+
+    const auto n = encoder.encode(
+        buf.data(), buf.size(), rows.begin(), rows.end(), &set_number2);
+
+    ASSERT_EQ(n, rows.size());
+    for(std::size_t i = 0; i != rows.size(); i++)
+    {
+        const auto m = get_message(i);
+        const auto header = sbepp::get_header(m);
+        ASSERT_EQ(
+            *header.templateId(), sbepp::message_traits<msg4_tag>::id());
+        ASSERT_EQ(
+            *header.blockLength(),
+            sbepp::message_traits<msg4_tag>::block_length());
+        ASSERT_EQ(
+            *header.schemaId(), sbepp::schema_traits<schema_tag>::id());
+        ASSERT_EQ(
+            *header.version(), sbepp::schema_traits<schema_tag>::version());
+        ASSERT_EQ(*m.number2(), rows[i]);
+        ASSERT_EQ(sbepp::size_bytes(m), encoder.message_size());
+    }
+}
+
+TEST_F(BatchEncoderTest, PrototypeFieldsAreCopiedIntoEachMessage)
+{
+    const std::vector<std::uint32_t> rows{1, 2};
+    encoder.prototype().number1(10);
+
+    const auto n = encoder.encode(
+        buf.data(), buf.size(), rows.begin(), rows.end(), &set_number2);
+
+    ASSERT_EQ(n, rows.size());
+    ASSERT_EQ(*get_message(0).number1(), 10u);
+    ASSERT_EQ(*get_message(0).number2(), 1u);
+    ASSERT_EQ(*get_message(1).number1(), 10u);
+    ASSERT_EQ(*get_message(1).number2(), 2u);
+}
+
+TEST_F(BatchEncoderTest, PerRowFieldsDontLeakIntoNextMessage)
+{
+    const std::vector<std::uint32_t> rows{1, 2};
+
+    encoder.encode(
+        buf.data(),
+        buf.size(),
+        rows.begin(),
+        rows.end(),
+        [](message_type m, const std::uint32_t row)
+        {
+            if(row == 1)
+            {
+                m.number1(5);
+            }
+        });
+
+    ASSERT_EQ(*get_message(0).number1(), 5u);
+    ASSERT_EQ(*get_message(1).number1(), 0u);
+}
+
+TEST_F(BatchEncoderTest, StopsWhenBufferIsFull)
+{
+    const std::vector<std::uint32_t> rows{1, 2, 3};
+    const auto size = 2 * encoder.message_size() + 1;
+
+    const auto n = encoder.encode(
+        buf.data(), size, rows.begin(), rows.end(), &set_number2);
+
+    ASSERT_EQ(n, 2u);
+    ASSERT_EQ(buf[size - 1], 0u);
+}
+
+TEST_F(BatchEncoderTest, EncodesNothingForEmptyRange)
+{
+    const std::vector<std::uint32_t> rows;
+
+    const auto n = encoder.encode(
+        buf.data(), buf.size(), rows.begin(), rows.end(), &set_number2);
+
+    ASSERT_EQ(n, 0u);
+    ASSERT_EQ(buf[0], 0u);
+}
+} // namespace
@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#    include <test_schema/messages/msg28.hpp>
+#endif
+
+#include <sbepp/binary_logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+using msg2_tag = test_schema::schema::messages::msg2;
+using msg28_tag = test_schema::schema::messages::msg28;
+
+class BinaryLoggerTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 1024> buf{};
+
+    test_schema::messages::msg2<std::uint8_t> fill_msg2()
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number(1);
+        m.array()[0] = 'a';
+        m.enumeration(test_schema::types::numbers_enum::Two);
+        m.set(test_schema::types::options_set{}.A(true));
+        m.composite().x(2);
+        m.composite().y(3);
+        auto g = m.group();
+        sbepp::fill_group_header(g, 1);
+        for(auto e : g)
+        {
+            e.number(10);
+            sbepp::fill_group_header(e.group(), 0);
+            e.data().resize(0);
+        }
+        const char str[] = "hi";
+        m.data().assign(std::begin(str), std::end(str) - 1);
+
+        return m;
+    }
+};
+
+TEST_F(BinaryLoggerTest, RingRoundsCapacityUpToPowerOfTwo)
+{
+    sbepp::binary_log_ring ring{100};
+
+    ASSERT_EQ(ring.capacity(), 128);
+}
+
+TEST_F(BinaryLoggerTest, RingPassesRecordsToConsumer)
+{
+    sbepp::binary_log_ring ring{1024};
+    const auto& vtable = sbepp::any_message_vtable_for<msg2_tag>();
+    const std::uint8_t data[] = {1, 2, 3};
+    struct record
+    {
+        std::int64_t timestamp;
+        std::vector<std::uint8_t> data;
+        std::string name;
+    };
+    std::vector<record> records;
+    const auto consumer =
+        [&records](const std::int64_t timestamp, const sbepp::any_message& m)
+    {
+        const auto ptr = static_cast<const std::uint8_t*>(m.data());
+        records.push_back({timestamp, {ptr, ptr + m.size()}, m.name()});
+    };
+
+    ASSERT_TRUE(ring.empty());
+    ASSERT_TRUE(ring.try_push(vtable, 1, data, 3));
+    ASSERT_TRUE(ring.try_push(vtable, 2, data, 1));
+    ASSERT_FALSE(ring.empty());
+    ASSERT_EQ(ring.consume(consumer), 2);
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.consume(consumer), 0);
+
+    ASSERT_EQ(records.size(), 2);
+    ASSERT_EQ(records[0].timestamp, 1);
+    ASSERT_EQ(records[0].data, (std::vector<std::uint8_t>{1, 2, 3}));
+    ASSERT_EQ(records[0].name, "msg2");
+    ASSERT_EQ(records[1].timestamp, 2);
+    ASSERT_EQ(records[1].data, (std::vector<std::uint8_t>{1}));
+}
+
+TEST_F(BinaryLoggerTest, RingRejectsRecordsWhenFull)
+{
+    sbepp::binary_log_ring ring{128};
+    const auto& vtable = sbepp::any_message_vtable_for<msg2_tag>();
+    // each record takes 64 bytes with the header
+    std::array<std::uint8_t, 40> data{};
+    std::size_t n{};
+    const auto consumer = [&n](std::int64_t, const sbepp::any_message&)
+    {
+        n++;
+    };
+
+    ASSERT_TRUE(ring.try_push(vtable, 0, data.data(), data.size()));
+    ASSERT_TRUE(ring.try_push(vtable, 0, data.data(), data.size()));
+    ASSERT_FALSE(ring.try_push(vtable, 0, data.data(), data.size()));
+    ASSERT_FALSE(ring.try_push(vtable, 0, data.data(), 200));
+
+    ASSERT_EQ(ring.consume(consumer), 2);
+    ASSERT_EQ(n, 2);
+    ASSERT_TRUE(ring.try_push(vtable, 0, data.data(), data.size()));
+}
+
+TEST_F(BinaryLoggerTest, RingKeepsRecordsContiguousOnWrapAround)
+{
+    sbepp::binary_log_ring ring{128};
+    const auto& vtable = sbepp::any_message_vtable_for<msg2_tag>();
+    std::array<std::uint8_t, 48> data{};
+    for(std::size_t i = 0; i != data.size(); i++)
+    {
+        data[i] = static_cast<std::uint8_t>(i);
+    }
+    std::vector<std::int64_t> timestamps;
+    std::size_t mismatches{};
+    const auto consumer =
+        [&timestamps, &mismatches, &data](
+            const std::int64_t timestamp, const sbepp::any_message& m)
+    {
+        timestamps.push_back(timestamp);
+        if((m.size() != data.size())
+           || std::memcmp(m.data(), data.data(), data.size()))
+        {
+            mismatches++;
+        }
+    };
+
+    // 72-byte records, most of them don't fit before the end of the ring
+    for(std::int64_t i = 0; i != 10; i++)
+    {
+        ASSERT_TRUE(ring.try_push(vtable, i, data.data(), data.size()));
+        ASSERT_EQ(ring.consume(consumer), 1);
+    }
+
+    ASSERT_EQ(
+        timestamps, (std::vector<std::int64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    ASSERT_EQ(mismatches, 0);
+}
+
+TEST_F(BinaryLoggerTest, FormatsText)
+{
+    const auto m = fill_msg2();
+    std::string out;
+    sbepp::binary_logger logger{
+        [&out](const char* data, const std::size_t size)
+        {
+            out.append(data, size);
+        }};
+
+    ASSERT_TRUE(logger.log<msg2_tag>(m, 1000000002));
+    ASSERT_TRUE(logger.log<msg2_tag>(m, 3000000000));
+    logger.flush();
+
+    const std::string line =
+        " msg2 number=1 array=\"a\" enumeration=Two set={A} "
+        "composite={x=2 y=3} group=[{number=10 array=\"\" enumeration=0 "
+        "set={} composite={x=0 y=0} group=[] data=[]}] data=[104 105]\n";
+    ASSERT_EQ(out, "1.000000002" + line + "3.000000000" + line);
+}
+
+TEST_F(BinaryLoggerTest, FormatsJson)
+{
+    auto m =
+        sbepp::make_view<test_schema::messages::msg28>(buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.required(1);
+    m.optional1(sbepp::nullopt);
+    m.optional2(5);
+    m.number(test_schema::types::numbers_enum::One);
+    m.option(test_schema::types::options_set{}.A(true));
+    m.string()[0] = '\n';
+    sbepp::fill_group_header(m.group(), 0);
+    m.varData().resize(0);
+    m.varStr().push_back('x');
+    std::string out;
+    sbepp::binary_logger_options options;
+    options.format = sbepp::binary_log_format::json;
+    sbepp::binary_logger logger{
+        [&out](const char* data, const std::size_t size)
+        {
+            out.append(data, size);
+        },
+        options};
+
+    ASSERT_TRUE(logger.log<msg28_tag>(m, 7));
+    logger.flush();
+
+    ASSERT_EQ(
+        out,
+        R"({"timestamp":7,"message":"msg28","value":{"required":1,)"
+        R"("optional1":null,"optional2":5,"number":"One","option":["A"],)"
+        R"("string":"\u000a","array":[0,0,0,0,0,0,0,0],"group":[],)"
+        R"("varData":[],"varStr":"x"}})"
+        "\n");
+}
+
+TEST_F(BinaryLoggerTest, FormatsRemainingMessagesOnDestruction)
+{
+    const auto m = fill_msg2();
+    std::size_t lines{};
+    {
+        sbepp::binary_logger logger{
+            [&lines](const char* data, const std::size_t size)
+            {
+                lines += static_cast<std::size_t>(
+                    std::count(data, data + size, '\n'));
+            }};
+        for(std::size_t i = 0; i != 100; i++)
+        {
+            ASSERT_TRUE(logger.log<msg2_tag>(m));
+        }
+    }
+
+    ASSERT_EQ(lines, 100);
+}
+
+TEST_F(BinaryLoggerTest, CountsDroppedMessages)
+{
+    const auto m = fill_msg2();
+    sbepp::binary_logger_options options;
+    options.capacity = 32;
+    sbepp::binary_logger logger{
+        [](const char*, std::size_t)
+        {
+        },
+        options};
+
+    ASSERT_FALSE(logger.log<msg2_tag>(m));
+    ASSERT_FALSE(logger.log<msg2_tag>(m));
+    ASSERT_EQ(logger.dropped(), 2);
+}
+
+TEST_F(BinaryLoggerTest, FlushRethrowsSinkException)
+{
+    const auto m = fill_msg2();
+    sbepp::binary_logger logger{
+        [](const char*, std::size_t)
+        {
+            throw std::runtime_error{"sink"};
+        }};
+
+    ASSERT_TRUE(logger.log<msg2_tag>(m));
+    ASSERT_THROW(logger.flush(), std::runtime_error);
+}
+} // namespace
@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#endif
+
+#include <sbepp/broadcast_ring.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::vector<std::uint64_t> read_all(sbepp::broadcast_ring::consumer& consumer)
+{
+    std::vector<std::uint64_t> res;
+    consumer.poll(
+        [&res](const std::uint8_t* data, const std::size_t size)
+        {
+            std::uint64_t value{};
+            EXPECT_EQ(size, sizeof(value));
+            std::memcpy(&value, data, sizeof(value));
+            res.push_back(value);
+        });
+    return res;
+}
+
+bool publish(sbepp::broadcast_ring& ring, const std::uint64_t value)
+{
+    return ring.try_publish(&value, sizeof(value));
+}
+
+TEST(BroadcastRingTest, RoundsCapacityUpToPowerOfTwo)
+{
+    sbepp::broadcast_ring ring{100, 2};
+
+    ASSERT_EQ(ring.capacity(), 128);
+    ASSERT_EQ(ring.max_consumers(), 2);
+}
+
+TEST(BroadcastRingTest, EveryConsumerReceivesEveryMessage)
+{
+    sbepp::broadcast_ring ring{1024, 3};
+    auto c1 = ring.add_consumer();
+    auto c2 = ring.add_consumer();
+
+    ASSERT_TRUE(publish(ring, 1));
+    ASSERT_TRUE(publish(ring, 2));
+
+    ASSERT_EQ(read_all(c1), (std::vector<std::uint64_t>{1, 2}));
+    ASSERT_TRUE(read_all(c1).empty());
+    ASSERT_TRUE(publish(ring, 3));
+    ASSERT_EQ(read_all(c1), (std::vector<std::uint64_t>{3}));
+    ASSERT_EQ(read_all(c2), (std::vector<std::uint64_t>{1, 2, 3}));
+}
+
+TEST(BroadcastRingTest, ConsumerReceivesOnlyNewMessages)
+{
+    sbepp::broadcast_ring ring{1024, 2};
+    auto c1 = ring.add_consumer();
+    ASSERT_TRUE(publish(ring, 1));
+
+    auto c2 = ring.add_consumer();
+    ASSERT_TRUE(publish(ring, 2));
+
+    ASSERT_EQ(read_all(c1), (std::vector<std::uint64_t>{1, 2}));
+    ASSERT_EQ(read_all(c2), (std::vector<std::uint64_t>{2}));
+}
+
+TEST(BroadcastRingTest, PollRespectsLimit)
+{
+    sbepp::broadcast_ring ring{1024, 1};
+    auto consumer = ring.add_consumer();
+    std::size_t n{};
+    const auto counter = [&n](const std::uint8_t*, std::size_t)
+    {
+        n++;
+    };
+    for(std::uint64_t i = 0; i != 5; i++)
+    {
+        ASSERT_TRUE(publish(ring, i));
+    }
+
+    ASSERT_EQ(consumer.poll(counter, 2), 2);
+    ASSERT_EQ(consumer.poll(counter, 2), 2);
+    ASSERT_EQ(consumer.poll(counter, 2), 1);
+    ASSERT_EQ(n, 5);
+}
+
+TEST(BroadcastRingTest, ThrowsIfThereAreTooManyConsumers)
+{
+    sbepp::broadcast_ring ring{1024, 1};
+    auto consumer = ring.add_consumer();
+
+    ASSERT_THROW(ring.add_consumer(), std::length_error);
+
+    consumer.close();
+    ASSERT_FALSE(consumer);
+    ASSERT_TRUE(ring.add_consumer());
+}
+
+TEST(BroadcastRingTest, SlowestConsumerBlocksProducer)
+{
+    // 16-byte records
+    sbepp::broadcast_ring ring{64, 2};
+    auto fast = ring.add_consumer();
+    auto slow = ring.add_consumer();
+
+    for(std::uint64_t i = 0; i != 4; i++)
+    {
+        ASSERT_TRUE(publish(ring, i));
+    }
+    ASSERT_EQ(read_all(fast).size(), 4);
+    ASSERT_FALSE(publish(ring, 4));
+    ASSERT_EQ(ring.stalls(), 1);
+
+    const auto slowest = ring.slowest_consumer();
+    ASSERT_EQ(slowest.index, slow.index());
+    ASSERT_EQ(slowest.lag, 64);
+    ASSERT_EQ(slow.lag(), 64);
+    ASSERT_EQ(fast.lag(), 0);
+
+    slow.close();
+    ASSERT_TRUE(publish(ring, 4));
+    ASSERT_EQ(read_all(fast), (std::vector<std::uint64_t>{4}));
+}
+
+TEST(BroadcastRingTest, ProducerIsNotBlockedWithoutConsumers)
+{
+    sbepp::broadcast_ring ring{64, 1};
+
+    for(std::uint64_t i = 0; i != 10; i++)
+    {
+        ASSERT_TRUE(publish(ring, i));
+    }
+    ASSERT_EQ(ring.slowest_consumer().index, ring.max_consumers());
+}
+
+TEST(BroadcastRingTest, KeepsMessagesContiguousOnWrapAround)
+{
+    sbepp::broadcast_ring ring{1024, 1};
+    auto consumer = ring.add_consumer();
+    // message is claimed with extra space and published with actual size
+    constexpr std::size_t max_size = 256;
+    std::vector<std::uint32_t> values;
+
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        auto ptr = ring.try_claim(max_size);
+        ASSERT_NE(ptr, nullptr);
+        // claimed memory is aligned
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % 8, 0);
+        auto claimed =
+            sbepp::make_view<test_schema::messages::msg2>(ptr, max_size);
+        sbepp::fill_message_header(claimed);
+        claimed.number(i);
+        sbepp::fill_group_header(claimed.group(), 0);
+        claimed.data().resize(0);
+        ring.publish(sbepp::size_bytes(claimed));
+
+        consumer.poll(
+            [&values](const std::uint8_t* data, const std::size_t size)
+            {
+                values.push_back(
+                    *sbepp::make_const_view<test_schema::messages::msg2>(
+                         data, size)
+                         .number());
+            });
+    }
+
+    ASSERT_EQ(values.size(), 20);
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+TEST(BroadcastRingTest, DeliversMessagesToConcurrentConsumers)
+{
+    constexpr std::size_t number_of_consumers = 4;
+    constexpr std::uint64_t number_of_messages = 10000;
+    sbepp::broadcast_ring ring{256, number_of_consumers};
+    std::vector<sbepp::broadcast_ring::consumer> consumers;
+    for(std::size_t i = 0; i != number_of_consumers; i++)
+    {
+        consumers.push_back(ring.add_consumer());
+    }
+    std::vector<std::uint64_t> sums(number_of_consumers);
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i != number_of_consumers; i++)
+    {
+        threads.emplace_back(
+            [&consumers, &sums, i]()
+            {
+                std::uint64_t n{};
+                while(n != number_of_messages)
+                {
+                    n += consumers[i].poll(
+                        [&sums, i](const std::uint8_t* data, std::size_t)
+                        {
+                            std::uint64_t value{};
+                            std::memcpy(&value, data, sizeof(value));
+                            sums[i] += value;
+                        });
+                    std::this_thread::yield();
+                }
+            });
+    }
+
+    for(std::uint64_t i = 0; i != number_of_messages; i++)
+    {
+        while(!publish(ring, i))
+        {
+            std::this_thread::yield();
+        }
+    }
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+
+    for(const auto sum : sums)
+    {
+        ASSERT_EQ(sum, number_of_messages * (number_of_messages - 1) / 2);
+    }
+}
+TEST(BroadcastRingTest, AddsConsumersWhileProducerIsRunning)
+{
+    constexpr std::size_t number_of_attaches = 1000;
+    constexpr std::size_t messages_per_consumer = 32;
+    // small ring makes the producer lap a consumer quickly if it's not seen
+    sbepp::broadcast_ring ring{128, 2};
+    std::atomic<bool> stop{};
+    std::thread producer{
+        [&ring, &stop]()
+        {
+            std::uint64_t i{};
+            while(!stop.load(std::memory_order_relaxed))
+            {
+                if(publish(ring, i))
+                {
+                    i++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }};
+
+    // producer must be stopped before any assertion fails
+    std::size_t gaps{};
+    for(std::size_t i = 0; i != number_of_attaches; i++)
+    {
+        auto consumer = ring.add_consumer();
+        std::vector<std::uint64_t> values;
+        while(values.size() < messages_per_consumer)
+        {
+            const auto received = read_all(consumer);
+            values.insert(values.end(), received.begin(), received.end());
+            std::this_thread::yield();
+        }
+
+        for(std::size_t j = 1; j != values.size(); j++)
+        {
+            if(values[j] != (values[j - 1] + 1))
+            {
+                gaps++;
+            }
+        }
+    }
+    stop = true;
+    producer.join();
+
+    ASSERT_EQ(gaps, 0);
+}
+} // namespace
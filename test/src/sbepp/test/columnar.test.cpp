@@ -0,0 +1,451 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#    include <big_endian_schema/big_endian_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#    include <test_schema/messages/msg28.hpp>
+#    include <test_schema/messages/msg32.hpp>
+#    include <big_endian_schema/messages/msg2.hpp>
+#endif
+
+#include <sbepp/columnar.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+class ColumnarConverterTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 1024> buf{};
+
+    test_schema::messages::msg2<std::uint8_t> fill_msg2(
+        const std::uint32_t number, const std::size_t entry_count)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number(number);
+        m.array()[0] = 'a';
+        m.enumeration(test_schema::types::numbers_enum::Two);
+        m.set(test_schema::types::options_set{}.A(true));
+        m.composite().x(number + 1);
+        m.composite().y(number + 2);
+
+        auto g = m.group();
+        sbepp::fill_group_header(g, entry_count);
+        std::size_t i{};
+        // group is not flat, its entries can only be iterated
+        for(auto e : g)
+        {
+            e.number(static_cast<std::uint32_t>(number * 10 + i));
+            e.composite().x(static_cast<std::uint32_t>(i));
+            sbepp::fill_group_header(e.group(), i);
+            e.data().resize(i);
+            i++;
+        }
+        const char str[] = "hi";
+        m.data().assign(std::begin(str), std::end(str) - 1);
+        return m;
+    }
+
+    // entry `i` of message `number` has all values derived from
+    // `number * 10 + i`, every third entry has null optional values
+    test_schema::messages::msg32<std::uint8_t> fill_msg32(
+        const std::uint32_t number, const std::size_t entry_count)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg32>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        auto g = m.group();
+        sbepp::fill_group_header(g, entry_count);
+        for(std::size_t i = 0; i != entry_count; i++)
+        {
+            const auto value = static_cast<std::uint32_t>(number * 10 + i);
+            const auto is_null = !(value % 3);
+            auto e = g[i];
+            e.number(value);
+            e.optional(
+                is_null ? decltype(e.optional()){} : decltype(e.optional()){
+                    value % 10});
+            e.real(
+                is_null ? decltype(e.real()){}
+                        : decltype(e.real()){static_cast<float>(value)});
+            e.wide(-static_cast<std::int64_t>(value));
+            e.enumeration(test_schema::types::numbers_enum::Two);
+            e.set(test_schema::types::options_set{}.B(true));
+            e.composite().number(value + 1);
+            e.composite().array()[0] = 'a';
+            e.composite().composite().y(value + 2);
+            e.array()[7] = static_cast<std::uint8_t>(value);
+        }
+        return m;
+    }
+};
+
+TEST_F(ColumnarConverterTest, ConvertsTopLevelFields)
+{
+    sbepp::columnar_converter<test_schema::messages::msg2> converter;
+
+    ASSERT_FALSE(converter.append(fill_msg2(1, 0)));
+    ASSERT_FALSE(converter.append(fill_msg2(2, 0)));
+
+    ASSERT_EQ(converter.size(), 2);
+    const auto& table = converter.tables()[0];
+    ASSERT_EQ(table.name(), "msg2");
+    ASSERT_EQ(table.parent(), sbepp::column_table::no_parent);
+    ASSERT_EQ(table.size(), 2);
+    ASSERT_TRUE(table.parent_index().empty());
+
+    std::vector<std::string> names;
+    for(const auto& c : table.columns())
+    {
+        names.push_back(c.name());
+        ASSERT_EQ(c.size(), 2);
+    }
+    const std::vector<std::string> expected_names{
+        "number",
+        "array",
+        "enumeration",
+        "set",
+        "composite.x",
+        "composite.y",
+        "data"};
+    ASSERT_EQ(names, expected_names);
+
+    const auto number = table.find_column("number");
+    ASSERT_NE(number, nullptr);
+    ASSERT_EQ(number->type(), sbepp::column_type::uint32);
+    ASSERT_FALSE(number->is_nullable());
+    ASSERT_EQ(number->values_as<std::uint32_t>()[0], 1);
+    ASSERT_EQ(number->values_as<std::uint32_t>()[1], 2);
+
+    const auto array = table.find_column("array");
+    ASSERT_EQ(array->type(), sbepp::column_type::fixed_binary);
+    ASSERT_EQ(array->element_size(), 128);
+    ASSERT_EQ(array->data()[128], 'a');
+
+    const auto enumeration = table.find_column("enumeration");
+    ASSERT_EQ(enumeration->type(), sbepp::column_type::uint8);
+    ASSERT_EQ(enumeration->values_as<std::uint8_t>()[0], 2);
+
+    const auto set = table.find_column("set");
+    ASSERT_EQ(set->type(), sbepp::column_type::uint8);
+    ASSERT_EQ(set->values_as<std::uint8_t>()[1], 1);
+
+    const auto y = table.find_column("composite.y");
+    ASSERT_EQ(y->values_as<std::uint32_t>()[0], 3);
+    ASSERT_EQ(y->values_as<std::uint32_t>()[1], 4);
+
+    const auto data = table.find_column("data");
+    ASSERT_EQ(data->type(), sbepp::column_type::binary);
+    ASSERT_EQ(data->offsets()[0], 0);
+    ASSERT_EQ(data->offsets()[1], 2);
+    ASSERT_EQ(data->offsets()[2], 4);
+    ASSERT_EQ(data->data_size(), 4);
+    ASSERT_EQ(std::memcmp(data->data(), "hihi", 4), 0);
+}
+
+TEST_F(ColumnarConverterTest, FlattensGroupsWithParentIndex)
+{
+    sbepp::columnar_converter<test_schema::messages::msg2> converter;
+
+    converter.append(fill_msg2(1, 2));
+    converter.append(fill_msg2(2, 0));
+    converter.append(fill_msg2(3, 3));
+
+    ASSERT_EQ(converter.tables().size(), 3);
+    const auto group = converter.find_table("group");
+    ASSERT_NE(group, nullptr);
+    ASSERT_EQ(group->parent(), 0);
+    ASSERT_EQ(group->size(), 5);
+    const std::vector<std::uint64_t> expected_parents{0, 0, 2, 2, 2};
+    ASSERT_EQ(group->parent_index(), expected_parents);
+
+    const auto number = group->find_column("number");
+    ASSERT_EQ(number->size(), 5);
+    ASSERT_EQ(number->values_as<std::uint32_t>()[1], 11);
+    ASSERT_EQ(number->values_as<std::uint32_t>()[4], 32);
+    ASSERT_EQ(group->find_column("composite.x")->values_as<std::uint32_t>()[4],
+              2);
+    const auto data = group->find_column("data");
+    ASSERT_EQ(data->offsets()[5], 0 + 1 + 0 + 1 + 2);
+
+    // entries of the nested group refer to rows of the outer group table
+    const auto nested = converter.find_table("group.group");
+    ASSERT_NE(nested, nullptr);
+    ASSERT_EQ(nested->parent(), 1);
+    ASSERT_TRUE(nested->columns().empty());
+    const std::vector<std::uint64_t> expected_nested_parents{1, 3, 4, 4};
+    ASSERT_EQ(nested->parent_index(), expected_nested_parents);
+}
+
+TEST_F(ColumnarConverterTest, DerivesNullBitmapFromOptionalFields)
+{
+    sbepp::columnar_converter<test_schema::messages::msg28> converter;
+    for(std::uint32_t i = 0; i != 10; i++)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg28>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.required(i);
+        m.optional1(i % 3 ? decltype(m.optional1()){i} : sbepp::nullopt);
+        m.optional2(sbepp::nullopt);
+        sbepp::fill_group_header(m.group(), 0);
+        m.varData().resize(0);
+        m.varStr().resize(0);
+        converter.append(m);
+    }
+
+    const auto& table = converter.tables()[0];
+    ASSERT_FALSE(table.find_column("required")->is_nullable());
+    const auto optional1 = table.find_column("optional1");
+    ASSERT_TRUE(optional1->is_nullable());
+    for(std::size_t i = 0; i != 10; i++)
+    {
+        ASSERT_EQ(optional1->is_null(i), (i % 3) == 0);
+    }
+    ASSERT_EQ(optional1->validity()[0], 0xB6);
+    ASSERT_EQ(optional1->validity()[1], 0x01);
+    ASSERT_EQ(optional1->values_as<std::uint32_t>()[4], 4);
+
+    const auto optional2 = table.find_column("optional2");
+    ASSERT_EQ(optional2->validity()[0], 0);
+    ASSERT_TRUE(optional2->is_null(9));
+
+    const auto var_str = table.find_column("varStr");
+    ASSERT_EQ(var_str->type(), sbepp::column_type::binary);
+    ASSERT_EQ(var_str->offsets()[10], 0);
+}
+
+TEST_F(ColumnarConverterTest, TreatsNaNAsNull)
+{
+    sbepp::columnar_converter<test_schema::messages::msg32> converter;
+    auto m = fill_msg32(0, 2);
+    m.group()[1].real(std::numeric_limits<float>::quiet_NaN());
+    converter.append(m);
+
+    const auto real = converter.find_table("group")->find_column("real");
+    ASSERT_TRUE(real->is_null(0));
+    ASSERT_TRUE(real->is_null(1));
+}
+
+TEST_F(ColumnarConverterTest, CopiesFlatGroupEntriesInBulk)
+{
+    // the first group is converted value by value, the rest are copied in
+    // bulk
+    sbepp::columnar_converter<test_schema::messages::msg32> converter;
+    const std::size_t entry_counts[] = {3, 0, 4, 5};
+    std::uint32_t number{};
+    for(const auto n : entry_counts)
+    {
+        converter.append(fill_msg32(number, n));
+        number++;
+    }
+
+    const auto& table = *converter.find_table("group");
+    ASSERT_EQ(table.size(), 12);
+    ASSERT_EQ(table.columns().size(), 13);
+    std::size_t row{};
+    number = 0;
+    for(const auto n : entry_counts)
+    {
+        for(std::size_t i = 0; i != n; i++)
+        {
+            const auto value = static_cast<std::uint32_t>(number * 10 + i);
+            const auto is_null = !(value % 3);
+            ASSERT_EQ(table.parent_index()[row], number);
+            ASSERT_EQ(
+                table.find_column("number")->values_as<std::uint32_t>()[row],
+                value);
+            const auto optional = table.find_column("optional");
+            ASSERT_EQ(optional->is_null(row), is_null);
+            if(!is_null)
+            {
+                ASSERT_EQ(
+                    optional->values_as<std::uint32_t>()[row], value % 10);
+                ASSERT_EQ(
+                    table.find_column("real")->values_as<float>()[row],
+                    static_cast<float>(value));
+            }
+            ASSERT_EQ(table.find_column("real")->is_null(row), is_null);
+            ASSERT_FALSE(table.find_column("wide")->is_null(row));
+            ASSERT_EQ(
+                table.find_column("wide")->values_as<std::int64_t>()[row],
+                -static_cast<std::int64_t>(value));
+            ASSERT_EQ(
+                table.find_column("enumeration")
+                    ->values_as<std::uint8_t>()[row],
+                2);
+            ASSERT_EQ(
+                table.find_column("set")->values_as<std::uint8_t>()[row], 4);
+            ASSERT_EQ(
+                table.find_column("composite.number")
+                    ->values_as<std::uint32_t>()[row],
+                value + 1);
+            const auto array = table.find_column("composite.array");
+            ASSERT_EQ(array->element_size(), 128);
+            ASSERT_EQ(array->data()[row * 128], 'a');
+            ASSERT_EQ(
+                table.find_column("composite.composite.y")
+                    ->values_as<std::uint32_t>()[row],
+                value + 2);
+            ASSERT_EQ(
+                table.find_column("array")->data()[row * 8 + 7],
+                static_cast<std::uint8_t>(value));
+            row++;
+        }
+        number++;
+    }
+}
+
+TEST_F(ColumnarConverterTest, SwapsBytesOfBulkCopiedValues)
+{
+    sbepp::columnar_converter<big_endian_schema::messages::msg2> converter;
+    for(std::uint32_t number = 0; number != 3; number++)
+    {
+        auto m = sbepp::make_view<big_endian_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        auto g = m.group();
+        sbepp::fill_group_header(g, 2);
+        for(std::uint32_t i = 0; i != 2; i++)
+        {
+            const auto value = 0x01020304 + number * 10 + i;
+            g[i].number(value);
+            g[i].short_number(static_cast<std::uint16_t>(value));
+            g[i].composite().field(value + 1);
+        }
+        converter.append(m);
+    }
+
+    const auto& table = *converter.find_table("group");
+    ASSERT_EQ(table.size(), 6);
+    for(std::uint32_t number = 0; number != 3; number++)
+    {
+        for(std::uint32_t i = 0; i != 2; i++)
+        {
+            const auto row = number * 2 + i;
+            const auto value = 0x01020304 + number * 10 + i;
+            ASSERT_EQ(
+                table.find_column("number")->values_as<std::uint32_t>()[row],
+                value);
+            ASSERT_EQ(
+                table.find_column("short_number")
+                    ->values_as<std::uint16_t>()[row],
+                static_cast<std::uint16_t>(value));
+            ASSERT_EQ(
+                table.find_column("composite.field")
+                    ->values_as<std::uint32_t>()[row],
+                value + 1);
+        }
+    }
+}
+
+TEST_F(ColumnarConverterTest, ReportsFullBatch)
+{
+    sbepp::columnar_converter<test_schema::messages::msg2> converter{3};
+    ASSERT_EQ(converter.batch_size(), 3);
+
+    ASSERT_FALSE(converter.append(fill_msg2(1, 1)));
+    ASSERT_FALSE(converter.append(fill_msg2(2, 1)));
+    ASSERT_TRUE(converter.append(fill_msg2(3, 1)));
+    ASSERT_TRUE(converter.full());
+}
+
+TEST_F(ColumnarConverterTest, ClearKeepsSchema)
+{
+    sbepp::columnar_converter<test_schema::messages::msg2> converter;
+    converter.append(fill_msg2(1, 2));
+    const auto columns = converter.tables()[0].columns().size();
+
+    converter.clear();
+
+    ASSERT_EQ(converter.size(), 0);
+    ASSERT_EQ(converter.tables().size(), 3);
+    ASSERT_EQ(converter.tables()[0].columns().size(), columns);
+    ASSERT_EQ(converter.tables()[1].size(), 0);
+    ASSERT_TRUE(converter.tables()[1].parent_index().empty());
+    for(const auto& c : converter.tables()[0].columns())
+    {
+        ASSERT_EQ(c.size(), 0);
+    }
+
+    converter.append(fill_msg2(5, 1));
+    ASSERT_EQ(converter.size(), 1);
+    ASSERT_EQ(converter.tables()[1].parent_index()[0], 0);
+    ASSERT_EQ(
+        converter.tables()[0].find_column("number")->values_as<std::uint32_t>()
+            [0],
+        5);
+    ASSERT_EQ(converter.tables()[0].find_column("data")->offsets()[1], 2);
+}
+
+TEST_F(ColumnarConverterTest, ReservesGroupTablesAfterFirstMessage)
+{
+    sbepp::columnar_converter<test_schema::messages::msg2> converter{10};
+    converter.append(fill_msg2(0, 2));
+    const auto group = converter.find_table("group");
+    const auto values = group->find_column("number")->data();
+    const auto parents = group->parent_index().data();
+
+    for(std::uint32_t i = 1; i != converter.batch_size(); i++)
+    {
+        converter.append(fill_msg2(i, 2));
+    }
+
+    ASSERT_EQ(group->size(), 20);
+    ASSERT_EQ(group->find_column("number")->data(), values);
+    ASSERT_EQ(group->parent_index().data(), parents);
+}
+
+TEST(ColumnTest, ReservesBinaryValuesByAverageSize)
+{
+    sbepp::column c{"c", sbepp::column_type::binary, 0, false};
+    const char value[] = "abcd";
+    c.append(value, 4);
+    c.reserve(10);
+    const auto data = c.data();
+    const auto offsets = c.offsets();
+
+    for(std::size_t i = 1; i != 10; i++)
+    {
+        c.append(value, 4);
+    }
+
+    ASSERT_EQ(c.size(), 10);
+    ASSERT_EQ(c.data(), data);
+    ASSERT_EQ(c.offsets(), offsets);
+}
+
+TEST(ColumnTest, AppendsValues)
+{
+    sbepp::column c{"c", sbepp::column_type::int16, 2, true};
+    const std::int16_t values[] = {-1, 2, 3};
+
+    for(std::size_t i = 0; i != 3; i++)
+    {
+        c.append(&values[i], sizeof(values[i]), i != 1);
+    }
+
+    ASSERT_EQ(c.name(), "c");
+    ASSERT_EQ(c.size(), 3);
+    ASSERT_EQ(c.data_size(), 6);
+    ASSERT_EQ(c.values_as<std::int16_t>()[0], -1);
+    ASSERT_EQ(c.values_as<std::int16_t>()[2], 3);
+    ASSERT_FALSE(c.is_null(0));
+    ASSERT_TRUE(c.is_null(1));
+    ASSERT_FALSE(c.is_null(2));
+}
+} // namespace
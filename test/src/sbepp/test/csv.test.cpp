@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#    include <test_schema/messages/msg28.hpp>
+#endif
+
+#include <sbepp/csv.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+class CsvFormatterTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 1024> buf{};
+
+    test_schema::messages::msg2<std::uint8_t> fill_msg2(
+        const std::uint32_t number, const std::size_t entry_count)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number(number);
+        m.array()[0] = 'a';
+        m.enumeration(test_schema::types::numbers_enum::Two);
+        m.set(test_schema::types::options_set{}.A(true));
+        m.composite().x(number + 1);
+        m.composite().y(number + 2);
+
+        auto g = m.group();
+        sbepp::fill_group_header(g, entry_count);
+        std::uint32_t i{};
+        for(auto e : g)
+        {
+            e.number(10 + i);
+            e.composite().x(i);
+            sbepp::fill_group_header(e.group(), i);
+            e.data().resize(i);
+            i++;
+        }
+        const char str[] = "hi";
+        m.data().assign(std::begin(str), std::end(str) - 1);
+        return m;
+    }
+
+    template<template<typename> class Message>
+    static std::string to_string(const sbepp::csv_formatter<Message>& f)
+    {
+        return {f.data(), f.size()};
+    }
+};
+
+TEST_F(CsvFormatterTest, BuildsColumnsFromTraits)
+{
+    sbepp::csv_formatter<test_schema::messages::msg2> formatter;
+
+    const std::vector<std::string> expected{
+        "number",
+        "array",
+        "enumeration",
+        "set",
+        "composite.x",
+        "composite.y",
+        "group.number",
+        "group.array",
+        "group.enumeration",
+        "group.set",
+        "group.composite.x",
+        "group.composite.y",
+        "group.data",
+        "data"};
+    ASSERT_EQ(formatter.columns(), expected);
+
+    formatter.format_header();
+    ASSERT_EQ(
+        to_string(formatter),
+        "number,array,enumeration,set,composite.x,composite.y,group.number,"
+        "group.array,group.enumeration,group.set,group.composite.x,"
+        "group.composite.y,group.data,data\n");
+}
+
+TEST_F(CsvFormatterTest, FormatsMessageWithoutEntriesAsSingleRow)
+{
+    sbepp::csv_formatter<test_schema::messages::msg2> formatter;
+
+    ASSERT_EQ(formatter.format(fill_msg2(1, 0)), 1);
+    ASSERT_EQ(to_string(formatter), "1,a,Two,A,2,3,,,,,,,,104 105\n");
+
+    formatter.clear();
+    ASSERT_EQ(formatter.size(), 0);
+}
+
+TEST_F(CsvFormatterTest, FlattensGroupsIntoRepeatedRows)
+{
+    sbepp::csv_formatter<test_schema::messages::msg2> formatter;
+
+    // entry with N nested entries produces N rows
+    ASSERT_EQ(formatter.format(fill_msg2(1, 3)), 4);
+    ASSERT_EQ(
+        to_string(formatter),
+        "1,a,Two,A,2,3,10,,0,,0,0,,104 105\n"
+        "1,a,Two,A,2,3,11,,0,,1,0,0,104 105\n"
+        "1,a,Two,A,2,3,12,,0,,2,0,0 0,104 105\n"
+        "1,a,Two,A,2,3,12,,0,,2,0,0 0,104 105\n");
+}
+
+TEST_F(CsvFormatterTest, FormatsValues)
+{
+    sbepp::csv_formatter<test_schema::messages::msg28> formatter;
+    auto m =
+        sbepp::make_view<test_schema::messages::msg28>(buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.required(1);
+    m.optional1(sbepp::nullopt);
+    m.optional2(5);
+    m.number(test_schema::types::numbers_enum::One);
+    m.option(test_schema::types::options_set{}.A(true).B(true));
+    const char str[] = "a,\"b";
+    std::copy(std::begin(str), std::end(str), m.string().begin());
+    m.array()[0] = 1;
+    m.array()[1] = 2;
+    sbepp::fill_group_header(m.group(), 0);
+    m.varData().push_back(1);
+    m.varData().push_back(2);
+    m.varStr().push_back('x');
+
+    formatter.format(m);
+
+    ASSERT_EQ(
+        to_string(formatter),
+        "1,,5,One,A|B,\"a,\"\"b\",1 2 0 0 0 0 0 0,,1 2,x\n");
+}
+
+TEST_F(CsvFormatterTest, FormatsUnknownEnumAsNumber)
+{
+    sbepp::csv_formatter<test_schema::messages::msg28> formatter;
+    auto m =
+        sbepp::make_view<test_schema::messages::msg28>(buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.number(static_cast<test_schema::types::numbers_enum>(7));
+    sbepp::fill_group_header(m.group(), 0);
+    m.varData().resize(0);
+    m.varStr().resize(0);
+
+    formatter.format(m);
+
+    ASSERT_EQ(to_string(formatter), "0,0,0,7,,,0 0 0 0 0 0 0 0,,,\n");
+}
+
+#if defined(__linux__)
+std::string read_file(std::FILE* file)
+{
+    std::string res;
+    std::rewind(file);
+    char buffer[256];
+    std::size_t n;
+    while((n = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+    {
+        res.append(buffer, n);
+    }
+    return res;
+}
+
+TEST_F(CsvFormatterTest, WriterFlushesFullBuffer)
+{
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    sbepp::csv_writer<test_schema::messages::msg2> writer{::fileno(file), 30};
+
+    writer.write_header();
+    const auto header = read_file(file);
+    ASSERT_FALSE(header.empty());
+    // row is smaller than the buffer
+    writer.write(fill_msg2(1, 0));
+    ASSERT_EQ(read_file(file), header);
+    writer.flush();
+    ASSERT_EQ(read_file(file), header + "1,a,Two,A,2,3,,,,,,,,104 105\n");
+
+    std::fclose(file);
+}
+
+TEST_F(CsvFormatterTest, ExportsJournalInParallel)
+{
+    std::vector<std::uint8_t> journal;
+    sbepp::csv_formatter<test_schema::messages::msg2> formatter;
+    formatter.format_header();
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        const auto m = fill_msg2(i, i % 4);
+        formatter.format(m);
+        journal.insert(
+            journal.end(), buf.data(), buf.data() + sbepp::size_bytes(m));
+    }
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    sbepp::csv_export_options options;
+    options.threads = 3;
+    options.chunk_size = 1;
+
+    const auto messages = sbepp::export_csv<test_schema::messages::msg2>(
+        ::fileno(file), journal.data(), journal.size(), options);
+
+    ASSERT_EQ(messages, 20);
+    ASSERT_EQ(read_file(file), to_string(formatter));
+    std::fclose(file);
+}
+
+TEST_F(CsvFormatterTest, ExportKeepsOrderWithSinglePendingChunk)
+{
+    std::vector<std::uint8_t> journal;
+    sbepp::csv_formatter<test_schema::messages::msg2> formatter;
+    for(std::uint32_t i = 0; i != 100; i++)
+    {
+        const auto m = fill_msg2(i, i % 4);
+        formatter.format(m);
+        journal.insert(
+            journal.end(), buf.data(), buf.data() + sbepp::size_bytes(m));
+    }
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    sbepp::csv_export_options options;
+    options.threads = 4;
+    options.chunk_size = 1;
+    options.max_pending_chunks = 1;
+    options.header = false;
+
+    const auto messages = sbepp::export_csv<test_schema::messages::msg2>(
+        ::fileno(file), journal.data(), journal.size(), options);
+
+    ASSERT_EQ(messages, 100);
+    ASSERT_EQ(read_file(file), to_string(formatter));
+    std::fclose(file);
+}
+
+TEST_F(CsvFormatterTest, ExportThrowsIfWriteFails)
+{
+    std::vector<std::uint8_t> journal;
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        const auto m = fill_msg2(i, 1);
+        journal.insert(
+            journal.end(), buf.data(), buf.data() + sbepp::size_bytes(m));
+    }
+    sbepp::csv_export_options options;
+    options.threads = 3;
+    options.chunk_size = 1;
+    options.max_pending_chunks = 2;
+    options.header = false;
+
+    ASSERT_THROW(
+        sbepp::export_csv<test_schema::messages::msg2>(
+            -1, journal.data(), journal.size(), options),
+        std::system_error);
+}
+
+TEST_F(CsvFormatterTest, ExportIgnoresIncompleteMessage)
+{
+    std::vector<std::uint8_t> journal;
+    for(std::uint32_t i = 0; i != 2; i++)
+    {
+        const auto m = fill_msg2(i, 1);
+        journal.insert(
+            journal.end(), buf.data(), buf.data() + sbepp::size_bytes(m));
+    }
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    sbepp::csv_export_options options;
+    options.header = false;
+
+    const auto messages = sbepp::export_csv<test_schema::messages::msg2>(
+        ::fileno(file), journal.data(), journal.size() - 1, options);
+
+    ASSERT_EQ(messages, 1);
+    ASSERT_EQ(read_file(file), "0,a,Two,A,1,2,10,,0,,0,0,,104 105\n");
+    std::fclose(file);
+}
+#endif
+} // namespace
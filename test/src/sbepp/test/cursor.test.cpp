@@ -423,6 +423,47 @@ TEST_F(CursorTest, LastTypeFieldSkipMovesCursorToBlockLength)
         std::is_void<decltype(m.number2(sbepp::cursor_ops::skip(c)))>);
 }
 
+TEST_F(CursorTest, TypeFieldReadAbsoluteMovesCursorToBlockLength)
+{
+    test_schema::messages::msg4<byte_type> m{buf.data(), buf.size()};
+    auto header = sbepp::fill_message_header(m);
+    header.blockLength(magic_block_length);
+    c = sbepp::init_cursor(m);
+    auto old_ptr = c.pointer();
+    m.number1(number_value);
+    m.number2(number_value + 1);
+
+    // order doesn't matter
+    auto n2 = m.number2(sbepp::cursor_ops::absolute(c));
+    auto n1 = m.number1(sbepp::cursor_ops::absolute(c));
+
+    ASSERT_EQ(n1, number_value);
+    ASSERT_EQ(n2, number_value + 1);
+    ASSERT_EQ(c.pointer(), old_ptr + magic_block_length);
+    STATIC_ASSERT(noexcept(m.number1(sbepp::cursor_ops::absolute(c))));
+    STATIC_ASSERT(noexcept(m.number2(sbepp::cursor_ops::absolute(c))));
+}
+
+TEST_F(CursorTest, TypeFieldWriteAbsoluteMovesCursorToBlockLength)
+{
+    test_schema::messages::msg4<byte_type> m{buf.data(), buf.size()};
+    auto header = sbepp::fill_message_header(m);
+    header.blockLength(magic_block_length);
+    c = sbepp::init_cursor(m);
+    auto old_ptr = c.pointer();
+
+    m.number2(number_value + 1, sbepp::cursor_ops::absolute(c));
+    m.number1(number_value, sbepp::cursor_ops::absolute(c));
+
+    ASSERT_EQ(m.number1(), number_value);
+    ASSERT_EQ(m.number2(), number_value + 1);
+    ASSERT_EQ(c.pointer(), old_ptr + magic_block_length);
+    STATIC_ASSERT(
+        noexcept(m.number1(number_value, sbepp::cursor_ops::absolute(c))));
+    STATIC_ASSERT(
+        noexcept(m.number2(number_value, sbepp::cursor_ops::absolute(c))));
+}
+
 TEST_F(CursorDeathTest, TypeFieldAccessorsTerminateIfBufferIsNotEnough)
 {
     // buffer is only enough to hold the header
@@ -439,6 +480,8 @@ TEST_F(CursorDeathTest, TypeFieldAccessorsTerminateIfBufferIsNotEnough)
     ASSERT_DEATH({ m.number1(sbepp::cursor_ops::init_dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.number1(1, sbepp::cursor_ops::init_dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.number1(sbepp::cursor_ops::skip(c)); }, ".*");
+    ASSERT_DEATH({ m.number1(sbepp::cursor_ops::absolute(c)); }, ".*");
+    ASSERT_DEATH({ m.number1(1, sbepp::cursor_ops::absolute(c)); }, ".*");
 
     ASSERT_DEATH({ m.number2(c); }, ".*");
     ASSERT_DEATH({ m.number2(1, c); }, ".*");
@@ -449,6 +492,8 @@ TEST_F(CursorDeathTest, TypeFieldAccessorsTerminateIfBufferIsNotEnough)
     ASSERT_DEATH({ m.number2(sbepp::cursor_ops::init_dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.number2(1, sbepp::cursor_ops::init_dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.number2(sbepp::cursor_ops::skip(c)); }, ".*");
+    ASSERT_DEATH({ m.number2(sbepp::cursor_ops::absolute(c)); }, ".*");
+    ASSERT_DEATH({ m.number2(1, sbepp::cursor_ops::absolute(c)); }, ".*");
 }
 
 TEST_F(CursorTest, NonLastArrayFieldReadMovesCursorToItsEnd)
@@ -604,6 +649,24 @@ TEST_F(CursorTest, LastArrayFieldSkipMovesCursorToBlockLength)
         std::is_void<decltype(m.array2(sbepp::cursor_ops::skip(c)))>);
 }
 
+TEST_F(CursorTest, ArrayFieldReadAbsoluteMovesCursorToBlockLength)
+{
+    test_schema::messages::msg5<byte_type> m{buf.data(), buf.size()};
+    auto header = sbepp::fill_message_header(m);
+    header.blockLength(magic_block_length);
+    c = sbepp::init_cursor(m);
+    auto old_ptr = c.pointer();
+
+    auto array2 = m.array2(sbepp::cursor_ops::absolute(c));
+    auto array1 = m.array1(sbepp::cursor_ops::absolute(c));
+
+    ASSERT_EQ(sbepp::addressof(array1), sbepp::addressof(m.array1()));
+    ASSERT_EQ(sbepp::addressof(array2), sbepp::addressof(m.array2()));
+    ASSERT_EQ(c.pointer(), old_ptr + magic_block_length);
+    STATIC_ASSERT(noexcept(m.array1(sbepp::cursor_ops::absolute(c))));
+    STATIC_ASSERT(noexcept(m.array2(sbepp::cursor_ops::absolute(c))));
+}
+
 TEST_F(CursorDeathTest, ArrayFieldAccessorsTerminateIfBufferIsNotEnough)
 {
     // buffer is only enough to hold the header
@@ -616,12 +679,14 @@ TEST_F(CursorDeathTest, ArrayFieldAccessorsTerminateIfBufferIsNotEnough)
     ASSERT_DEATH({ m.array1(sbepp::cursor_ops::dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.array1(sbepp::cursor_ops::init_dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.array1(sbepp::cursor_ops::skip(c)); }, ".*");
+    ASSERT_DEATH({ m.array1(sbepp::cursor_ops::absolute(c)); }, ".*");
 
     ASSERT_DEATH({ m.array2(c); }, ".*");
     ASSERT_DEATH({ m.array2(sbepp::cursor_ops::init(c)); }, ".*");
     ASSERT_DEATH({ m.array2(sbepp::cursor_ops::dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.array2(sbepp::cursor_ops::init_dont_move(c)); }, ".*");
     ASSERT_DEATH({ m.array2(sbepp::cursor_ops::skip(c)); }, ".*");
+    ASSERT_DEATH({ m.array2(sbepp::cursor_ops::absolute(c)); }, ".*");
 }
 
 TEST_F(CursorTest, NonLastEnumFieldReadMovesCursorToItsEnd)
@@ -1806,6 +1871,34 @@ TEST_F(CursorTest, CanIterateOverEmptyGroupUsingCursor)
     ASSERT_EQ(d[0], d2[0]);
 }
 
+TEST_F(CursorTest, CanIterateOverGroupsUsingAbsoluteFieldAccess)
+{
+    test_schema::messages::msg9<byte_type> m{buf.data(), buf.size()};
+    sbepp::fill_message_header(m);
+    m.number(1);
+    auto g1 = m.group1();
+    sbepp::fill_group_header(g1, 3);
+    for(std::size_t i = 0; i != g1.size(); i++)
+    {
+        g1[i].number(static_cast<std::uint32_t>(i));
+    }
+    auto g2 = m.group2();
+    sbepp::fill_group_header(g2, 2);
+    g2[1].number(2);
+    std::size_t i{};
+
+    // absolute access doesn't require initialized cursor
+    ASSERT_EQ(m.number(sbepp::cursor_ops::absolute(c)), 1);
+    for(const auto entry : m.group1(c).cursor_range(c))
+    {
+        ASSERT_EQ(sbepp::addressof(entry), sbepp::addressof(g1[i]));
+        ASSERT_EQ(entry.number(sbepp::cursor_ops::absolute(c)), i);
+        i++;
+    }
+    auto g2_from_cursor = m.group2(c);
+    ASSERT_EQ(sbepp::addressof(g2_from_cursor), sbepp::addressof(g2));
+}
+
 TEST_F(
     CursorTest, CursorBasedSizeBytesReturnsDistanceFromViewStartToCursorPointer)
 {
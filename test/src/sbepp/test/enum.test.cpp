@@ -63,6 +63,14 @@ TEST(EnumTest, EnumToStringReturnsNullptrIfValueIsUnknown)
     ASSERT_EQ(sbepp::enum_to_string(e), nullptr);
 }
 
+TEST(EnumTest, EnumIsValidChecksValidValues)
+{
+    ASSERT_TRUE(sbepp::enum_is_valid(enum_t::One));
+    ASSERT_TRUE(sbepp::enum_is_valid(enum_t::Two));
+    ASSERT_FALSE(sbepp::enum_is_valid(static_cast<enum_t>(0)));
+    ASSERT_FALSE(sbepp::enum_is_valid(static_cast<enum_t>(4)));
+}
+
 #if SBEPP_HAS_CONSTEXPR_ACCESSORS
 constexpr auto underlying = sbepp::to_underlying(enum_t::One);
 #endif
@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg27.hpp>
+#endif
+
+#include <sbepp/fragmentation.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using byte_type = std::uint8_t;
+using fragment_t = std::vector<byte_type>;
+
+class FragmentationTest : public ::testing::Test
+{
+public:
+    std::array<byte_type, 64> message{};
+    sbepp::fragmenter fragmenter{10};
+    sbepp::reassembler_options options;
+
+    FragmentationTest()
+    {
+        for(std::size_t i = 0; i != message.size(); i++)
+        {
+            message[i] = static_cast<byte_type>(i);
+        }
+    }
+
+    std::vector<fragment_t> make_fragments(const std::size_t size)
+    {
+        std::vector<fragment_t> res;
+        fragmenter.fragment(
+            message.data(),
+            size,
+            [&res](
+                const sbepp::fragment_header& header,
+                const byte_type* payload,
+                const std::size_t payload_size)
+            {
+                fragment_t fragment(sbepp::fragment_header_size + payload_size);
+                sbepp::write_fragment_header(fragment.data(), header);
+                std::copy_n(
+                    payload,
+                    payload_size,
+                    fragment.data() + sbepp::fragment_header_size);
+                res.push_back(std::move(fragment));
+            });
+
+        return res;
+    }
+
+    static sbepp::reassembler::status
+        on_fragment(sbepp::reassembler& r, const fragment_t& fragment)
+    {
+        return r.on_fragment(fragment.data(), fragment.size());
+    }
+
+    bool is_equal_to_message(
+        const sbepp::reassembler& r, const std::size_t size) const
+    {
+        return (r.message_size() == size)
+               && std::equal(
+                   message.data(), message.data() + size, r.message_data());
+    }
+};
+
+TEST_F(FragmentationTest, HeaderRoundTrips)
+{
+    std::array<byte_type, sbepp::fragment_header_size> buf{};
+    const sbepp::fragment_header header{1, 2, 3, 4};
+
+    sbepp::write_fragment_header(buf.data(), header);
+    const auto res = sbepp::read_fragment_header(buf.data());
+
+    ASSERT_EQ(res.message_id, header.message_id);
+    ASSERT_EQ(res.message_size, header.message_size);
+    ASSERT_EQ(res.fragment_index, header.fragment_index);
+    ASSERT_EQ(res.fragment_count, header.fragment_count);
+}
+
+TEST_F(FragmentationTest, SplitsMessageIntoFragments)
+{
+    const auto fragments = make_fragments(25);
+
+    ASSERT_EQ(fragmenter.get_fragment_count(25), 3);
+    ASSERT_EQ(fragments.size(), 3);
+    ASSERT_EQ(fragments[0].size(), sbepp::fragment_header_size + 10);
+    ASSERT_EQ(fragments[1].size(), sbepp::fragment_header_size + 10);
+    ASSERT_EQ(fragments[2].size(), sbepp::fragment_header_size + 5);
+    for(std::size_t i = 0; i != fragments.size(); i++)
+    {
+        const auto header = sbepp::read_fragment_header(fragments[i].data());
+        ASSERT_EQ(header.message_id, 0);
+        ASSERT_EQ(header.message_size, 25);
+        ASSERT_EQ(header.fragment_index, i);
+        ASSERT_EQ(header.fragment_count, 3);
+    }
+    ASSERT_EQ(fragmenter.next_message_id(), 1);
+}
+
+TEST_F(FragmentationTest, EmptyMessageHasSingleFragment)
+{
+    const auto fragments = make_fragments(0);
+    sbepp::reassembler r{options};
+
+    ASSERT_EQ(fragments.size(), 1);
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::complete);
+    ASSERT_EQ(r.message_size(), 0);
+}
+
+TEST_F(FragmentationTest, ReassemblesMessage)
+{
+    const auto fragments = make_fragments(25);
+    sbepp::reassembler r{options};
+
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::incomplete);
+    ASSERT_EQ(
+        on_fragment(r, fragments[1]), sbepp::reassembler::status::incomplete);
+    ASSERT_EQ(
+        on_fragment(r, fragments[2]), sbepp::reassembler::status::complete);
+
+    ASSERT_TRUE(is_equal_to_message(r, 25));
+    ASSERT_TRUE(r.is_copied());
+    ASSERT_EQ(r.get_lost_messages(), 0);
+    ASSERT_EQ(r.get_dropped_fragments(), 0);
+}
+
+TEST_F(FragmentationTest, DoesNotCopySingleFragmentMessage)
+{
+    const auto fragments = make_fragments(10);
+    sbepp::reassembler r{options};
+
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::complete);
+
+    ASSERT_FALSE(r.is_copied());
+    ASSERT_EQ(
+        r.message_data(), fragments[0].data() + sbepp::fragment_header_size);
+    ASSERT_TRUE(is_equal_to_message(r, 10));
+}
+
+TEST_F(FragmentationTest, DoesNotCopyContiguousStableFragments)
+{
+    // headers and payloads are stored separately like with scatter/gather I/O
+    std::vector<sbepp::fragment_header> headers;
+    std::array<byte_type, 64> payloads{};
+    std::vector<std::size_t> sizes;
+    std::size_t offset{};
+    fragmenter.fragment(
+        message.data(),
+        25,
+        [&](const sbepp::fragment_header& header,
+            const byte_type* payload,
+            const std::size_t size)
+        {
+            headers.push_back(header);
+            std::copy_n(payload, size, payloads.data() + offset);
+            sizes.push_back(size);
+            offset += size;
+        });
+    options.stable_fragments = true;
+    sbepp::reassembler r{options};
+
+    offset = 0;
+    sbepp::reassembler::status status{};
+    for(std::size_t i = 0; i != headers.size(); i++)
+    {
+        status = r.on_fragment(headers[i], payloads.data() + offset, sizes[i]);
+        offset += sizes[i];
+    }
+
+    ASSERT_EQ(status, sbepp::reassembler::status::complete);
+    ASSERT_FALSE(r.is_copied());
+    ASSERT_EQ(r.message_data(), payloads.data());
+    ASSERT_TRUE(is_equal_to_message(r, 25));
+}
+
+TEST_F(FragmentationTest, CopiesNonContiguousStableFragments)
+{
+    const auto fragments = make_fragments(25);
+    options.stable_fragments = true;
+    sbepp::reassembler r{options};
+
+    on_fragment(r, fragments[0]);
+    on_fragment(r, fragments[1]);
+    ASSERT_EQ(
+        on_fragment(r, fragments[2]), sbepp::reassembler::status::complete);
+
+    ASSERT_TRUE(r.is_copied());
+    ASSERT_TRUE(is_equal_to_message(r, 25));
+}
+
+TEST_F(FragmentationTest, ProvidesMessageView)
+{
+    std::array<byte_type, 64> buf{};
+    auto m = sbepp::make_view<test_schema::messages::msg27>(
+        buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.number(7);
+    sbepp::fill_group_header(m.group(), 0);
+    m.data().resize(20);
+    std::vector<fragment_t> fragments;
+    fragmenter.fragment(
+        m,
+        [&fragments](
+            const sbepp::fragment_header& header,
+            const byte_type* payload,
+            const std::size_t size)
+        {
+            fragment_t fragment(sbepp::fragment_header_size + size);
+            sbepp::write_fragment_header(fragment.data(), header);
+            std::copy_n(
+                payload, size, fragment.data() + sbepp::fragment_header_size);
+            fragments.push_back(std::move(fragment));
+        });
+    sbepp::reassembler r{options};
+
+    for(const auto& fragment : fragments)
+    {
+        on_fragment(r, fragment);
+    }
+    const auto m2 = r.get_message<test_schema::messages::msg27>();
+
+    ASSERT_EQ(sbepp::size_bytes(m2), sbepp::size_bytes(m));
+    ASSERT_EQ(m2.number(), 7);
+    ASSERT_EQ(m2.data().size(), 20);
+}
+
+TEST_F(FragmentationTest, DetectsLostFragment)
+{
+    const auto fragments = make_fragments(25);
+    const auto fragments2 = make_fragments(25);
+    sbepp::reassembler r{options};
+
+    on_fragment(r, fragments[0]);
+    ASSERT_EQ(
+        on_fragment(r, fragments[2]), sbepp::reassembler::status::dropped);
+    ASSERT_EQ(r.get_lost_messages(), 1);
+
+    // the next message is not affected
+    on_fragment(r, fragments2[0]);
+    on_fragment(r, fragments2[1]);
+    ASSERT_EQ(
+        on_fragment(r, fragments2[2]), sbepp::reassembler::status::complete);
+    ASSERT_EQ(r.get_lost_messages(), 1);
+}
+
+TEST_F(FragmentationTest, DetectsLostMessages)
+{
+    const auto fragments = make_fragments(5);
+    make_fragments(5);
+    make_fragments(5);
+    const auto fragments2 = make_fragments(5);
+    sbepp::reassembler r{options};
+
+    on_fragment(r, fragments[0]);
+    ASSERT_EQ(
+        on_fragment(r, fragments2[0]), sbepp::reassembler::status::complete);
+
+    ASSERT_EQ(r.get_lost_messages(), 2);
+}
+
+TEST_F(FragmentationTest, DetectsLostMessageTail)
+{
+    const auto fragments = make_fragments(25);
+    const auto fragments2 = make_fragments(5);
+    sbepp::reassembler r{options};
+
+    on_fragment(r, fragments[0]);
+    ASSERT_EQ(
+        on_fragment(r, fragments2[0]), sbepp::reassembler::status::complete);
+
+    ASSERT_EQ(r.get_lost_messages(), 1);
+    ASSERT_TRUE(is_equal_to_message(r, 5));
+}
+
+TEST_F(FragmentationTest, DropsMessageWithoutBeginning)
+{
+    const auto fragments = make_fragments(25);
+    sbepp::reassembler r{options};
+
+    ASSERT_EQ(
+        on_fragment(r, fragments[1]), sbepp::reassembler::status::dropped);
+    ASSERT_EQ(
+        on_fragment(r, fragments[2]), sbepp::reassembler::status::dropped);
+
+    ASSERT_EQ(r.get_lost_messages(), 1);
+    ASSERT_EQ(r.get_dropped_fragments(), 2);
+}
+
+TEST_F(FragmentationTest, DropsDuplicatedFragments)
+{
+    const auto fragments = make_fragments(5);
+    sbepp::reassembler r{options};
+
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::complete);
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::dropped);
+
+    ASSERT_EQ(r.get_lost_messages(), 0);
+    ASSERT_EQ(r.get_dropped_fragments(), 1);
+}
+
+TEST_F(FragmentationTest, IgnoresRepeatedFragmentOfCurrentMessage)
+{
+    const auto fragments = make_fragments(25);
+    sbepp::reassembler r{options};
+
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::incomplete);
+    ASSERT_EQ(
+        on_fragment(r, fragments[1]), sbepp::reassembler::status::incomplete);
+    ASSERT_EQ(
+        on_fragment(r, fragments[1]), sbepp::reassembler::status::dropped);
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::dropped);
+    ASSERT_EQ(
+        on_fragment(r, fragments[2]), sbepp::reassembler::status::complete);
+
+    ASSERT_TRUE(is_equal_to_message(r, 25));
+    ASSERT_EQ(r.get_lost_messages(), 0);
+    ASSERT_EQ(r.get_dropped_fragments(), 2);
+}
+
+TEST_F(FragmentationTest, DropsMalformedFragments)
+{
+    options.max_message_size = 20;
+    sbepp::reassembler r{options};
+    const std::array<byte_type, 2> too_short{};
+    const auto too_big = make_fragments(25);
+
+    ASSERT_EQ(
+        r.on_fragment(too_short.data(), too_short.size()),
+        sbepp::reassembler::status::dropped);
+    ASSERT_EQ(
+        on_fragment(r, too_big[0]), sbepp::reassembler::status::dropped);
+
+    ASSERT_EQ(r.get_dropped_fragments(), 2);
+}
+
+TEST_F(FragmentationTest, ResetForgetsExpectedMessageId)
+{
+    const auto fragments = make_fragments(5);
+    sbepp::reassembler r{options};
+
+    on_fragment(r, fragments[0]);
+    r.reset();
+
+    ASSERT_EQ(
+        on_fragment(r, fragments[0]), sbepp::reassembler::status::complete);
+    ASSERT_EQ(r.get_dropped_fragments(), 0);
+}
+} // namespace
@@ -0,0 +1,305 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#endif
+
+#include <sbepp/journal_index.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+using message_type = test_schema::messages::msg2<const std::uint8_t>;
+
+// `number` is a key, `composite.x` is a timestamp
+struct record
+{
+    std::uint32_t key;
+    std::uint32_t timestamp;
+};
+
+class JournalIndexTest : public ::testing::Test
+{
+public:
+    std::vector<std::uint8_t> journal;
+    std::size_t message_size{};
+
+    void append(const record r)
+    {
+        std::array<std::uint8_t, 1024> buf{};
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number(r.key);
+        std::memcpy(m.array().data(), &r.key, sizeof(r.key));
+        m.composite().x(r.timestamp);
+        sbepp::fill_group_header(m.group(), 0);
+        m.data().resize(1);
+        message_size = sbepp::size_bytes(m);
+        journal.insert(journal.end(), buf.data(), buf.data() + message_size);
+    }
+
+    std::vector<std::uint8_t>
+        build(const sbepp::journal_index_options& options)
+    {
+        return sbepp::build_journal_index<test_schema::messages::msg2>(
+            journal.data(),
+            journal.size(),
+            [](const message_type m)
+            {
+                return *m.number();
+            },
+            [](const message_type m)
+            {
+                return std::uint64_t{*m.composite().x()};
+            },
+            options);
+    }
+
+    // options with `n` messages per chunk
+    sbepp::journal_index_options chunk_of(const std::size_t n) const
+    {
+        sbepp::journal_index_options options;
+        options.chunk_size = n * message_size;
+        return options;
+    }
+
+    std::vector<record> scan(
+        const sbepp::journal_index_view& index,
+        const std::uint32_t key,
+        const std::uint64_t min_timestamp,
+        const std::uint64_t max_timestamp)
+    {
+        std::vector<record> res;
+        sbepp::scan_journal<test_schema::messages::msg2>(
+            journal.data(),
+            journal.size(),
+            index,
+            key,
+            min_timestamp,
+            max_timestamp,
+            [&](const message_type m)
+            {
+                const auto ts = std::uint64_t{*m.composite().x()};
+                if((*m.number() == key) && (ts >= min_timestamp)
+                   && (ts <= max_timestamp))
+                {
+                    res.push_back({*m.number(), *m.composite().x()});
+                }
+            });
+        return res;
+    }
+};
+
+TEST_F(JournalIndexTest, StoresChunkBoundsAndTimestamps)
+{
+    for(std::uint32_t i = 0; i != 10; i++)
+    {
+        append({i, 100 - i});
+    }
+
+    const auto data = build(chunk_of(4));
+    const sbepp::journal_index_view index{data.data(), data.size()};
+
+    ASSERT_TRUE(index);
+    ASSERT_EQ(index.chunk_count(), 3);
+    ASSERT_EQ(index.journal_size(), journal.size());
+    const std::uint64_t counts[] = {4, 4, 2};
+    std::uint64_t offset{};
+    std::uint64_t timestamp = 100;
+    for(std::size_t i = 0; i != index.chunk_count(); i++)
+    {
+        const auto chunk = index.chunk(i);
+        ASSERT_EQ(chunk.begin, offset);
+        ASSERT_EQ(chunk.end, offset + counts[i] * message_size);
+        ASSERT_EQ(chunk.message_count, counts[i]);
+        ASSERT_EQ(chunk.max_timestamp, timestamp);
+        ASSERT_EQ(chunk.min_timestamp, timestamp - counts[i] + 1);
+        offset = chunk.end;
+        timestamp -= counts[i];
+    }
+}
+
+TEST_F(JournalIndexTest, BloomFilterHasNoFalseNegatives)
+{
+    for(std::uint32_t i = 0; i != 1000; i++)
+    {
+        append({i * 7919 % 1000, i});
+    }
+    const auto data = build(chunk_of(16));
+    const sbepp::journal_index_view index{data.data(), data.size()};
+
+    for(std::size_t chunk = 0; chunk != index.chunk_count(); chunk++)
+    {
+        for(std::uint32_t i = 0; i != 16; i++)
+        {
+            const auto message = chunk * 16 + i;
+            if(message < 1000)
+            {
+                ASSERT_TRUE(index.may_contain(
+                    chunk, static_cast<std::uint32_t>(message * 7919 % 1000)));
+            }
+        }
+    }
+}
+
+TEST_F(JournalIndexTest, ScanVisitsOnlyCandidateChunks)
+{
+    // keys are unique per chunk, timestamps grow
+    for(std::uint32_t i = 0; i != 100; i++)
+    {
+        append({i / 10, i});
+    }
+    const auto data = build(chunk_of(10));
+    const sbepp::journal_index_view index{data.data(), data.size()};
+    std::size_t visited{};
+
+    const auto candidates = index.for_each_candidate(
+        std::uint32_t{3},
+        0,
+        1000,
+        [&visited](const sbepp::journal_chunk& chunk)
+        {
+            ASSERT_EQ(chunk.min_timestamp, 30);
+            visited++;
+        });
+
+    ASSERT_EQ(candidates, 1);
+    ASSERT_EQ(visited, 1);
+    const auto found = scan(index, 3, 32, 34);
+    ASSERT_EQ(found.size(), 3);
+    ASSERT_EQ(found.front().timestamp, 32);
+    ASSERT_EQ(found.back().timestamp, 34);
+}
+
+TEST_F(JournalIndexTest, SkipsChunksOutsideTimestampRange)
+{
+    for(std::uint32_t i = 0; i != 100; i++)
+    {
+        append({1, i});
+    }
+    const auto data = build(chunk_of(10));
+    const sbepp::journal_index_view index{data.data(), data.size()};
+
+    const auto candidates = index.for_each_candidate(
+        std::uint32_t{1},
+        25,
+        44,
+        [](const sbepp::journal_chunk&)
+        {
+        });
+
+    ASSERT_EQ(candidates, 3);
+    ASSERT_EQ(scan(index, 1, 25, 44).size(), 20);
+    ASSERT_TRUE(scan(index, 1, 100, 200).empty());
+}
+
+TEST_F(JournalIndexTest, SupportsByteRangeKeys)
+{
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        append({i, i});
+    }
+    const auto data = sbepp::build_journal_index<test_schema::messages::msg2>(
+        journal.data(),
+        journal.size(),
+        [](const message_type m)
+        {
+            return m.array();
+        },
+        [](const message_type m)
+        {
+            return std::uint64_t{*m.composite().x()};
+        },
+        chunk_of(10));
+    const sbepp::journal_index_view index{data.data(), data.size()};
+    std::array<char, 128> key{};
+    const std::uint32_t value = 15;
+    std::memcpy(key.data(), &value, sizeof(value));
+
+    ASSERT_EQ(index.chunk_count(), 2);
+    ASSERT_TRUE(index.may_contain(1, key));
+}
+
+TEST_F(JournalIndexTest, IgnoresTrailingIncompleteMessage)
+{
+    append({1, 1});
+    append({2, 2});
+    journal.resize(journal.size() - 1);
+
+    const auto data = build(chunk_of(10));
+    const sbepp::journal_index_view index{data.data(), data.size()};
+
+    ASSERT_EQ(index.chunk_count(), 1);
+    ASSERT_EQ(index.chunk(0).message_count, 1);
+    ASSERT_EQ(index.journal_size(), message_size);
+}
+
+TEST_F(JournalIndexTest, RejectsMalformedIndex)
+{
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        append({i, i});
+    }
+    auto data = build(chunk_of(10));
+
+    ASSERT_FALSE(sbepp::journal_index_view{});
+    ASSERT_FALSE((sbepp::journal_index_view{data.data(), data.size() - 1}));
+    ASSERT_FALSE((sbepp::journal_index_view{data.data(), 47}));
+    data[0] = 0;
+    const sbepp::journal_index_view index{data.data(), data.size()};
+    ASSERT_FALSE(index);
+    ASSERT_EQ(index.chunk_count(), 0);
+}
+TEST_F(JournalIndexTest, ScanRejectsIndexWhichDoesNotMatchJournal)
+{
+    for(std::uint32_t i = 0; i != 20; i++)
+    {
+        append({1, i});
+    }
+    auto data = build(chunk_of(10));
+    const auto scan_with_size = [this, &data](const std::size_t size)
+    {
+        const sbepp::journal_index_view index{data.data(), data.size()};
+        sbepp::scan_journal<test_schema::messages::msg2>(
+            journal.data(),
+            size,
+            index,
+            std::uint32_t{1},
+            0,
+            100,
+            [](const message_type)
+            {
+            });
+    };
+    const auto set_chunk_end =
+        [&data](const std::size_t chunk, const std::uint64_t end)
+    {
+        // entry starts with `begin` and `end`
+        const auto entry_size =
+            (data.size() - sbepp::detail::journal_index_header_size) / 2;
+        sbepp::detail::set_primitive<sbepp::endian::little>(
+            data.data() + sbepp::detail::journal_index_header_size
+                + chunk * entry_size + 8,
+            end);
+    };
+
+    ASSERT_THROW(scan_with_size(journal.size() - 1), std::runtime_error);
+    set_chunk_end(1, journal.size() + 1);
+    ASSERT_THROW(scan_with_size(journal.size()), std::runtime_error);
+    set_chunk_end(1, 0);
+    ASSERT_THROW(scan_with_size(journal.size()), std::runtime_error);
+    set_chunk_end(1, journal.size() - 1);
+    ASSERT_THROW(scan_with_size(journal.size()), std::runtime_error);
+}
+} // namespace
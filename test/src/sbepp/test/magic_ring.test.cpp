@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg27.hpp>
+#endif
+
+#include <sbepp/magic_ring.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__)
+#    include <sys/mman.h>
+
+namespace
+{
+TEST(MagicRingTest, DefaultConstructedRingIsEmpty)
+{
+    sbepp::magic_ring ring;
+
+    ASSERT_EQ(ring.capacity(), 0);
+    ASSERT_EQ(ring.size(), 0);
+    ASSERT_EQ(ring.free_space(), 0);
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(MagicRingTest, RoundsCapacityUpToPageSize)
+{
+    const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+    sbepp::magic_ring ring1{1};
+    sbepp::magic_ring ring2{page_size + 1};
+
+    ASSERT_EQ(ring1.capacity(), page_size);
+    ASSERT_EQ(ring2.capacity(), 2 * page_size);
+    ASSERT_EQ(ring1.free_space(), ring1.capacity());
+}
+
+TEST(MagicRingTest, SecondMappingMirrorsFirstOne)
+{
+    sbepp::magic_ring ring{1};
+    const auto cap = ring.capacity();
+
+    ring.write_data()[0] = 1;
+    ring.commit(cap);
+    ring.consume(cap - 1);
+    ring.commit(cap - 1);
+
+    // last byte of the ring is followed by the first one
+    ASSERT_EQ(ring.read_data()[1], 1);
+}
+
+TEST(MagicRingTest, FallsBackWhenHugePagesAreNotAvailable)
+{
+    sbepp::memory_options options;
+    options.pages = sbepp::huge_pages::preferred;
+    options.numa_node = 0;
+    options.prefault = true;
+
+    sbepp::magic_ring ring{1, options};
+
+    ASSERT_GE(ring.capacity(), 1);
+    ring.write_data()[0] = 1;
+    ring.commit(ring.capacity());
+    ring.consume(ring.capacity() - 1);
+    ring.commit(1);
+    ASSERT_EQ(ring.read_data()[1], 1);
+}
+
+TEST(MagicRingTest, UsesHugePagesWhenTheyAreAvailable)
+{
+    // checks whether the pool has at least one free huge page
+    const auto huge_page_size = sbepp::detail::get_huge_page_size();
+    if(!huge_page_size)
+    {
+        GTEST_SKIP();
+    }
+    const auto addr = ::mmap(
+        nullptr,
+        huge_page_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+        -1,
+        0);
+    if(addr == MAP_FAILED)
+    {
+        GTEST_SKIP();
+    }
+    ::munmap(addr, huge_page_size);
+    sbepp::memory_options options;
+    options.pages = sbepp::huge_pages::preferred;
+
+    sbepp::magic_ring ring{1, options};
+
+    ASSERT_TRUE(ring.uses_huge_pages());
+    ASSERT_EQ(ring.capacity(), huge_page_size);
+    ASSERT_EQ(
+        reinterpret_cast<std::uintptr_t>(ring.read_data()) % huge_page_size,
+        0);
+    ring.write_data()[0] = 1;
+    ring.commit(ring.capacity());
+    ring.consume(ring.capacity() - 1);
+    ring.commit(1);
+    ASSERT_EQ(ring.read_data()[1], 1);
+}
+
+TEST(MagicRingTest, WrappedMessageIsContiguous)
+{
+    sbepp::magic_ring ring{1};
+    const auto cap = ring.capacity();
+    ring.commit(cap - 10);
+    ring.consume(cap - 10);
+
+    auto m = sbepp::make_view<test_schema::messages::msg27>(
+        ring.write_data(), ring.free_space());
+    sbepp::fill_message_header(m);
+    m.number(3);
+    sbepp::fill_group_header(m.group(), 2);
+    m.group()[1].number(4);
+    m.data().resize(5);
+    const auto size = sbepp::size_bytes(m);
+    ring.commit(size);
+
+    ASSERT_GT(size, 10);
+    const auto m2 = sbepp::make_const_view<test_schema::messages::msg27>(
+        ring.read_data(), ring.size());
+    ASSERT_EQ(sbepp::size_bytes(m2), size);
+    ASSERT_EQ(m2.number(), 3);
+    ASSERT_EQ(m2.group()[1].number(), 4);
+    ASSERT_EQ(m2.data().size(), 5);
+    ring.consume(size);
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(MagicRingTest, TracksReadAndWritePositions)
+{
+    sbepp::magic_ring ring{1};
+    const auto cap = ring.capacity();
+    const char str[] = "abc";
+
+    std::memcpy(ring.write_data(), str, sizeof(str));
+    ring.commit(sizeof(str));
+    ASSERT_EQ(ring.size(), sizeof(str));
+    ASSERT_EQ(ring.free_space(), cap - sizeof(str));
+    ASSERT_EQ(ring.write_data(), ring.read_data() + sizeof(str));
+
+    ring.consume(1);
+    ASSERT_EQ(ring.size(), sizeof(str) - 1);
+    ASSERT_STREQ(reinterpret_cast<const char*>(ring.read_data()), "bc");
+
+    ring.clear();
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.free_space(), cap);
+}
+
+TEST(MagicRingTest, CanBeMoved)
+{
+    sbepp::magic_ring ring{1};
+    ring.commit(1);
+    const auto data = ring.read_data();
+
+    sbepp::magic_ring ring2{std::move(ring)};
+    ASSERT_EQ(ring.capacity(), 0);
+    ASSERT_EQ(ring2.read_data(), data);
+    ASSERT_EQ(ring2.size(), 1);
+
+    ring = std::move(ring2);
+    ASSERT_EQ(ring2.capacity(), 0);
+    ASSERT_EQ(ring.read_data(), data);
+}
+} // namespace
+#endif
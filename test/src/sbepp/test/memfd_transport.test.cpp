@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#endif
+
+#include <sbepp/memfd_transport.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+
+namespace
+{
+constexpr std::size_t inline_threshold = 256;
+
+class MemfdTransportTest : public ::testing::Test
+{
+public:
+    sbepp::memfd_transport sender{-1};
+    sbepp::memfd_transport receiver{-1};
+
+    MemfdTransportTest()
+    {
+        sbepp::memfd_transport_options options;
+        options.inline_threshold = inline_threshold;
+        auto transports = sbepp::memfd_transport::make_pair(options);
+        sender = std::move(transports.first);
+        receiver = std::move(transports.second);
+    }
+
+    // encodes msg2 with `data_size` bytes of data into `buf`
+    static std::size_t encode_msg2(
+        std::uint8_t* buf,
+        const std::size_t buf_size,
+        const std::uint32_t number,
+        const std::size_t data_size)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg2>(buf, buf_size);
+        sbepp::fill_message_header(m);
+        m.number(number);
+        sbepp::fill_group_header(m.group(), 0);
+        auto d = m.data();
+        d.resize(data_size);
+        for(std::size_t i = 0; i != data_size; i++)
+        {
+            d[i] = static_cast<std::uint8_t>(i);
+        }
+        return sbepp::size_bytes(m);
+    }
+
+    static void expect_msg2(
+        const sbepp::received_message& msg,
+        const std::uint32_t number,
+        const std::size_t data_size)
+    {
+        const auto m = sbepp::make_const_view<test_schema::messages::msg2>(
+            msg.data(), msg.size());
+        ASSERT_EQ(sbepp::size_bytes(m), msg.size());
+        ASSERT_EQ(*m.number(), number);
+        const auto d = m.data();
+        ASSERT_EQ(d.size(), data_size);
+        for(std::size_t i = 0; i != data_size; i++)
+        {
+            ASSERT_EQ(d[i], static_cast<std::uint8_t>(i));
+        }
+    }
+
+    // sends raw shared frame with `fd` attached
+    void send_raw_shared(const int fd, const std::uint64_t size)
+    {
+        std::uint8_t header[16];
+        sbepp::detail::set_primitive<sbepp::endian::little>(
+            header, sbepp::detail::memfd_frame_magic);
+        sbepp::detail::set_primitive<sbepp::endian::little>(
+            header + 4, sbepp::detail::memfd_frame_shared);
+        sbepp::detail::set_primitive<sbepp::endian::little>(header + 8, size);
+        iovec iov;
+        iov.iov_base = header;
+        iov.iov_len = sizeof(header);
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        const auto cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(fd));
+        ASSERT_EQ(
+            ::sendmsg(sender.native_handle(), &msg, 0),
+            static_cast<ssize_t>(sizeof(header)));
+    }
+};
+
+TEST_F(MemfdTransportTest, SendsSmallMessageInline)
+{
+    std::vector<std::uint8_t> buf(inline_threshold);
+    const auto size = encode_msg2(buf.data(), buf.size(), 1, 10);
+    sender.send(buf.data(), size);
+    sbepp::received_message msg;
+
+    ASSERT_TRUE(receiver.receive(msg));
+    ASSERT_FALSE(msg.is_shared());
+    expect_msg2(msg, 1, 10);
+}
+
+TEST_F(MemfdTransportTest, SendsLargeMessageViaMemfd)
+{
+    std::vector<std::uint8_t> buf(4096);
+    const auto size = encode_msg2(buf.data(), buf.size(), 2, 3000);
+    sender.send(buf.data(), size);
+    sbepp::received_message msg;
+
+    ASSERT_TRUE(receiver.receive(msg));
+    ASSERT_TRUE(msg.is_shared());
+    expect_msg2(msg, 2, 3000);
+}
+
+TEST_F(MemfdTransportTest, SendsRegionWithoutCopying)
+{
+    sbepp::memfd_region region{4096};
+    const auto size = encode_msg2(region.data(), region.size(), 3, 2000);
+    const auto fd = ::dup(region.native_handle());
+    sender.send_shared(std::move(region), size);
+
+    ASSERT_FALSE(region);
+    // sent memfd can't be resized anymore
+    ASSERT_EQ(::ftruncate(fd, 8192), -1);
+    ASSERT_EQ(errno, EPERM);
+    ::close(fd);
+
+    sbepp::received_message msg;
+    ASSERT_TRUE(receiver.receive(msg));
+    ASSERT_TRUE(msg.is_shared());
+    expect_msg2(msg, 3, 2000);
+}
+
+TEST_F(MemfdTransportTest, ReusesReceivedMessage)
+{
+    std::vector<std::uint8_t> buf(4096);
+    auto size = encode_msg2(buf.data(), buf.size(), 1, 3000);
+    sender.send(buf.data(), size);
+    size = encode_msg2(buf.data(), buf.size(), 2, 5);
+    sender.send(buf.data(), size);
+    sbepp::received_message msg;
+
+    ASSERT_TRUE(receiver.receive(msg));
+    expect_msg2(msg, 1, 3000);
+    ASSERT_TRUE(receiver.receive(msg));
+    ASSERT_FALSE(msg.is_shared());
+    expect_msg2(msg, 2, 5);
+}
+
+TEST_F(MemfdTransportTest, KeepsPooledRegionUntilMessageIsReleased)
+{
+    sbepp::memfd_transport_options options;
+    options.inline_threshold = inline_threshold;
+    options.max_pooled_regions = 1;
+    auto transports = sbepp::memfd_transport::make_pair(options);
+    std::vector<std::uint8_t> buf(4096);
+    sbepp::received_message first;
+    sbepp::received_message second;
+
+    for(std::uint32_t i = 0; i != 3; i++)
+    {
+        auto size = encode_msg2(buf.data(), buf.size(), i, 3000);
+        transports.first.send(buf.data(), size);
+        ASSERT_TRUE(transports.second.receive(first));
+        // pooled region is still used by `first`
+        size = encode_msg2(buf.data(), buf.size(), i + 10, 2000);
+        transports.first.send(buf.data(), size);
+        ASSERT_TRUE(transports.second.receive(second));
+
+        expect_msg2(first, i, 3000);
+        expect_msg2(second, i + 10, 2000);
+        transports.second.release(first);
+        ASSERT_EQ(first.data(), nullptr);
+    }
+}
+
+TEST_F(MemfdTransportTest, SkipsReleaseFramesWhenReceiving)
+{
+    std::vector<std::uint8_t> buf(4096);
+    auto size = encode_msg2(buf.data(), buf.size(), 1, 3000);
+    sender.send(buf.data(), size);
+    sbepp::received_message msg;
+    ASSERT_TRUE(receiver.receive(msg));
+    receiver.release(msg);
+
+    size = encode_msg2(buf.data(), buf.size(), 2, 5);
+    receiver.send(buf.data(), size);
+
+    ASSERT_TRUE(sender.receive(msg));
+    expect_msg2(msg, 2, 5);
+}
+
+TEST_F(MemfdTransportTest, ReceiveReturnsFalseAfterShutdown)
+{
+    sender.shutdown();
+    sbepp::received_message msg;
+
+    ASSERT_FALSE(receiver.receive(msg));
+}
+
+TEST_F(MemfdTransportTest, RejectsUnsealedMemfd)
+{
+    const auto fd = ::memfd_create("test", MFD_CLOEXEC);
+    ASSERT_NE(fd, -1);
+    ASSERT_EQ(::ftruncate(fd, 4096), 0);
+    send_raw_shared(fd, 4096);
+    ::close(fd);
+    sbepp::received_message msg;
+
+    ASSERT_THROW(receiver.receive(msg), std::runtime_error);
+}
+
+TEST_F(MemfdTransportTest, RejectsMemfdSmallerThanMessage)
+{
+    sbepp::memfd_region region{4096};
+    ASSERT_EQ(
+        ::fcntl(
+            region.native_handle(),
+            F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW),
+        0);
+    send_raw_shared(region.native_handle(), 8192);
+    sbepp::received_message msg;
+
+    ASSERT_THROW(receiver.receive(msg), std::runtime_error);
+}
+
+TEST_F(MemfdTransportTest, RejectsInvalidFrame)
+{
+    const std::uint8_t garbage[4] = {1, 2, 3, 4};
+    ASSERT_EQ(
+        ::send(sender.native_handle(), garbage, sizeof(garbage), 0),
+        static_cast<ssize_t>(sizeof(garbage)));
+    sbepp::received_message msg;
+
+    ASSERT_THROW(receiver.receive(msg), std::runtime_error);
+}
+
+TEST(MemfdRegionTest, DefaultConstructedRegionIsEmpty)
+{
+    sbepp::memfd_region region;
+
+    ASSERT_FALSE(region);
+    ASSERT_EQ(region.data(), nullptr);
+    ASSERT_EQ(region.size(), 0u);
+    ASSERT_EQ(region.native_handle(), -1);
+}
+
+TEST(MemfdRegionTest, ThrowsOnZeroSize)
+{
+    ASSERT_THROW(sbepp::memfd_region{0}, std::system_error);
+}
+} // namespace
+#endif
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg28.hpp>
+#    include <test_schema/messages/msg3.hpp>
+#    include <test_schema/messages/msg9.hpp>
+#endif
+
+#include <sbepp/memoized_view.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace
+{
+using msg28_tag = test_schema::schema::messages::msg28;
+using msg9_tag = test_schema::schema::messages::msg9;
+using msg3_tag = test_schema::schema::messages::msg3;
+
+template<typename Data>
+void assign(const Data d, const std::string& str)
+{
+    d.assign(std::begin(str), std::end(str));
+}
+
+// checks that both views point to the same member
+template<typename View1, typename View2>
+bool same(const View1 v1, const View2 v2)
+{
+    return sbepp::addressof(v1) == sbepp::addressof(v2);
+}
+
+class MemoizedViewTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 1024> buf{};
+
+    test_schema::messages::msg28<std::uint8_t> make_msg28()
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg28>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.required(1);
+        auto g = m.group();
+        sbepp::fill_group_header(g, 3);
+        std::uint32_t number{};
+        for(const auto entry : g)
+        {
+            entry.number(number++);
+        }
+        assign(m.varData(), "data");
+        assign(m.varStr(), "string");
+        return m;
+    }
+};
+
+TEST_F(MemoizedViewTest, ProvidesSameMembersAsView)
+{
+    const auto m = make_msg28();
+    auto memoized = sbepp::make_memoized_view(m);
+
+    EXPECT_TRUE(same(memoized.view(), m));
+    EXPECT_EQ(*memoized->required(), 1);
+    EXPECT_TRUE(same(memoized.group<msg28_tag::group>(), m.group()));
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varData>(), m.varData()));
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varStr>(), m.varStr()));
+}
+
+TEST_F(MemoizedViewTest, CachesAllPrecedingMembers)
+{
+    const auto m = make_msg28();
+    auto memoized = sbepp::make_memoized_view(m);
+
+    EXPECT_EQ(memoized.cached_members(), 0u);
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varStr>(), m.varStr()));
+    EXPECT_EQ(memoized.cached_members(), 3u);
+
+    // doesn't depend on access order
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varData>(), m.varData()));
+    EXPECT_TRUE(same(memoized.group<msg28_tag::group>(), m.group()));
+    EXPECT_EQ(memoized.cached_members(), 3u);
+}
+
+TEST_F(MemoizedViewTest, CachesMembersIncrementally)
+{
+    const auto m = make_msg28();
+    auto memoized = sbepp::make_memoized_view(m);
+
+    EXPECT_TRUE(same(memoized.group<msg28_tag::group>(), m.group()));
+    EXPECT_EQ(memoized.cached_members(), 1u);
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varData>(), m.varData()));
+    EXPECT_EQ(memoized.cached_members(), 2u);
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varStr>(), m.varStr()));
+    EXPECT_EQ(memoized.cached_members(), 3u);
+}
+
+TEST_F(MemoizedViewTest, ReturnedViewsAreUsable)
+{
+    const auto m = make_msg28();
+    auto memoized = sbepp::make_memoized_view(m);
+
+    const auto str = memoized.data<msg28_tag::varStr>();
+    EXPECT_EQ(std::string(str.begin(), str.end()), "string");
+
+    const auto g = memoized.group<msg28_tag::group>();
+    ASSERT_EQ(g.size(), 3);
+    EXPECT_EQ(*g[2].number(), 2);
+
+    // modifications are visible through the original view
+    memoized.data<msg28_tag::varData>()[0] = 'D';
+    EXPECT_EQ(m.varData()[0], 'D');
+}
+
+TEST_F(MemoizedViewTest, MembersBeyondLimitAreNotCached)
+{
+    const auto m = make_msg28();
+    auto memoized = sbepp::make_memoized_view<1>(m);
+
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varStr>(), m.varStr()));
+    EXPECT_EQ(memoized.cached_members(), 1u);
+    EXPECT_TRUE(same(memoized.data<msg28_tag::varData>(), m.varData()));
+    EXPECT_TRUE(same(memoized.group<msg28_tag::group>(), m.group()));
+    EXPECT_EQ(memoized.cached_members(), 1u);
+}
+
+TEST_F(MemoizedViewTest, WorksWithSeveralGroups)
+{
+    auto m = sbepp::make_view<test_schema::messages::msg9>(
+        buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    sbepp::fill_group_header(m.group1(), 2);
+    sbepp::fill_group_header(m.group2(), 3);
+    m.group2()[2].number(42);
+    auto memoized = sbepp::make_memoized_view(m);
+
+    const auto group2 = memoized.group<msg9_tag::group2>();
+
+    EXPECT_TRUE(same(group2, m.group2()));
+    EXPECT_EQ(*group2[2].number(), 42);
+    EXPECT_TRUE(same(memoized.group<msg9_tag::group1>(), m.group1()));
+    EXPECT_EQ(memoized.cached_members(), 2u);
+}
+
+TEST_F(MemoizedViewTest, WorksWithGroupEntries)
+{
+    auto m = sbepp::make_view<test_schema::messages::msg3>(
+        buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    auto g = m.nested_group();
+    sbepp::fill_group_header(g, 2);
+    for(const auto entry : g)
+    {
+        sbepp::fill_group_header(entry.flat_group(), 2);
+        assign(entry.data(), "data");
+    }
+    const auto const_m = sbepp::make_const_view<test_schema::messages::msg3>(
+        buf.data(), buf.size());
+
+    for(const auto entry : const_m.nested_group())
+    {
+        auto memoized = sbepp::make_memoized_view(entry);
+
+        EXPECT_TRUE(same(
+            memoized.data<msg3_tag::nested_group::data>(), entry.data()));
+        EXPECT_TRUE(same(
+            memoized.group<msg3_tag::nested_group::flat_group>(),
+            entry.flat_group()));
+        EXPECT_EQ(memoized.cached_members(), 2u);
+    }
+}
+} // namespace
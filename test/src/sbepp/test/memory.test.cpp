@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#include <sbepp/memory.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#    include <unistd.h>
+#endif
+
+namespace
+{
+bool is_zeroed(const sbepp::buffer_memory& memory)
+{
+    return std::all_of(
+        memory.data(),
+        memory.data() + memory.size(),
+        [](const std::uint8_t b)
+        {
+            return b == 0;
+        });
+}
+
+TEST(BufferMemoryTest, DefaultConstructedBufferIsEmpty)
+{
+    sbepp::buffer_memory memory;
+
+    ASSERT_EQ(memory.data(), nullptr);
+    ASSERT_EQ(memory.size(), 0);
+    ASSERT_FALSE(memory.uses_huge_pages());
+    ASSERT_FALSE(memory.is_numa_bound());
+}
+
+TEST(BufferMemoryTest, AllocatesZeroedMemory)
+{
+    sbepp::buffer_memory memory{12345};
+
+    ASSERT_NE(memory.data(), nullptr);
+    ASSERT_EQ(memory.size(), 12345);
+    ASSERT_TRUE(is_zeroed(memory));
+    memory.data()[memory.size() - 1] = 1;
+    ASSERT_FALSE(memory.uses_huge_pages());
+    ASSERT_FALSE(memory.is_numa_bound());
+}
+
+TEST(BufferMemoryTest, FallsBackWhenHugePagesAreNotAvailable)
+{
+    sbepp::memory_options options;
+    options.pages = sbepp::huge_pages::preferred;
+    options.prefault = true;
+
+    // huge pages pool is usually empty, in that case regular pages are used
+    sbepp::buffer_memory memory{1, options};
+
+    ASSERT_NE(memory.data(), nullptr);
+    ASSERT_EQ(memory.size(), 1);
+    ASSERT_TRUE(is_zeroed(memory));
+}
+
+TEST(BufferMemoryTest, AllocatesTransparentHugePages)
+{
+    sbepp::memory_options options;
+    options.pages = sbepp::huge_pages::transparent;
+
+    sbepp::buffer_memory memory{4 * 1024 * 1024, options};
+
+    ASSERT_NE(memory.data(), nullptr);
+    ASSERT_FALSE(memory.uses_huge_pages());
+    ASSERT_TRUE(is_zeroed(memory));
+}
+
+TEST(BufferMemoryTest, IgnoresInvalidNumaNode)
+{
+    sbepp::memory_options options;
+    options.numa_node = 100000;
+
+    sbepp::buffer_memory memory{100, options};
+
+    ASSERT_NE(memory.data(), nullptr);
+    ASSERT_FALSE(memory.is_numa_bound());
+}
+
+TEST(BufferMemoryTest, CanBeBoundToNumaNode)
+{
+    sbepp::memory_options options;
+    options.numa_node = 0;
+    options.prefault = true;
+
+    // binding can fail in restricted environments, memory must be usable
+    // anyway
+    sbepp::buffer_memory memory{100, options};
+
+    ASSERT_NE(memory.data(), nullptr);
+    memory.data()[0] = 1;
+    ASSERT_EQ(memory.data()[0], 1);
+}
+
+TEST(BufferMemoryTest, CanBeMoved)
+{
+    sbepp::buffer_memory memory{100};
+    const auto data = memory.data();
+
+    sbepp::buffer_memory memory2{std::move(memory)};
+    ASSERT_EQ(memory.data(), nullptr);
+    ASSERT_EQ(memory.size(), 0);
+    ASSERT_EQ(memory2.data(), data);
+    ASSERT_EQ(memory2.size(), 100);
+
+    memory = std::move(memory2);
+    ASSERT_EQ(memory2.data(), nullptr);
+    ASSERT_EQ(memory.data(), data);
+}
+
+#if defined(__linux__)
+TEST(UniqueFdTest, PreservesErrnoOnClose)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    sbepp::detail::unique_fd reader{fds[0]};
+    sbepp::detail::unique_fd writer{fds[1]};
+
+    errno = EINVAL;
+    reader.reset();
+    writer = std::move(reader);
+
+    ASSERT_EQ(errno, EINVAL);
+    ASSERT_FALSE(reader);
+    ASSERT_FALSE(writer);
+}
+
+TEST(ReadOnlyMappingTest, MapsWholeFile)
+{
+    char path[] = "/tmp/sbepp_mapping_XXXXXX";
+    const sbepp::detail::unique_fd fd{::mkstemp(path)};
+    ASSERT_TRUE(fd);
+    const std::string content = "mapping";
+    ASSERT_EQ(
+        ::write(fd.get(), content.data(), content.size()),
+        static_cast<ssize_t>(content.size()));
+
+    sbepp::detail::read_only_mapping mapping{path};
+    const sbepp::detail::read_only_mapping mapping2{std::move(mapping)};
+    ::unlink(path);
+
+    ASSERT_EQ(mapping.data(), nullptr);
+    ASSERT_EQ(mapping2.size(), content.size());
+    ASSERT_EQ(
+        std::string(
+            reinterpret_cast<const char*>(mapping2.data()), mapping2.size()),
+        content);
+}
+
+TEST(ReadOnlyMappingTest, DoesNotMapEmptyFile)
+{
+    char path[] = "/tmp/sbepp_mapping_XXXXXX";
+    const sbepp::detail::unique_fd fd{::mkstemp(path)};
+    ASSERT_TRUE(fd);
+
+    const sbepp::detail::read_only_mapping mapping{path};
+    ::unlink(path);
+
+    ASSERT_EQ(mapping.data(), nullptr);
+    ASSERT_EQ(mapping.size(), 0);
+    ASSERT_THROW(
+        sbepp::detail::read_only_mapping{std::string{path}},
+        std::system_error);
+}
+#endif
+} // namespace
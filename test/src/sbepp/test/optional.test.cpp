@@ -142,6 +142,19 @@ TEST(OptionalTest, ConvertsToTrueIfNotNull)
     ASSERT_TRUE(t);
 }
 
+TEST(OptionalTest, BuiltInOptionalTypesUseTheirNullValue)
+{
+    sbepp::uint32_opt_t t;
+
+    ASSERT_EQ(*t, sbepp::uint32_opt_t::null_value());
+    ASSERT_FALSE(t.has_value());
+
+    t = 1;
+
+    ASSERT_TRUE(t.has_value());
+    ASSERT_EQ(t.value_or(2), 1);
+}
+
 TEST(OptionalTest, ValueOrReturnsValueIfNotNull)
 {
     static constexpr value_type value{2};
@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg27.hpp>
+#endif
+
+#include <sbepp/packet_batcher.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using byte_type = std::uint8_t;
+using message_t = test_schema::messages::msg27<byte_type>;
+
+struct packet_message
+{
+    const byte_type* ptr;
+    std::size_t size;
+};
+
+std::vector<packet_message> get_packet_messages(
+    const sbepp::packet_batcher& batcher, const std::size_t packet)
+{
+    std::vector<packet_message> res;
+    const auto is_valid = sbepp::for_each_packet_message(
+        batcher.packet_data(packet),
+        batcher.packet_size(packet),
+        batcher.get_options().use_packet_header,
+        [&res](const byte_type* ptr, const std::size_t size)
+        {
+            res.push_back({ptr, size});
+        });
+    EXPECT_TRUE(is_valid);
+
+    return res;
+}
+
+sbepp::packet_batcher_options make_options(
+    const std::size_t mtu,
+    const std::size_t max_packets,
+    const bool use_packet_header = false)
+{
+    sbepp::packet_batcher_options options;
+    options.mtu = mtu;
+    options.max_packets = max_packets;
+    options.use_packet_header = use_packet_header;
+    return options;
+}
+
+TEST(PacketBatcherTest, DefaultOptionsFitIntoEthernetFrame)
+{
+    sbepp::packet_batcher_options options;
+
+    ASSERT_EQ(options.mtu, 1472);
+    ASSERT_FALSE(options.use_packet_header);
+    ASSERT_EQ(options.max_delay, std::chrono::nanoseconds::zero());
+}
+
+TEST(PacketBatcherTest, MaxMessageSizeIncludesOverhead)
+{
+    sbepp::packet_batcher b1{make_options(100, 1)};
+    sbepp::packet_batcher b2{make_options(100, 1, true)};
+
+    ASSERT_EQ(b1.max_message_size(), 100 - sbepp::packet_message_prefix_size);
+    ASSERT_EQ(
+        b2.max_message_size(),
+        100 - sbepp::packet_message_prefix_size - sbepp::packet_header_size);
+}
+
+TEST(PacketBatcherTest, PacksMessagesIntoSinglePacket)
+{
+    sbepp::packet_batcher batcher{make_options(100, 4)};
+    const std::array<byte_type, 3> msg1{1, 2, 3};
+    const std::array<byte_type, 2> msg2{4, 5};
+
+    ASSERT_TRUE(batcher.push(msg1.data(), msg1.size()));
+    ASSERT_TRUE(batcher.push(msg2.data(), msg2.size()));
+    ASSERT_EQ(batcher.packet_count(), 0);
+    ASSERT_FALSE(batcher.empty());
+
+    batcher.flush();
+
+    ASSERT_EQ(batcher.packet_count(), 1);
+    ASSERT_EQ(
+        batcher.packet_size(0),
+        msg1.size() + msg2.size() + 2 * sbepp::packet_message_prefix_size);
+    const auto messages = get_packet_messages(batcher, 0);
+    ASSERT_EQ(messages.size(), 2);
+    ASSERT_EQ(messages[0].size, msg1.size());
+    ASSERT_TRUE(std::equal(msg1.begin(), msg1.end(), messages[0].ptr));
+    ASSERT_EQ(messages[1].size, msg2.size());
+    ASSERT_TRUE(std::equal(msg2.begin(), msg2.end(), messages[1].ptr));
+}
+
+TEST(PacketBatcherTest, StartsNewPacketWhenMessageDoesNotFit)
+{
+    sbepp::packet_batcher batcher{make_options(10, 4)};
+    const std::array<byte_type, 5> msg{};
+
+    ASSERT_TRUE(batcher.push(msg.data(), msg.size()));
+    ASSERT_EQ(batcher.packet_count(), 0);
+    ASSERT_TRUE(batcher.push(msg.data(), msg.size()));
+
+    ASSERT_EQ(batcher.packet_count(), 1);
+    ASSERT_EQ(batcher.packet_size(0), 7);
+}
+
+TEST(PacketBatcherTest, ClosesFullPacketImmediately)
+{
+    sbepp::packet_batcher batcher{make_options(10, 4)};
+    const std::array<byte_type, 8> msg{};
+
+    ASSERT_TRUE(batcher.push(msg.data(), msg.size()));
+
+    ASSERT_EQ(batcher.packet_count(), 1);
+    ASSERT_EQ(batcher.packet_size(0), 10);
+}
+
+TEST(PacketBatcherTest, RejectsTooBigMessage)
+{
+    sbepp::packet_batcher batcher{make_options(10, 4)};
+    const std::array<byte_type, 9> msg{};
+
+    ASSERT_EQ(batcher.prepare(msg.size()), nullptr);
+    ASSERT_FALSE(batcher.push(msg.data(), msg.size()));
+    ASSERT_TRUE(batcher.empty());
+}
+
+TEST(PacketBatcherTest, RejectsMessageWhenAllPacketsAreCompleted)
+{
+    sbepp::packet_batcher batcher{make_options(10, 2)};
+    const std::array<byte_type, 8> msg{};
+
+    ASSERT_TRUE(batcher.push(msg.data(), msg.size()));
+    ASSERT_TRUE(batcher.push(msg.data(), msg.size()));
+    ASSERT_FALSE(batcher.push(msg.data(), msg.size()));
+
+    batcher.release(1);
+
+    ASSERT_EQ(batcher.packet_count(), 1);
+    ASSERT_TRUE(batcher.push(msg.data(), msg.size()));
+}
+
+TEST(PacketBatcherTest, WritesPacketHeader)
+{
+    auto options = make_options(20, 4, true);
+    options.first_sequence_number = 10;
+    sbepp::packet_batcher batcher{options};
+    const std::array<byte_type, 2> msg{};
+
+    batcher.push(msg.data(), msg.size());
+    batcher.push(msg.data(), msg.size());
+    batcher.flush();
+    batcher.push(msg.data(), msg.size());
+    batcher.flush();
+
+    ASSERT_EQ(batcher.packet_count(), 2);
+    ASSERT_EQ(batcher.next_sequence_number(), 12);
+
+    auto header = sbepp::read_packet_header(batcher.packet_data(0));
+    ASSERT_EQ(header.sequence_number, 10);
+    ASSERT_EQ(header.message_count, 2);
+    ASSERT_EQ(get_packet_messages(batcher, 0).size(), 2);
+
+    header = sbepp::read_packet_header(batcher.packet_data(1));
+    ASSERT_EQ(header.sequence_number, 11);
+    ASSERT_EQ(header.message_count, 1);
+    ASSERT_EQ(get_packet_messages(batcher, 1).size(), 1);
+}
+
+TEST(PacketBatcherTest, FlushIgnoresEmptyPacket)
+{
+    sbepp::packet_batcher batcher{make_options(20, 4, true)};
+
+    batcher.flush();
+
+    ASSERT_EQ(batcher.packet_count(), 0);
+    ASSERT_EQ(batcher.next_sequence_number(), 0);
+}
+
+TEST(PacketBatcherTest, EncodesMessageInPlace)
+{
+    sbepp::packet_batcher batcher{make_options(128, 1)};
+    const auto max_size = batcher.max_message_size();
+
+    auto ptr = batcher.prepare(max_size);
+    ASSERT_NE(ptr, nullptr);
+    auto m = sbepp::make_view<test_schema::messages::msg27>(ptr, max_size);
+    sbepp::fill_message_header(m);
+    m.number(1);
+    sbepp::fill_group_header(m.group(), 2);
+    m.data().resize(3);
+    batcher.commit(sbepp::size_bytes(m));
+    batcher.flush();
+
+    const auto messages = get_packet_messages(batcher, 0);
+    ASSERT_EQ(messages.size(), 1);
+    ASSERT_EQ(messages[0].size, sbepp::size_bytes(m));
+    const auto m2 = sbepp::make_const_view<test_schema::messages::msg27>(
+        messages[0].ptr, messages[0].size);
+    ASSERT_EQ(m2.number(), 1);
+    ASSERT_EQ(m2.group().size(), 2);
+    ASSERT_EQ(m2.data().size(), 3);
+}
+
+TEST(PacketBatcherTest, PushCopiesMessageView)
+{
+    std::array<byte_type, 128> buf{};
+    message_t m{buf.data(), buf.size()};
+    sbepp::fill_message_header(m);
+    sbepp::fill_group_header(m.group(), 0);
+    m.data().resize(1);
+    sbepp::packet_batcher batcher{make_options(128, 1)};
+
+    ASSERT_TRUE(batcher.push(m));
+    batcher.flush();
+
+    const auto messages = get_packet_messages(batcher, 0);
+    ASSERT_EQ(messages.size(), 1);
+    ASSERT_EQ(messages[0].size, sbepp::size_bytes(m));
+}
+
+TEST(PacketBatcherTest, PollClosesExpiredPacket)
+{
+    auto options = make_options(100, 4);
+    options.max_delay = std::chrono::microseconds{10};
+    sbepp::packet_batcher batcher{options};
+    const std::array<byte_type, 2> msg{};
+    const auto now = sbepp::packet_batcher::clock_type::now();
+
+    ASSERT_FALSE(batcher.poll(now));
+    batcher.push(msg.data(), msg.size());
+
+    ASSERT_FALSE(batcher.poll(now - std::chrono::seconds{1}));
+    ASSERT_EQ(batcher.packet_count(), 0);
+    ASSERT_TRUE(batcher.poll(now + std::chrono::seconds{1}));
+    ASSERT_EQ(batcher.packet_count(), 1);
+}
+
+TEST(PacketBatcherTest, PollDoesNothingIfTimeFlushingIsDisabled)
+{
+    sbepp::packet_batcher batcher{make_options(100, 4)};
+    const std::array<byte_type, 2> msg{};
+    batcher.push(msg.data(), msg.size());
+
+    ASSERT_FALSE(batcher.poll(
+        sbepp::packet_batcher::clock_type::now() + std::chrono::hours{1}));
+    ASSERT_EQ(batcher.packet_count(), 0);
+}
+
+TEST(PacketBatcherTest, ReleasePreservesRemainingPackets)
+{
+    sbepp::packet_batcher batcher{make_options(10, 4)};
+    const std::array<byte_type, 8> msg1{1};
+    const std::array<byte_type, 8> msg2{2};
+    const std::array<byte_type, 3> msg3{3};
+
+    batcher.push(msg1.data(), msg1.size());
+    batcher.push(msg2.data(), msg2.size());
+    batcher.push(msg3.data(), msg3.size());
+    batcher.release(1);
+
+    ASSERT_EQ(batcher.packet_count(), 1);
+    auto messages = get_packet_messages(batcher, 0);
+    ASSERT_EQ(messages.size(), 1);
+    ASSERT_EQ(messages[0].ptr[0], 2);
+
+    // open packet is preserved too
+    batcher.release();
+    batcher.flush();
+    ASSERT_EQ(batcher.packet_count(), 1);
+    messages = get_packet_messages(batcher, 0);
+    ASSERT_EQ(messages.size(), 1);
+    ASSERT_EQ(messages[0].size, msg3.size());
+    ASSERT_EQ(messages[0].ptr[0], 3);
+}
+
+TEST(PacketBatcherTest, ForEachPacketMessageDetectsTruncatedPacket)
+{
+    sbepp::packet_batcher batcher{make_options(100, 1, true)};
+    const std::array<byte_type, 5> msg{};
+    batcher.push(msg.data(), msg.size());
+    batcher.push(msg.data(), msg.size());
+    batcher.flush();
+    std::size_t count{};
+    auto counter = [&count](const byte_type*, const std::size_t)
+    {
+        count++;
+    };
+
+    ASSERT_FALSE(sbepp::for_each_packet_message(
+        batcher.packet_data(0), batcher.packet_size(0) - 1, true, counter));
+    ASSERT_EQ(count, 1);
+    ASSERT_FALSE(sbepp::for_each_packet_message(
+        batcher.packet_data(0), sbepp::packet_header_size - 1, true, counter));
+    ASSERT_EQ(count, 1);
+    // message count doesn't match
+    ASSERT_FALSE(sbepp::for_each_packet_message(
+        batcher.packet_data(0),
+        sbepp::packet_header_size + sbepp::packet_message_prefix_size
+            + msg.size(),
+        true,
+        counter));
+    ASSERT_EQ(count, 2);
+}
+
+#if defined(__linux__)
+TEST(PacketBatcherTest, MakeMmsghdrsReferencesCompletedPackets)
+{
+    sbepp::packet_batcher batcher{make_options(10, 4)};
+    const std::array<byte_type, 8> msg{};
+    batcher.push(msg.data(), msg.size());
+    batcher.push(msg.data(), msg.size());
+    std::array<mmsghdr, 4> msgs{};
+    std::array<iovec, 4> iovs{};
+
+    ASSERT_EQ(
+        sbepp::make_mmsghdrs(batcher, msgs.data(), iovs.data(), 1), 1);
+    ASSERT_EQ(
+        sbepp::make_mmsghdrs(
+            batcher, msgs.data(), iovs.data(), msgs.size()),
+        2);
+
+    for(std::size_t i = 0; i != 2; i++)
+    {
+        ASSERT_EQ(msgs[i].msg_hdr.msg_iov, &iovs[i]);
+        ASSERT_EQ(msgs[i].msg_hdr.msg_iovlen, 1);
+        ASSERT_EQ(iovs[i].iov_base, batcher.packet_data(i));
+        ASSERT_EQ(iovs[i].iov_len, batcher.packet_size(i));
+    }
+}
+#endif
+} // namespace
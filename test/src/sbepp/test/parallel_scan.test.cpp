@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#endif
+
+#include <sbepp/parallel_scan.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+TEST(WorkStealingPoolTest, ZeroConcurrencyIsTreatedAsOne)
+{
+    sbepp::work_stealing_pool pool{0};
+
+    ASSERT_EQ(pool.concurrency(), 1u);
+}
+
+TEST(WorkStealingPoolTest, RunsEachTaskExactlyOnce)
+{
+    static constexpr std::size_t task_count = 1000;
+    sbepp::work_stealing_pool pool{4};
+    std::vector<std::atomic<int>> calls(task_count);
+    std::atomic<bool> valid_workers{true};
+
+    for(int batch = 0; batch != 3; batch++)
+    {
+        pool.run(
+            task_count,
+            [&](const std::size_t task, const std::size_t worker)
+            {
+                calls[task]++;
+                if(worker >= pool.concurrency())
+                {
+                    valid_workers = false;
+                }
+            });
+    }
+
+    ASSERT_TRUE(valid_workers);
+    for(const auto& c : calls)
+    {
+        ASSERT_EQ(c, 3);
+    }
+}
+
+TEST(WorkStealingPoolTest, RunsTasksInCallerThreadIfConcurrencyIsOne)
+{
+    sbepp::work_stealing_pool pool{1};
+    std::vector<std::size_t> tasks;
+
+    pool.run(
+        3,
+        [&tasks](const std::size_t task, const std::size_t worker)
+        {
+            EXPECT_EQ(worker, 0u);
+            tasks.push_back(task);
+        });
+
+    ASSERT_EQ(tasks, (std::vector<std::size_t>{0, 1, 2}));
+    ASSERT_EQ(pool.steals(), 0u);
+}
+
+TEST(WorkStealingPoolTest, DoesNothingForEmptyBatch)
+{
+    sbepp::work_stealing_pool pool{2};
+    bool called{};
+
+    pool.run(
+        0,
+        [&called](std::size_t, std::size_t)
+        {
+            called = true;
+        });
+
+    ASSERT_FALSE(called);
+}
+
+TEST(WorkStealingPoolTest, RethrowsTaskExceptionAfterAllTasksAreDone)
+{
+    sbepp::work_stealing_pool pool{2};
+    std::atomic<int> calls{};
+
+    ASSERT_THROW(
+        pool.run(
+            10,
+            [&calls](const std::size_t task, std::size_t)
+            {
+                calls++;
+                if(task == 3)
+                {
+                    throw std::runtime_error{"error"};
+                }
+            }),
+        std::runtime_error);
+    ASSERT_EQ(calls, 10);
+
+    // pool is usable after exception
+    pool.run(
+        2,
+        [&calls](std::size_t, std::size_t)
+        {
+            calls++;
+        });
+    ASSERT_EQ(calls, 12);
+}
+
+class ParallelScanTest : public ::testing::Test
+{
+public:
+    std::vector<std::uint8_t> journal;
+
+    // appends msg2 with `number` and `data_size` bytes of data
+    void append_msg2(const std::uint32_t number, const std::size_t data_size)
+    {
+        const auto offset = journal.size();
+        journal.resize(offset + 256);
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            journal.data() + offset, 256);
+        sbepp::fill_message_header(m);
+        m.number(number);
+        sbepp::fill_group_header(m.group(), 0);
+        m.data().resize(data_size);
+        journal.resize(offset + sbepp::size_bytes(m));
+    }
+
+    void fill_journal(const std::uint32_t n)
+    {
+        for(std::uint32_t i = 0; i != n; i++)
+        {
+            append_msg2(i, i % 5);
+        }
+    }
+};
+
+TEST_F(ParallelScanTest, SplitsJournalOnMessageBoundaries)
+{
+    fill_journal(100);
+
+    const auto ranges = sbepp::split_journal<test_schema::messages::msg2>(
+        journal.data(), journal.size(), 200);
+
+    ASSERT_GT(ranges.size(), 1u);
+    std::size_t end{};
+    std::uint32_t expected_number{};
+    for(const auto& range : ranges)
+    {
+        ASSERT_EQ(range.begin, end);
+        auto offset = range.begin;
+        while(offset != range.end)
+        {
+            ASSERT_LT(offset, range.end);
+            const auto m = sbepp::make_const_view<test_schema::messages::msg2>(
+                journal.data() + offset, range.end - offset);
+            ASSERT_EQ(*m.number(), expected_number);
+            expected_number++;
+            offset += sbepp::size_bytes(m);
+        }
+        end = range.end;
+    }
+    ASSERT_EQ(end, journal.size());
+    ASSERT_EQ(expected_number, 100u);
+}
+
+TEST_F(ParallelScanTest, SplitIgnoresTrailingIncompleteMessage)
+{
+    fill_journal(3);
+    const auto complete_size = journal.size();
+    append_msg2(3, 1);
+    journal.pop_back();
+
+    const auto ranges = sbepp::split_journal<test_schema::messages::msg2>(
+        journal.data(), journal.size(), 1000);
+
+    ASSERT_EQ(ranges.size(), 1u);
+    ASSERT_EQ(ranges[0].begin, 0u);
+    ASSERT_EQ(ranges[0].end, complete_size);
+}
+
+TEST_F(ParallelScanTest, MergesPerWorkerReducers)
+{
+    fill_journal(1000);
+    const auto ranges = sbepp::split_journal<test_schema::messages::msg2>(
+        journal.data(), journal.size(), 256);
+    sbepp::work_stealing_pool pool{4};
+
+    const auto sum =
+        sbepp::parallel_scan_journal<test_schema::messages::msg2>(
+            pool,
+            journal.data(),
+            ranges,
+            std::uint64_t{},
+            [](std::uint64_t& res,
+               test_schema::messages::msg2<const std::uint8_t> m)
+            {
+                res += *m.number();
+            },
+            [](std::uint64_t& res, const std::uint64_t& worker_res)
+            {
+                res += worker_res;
+            });
+
+    ASSERT_EQ(sum, 999u * 1000u / 2);
+}
+
+TEST_F(ParallelScanTest, KeepsWorkerReducersInSeparateCacheLines)
+{
+    fill_journal(1000);
+    const auto ranges = sbepp::split_journal<test_schema::messages::msg2>(
+        journal.data(), journal.size(), 64);
+    sbepp::work_stealing_pool pool{4};
+    std::mutex mutex;
+    std::set<const std::uint64_t*> reducers;
+
+    sbepp::parallel_scan_journal<test_schema::messages::msg2>(
+        pool,
+        journal.data(),
+        ranges,
+        std::uint64_t{},
+        [&mutex, &reducers](
+            std::uint64_t& res, test_schema::messages::msg2<const std::uint8_t>)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            reducers.insert(&res);
+        },
+        [&reducers](std::uint64_t&, const std::uint64_t& worker_res)
+        {
+            reducers.insert(&worker_res);
+        });
+
+    for(const auto reducer : reducers)
+    {
+        ASSERT_EQ(
+            reinterpret_cast<std::uintptr_t>(reducer)
+                % sbepp::cache_line_size,
+            0u);
+    }
+}
+
+TEST_F(ParallelScanTest, ReturnsInitForEmptyJournal)
+{
+    sbepp::work_stealing_pool pool{2};
+    const auto ranges = sbepp::split_journal<test_schema::messages::msg2>(
+        journal.data(), journal.size(), 256);
+
+    const auto res = sbepp::parallel_scan_journal<test_schema::messages::msg2>(
+        pool,
+        journal.data(),
+        ranges,
+        std::uint64_t{},
+        [](std::uint64_t& res, test_schema::messages::msg2<const std::uint8_t>)
+        {
+            res++;
+        },
+        [](std::uint64_t& res, const std::uint64_t& worker_res)
+        {
+            res += worker_res;
+        });
+
+    ASSERT_TRUE(ranges.empty());
+    ASSERT_EQ(res, 0u);
+}
+} // namespace
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg4.hpp>
+#    include <test_schema/messages/msg31.hpp>
+#endif
+
+#include <sbepp/test/utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace
+{
+using msg31_tag = test_schema::schema::messages::msg31;
+
+template<typename Tag, typename = void>
+struct has_presence_bit : std::false_type
+{
+};
+
+template<typename Tag>
+struct has_presence_bit<
+    Tag,
+    decltype((void)sbepp::field_traits<Tag>::presence_bit())> : std::true_type
+{
+};
+
+class PresenceMaskTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 512> buf{};
+
+    test_schema::messages::msg31<std::uint8_t> make_msg31()
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg31>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.optional1(sbepp::nullopt);
+        m.optional2(sbepp::nullopt);
+        m.optional3(sbepp::nullopt);
+        m.optional_real(sbepp::nullopt);
+        sbepp::fill_group_header(m.group(), 1);
+        m.group()[0].optional(sbepp::nullopt);
+        return m;
+    }
+};
+
+TEST_F(PresenceMaskTest, PresenceBitsAreAssignedToOptionalFieldsInSchemaOrder)
+{
+    STATIC_ASSERT(
+        sbepp::field_traits<msg31_tag::optional1>::presence_bit() == 0);
+    STATIC_ASSERT(
+        sbepp::field_traits<msg31_tag::optional2>::presence_bit() == 1);
+    STATIC_ASSERT(
+        sbepp::field_traits<msg31_tag::optional3>::presence_bit() == 2);
+    STATIC_ASSERT(
+        sbepp::field_traits<msg31_tag::group::optional>::presence_bit() == 0);
+}
+
+TEST_F(PresenceMaskTest, NonOptionalArrayAndCompositeFieldsHaveNoPresenceBit)
+{
+    STATIC_ASSERT(has_presence_bit<msg31_tag::optional1>::value);
+    STATIC_ASSERT(!has_presence_bit<msg31_tag::required>::value);
+    STATIC_ASSERT(!has_presence_bit<msg31_tag::array>::value);
+    STATIC_ASSERT(!has_presence_bit<msg31_tag::composite>::value);
+    STATIC_ASSERT(!has_presence_bit<msg31_tag::group::number>::value);
+}
+
+TEST_F(PresenceMaskTest, ReturnsZeroIfAllOptionalFieldsAreNull)
+{
+    const auto m = make_msg31();
+    m.required(1);
+
+    ASSERT_EQ(sbepp::presence_mask(m), 0u);
+    STATIC_ASSERT(noexcept(sbepp::presence_mask(m)));
+    STATIC_ASSERT_V(
+        std::is_same<decltype(sbepp::presence_mask(m)), std::uint64_t>);
+}
+
+TEST_F(PresenceMaskTest, SetsBitsOfNonNullOptionalFields)
+{
+    const auto m = make_msg31();
+    m.optional2(1);
+
+    ASSERT_EQ(
+        sbepp::presence_mask(m),
+        std::uint64_t{1}
+            << sbepp::field_traits<msg31_tag::optional2>::presence_bit());
+
+    m.optional1(2);
+    m.optional3(3);
+
+    ASSERT_EQ(sbepp::presence_mask(m), 7u);
+}
+
+TEST_F(PresenceMaskTest, TreatsNaNAsNull)
+{
+    const auto m = make_msg31();
+    m.optional_real(std::numeric_limits<float>::quiet_NaN());
+
+    ASSERT_EQ(sbepp::presence_mask(m), 0u);
+
+    m.optional_real(1.5f);
+
+    ASSERT_EQ(
+        sbepp::presence_mask(m),
+        std::uint64_t{1}
+            << sbepp::field_traits<msg31_tag::optional_real>::presence_bit());
+}
+
+TEST_F(PresenceMaskTest, WorksWithGroupEntries)
+{
+    const auto m = make_msg31();
+    m.optional1(1);
+    const auto entry = m.group()[0];
+
+    ASSERT_EQ(sbepp::presence_mask(entry), 0u);
+
+    entry.optional(1);
+
+    ASSERT_EQ(sbepp::presence_mask(entry), 1u);
+}
+
+TEST_F(PresenceMaskTest, ReturnsZeroForLevelWithoutOptionalFields)
+{
+    auto m = sbepp::make_view<test_schema::messages::msg4>(
+        buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.number1(1);
+
+    ASSERT_EQ(sbepp::presence_mask(m), 0u);
+}
+} // namespace
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg2.hpp>
+#    include <test_schema/messages/msg28.hpp>
+#    include <test_schema/schema/schema.hpp>
+#endif
+
+#include <sbepp/reorder.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+using schema_tag = test_schema::schema;
+using msg2_tag = test_schema::schema::messages::msg2;
+using msg28_tag = test_schema::schema::messages::msg28;
+
+class ReorderTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 4096> buf{};
+    std::size_t used{};
+    sbepp::template_id_reorderer<schema_tag> reorderer;
+
+    // pushes msg2 with the given number
+    void push_msg2(const std::uint32_t number)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg2>(
+            buf.data() + used, buf.size() - used);
+        sbepp::fill_message_header(m);
+        m.number(number);
+        sbepp::fill_group_header(m.group(), 0);
+        m.data().resize(0);
+        push(sbepp::size_bytes(m));
+    }
+
+    // pushes msg28 with the given `required` value
+    void push_msg28(const std::uint32_t required)
+    {
+        auto m = sbepp::make_view<test_schema::messages::msg28>(
+            buf.data() + used, buf.size() - used);
+        sbepp::fill_message_header(m);
+        m.required(required);
+        sbepp::fill_group_header(m.group(), 0);
+        m.varData().resize(0);
+        m.varStr().resize(0);
+        push(sbepp::size_bytes(m));
+    }
+
+    void push(const std::size_t size)
+    {
+        ASSERT_TRUE(reorderer.push(buf.data() + used, size));
+        used += size;
+    }
+
+    std::vector<std::uint32_t> get_msg2_numbers()
+    {
+        std::vector<std::uint32_t> res;
+        reorderer.for_each<msg2_tag>(
+            [&res](test_schema::messages::msg2<const std::uint8_t> m)
+            {
+                res.push_back(*m.number());
+            });
+        return res;
+    }
+
+    std::vector<std::uint32_t> get_msg28_values()
+    {
+        std::vector<std::uint32_t> res;
+        reorderer.for_each<msg28_tag>(
+            [&res](test_schema::messages::msg28<const std::uint8_t> m)
+            {
+                res.push_back(*m.required());
+            });
+        return res;
+    }
+};
+
+TEST_F(ReorderTest, GroupsMessagesByTemplateIdPreservingOrder)
+{
+    push_msg28(1);
+    push_msg2(2);
+    push_msg28(3);
+    push_msg2(4);
+    push_msg2(5);
+
+    ASSERT_EQ(reorderer.size(), 5);
+    ASSERT_EQ(get_msg2_numbers(), (std::vector<std::uint32_t>{2, 4, 5}));
+    ASSERT_EQ(get_msg28_values(), (std::vector<std::uint32_t>{1, 3}));
+}
+
+TEST_F(ReorderTest, ReturnsNumberOfHandledMessages)
+{
+    push_msg2(1);
+    push_msg2(2);
+
+    const auto handler = [](test_schema::messages::msg2<const std::uint8_t>)
+    {
+    };
+    ASSERT_EQ(reorderer.for_each<msg2_tag>(handler), 2);
+    ASSERT_EQ(
+        reorderer.for_each<msg28_tag>(
+            [](test_schema::messages::msg28<const std::uint8_t>)
+            {
+            }),
+        0);
+}
+
+TEST_F(ReorderTest, VisitsAllMessagesInTemplateIdOrder)
+{
+    push_msg28(1);
+    push_msg2(2);
+    push_msg28(3);
+    push_msg2(4);
+    std::vector<sbepp::message_id_t> ids;
+    std::vector<const std::uint8_t*> pointers;
+
+    reorderer.for_each(
+        [&ids, &pointers](const sbepp::reordered_message& m)
+        {
+            ids.push_back(m.template_id);
+            pointers.push_back(m.data);
+        });
+
+    ASSERT_EQ(ids, (std::vector<sbepp::message_id_t>{2, 2, 28, 28}));
+    // messages are not copied
+    ASSERT_EQ(
+        *sbepp::make_const_view<test_schema::messages::msg2>(
+             pointers[0], buf.size())
+             .number(),
+        2);
+}
+
+TEST_F(ReorderTest, PutsLargeTemplateIdsIntoCommonBucket)
+{
+    reorderer = sbepp::template_id_reorderer<schema_tag>{10};
+    push_msg28(1);
+    push_msg2(2);
+    push_msg28(3);
+    std::vector<sbepp::message_id_t> ids;
+
+    ASSERT_EQ(reorderer.max_template_id(), 10);
+    reorderer.for_each(
+        [&ids](const sbepp::reordered_message& m)
+        {
+            ids.push_back(m.template_id);
+        });
+
+    ASSERT_EQ(ids, (std::vector<sbepp::message_id_t>{2, 28, 28}));
+}
+
+TEST_F(ReorderTest, HandlesPushAfterDispatch)
+{
+    push_msg2(1);
+    ASSERT_EQ(get_msg2_numbers(), (std::vector<std::uint32_t>{1}));
+
+    push_msg28(2);
+    push_msg2(3);
+
+    ASSERT_EQ(get_msg2_numbers(), (std::vector<std::uint32_t>{1, 3}));
+    ASSERT_EQ(get_msg28_values(), (std::vector<std::uint32_t>{2}));
+}
+
+TEST_F(ReorderTest, CanBeReusedAfterClear)
+{
+    push_msg2(1);
+    push_msg28(2);
+    ASSERT_EQ(get_msg2_numbers().size(), 1);
+
+    reorderer.clear();
+    ASSERT_TRUE(reorderer.empty());
+    ASSERT_TRUE(get_msg2_numbers().empty());
+
+    push_msg28(3);
+    ASSERT_TRUE(get_msg2_numbers().empty());
+    ASSERT_EQ(get_msg28_values(), (std::vector<std::uint32_t>{3}));
+}
+
+TEST_F(ReorderTest, RejectsMessagesWithoutHeader)
+{
+    ASSERT_FALSE(reorderer.push(buf.data(), 7));
+    ASSERT_TRUE(reorderer.empty());
+}
+} // namespace
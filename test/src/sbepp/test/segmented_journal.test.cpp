@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg4.hpp>
+#    include <test_schema/schema/schema.hpp>
+#endif
+
+#include <sbepp/segmented_journal.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <sys/stat.h>
+#    include <unistd.h>
+
+namespace
+{
+struct record
+{
+    std::uint64_t sequence;
+    std::uint64_t value;
+};
+
+class SegmentedJournalTest : public ::testing::Test
+{
+public:
+    std::string dir;
+    sbepp::segmented_journal_options options;
+
+    SegmentedJournalTest()
+    {
+        char tmpl[] = "/tmp/sbepp_journal_XXXXXX";
+        if(::mkdtemp(tmpl))
+        {
+            dir = tmpl;
+        }
+        // header + 4 records with 8-byte messages
+        options.segment_size = 64 + 4 * (4 + 8);
+    }
+
+    ~SegmentedJournalTest() override
+    {
+        for(const auto& path : sbepp::list_journal_segments(dir))
+        {
+            ::unlink(path.c_str());
+        }
+        ::unlink((dir + "/other").c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    static void append(
+        sbepp::segmented_journal_writer& writer, const std::uint64_t value)
+    {
+        writer.append(&value, sizeof(value));
+    }
+
+    std::vector<record> read_all() const
+    {
+        std::vector<record> res;
+        sbepp::segmented_journal_reader reader{dir};
+        reader.for_each(
+            [&res](
+                const std::uint64_t sequence,
+                const std::uint8_t* data,
+                const std::size_t size)
+            {
+                record r{sequence, 0};
+                EXPECT_EQ(size, sizeof(r.value));
+                std::memcpy(&r.value, data, sizeof(r.value));
+                res.push_back(r);
+            });
+        return res;
+    }
+};
+
+void expect_records(
+    const std::vector<record>& records,
+    const std::uint64_t first_sequence,
+    const std::vector<std::uint64_t>& values)
+{
+    ASSERT_EQ(records.size(), values.size());
+    for(std::size_t i = 0; i != records.size(); i++)
+    {
+        ASSERT_EQ(records[i].sequence, first_sequence + i);
+        ASSERT_EQ(records[i].value, values[i]);
+    }
+}
+
+TEST_F(SegmentedJournalTest, ReadsWrittenMessages)
+{
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+
+        ASSERT_EQ(writer.next_sequence(), 0u);
+        append(writer, 10);
+        append(writer, 11);
+        ASSERT_EQ(writer.next_sequence(), 2u);
+    }
+
+    expect_records(read_all(), 0, {10, 11});
+}
+
+TEST_F(SegmentedJournalTest, EncodesMessagesInPlace)
+{
+    options.segment_size = 0x1000;
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        const auto max_size = 64;
+        auto m = sbepp::make_view<test_schema::messages::msg4>(
+            writer.claim(max_size), max_size);
+        sbepp::fill_message_header(m);
+        m.number1(5);
+
+        ASSERT_EQ(writer.commit(sbepp::size_bytes(m)), 0u);
+    }
+
+    sbepp::segmented_journal_reader reader{dir};
+    const auto n = reader.for_each(
+        [](std::uint64_t, const std::uint8_t* data, const std::size_t size)
+        {
+            const auto m = sbepp::make_const_view<test_schema::messages::msg4>(
+                data, size);
+            EXPECT_EQ(sbepp::size_bytes(m), size);
+            EXPECT_EQ(*m.number1(), 5u);
+        });
+    ASSERT_EQ(n, 1u);
+}
+
+TEST_F(SegmentedJournalTest, PreallocatesSegmentAndWritesHeader)
+{
+    options.schema_id = sbepp::schema_traits<test_schema::schema>::id();
+    options.schema_version =
+        sbepp::schema_traits<test_schema::schema>::version();
+    sbepp::segmented_journal_writer writer{dir, options};
+
+    const auto paths = sbepp::list_journal_segments(dir);
+    ASSERT_EQ(paths.size(), 1u);
+    ASSERT_EQ(paths[0], dir + "/00000000000000000000.sbeseg");
+    struct stat st;
+    ASSERT_EQ(::stat(paths[0].c_str(), &st), 0);
+    ASSERT_EQ(static_cast<std::size_t>(st.st_size), options.segment_size);
+
+    const sbepp::journal_segment segment{paths[0]};
+    ASSERT_TRUE(segment);
+    ASSERT_EQ(segment.header().schema_id, options.schema_id);
+    ASSERT_EQ(segment.header().schema_version, options.schema_version);
+    ASSERT_EQ(segment.header().first_sequence, 0u);
+    ASSERT_EQ(segment.header().segment_size, options.segment_size);
+}
+
+TEST_F(SegmentedJournalTest, RollsSegmentWhenItIsFull)
+{
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        for(std::uint64_t i = 0; i != 10; i++)
+        {
+            append(writer, i);
+        }
+        ASSERT_EQ(writer.segment_count(), 3u);
+    }
+
+    sbepp::segmented_journal_reader reader{dir};
+    ASSERT_EQ(reader.segment_count(), 3u);
+    ASSERT_EQ(reader.open_segment(0).header().first_sequence, 0u);
+    ASSERT_EQ(reader.open_segment(1).header().first_sequence, 4u);
+    ASSERT_EQ(reader.open_segment(2).header().first_sequence, 8u);
+    expect_records(read_all(), 0, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+}
+
+TEST_F(SegmentedJournalTest, RemovesOldestSegmentsBeyondRetentionLimit)
+{
+    options.max_segments = 2;
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        for(std::uint64_t i = 0; i != 10; i++)
+        {
+            append(writer, i);
+        }
+        ASSERT_EQ(writer.segment_count(), 2u);
+    }
+
+    expect_records(read_all(), 4, {4, 5, 6, 7, 8, 9});
+}
+
+TEST_F(SegmentedJournalTest, ContinuesSequenceAfterExistingSegments)
+{
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        append(writer, 0);
+        append(writer, 1);
+    }
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+
+        ASSERT_EQ(writer.next_sequence(), 2u);
+        ASSERT_EQ(writer.segment_count(), 2u);
+        append(writer, 2);
+    }
+    {
+        // empty last segment is replaced
+        sbepp::segmented_journal_writer writer1{dir, options};
+    }
+    sbepp::segmented_journal_writer writer2{dir, options};
+
+    ASSERT_EQ(writer2.next_sequence(), 3u);
+    ASSERT_EQ(writer2.segment_count(), 3u);
+    expect_records(read_all(), 0, {0, 1, 2});
+}
+
+TEST_F(SegmentedJournalTest, PreparesNextSegmentInBackground)
+{
+    const auto next_path = dir + "/next.sbeseg.tmp";
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        struct stat st{};
+        for(int i = 0; (i != 5000) && (::stat(next_path.c_str(), &st) == -1);
+            i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        ASSERT_EQ(::stat(next_path.c_str(), &st), 0);
+        ASSERT_EQ(static_cast<std::size_t>(st.st_size), options.segment_size);
+        ASSERT_EQ(sbepp::list_journal_segments(dir).size(), 1u);
+
+        for(std::uint64_t i = 0; i != 10; i++)
+        {
+            append(writer, i);
+        }
+        ASSERT_EQ(writer.segment_count(), 3u);
+    }
+
+    struct stat st{};
+    ASSERT_EQ(::stat(next_path.c_str(), &st), -1);
+    expect_records(read_all(), 0, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+}
+
+TEST_F(SegmentedJournalTest, CreatesNextSegmentInClaimIfNotPreparedInBackground)
+{
+    options.prepare_in_background = false;
+    options.max_segments = 2;
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        for(std::uint64_t i = 0; i != 10; i++)
+        {
+            append(writer, i);
+        }
+        ASSERT_EQ(writer.segment_count(), 2u);
+    }
+
+    struct stat st{};
+    ASSERT_EQ(::stat((dir + "/next.sbeseg.tmp").c_str(), &st), -1);
+    expect_records(read_all(), 4, {4, 5, 6, 7, 8, 9});
+}
+
+TEST_F(SegmentedJournalTest, RemovesLeftNextSegment)
+{
+    const auto next_path = dir + "/next.sbeseg.tmp";
+    const auto file = std::fopen(next_path.c_str(), "w");
+    ASSERT_TRUE(file);
+    std::fclose(file);
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        for(std::uint64_t i = 0; i != 6; i++)
+        {
+            append(writer, i);
+        }
+    }
+
+    expect_records(read_all(), 0, {0, 1, 2, 3, 4, 5});
+}
+
+TEST_F(SegmentedJournalTest, ReaderIgnoresOtherFiles)
+{
+    {
+        sbepp::segmented_journal_writer writer{dir, options};
+        append(writer, 1);
+    }
+    const auto file = std::fopen((dir + "/other").c_str(), "w");
+    ASSERT_TRUE(file);
+    std::fclose(file);
+
+    expect_records(read_all(), 0, {1});
+}
+
+TEST_F(SegmentedJournalTest, ThrowsIfMessageDoesNotFitIntoSegment)
+{
+    sbepp::segmented_journal_writer writer{dir, options};
+
+    ASSERT_EQ(writer.max_message_size(), options.segment_size - 64 - 4);
+    ASSERT_THROW(
+        writer.claim(writer.max_message_size() + 1), std::length_error);
+    ASSERT_NO_THROW(writer.claim(writer.max_message_size()));
+}
+
+TEST_F(SegmentedJournalTest, ThrowsOnInvalidOptions)
+{
+    auto opts = options;
+    opts.segment_size = 64;
+    ASSERT_THROW(
+        (sbepp::segmented_journal_writer{dir, opts}), std::invalid_argument);
+
+    opts = options;
+    opts.max_segments = 1;
+    ASSERT_THROW(
+        (sbepp::segmented_journal_writer{dir, opts}), std::invalid_argument);
+}
+
+TEST_F(SegmentedJournalTest, ThrowsIfDirectoryDoesNotExist)
+{
+    ASSERT_THROW(
+        (sbepp::segmented_journal_writer{dir + "/missing", options}),
+        std::system_error);
+    ASSERT_THROW(
+        (sbepp::segmented_journal_reader{dir + "/missing"}),
+        std::system_error);
+}
+
+TEST_F(SegmentedJournalTest, SegmentThrowsOnInvalidFile)
+{
+    const auto path = dir + "/other";
+    const auto file = std::fopen(path.c_str(), "w");
+    ASSERT_TRUE(file);
+    const std::array<char, 64> zeros{};
+    std::fwrite(zeros.data(), 1, zeros.size(), file);
+    std::fclose(file);
+
+    ASSERT_THROW(sbepp::journal_segment{path}, std::runtime_error);
+    ASSERT_THROW(sbepp::journal_segment{dir + "/missing"}, std::system_error);
+}
+} // namespace
+#endif
@@ -172,6 +172,14 @@ TEST(SetTest, VisitSetVisitsChoices)
         });
 }
 
+TEST(SetTest, SetHasReservedBitsChecksNonChoiceBits)
+{
+    ASSERT_FALSE(sbepp::set_has_reserved_bits(set_t{}));
+    ASSERT_FALSE(sbepp::set_has_reserved_bits(set_t{}.A(true).B(true)));
+    ASSERT_TRUE(sbepp::set_has_reserved_bits(set_t{0x02}));
+    ASSERT_TRUE(sbepp::set_has_reserved_bits(set_t{0x80}));
+}
+
 #if SBEPP_HAS_CONSTEXPR_ACCESSORS
 constexpr set_t constexpr_test()
 {
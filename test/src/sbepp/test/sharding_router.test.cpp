@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg4.hpp>
+#endif
+
+#include <sbepp/shared_buffer.hpp>
+#include <sbepp/sharding_router.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+std::vector<int> pop_all(sbepp::spsc_queue<int>& queue)
+{
+    std::vector<int> res;
+    queue.poll(
+        [&res](const int value)
+        {
+            res.push_back(value);
+        });
+    return res;
+}
+
+TEST(SpscQueueTest, RoundsCapacityUpToPowerOfTwo)
+{
+    sbepp::spsc_queue<int> queue{5};
+
+    ASSERT_EQ(queue.capacity(), 8u);
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, PopsElementsInPushOrder)
+{
+    sbepp::spsc_queue<int> queue{4};
+
+    ASSERT_TRUE(queue.try_push(1));
+    ASSERT_TRUE(queue.try_push(2));
+    ASSERT_EQ(queue.size(), 2u);
+
+    ASSERT_EQ(pop_all(queue), (std::vector<int>{1, 2}));
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, TryPushFailsIfQueueIsFull)
+{
+    sbepp::spsc_queue<int> queue{2};
+
+    ASSERT_TRUE(queue.try_push(1));
+    ASSERT_TRUE(queue.try_push(2));
+    ASSERT_FALSE(queue.try_push(3));
+
+    ASSERT_EQ(pop_all(queue), (std::vector<int>{1, 2}));
+    ASSERT_TRUE(queue.try_push(3));
+    ASSERT_TRUE(queue.try_push(4));
+    ASSERT_EQ(pop_all(queue), (std::vector<int>{3, 4}));
+}
+
+TEST(SpscQueueTest, PollRespectsMaxCount)
+{
+    sbepp::spsc_queue<int> queue{4};
+    queue.try_push(1);
+    queue.try_push(2);
+    queue.try_push(3);
+    std::vector<int> res;
+
+    const auto n = queue.poll(
+        [&res](const int value)
+        {
+            res.push_back(value);
+        },
+        2);
+
+    ASSERT_EQ(n, 2u);
+    ASSERT_EQ(res, (std::vector<int>{1, 2}));
+    ASSERT_EQ(pop_all(queue), (std::vector<int>{3}));
+}
+
+TEST(ShardingRouterTest, ThrowsIfThereAreNoShards)
+{
+    ASSERT_THROW(
+        (sbepp::sharding_router<int>{0, 4}), std::invalid_argument);
+}
+
+TEST(ShardingRouterTest, SameKeyIsAlwaysRoutedToTheSameShard)
+{
+    sbepp::sharding_router<int> router{4, 16};
+
+    for(std::uint32_t key = 0; key != 100; key++)
+    {
+        const auto shard = router.shard_of(key);
+
+        ASSERT_LT(shard, router.shards());
+        ASSERT_EQ(router.shard_of(key), shard);
+    }
+}
+
+TEST(ShardingRouterTest, SequentialKeysAreSpreadAcrossShards)
+{
+    sbepp::sharding_router<int> router{4, 16};
+    std::array<std::size_t, 4> counts{};
+
+    for(std::uint32_t key = 0; key != 1000; key++)
+    {
+        counts[router.shard_of(key)]++;
+    }
+
+    for(const auto count : counts)
+    {
+        ASSERT_GT(count, 150u);
+    }
+}
+
+TEST(ShardingRouterTest, PreservesPerKeyOrder)
+{
+    sbepp::sharding_router<int> router{2, 16};
+    const std::uint32_t key = 7;
+
+    ASSERT_TRUE(router.try_route(key, 1));
+    ASSERT_TRUE(router.try_route(key, 2));
+    ASSERT_TRUE(router.try_route(key, 3));
+
+    const auto shard = router.shard_of(key);
+    ASSERT_EQ(pop_all(router.shard(shard)), (std::vector<int>{1, 2, 3}));
+    ASSERT_TRUE(router.shard(1 - shard).empty());
+}
+
+TEST(ShardingRouterTest, CountsStalls)
+{
+    sbepp::sharding_router<int> router{1, 1};
+
+    ASSERT_TRUE(router.try_route(1, 1));
+    ASSERT_FALSE(router.try_route(1, 2));
+    ASSERT_EQ(router.stalls(), 1u);
+}
+
+TEST(ShardingRouterTest, RoutesMessageByExtractedKeyWithoutCopying)
+{
+    std::array<std::uint8_t, 64> buf{};
+    auto m = sbepp::make_view<test_schema::messages::msg4>(
+        buf.data(), buf.size());
+    sbepp::fill_message_header(m);
+    m.number1(10);
+    const auto size = sbepp::size_bytes(m);
+    sbepp::sharding_router<> router{4, 16};
+
+    ASSERT_TRUE(sbepp::try_route_message<test_schema::messages::msg4>(
+        router,
+        buf.data(),
+        size,
+        [](test_schema::messages::msg4<const std::uint8_t> m)
+        {
+            return *m.number1();
+        }));
+
+    std::vector<sbepp::routed_message> res;
+    router.shard(router.shard_of(std::uint32_t{10}))
+        .poll(
+            [&res](const sbepp::routed_message& msg)
+            {
+                res.push_back(msg);
+            });
+    ASSERT_EQ(res.size(), 1u);
+    ASSERT_EQ(res[0].data, buf.data());
+    ASSERT_EQ(res[0].size, size);
+}
+
+TEST(ShardingRouterTest, ReleasesSharedMessageOncePolled)
+{
+    using message_t = sbepp::shared_message<
+        test_schema::messages::msg4<const std::uint8_t>,
+        sbepp::atomic_ref_count>;
+    sbepp::buffer_slab<sbepp::atomic_ref_count> slab{64};
+    auto m = sbepp::make_view<test_schema::messages::msg4>(
+        slab.data(), slab.size());
+    sbepp::fill_message_header(m);
+    sbepp::sharding_router<message_t> router{1, 16};
+
+    ASSERT_TRUE(router.try_route(
+        1,
+        sbepp::make_shared_message<test_schema::messages::msg4>(
+            slab, 0, sbepp::size_bytes(m))));
+    ASSERT_EQ(slab.use_count(), 2);
+
+    std::size_t use_count{};
+    router.shard(0).poll(
+        [&use_count, &slab](const message_t&)
+        {
+            use_count = slab.use_count();
+        });
+    ASSERT_EQ(use_count, 2u);
+    ASSERT_EQ(slab.use_count(), 1);
+}
+
+TEST(ShardingRouterTest, ConsumersReceivePerKeyOrderedMessages)
+{
+    static constexpr std::size_t number_of_shards = 4;
+    static constexpr int number_of_keys = 16;
+    static constexpr int messages_per_key = 1000;
+    // value is `key * messages_per_key + n`
+    sbepp::sharding_router<int> router{number_of_shards, 64};
+    std::vector<char> ordered(number_of_shards, true);
+    std::vector<std::thread> threads;
+    std::vector<int> received(number_of_shards);
+    std::vector<int> expected(number_of_shards);
+    for(int key = 0; key != number_of_keys; key++)
+    {
+        expected[router.shard_of(key)] += messages_per_key;
+    }
+
+    for(std::size_t i = 0; i != number_of_shards; i++)
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                std::vector<int> last(number_of_keys, -1);
+                while(received[i] != expected[i])
+                {
+                    received[i] += static_cast<int>(router.shard(i).poll(
+                        [&](const int value)
+                        {
+                            const auto key = value / messages_per_key;
+                            const auto n = value % messages_per_key;
+                            if(n != last[key] + 1)
+                            {
+                                ordered[i] = false;
+                            }
+                            last[key] = n;
+                        }));
+                    std::this_thread::yield();
+                }
+            });
+    }
+
+    for(int n = 0; n != messages_per_key; n++)
+    {
+        for(int key = 0; key != number_of_keys; key++)
+        {
+            while(!router.try_route(key, key * messages_per_key + n))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+    for(std::size_t i = 0; i != number_of_shards; i++)
+    {
+        ASSERT_TRUE(ordered[i]);
+        ASSERT_EQ(received[i], expected[i]);
+    }
+}
+} // namespace
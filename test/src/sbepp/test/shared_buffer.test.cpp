@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg27.hpp>
+#endif
+
+#include <sbepp/shared_buffer.hpp>
+#include <sbepp/test/utils.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+template<typename RefCount>
+class BufferSlabTest : public ::testing::Test
+{
+};
+
+using ref_count_types =
+    ::testing::Types<sbepp::local_ref_count, sbepp::atomic_ref_count>;
+
+TYPED_TEST_SUITE(BufferSlabTest, ref_count_types);
+
+TYPED_TEST(BufferSlabTest, DefaultConstructedSlabIsEmpty)
+{
+    sbepp::buffer_slab<TypeParam> slab;
+
+    ASSERT_FALSE(slab);
+    ASSERT_EQ(slab.data(), nullptr);
+    ASSERT_EQ(slab.size(), 0);
+    ASSERT_EQ(slab.use_count(), 0);
+}
+
+TYPED_TEST(BufferSlabTest, AllocatesAlignedBuffer)
+{
+    sbepp::buffer_slab<TypeParam> slab{100};
+
+    ASSERT_TRUE(slab);
+    ASSERT_NE(slab.data(), nullptr);
+    ASSERT_EQ(slab.size(), 100);
+    ASSERT_EQ(slab.use_count(), 1);
+    ASSERT_EQ(
+        reinterpret_cast<std::uintptr_t>(slab.data())
+            % alignof(std::max_align_t),
+        0);
+}
+
+TYPED_TEST(BufferSlabTest, CountsReferences)
+{
+    sbepp::buffer_slab<TypeParam> slab{100};
+
+    auto slab2 = slab;
+    ASSERT_EQ(slab.use_count(), 2);
+    ASSERT_EQ(slab2.data(), slab.data());
+
+    auto slab3 = std::move(slab2);
+    ASSERT_FALSE(slab2);
+    ASSERT_EQ(slab.use_count(), 2);
+
+    slab3.reset();
+    ASSERT_FALSE(slab3);
+    ASSERT_EQ(slab.use_count(), 1);
+
+    slab2 = slab;
+    slab3 = slab2;
+    ASSERT_EQ(slab.use_count(), 3);
+    slab2 = sbepp::buffer_slab<TypeParam>{};
+    ASSERT_EQ(slab.use_count(), 2);
+}
+
+using message_t = test_schema::messages::msg27<const std::uint8_t>;
+
+std::size_t fill_message(std::uint8_t* ptr, const std::size_t size)
+{
+    auto m = sbepp::make_view<test_schema::messages::msg27>(ptr, size);
+    sbepp::fill_message_header(m);
+    m.number(static_cast<std::uint32_t>(size));
+    sbepp::fill_group_header(m.group(), 0);
+    m.data().resize(0);
+    return sbepp::size_bytes(m);
+}
+
+TEST(SharedMessageTest, KeepsSlabAlive)
+{
+    sbepp::buffer_slab<> slab{128};
+    const auto size = fill_message(slab.data(), 64);
+
+    auto m = sbepp::make_shared_message<test_schema::messages::msg27>(
+        slab, 0, size);
+    using expected_t =
+        sbepp::shared_message<message_t, sbepp::local_ref_count>;
+    IS_SAME_TYPE(decltype(m), expected_t);
+    ASSERT_EQ(slab.use_count(), 2);
+    slab.reset();
+
+    ASSERT_TRUE(m);
+    ASSERT_EQ(m.get_slab().use_count(), 1);
+    ASSERT_EQ(m->number(), 64);
+    ASSERT_EQ((*m).number(), 64);
+    ASSERT_EQ(sbepp::size_bytes(m.get()), size);
+
+    m.reset();
+    ASSERT_FALSE(m);
+}
+
+TEST(SharedMessageTest, SharesSlabBetweenMessages)
+{
+    sbepp::buffer_slab<> slab{128};
+    const auto size1 = fill_message(slab.data(), 64);
+    const auto size2 = fill_message(slab.data() + 64, 64);
+    std::vector<sbepp::shared_message<message_t>> messages;
+
+    messages.push_back(
+        sbepp::make_shared_message<test_schema::messages::msg27>(
+            slab, 0, size1));
+    messages.push_back(
+        sbepp::make_shared_message<test_schema::messages::msg27>(
+            slab, 64, size2));
+    slab.reset();
+
+    ASSERT_EQ(messages[0].get_slab().use_count(), 2);
+    ASSERT_EQ(
+        sbepp::addressof(messages[1].get()),
+        messages[0].get_slab().data() + 64);
+    messages.pop_back();
+    ASSERT_EQ(messages[0].get_slab().use_count(), 1);
+}
+
+TEST(SharedMessageTest, CanBeReleasedOnAnotherThread)
+{
+    std::vector<sbepp::shared_message<message_t, sbepp::atomic_ref_count>>
+        messages;
+    {
+        sbepp::buffer_slab<sbepp::atomic_ref_count> slab{128};
+        const auto size = fill_message(slab.data(), 64);
+        for(std::size_t i = 0; i != 100; i++)
+        {
+            messages.push_back(
+                sbepp::make_shared_message<test_schema::messages::msg27>(
+                    slab, 0, size));
+        }
+    }
+    std::uint64_t sum1{};
+    std::uint64_t sum2{};
+
+    std::thread t1{
+        [&sum1, &messages]()
+        {
+            for(std::size_t i = 0; i != 50; i++)
+            {
+                sum1 += *messages[i]->number();
+                messages[i].reset();
+            }
+        }};
+    std::thread t2{
+        [&sum2, &messages]()
+        {
+            for(std::size_t i = 50; i != 100; i++)
+            {
+                sum2 += *messages[i]->number();
+                messages[i].reset();
+            }
+        }};
+    t1.join();
+    t2.join();
+
+    ASSERT_EQ(sum1 + sum2, 100 * 64);
+}
+} // namespace
@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg4.hpp>
+#    include <test_schema/schema/schema.hpp>
+#endif
+
+#include <sbepp/snapshot.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <unistd.h>
+
+namespace
+{
+constexpr std::size_t msg4_size =
+    8
+    + sbepp::message_traits<test_schema::schema::messages::msg4>::
+        block_length();
+
+class SnapshotTest : public ::testing::Test
+{
+public:
+    std::string dir;
+    std::string path;
+
+    SnapshotTest()
+    {
+        char tmpl[] = "/tmp/sbepp_snapshot_XXXXXX";
+        if(::mkdtemp(tmpl))
+        {
+            dir = tmpl;
+        }
+        path = dir + "/state.snapshot";
+    }
+
+    ~SnapshotTest() override
+    {
+        ::unlink(path.c_str());
+        ::unlink((path + ".tmp").c_str());
+        ::rmdir(dir.c_str());
+    }
+
+    static void append_msg4(
+        sbepp::snapshot_writer& writer,
+        const std::uint64_t key,
+        const std::uint32_t number)
+    {
+        std::array<std::uint8_t, msg4_size> buf{};
+        auto m = sbepp::make_view<test_schema::messages::msg4>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number1(number);
+        writer.append(key, buf.data(), buf.size());
+    }
+
+    static std::uint32_t get_number(const sbepp::snapshot_entry& e)
+    {
+        const auto m = sbepp::make_const_view<test_schema::messages::msg4>(
+            e.data, e.size);
+        EXPECT_EQ(sbepp::size_bytes(m), e.size);
+        return *m.number1();
+    }
+
+    void write_snapshot(const std::vector<std::uint64_t>& keys)
+    {
+        sbepp::snapshot_writer writer{path};
+        for(std::size_t i = 0; i != keys.size(); i++)
+        {
+            append_msg4(writer, keys[i], static_cast<std::uint32_t>(i));
+        }
+        writer.finish(keys.size());
+    }
+};
+
+TEST_F(SnapshotTest, ReadsEntriesInKeyOrder)
+{
+    write_snapshot({3, 1, 2});
+    const sbepp::snapshot_file snapshot{path};
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> numbers;
+
+    const auto n = snapshot.for_each(
+        [&keys, &numbers](const sbepp::snapshot_entry& e)
+        {
+            keys.push_back(e.key);
+            numbers.push_back(get_number(e));
+        });
+
+    ASSERT_EQ(n, 3u);
+    ASSERT_EQ(keys, (std::vector<std::uint64_t>{1, 2, 3}));
+    ASSERT_EQ(numbers, (std::vector<std::uint32_t>{1, 2, 0}));
+}
+
+TEST_F(SnapshotTest, FindsEntriesByKeyInAppendOrder)
+{
+    write_snapshot({5, 7, 5, 1, 5});
+    const sbepp::snapshot_file snapshot{path};
+    std::vector<std::uint32_t> numbers;
+
+    const auto n = snapshot.for_each_of(
+        5,
+        [&numbers](const sbepp::snapshot_entry& e)
+        {
+            EXPECT_EQ(e.key, 5u);
+            numbers.push_back(get_number(e));
+        });
+
+    ASSERT_EQ(n, 3u);
+    ASSERT_EQ(numbers, (std::vector<std::uint32_t>{0, 2, 4}));
+}
+
+TEST_F(SnapshotTest, LowerBoundHandlesMissingKeys)
+{
+    write_snapshot({10, 20, 30});
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_EQ(snapshot.lower_bound(0), 0u);
+    ASSERT_EQ(snapshot.lower_bound(20), 1u);
+    ASSERT_EQ(snapshot.lower_bound(25), 2u);
+    ASSERT_EQ(snapshot.lower_bound(31), 3u);
+    ASSERT_EQ(
+        snapshot.for_each_of(
+            25,
+            [](const sbepp::snapshot_entry&)
+            {
+            }),
+        0u);
+}
+
+TEST_F(SnapshotTest, StoresHeader)
+{
+    sbepp::snapshot_options options;
+    options.schema_id = sbepp::schema_traits<test_schema::schema>::id();
+    options.schema_version =
+        sbepp::schema_traits<test_schema::schema>::version();
+    {
+        sbepp::snapshot_writer writer{path, options};
+        append_msg4(writer, 1, 1);
+        ASSERT_EQ(writer.message_count(), 1u);
+        writer.finish(1234);
+    }
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_TRUE(snapshot);
+    ASSERT_EQ(snapshot.header().schema_id, options.schema_id);
+    ASSERT_EQ(snapshot.header().schema_version, options.schema_version);
+    ASSERT_EQ(snapshot.header().sequence, 1234u);
+    ASSERT_EQ(snapshot.header().message_count, 1u);
+    ASSERT_EQ(snapshot.message_count(), 1u);
+}
+
+TEST_F(SnapshotTest, AppendsMessageView)
+{
+    {
+        sbepp::snapshot_writer writer{path};
+        std::array<std::uint8_t, msg4_size> buf{};
+        auto m = sbepp::make_view<test_schema::messages::msg4>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number1(42);
+        writer.append(1, m);
+        writer.finish(0);
+    }
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_EQ(snapshot.entry(0).size, msg4_size);
+    ASSERT_EQ(get_number(snapshot.entry(0)), 42u);
+}
+
+TEST_F(SnapshotTest, WritesThroughSmallBuffer)
+{
+    static constexpr std::uint32_t message_count = 100;
+    sbepp::snapshot_options options;
+    options.buffer_size = 1;
+    {
+        sbepp::snapshot_writer writer{path, options};
+        for(std::uint32_t i = 0; i != message_count; i++)
+        {
+            append_msg4(writer, message_count - i, i);
+        }
+        writer.finish(0);
+    }
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_EQ(snapshot.message_count(), message_count);
+    for(std::uint32_t i = 0; i != message_count; i++)
+    {
+        const auto e = snapshot.entry(i);
+        ASSERT_EQ(e.key, i + 1);
+        ASSERT_EQ(get_number(e), message_count - 1 - i);
+    }
+}
+
+TEST_F(SnapshotTest, ReadsEmptySnapshot)
+{
+    write_snapshot({});
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_EQ(snapshot.message_count(), 0u);
+    ASSERT_EQ(snapshot.lower_bound(1), 0u);
+}
+
+TEST_F(SnapshotTest, SnapshotAppearsOnlyAfterFinish)
+{
+    {
+        sbepp::snapshot_writer writer{path};
+        append_msg4(writer, 1, 1);
+
+        ASSERT_EQ(::access(path.c_str(), F_OK), -1);
+    }
+    // unfinished temporary file is removed
+    ASSERT_EQ(::access((path + ".tmp").c_str(), F_OK), -1);
+    ASSERT_EQ(::access(path.c_str(), F_OK), -1);
+}
+
+TEST_F(SnapshotTest, FinishesSnapshotInCurrentDirectory)
+{
+    std::array<char, 4096> cwd{};
+    ASSERT_TRUE(::getcwd(cwd.data(), cwd.size()));
+    ASSERT_EQ(::chdir(dir.c_str()), 0);
+    {
+        sbepp::snapshot_writer writer{"state.snapshot"};
+        append_msg4(writer, 1, 1);
+        writer.finish(0);
+    }
+    ASSERT_EQ(::chdir(cwd.data()), 0);
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_EQ(snapshot.message_count(), 1u);
+}
+
+TEST_F(SnapshotTest, ThrowsOnInvalidFile)
+{
+    const auto file = std::fopen(path.c_str(), "w");
+    ASSERT_TRUE(file);
+    const std::array<char, 64> zeros{};
+    std::fwrite(zeros.data(), 1, zeros.size(), file);
+    std::fclose(file);
+
+    ASSERT_THROW(sbepp::snapshot_file{path}, std::runtime_error);
+    ASSERT_THROW(sbepp::snapshot_file{dir + "/missing"}, std::system_error);
+}
+
+TEST_F(SnapshotTest, ThrowsOnCorruptedIndexEntry)
+{
+    write_snapshot({1});
+    const auto fd = ::open(path.c_str(), O_WRONLY);
+    ASSERT_NE(fd, -1);
+    // offset of the only index entry
+    std::array<std::uint8_t, 8> offset{};
+    sbepp::detail::set_primitive<sbepp::endian::little>(
+        offset.data(), std::uint64_t{1000});
+    ASSERT_EQ(
+        ::pwrite(fd, offset.data(), offset.size(), 64 + msg4_size + 8),
+        static_cast<ssize_t>(offset.size()));
+    ::close(fd);
+    const sbepp::snapshot_file snapshot{path};
+
+    ASSERT_THROW(snapshot.entry(0), std::runtime_error);
+}
+} // namespace
+#endif
@@ -0,0 +1,293 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg4.hpp>
+#endif
+
+#include <sbepp/tcp_transport.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#    include <netinet/in.h>
+#    include <netinet/tcp.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+
+namespace
+{
+constexpr std::size_t msg4_size =
+    8
+    + sbepp::message_traits<test_schema::schema::messages::msg4>::
+        block_length();
+
+class TcpTransportTest : public ::testing::Test
+{
+public:
+    sbepp::tcp_listener listener{"127.0.0.1", 0};
+    sbepp::tcp_connection client;
+    sbepp::tcp_connection server;
+
+    void connect(const sbepp::tcp_options& options = {})
+    {
+        client = sbepp::tcp_connection::connect(
+            "127.0.0.1", listener.port(), options);
+        sbepp::tcp_poller poller;
+        poller.add(listener.native_handle(), nullptr);
+        while(!server)
+        {
+            poller.wait(
+                1000,
+                [this, &options](void*, std::uint32_t)
+                {
+                    server = listener.accept(options);
+                });
+        }
+    }
+
+    static void send_msg4(
+        sbepp::tcp_connection& conn, const std::uint32_t number)
+    {
+        std::array<std::uint8_t, msg4_size> buf{};
+        auto m = sbepp::make_view<test_schema::messages::msg4>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.number1(number);
+        conn.send(buf.data(), buf.size());
+    }
+
+    // polls until `n` messages are received or connection is closed
+    static std::vector<std::uint32_t>
+        receive_msg4(sbepp::tcp_connection& conn, const std::size_t n)
+    {
+        std::vector<std::uint32_t> res;
+        while(conn.is_open() && (res.size() < n))
+        {
+            conn.poll(
+                [&res](const std::uint8_t* data, const std::size_t size)
+                {
+                    const auto m =
+                        sbepp::make_const_view<test_schema::messages::msg4>(
+                            data, size);
+                    EXPECT_EQ(sbepp::size_bytes(m), size);
+                    res.push_back(*m.number1());
+                });
+        }
+        return res;
+    }
+
+    void send_raw(const void* data, const std::size_t size)
+    {
+        ASSERT_EQ(
+            ::send(client.native_handle(), data, size, 0),
+            static_cast<ssize_t>(size));
+    }
+};
+
+TEST_F(TcpTransportTest, TransfersMessagesInBothDirections)
+{
+    connect();
+
+    send_msg4(client, 1);
+    send_msg4(client, 2);
+    send_msg4(server, 3);
+
+    ASSERT_EQ(receive_msg4(server, 2), (std::vector<std::uint32_t>{1, 2}));
+    ASSERT_EQ(receive_msg4(client, 1), (std::vector<std::uint32_t>{3}));
+}
+
+TEST_F(TcpTransportTest, AppliesNoDelay)
+{
+    connect();
+    int value{};
+    socklen_t size = sizeof(value);
+
+    ASSERT_EQ(
+        ::getsockopt(
+            client.native_handle(), IPPROTO_TCP, TCP_NODELAY, &value, &size),
+        0);
+    ASSERT_EQ(value, 1);
+}
+
+TEST_F(TcpTransportTest, WaitsForCompleteFrame)
+{
+    connect();
+    std::array<std::uint8_t, sbepp::sofh_size + 4> frame{};
+    sbepp::detail::set_primitive<sbepp::endian::big>(
+        frame.data(), static_cast<std::uint32_t>(frame.size()));
+    sbepp::detail::set_primitive<sbepp::endian::big>(
+        frame.data() + 4, sbepp::sofh_sbe_little_endian);
+    frame[sbepp::sofh_size] = 42;
+    std::vector<std::uint8_t> received;
+    const auto handler =
+        [&received](const std::uint8_t* data, const std::size_t size)
+    {
+        received.assign(data, data + size);
+    };
+
+    send_raw(frame.data(), 3);
+    ASSERT_EQ(server.poll(handler), 0u);
+    send_raw(frame.data() + 3, frame.size() - 3);
+    while(!server.poll(handler))
+    {
+    }
+
+    ASSERT_EQ(received.size(), 4u);
+    ASSERT_EQ(received[0], 42);
+}
+
+TEST_F(TcpTransportTest, ThrowsOnUnexpectedEncodingType)
+{
+    connect();
+    std::array<std::uint8_t, sbepp::sofh_size> frame{};
+    sbepp::detail::set_primitive<sbepp::endian::big>(
+        frame.data(), static_cast<std::uint32_t>(frame.size()));
+    sbepp::detail::set_primitive<sbepp::endian::big>(
+        frame.data() + 4, sbepp::sofh_sbe_big_endian);
+    send_raw(frame.data(), frame.size());
+
+    ASSERT_THROW(
+        server.poll(
+            [](const std::uint8_t*, std::size_t)
+            {
+            }),
+        std::runtime_error);
+}
+
+TEST_F(TcpTransportTest, ThrowsIfFrameDoesNotFitIntoBuffer)
+{
+    sbepp::tcp_options options;
+    options.receive_buffer_size = 64;
+    connect(options);
+    std::array<std::uint8_t, 65> message{};
+    client.send(message.data(), message.size());
+
+    ASSERT_THROW(
+        server.poll(
+            [](const std::uint8_t*, std::size_t)
+            {
+            }),
+        std::runtime_error);
+}
+
+TEST_F(TcpTransportTest, DetectsClosedConnection)
+{
+    connect();
+    send_msg4(client, 1);
+    client = sbepp::tcp_connection{};
+
+    ASSERT_EQ(receive_msg4(server, 2), (std::vector<std::uint32_t>{1}));
+    ASSERT_FALSE(server.is_open());
+}
+
+TEST_F(TcpTransportTest, QueuesOutputWhenSocketBufferIsFull)
+{
+    connect();
+    static constexpr std::size_t message_count = 200;
+    std::vector<std::uint8_t> message(0x8000);
+    for(std::uint32_t i = 0; i != message_count; i++)
+    {
+        sbepp::detail::set_primitive<sbepp::endian::little>(
+            message.data(), i);
+        client.send(message.data(), message.size());
+    }
+    ASSERT_TRUE(client.has_pending_output());
+
+    std::vector<std::uint32_t> received;
+    while(received.size() != message_count)
+    {
+        client.flush();
+        server.poll(
+            [&received, &message](
+                const std::uint8_t* data, const std::size_t size)
+            {
+                EXPECT_EQ(size, message.size());
+                received.push_back(
+                    sbepp::detail::get_primitive<
+                        std::uint32_t,
+                        sbepp::endian::little>(data));
+            });
+    }
+
+    ASSERT_TRUE(client.flush());
+    ASSERT_FALSE(client.has_pending_output());
+    for(std::uint32_t i = 0; i != message_count; i++)
+    {
+        ASSERT_EQ(received[i], i);
+    }
+}
+
+TEST_F(TcpTransportTest, PollerReportsReadableConnection)
+{
+    connect();
+    sbepp::tcp_poller poller;
+    poller.add(server.native_handle(), &server);
+    send_msg4(client, 5);
+    std::vector<std::uint32_t> received;
+
+    while(received.empty())
+    {
+        poller.wait(
+            1000,
+            [&received](void* user_data, std::uint32_t)
+            {
+                static_cast<sbepp::tcp_connection*>(user_data)->poll(
+                    [&received](
+                        const std::uint8_t* data, const std::size_t size)
+                    {
+                        received.push_back(
+                            *sbepp::make_const_view<
+                                 test_schema::messages::msg4>(data, size)
+                                 .number1());
+                    });
+            });
+    }
+
+    ASSERT_EQ(received, (std::vector<std::uint32_t>{5}));
+    // edge-triggered poller doesn't report drained socket again
+    ASSERT_EQ(
+        poller.wait(
+            0,
+            [](void*, std::uint32_t)
+            {
+            }),
+        0u);
+}
+
+TEST_F(TcpTransportTest, AcceptReturnsEmptyConnectionIfNoneIsPending)
+{
+    ASSERT_FALSE(listener.accept());
+}
+
+TEST(TcpReceiveBufferTest, ThrowsOnTooShortFrameLength)
+{
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+    std::array<std::uint8_t, sbepp::sofh_size> frame{};
+    sbepp::detail::set_primitive<sbepp::endian::big>(
+        frame.data() + 4, sbepp::sofh_sbe_little_endian);
+    ASSERT_EQ(::write(fds[0], frame.data(), frame.size()), 6);
+    sbepp::tcp_receive_buffer buffer{64};
+
+    ASSERT_EQ(buffer.read_from(fds[1]), sbepp::tcp_read_status::would_block);
+    ASSERT_EQ(buffer.size(), frame.size());
+    ASSERT_THROW(
+        buffer.for_each_frame(
+            [](const std::uint8_t*, std::size_t)
+            {
+            }),
+        std::runtime_error);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+} // namespace
+#endif
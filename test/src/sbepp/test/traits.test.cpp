@@ -442,6 +442,7 @@ TEST(MessageTraitsTest, ProvidesTheSameValuesAsSchemaXml)
     ASSERT_EQ(traits::semantic_type(), "message semantic type");
     IS_SAME_TYPE(
         traits::value_type<char>, traits_test_schema::messages::msg_1<char>);
+    IS_SAME_TYPE(traits::schema_tag, traits_test_schema::schema);
     IS_NOEXCEPT(traits::name());
     IS_NOEXCEPT(traits::description());
     IS_NOEXCEPT(traits::id());
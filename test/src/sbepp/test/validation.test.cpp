@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2023, Oleksandr Koval
+
+#ifdef USE_TOP_FILE
+#    include <test_schema/test_schema.hpp>
+#else
+#    include <test_schema/messages/msg30.hpp>
+#endif
+
+#include <sbepp/validation.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+namespace
+{
+using numbers_enum = test_schema::types::numbers_enum;
+using options_set = test_schema::types::options_set;
+
+class ValidationTest : public ::testing::Test
+{
+public:
+    std::array<std::uint8_t, 1024> buf{};
+    test_schema::messages::msg30<std::uint8_t> m;
+
+    void SetUp() override
+    {
+        m = sbepp::make_view<test_schema::messages::msg30>(
+            buf.data(), buf.size());
+        sbepp::fill_message_header(m);
+        m.required(5);
+        m.optional(sbepp::nullopt);
+        m.enumeration(numbers_enum::One);
+        m.set(options_set{}.A(true).B(true));
+        m.composite().number(1);
+        m.composite().enumeration(numbers_enum::Two);
+        m.composite().set(options_set{}.B(true));
+
+        auto g = m.group();
+        sbepp::fill_group_header(g, 2);
+        for(auto e : g)
+        {
+            e.number(10);
+            auto nested = e.nested();
+            sbepp::fill_group_header(nested, 2);
+            for(auto nested_entry : nested)
+            {
+                nested_entry.enumeration(numbers_enum::Two);
+            }
+        }
+        m.data().resize(3);
+    }
+
+    static void assert_invalid(
+        const sbepp::validation_result& res,
+        const sbepp::validation_error error,
+        const char* path)
+    {
+        ASSERT_FALSE(res.valid());
+        ASSERT_EQ(res.error, error);
+        ASSERT_EQ(res.path, path);
+    }
+};
+
+TEST_F(ValidationTest, ReturnsSizeForValidMessage)
+{
+    const auto res = sbepp::validate(m, buf.size());
+
+    ASSERT_TRUE(res.valid());
+    ASSERT_EQ(res.error, sbepp::validation_error::none);
+    ASSERT_TRUE(res.path.empty());
+    ASSERT_EQ(res.size, sbepp::size_bytes(m));
+}
+
+TEST_F(ValidationTest, ChecksSizeFirst)
+{
+    const auto res = sbepp::validate(m, sbepp::size_bytes(m) - 1);
+
+    assert_invalid(res, sbepp::validation_error::size, "");
+}
+
+TEST_F(ValidationTest, ChecksRequiredRange)
+{
+    m.required(11);
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::out_of_range,
+        "required");
+}
+
+TEST_F(ValidationTest, AcceptsNullOptional)
+{
+    m.optional(sbepp::nullopt);
+    ASSERT_TRUE(sbepp::validate(m, buf.size()).valid());
+
+    m.optional(10);
+    ASSERT_TRUE(sbepp::validate(m, buf.size()).valid());
+
+    m.optional(12);
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::out_of_range,
+        "optional");
+}
+
+TEST_F(ValidationTest, AcceptsAnyFloatWithoutSchemaBounds)
+{
+    m.real(0.0f);
+    m.optional_real(0.0f);
+    ASSERT_TRUE(sbepp::validate(m, buf.size()).valid());
+
+    m.real(-1.5f);
+    m.optional_real(-1.5f);
+    ASSERT_TRUE(sbepp::validate(m, buf.size()).valid());
+}
+
+TEST_F(ValidationTest, AcceptsNullFloat)
+{
+    m.optional_real(sbepp::nullopt);
+    m.bounded_real(sbepp::nullopt);
+
+    ASSERT_TRUE(sbepp::validate(m, buf.size()).valid());
+}
+
+TEST_F(ValidationTest, ChecksFloatSchemaBounds)
+{
+    m.bounded_real(-10.0f);
+    ASSERT_TRUE(sbepp::validate(m, buf.size()).valid());
+
+    m.bounded_real(-10.5f);
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::out_of_range,
+        "bounded_real");
+
+    m.bounded_real(10.5f);
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::out_of_range,
+        "bounded_real");
+}
+
+TEST_F(ValidationTest, ChecksEnumValue)
+{
+    m.enumeration(static_cast<numbers_enum>(3));
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::enum_value,
+        "enumeration");
+}
+
+TEST_F(ValidationTest, ChecksSetReservedBits)
+{
+    m.set(options_set{0x02});
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::reserved_bits,
+        "set");
+}
+
+TEST_F(ValidationTest, ChecksCompositeMembers)
+{
+    m.composite().set(options_set{0x80});
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::reserved_bits,
+        "composite.set");
+
+    m.composite().set(options_set{});
+    m.composite().number(20);
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::out_of_range,
+        "composite.number");
+}
+
+TEST_F(ValidationTest, ReportsEntryIndexes)
+{
+    auto it = m.group().begin();
+    ++it;
+    auto nested_it = (*it).nested().begin();
+    ++nested_it;
+    (*nested_it).enumeration(static_cast<numbers_enum>(0));
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::enum_value,
+        "group[1].nested[1].enumeration");
+}
+
+TEST_F(ValidationTest, ReportsFirstInvalidField)
+{
+    m.required(11);
+    (*m.group().begin()).number(11);
+
+    assert_invalid(
+        sbepp::validate(m, buf.size()),
+        sbepp::validation_error::out_of_range,
+        "required");
+}
+
+TEST_F(ValidationTest, CanValidateGroup)
+{
+    auto g = m.group();
+    auto it = g.begin();
+    ++it;
+    (*it).number(11);
+    const auto size =
+        buf.size()
+        - static_cast<std::size_t>(sbepp::addressof(g) - buf.data());
+
+    assert_invalid(
+        sbepp::validate(g, size),
+        sbepp::validation_error::out_of_range,
+        "group[1].number");
+}
+} // namespace
@@ -14,6 +14,7 @@
 
 #include <array>
 #include <cstring>
+#include <string>
 #include <type_traits>
 
 namespace
@@ -479,4 +480,36 @@ TEST(VisitGroupTest, OnEntryVisitorIsCalledCorrectNumberOfTimes)
 
     ASSERT_TRUE(visitor.is_valid());
 }
+
+class group_tag_visitor
+{
+public:
+    template<typename T, typename Cursor, typename Tag>
+    bool on_group(T, Cursor&, Tag)
+    {
+        name = sbepp::group_traits<Tag>::name();
+        is_group_tag = std::is_same<
+            Tag,
+            test_schema::schema::messages::msg17::group>::value;
+        return false;
+    }
+
+    std::string name;
+    bool is_group_tag{};
+};
+
+TEST(VisitGroupTest, OnGroupGetsGroupTag)
+{
+    std::array<byte_type, 512> buf{};
+    using group_t = sbepp::group_traits<
+        test_schema::schema::messages::msg17::group>::value_type<byte_type>;
+    group_t g{buf.data(), buf.size()};
+    sbepp::fill_group_header(g, 0);
+    group_tag_visitor visitor;
+
+    sbepp::visit(g, visitor);
+
+    ASSERT_TRUE(visitor.is_group_tag);
+    ASSERT_EQ(visitor.name, "group");
+}
 } // namespace